@@ -0,0 +1,155 @@
+#pragma once
+#include <cstddef> // For std::size_t
+#include <cstdint>
+
+/**
+ * @brief Reception ring filled-in by a DMA channel running in circular mode
+ *
+ * The storage of this object is handed over to the DMA controller, that will write incoming bytes into it, wrapping around at the end.
+ * Each time the DMA (or the peripheral feeding it) raises an event (half-transfer, transfer complete or idle line), the owner of this
+ * ring should call onDmaEvent() with the current DMA write position. We will then forward all bytes written since the previous event
+ * to the onBytes callback in one or two contiguous chunks, so that the receiver processes whole bursts instead of single bytes.
+ *
+ * @tparam N The size of the DMA storage (in bytes)
+ *
+ * @note There is no hardware dependency here, so a host mock can drive this class exactly like the DMA controller would
+ * @warning The DMA write position is not able to tell us if more than N bytes were written between two events (the DMA has lapped us)
+ *          With half-transfer and transfer complete events enabled, we are guaranteed to get at least one event every N/2 bytes anyway
+ */
+template <std::size_t N>
+class DmaRxRing {
+public:
+/* Types */
+    typedef void(*FOnBytesFunc)(const uint8_t* buf, std::size_t len, void* context); /*!< The prototype of callbacks invoked on new bytes written by the DMA */
+
+    typedef enum {
+        HalfTransfer = 0,
+        TransferComplete,
+        IdleLine,
+    } Event;
+
+/* Methods */
+    /**
+     * @brief Construct a new DMA reception ring
+     *
+     * @param onBytes A function to invoke with each chunk of newly received bytes
+     * @param context A user-defined pointer that will be passed as last argument when invoking onBytes()
+     */
+    DmaRxRing(FOnBytesFunc onBytes = nullptr, void* context = nullptr);
+
+    /**
+     * @brief Set the method to invoke on new bytes written by the DMA
+     *
+     * @param onBytes The method to invoke
+     * @param context A context provided to the method
+     */
+    void setOnBytes(FOnBytesFunc onBytes, void* context);
+
+    /**
+     * @brief Restart from the beginning of the storage (to be invoked each time the DMA transfer is (re)started)
+     */
+    void reset();
+
+    /**
+     * @brief Get the storage the DMA should write to
+     *
+     * @return A pointer to the first byte of a getCapacity() bytes buffer
+     */
+    uint8_t* getStorage();
+
+    std::size_t getCapacity() const;
+
+    /**
+     * @brief Process a DMA event
+     *
+     * @param event The event that occurred (for statistics only, all events are processed the same way)
+     * @param writePos The current DMA write offset in the storage (0 to N, N being equivalent to 0, as seen on transfer complete)
+     * @return The number of new bytes forwarded to the onBytes callback
+     *
+     * @note This method is meant to be called in interrupt context
+     */
+    std::size_t onDmaEvent(Event event, std::size_t writePos);
+
+    /**
+     * @brief Get the number of events processed by onDmaEvent() since the last reset()
+     *
+     * @param event The type of event to count
+     */
+    unsigned int getEventCount(Event event) const;
+
+private:
+    void forward(const uint8_t* buf, std::size_t len);
+
+/* Attributes */
+    alignas(32) uint8_t buf[N]; /*!< Internal storage written by the DMA (aligned on a cache line for cores that have a data cache) */
+    std::size_t readPos;    /*!< Offset of the next byte to forward */
+    unsigned int eventCount[IdleLine + 1]; /*!< Per-event type counters */
+    FOnBytesFunc onBytes;   /*!< Function invoked on new bytes */
+    void* onBytesContext;   /*!< A context pointer passed as argument to the above method */
+};
+
+template <std::size_t N>
+DmaRxRing<N>::DmaRxRing(FOnBytesFunc onBytes, void* context) :
+    onBytes(onBytes),
+    onBytesContext(context)
+{
+    this->reset();
+}
+
+template <std::size_t N>
+void DmaRxRing<N>::setOnBytes(FOnBytesFunc onBytes, void* context) {
+    this->onBytes = onBytes;
+    this->onBytesContext = context;
+}
+
+template <std::size_t N>
+void DmaRxRing<N>::reset() {
+    this->readPos = 0;
+    for (std::size_t i = 0; i < sizeof(this->eventCount)/sizeof(this->eventCount[0]); i++) {
+        this->eventCount[i] = 0;
+    }
+}
+
+template <std::size_t N>
+uint8_t* DmaRxRing<N>::getStorage() {
+    return this->buf;
+}
+
+template <std::size_t N>
+std::size_t DmaRxRing<N>::getCapacity() const {
+    return N;
+}
+
+template <std::size_t N>
+void DmaRxRing<N>::forward(const uint8_t* buf, std::size_t len) {
+    if (len > 0 && this->onBytes != nullptr) {
+        this->onBytes(buf, len, this->onBytesContext);
+    }
+}
+
+template <std::size_t N>
+std::size_t DmaRxRing<N>::onDmaEvent(Event event, std::size_t writePos) {
+    this->eventCount[event]++;
+    if (writePos > N) {
+        return 0; /* Failsafe, DMA cannot write outside of our storage */
+    }
+    writePos %= N; /* On transfer complete, the DMA is back to offset 0 */
+    std::size_t forwarded = 0;
+    if (writePos > this->readPos) {
+        forwarded = writePos - this->readPos;
+        this->forward(this->buf + this->readPos, forwarded);
+    }
+    else if (writePos < this->readPos) { /* DMA wrapped around, forward the tail of the storage, then its head */
+        forwarded = N - this->readPos;
+        this->forward(this->buf + this->readPos, forwarded);
+        this->forward(this->buf, writePos);
+        forwarded += writePos;
+    }
+    this->readPos = writePos;
+    return forwarded;
+}
+
+template <std::size_t N>
+unsigned int DmaRxRing<N>::getEventCount(Event event) const {
+    return this->eventCount[event];
+}
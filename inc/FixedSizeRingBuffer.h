@@ -39,6 +39,18 @@ public:
      */
     T getReverse(std::size_t n) const;
 
+    /**
+     * @brief Get the stored elements in place, as (at most) two contiguous spans of the internal storage
+     * 
+     * @param[out] older The oldest elements (the first one being the oldest element)
+     * @param[out] olderCount The number of elements in @p older
+     * @param[out] newer The newest elements, following @p older after a wrap around the storage (the last one being the last element), or empty
+     * @param[out] newerCount The number of elements in @p newer
+     * 
+     * @note Spans point to the internal storage and are only valid until the buffer is modified
+     */
+    void getSpans(const T*& older, std::size_t& olderCount, const T*& newer, std::size_t& newerCount) const;
+
     std::vector<T> getTail(std::size_t n) const;
     std::vector<T> toVector() const;
 
@@ -112,6 +124,24 @@ T* FixedSizeRingBuffer<T, N>::getPtrToLast() {
 	return &(this->buf[eltOffs]);
 }
 
+template <class T, std::size_t N>
+void FixedSizeRingBuffer<T, N>::getSpans(const T*& older, std::size_t& olderCount, const T*& newer, std::size_t& newerCount) const {
+    older = &(this->buf[this->tail]);
+    newer = this->buf;
+    if (this->isEmpty()) {
+        olderCount = 0;
+        newerCount = 0;
+    }
+    else if (this->tail < this->head) {
+        olderCount = this->head - this->tail;
+        newerCount = 0;
+    }
+    else {  /* Elements wrap around the end of the storage */
+        olderCount = N - this->tail;
+        newerCount = this->head;
+    }
+}
+
 template <class T, std::size_t N>
 std::vector<T> FixedSizeRingBuffer<T, N>::getTail(std::size_t len) const {
     std::vector<T> result;
@@ -0,0 +1,204 @@
+#pragma once
+#include <cstddef> // For std::size_t
+#include <cstdint>
+
+/**
+ * @brief Instrumentation of a serial reception path
+ *
+ * Collects, from the reception interrupt handlers:
+ * - the high-water mark of the reception buffer fill level
+ * - a log of the last overflow events (with a timestamp and the number of bytes lost)
+ * - statistics on the gaps between reception events (bytes in interrupt mode, bursts in DMA mode)
+ * - a histogram of the time spent in the reception interrupt handler
+ *
+ * Time units are up to the caller (on target, overflow timestamps are in ms, gaps and interrupt costs are in CPU cycles).
+ * Everything is stored in a Snapshot, that can be copied out as a whole by the consumer.
+ *
+ * @tparam OverflowLogSize How many overflow events are kept (the oldest ones are overwritten)
+ * @tparam IsrCostBins The number of bins of the interrupt cost histogram, bin i counts costs in [2^i, 2^(i+1)[ (bin 0 also counts 0, the last bin counts everything above)
+ *
+ * @note There is no hardware dependency here, nor any locking, the owner should make sure a snapshot is not copied while an interrupt updates it
+ */
+template <std::size_t OverflowLogSize = 8, std::size_t IsrCostBins = 16>
+class SerialRxStats {
+public:
+/* Types */
+    struct OverflowEvent {
+        uint32_t timestamp; /*!< When the overflow occurred */
+        unsigned int lostBytes; /*!< How many bytes were dropped */
+    };
+
+    struct Snapshot {
+        std::size_t fillHighWaterMark;  /*!< The highest fill level of the reception buffer seen so far */
+        OverflowEvent overflowLog[OverflowLogSize]; /*!< The last overflow events (circular, see getOverflowEvent()) */
+        unsigned int overflowEventCount;    /*!< How many overflow events occurred in total (may be more than OverflowLogSize) */
+        uint32_t lastRxTimestamp;   /*!< When the last reception event occurred */
+        unsigned int rxEventCount;  /*!< How many reception events occurred */
+        uint32_t minGap;    /*!< The shortest gap between two reception events */
+        uint32_t maxGap;    /*!< The longest gap between two reception events */
+        uint64_t gapSum;    /*!< The sum of all gaps between reception events (there are rxEventCount-1 of them) */
+        unsigned int isrCostHistogram[IsrCostBins]; /*!< Number of interrupt handler invocations per cost bin */
+        uint32_t maxIsrCost;    /*!< The highest interrupt handler cost seen so far */
+
+        /**
+         * @brief Get a logged overflow event
+         *
+         * @param age 0 for the most recent event, 1 for the one before, etc.
+         * @return The event, or nullptr if there is no such event in the log
+         */
+        const OverflowEvent* getOverflowEvent(unsigned int age) const;
+
+        /**
+         * @brief Get the average gap between two reception events
+         *
+         * @return The average gap (0 if less than 2 reception events occurred)
+         */
+        uint32_t getAverageGap() const;
+    };
+
+/* Methods */
+    SerialRxStats();
+
+    /**
+     * @brief Clear all statistics
+     */
+    void reset();
+
+    /**
+     * @brief Record the current fill level of the reception buffer
+     *
+     * @param fillLevel The number of bytes currently stored in the reception buffer
+     */
+    void onFillLevel(std::size_t fillLevel);
+
+    /**
+     * @brief Record an overflow event
+     *
+     * @param timestamp The current time
+     * @param lostBytes How many bytes were dropped
+     */
+    void onOverflow(uint32_t timestamp, unsigned int lostBytes);
+
+    /**
+     * @brief Record a reception event
+     *
+     * @param timestamp The current time (it may wrap around, gaps are computed modulo 2^32)
+     */
+    void onRxEvent(uint32_t timestamp);
+
+    /**
+     * @brief Record the cost of one invocation of the reception interrupt handler
+     *
+     * @param cost The time spent in the handler
+     */
+    void onIsrCost(uint32_t cost);
+
+    /**
+     * @brief Get the bin of the interrupt cost histogram a given cost falls into
+     */
+    static std::size_t getIsrCostBin(uint32_t cost);
+
+    /**
+     * @brief Get a copy of all statistics
+     */
+    Snapshot getSnapshot() const;
+
+private:
+/* Attributes */
+    Snapshot stats; /*!< All statistics collected so far */
+};
+
+template <std::size_t OverflowLogSize, std::size_t IsrCostBins>
+const typename SerialRxStats<OverflowLogSize, IsrCostBins>::OverflowEvent* SerialRxStats<OverflowLogSize, IsrCostBins>::Snapshot::getOverflowEvent(unsigned int age) const {
+    if (age >= this->overflowEventCount || age >= OverflowLogSize) {
+        return nullptr;
+    }
+    return &(this->overflowLog[(this->overflowEventCount - 1 - age) % OverflowLogSize]);
+}
+
+template <std::size_t OverflowLogSize, std::size_t IsrCostBins>
+uint32_t SerialRxStats<OverflowLogSize, IsrCostBins>::Snapshot::getAverageGap() const {
+    if (this->rxEventCount < 2) {
+        return 0;
+    }
+    return static_cast<uint32_t>(this->gapSum / (this->rxEventCount - 1));
+}
+
+template <std::size_t OverflowLogSize, std::size_t IsrCostBins>
+SerialRxStats<OverflowLogSize, IsrCostBins>::SerialRxStats() {
+    this->reset();
+}
+
+template <std::size_t OverflowLogSize, std::size_t IsrCostBins>
+void SerialRxStats<OverflowLogSize, IsrCostBins>::reset() {
+    this->stats.fillHighWaterMark = 0;
+    for (std::size_t i = 0; i < OverflowLogSize; i++) {
+        this->stats.overflowLog[i] = OverflowEvent{0, 0};
+    }
+    this->stats.overflowEventCount = 0;
+    this->stats.lastRxTimestamp = 0;
+    this->stats.rxEventCount = 0;
+    this->stats.minGap = static_cast<uint32_t>(-1);
+    this->stats.maxGap = 0;
+    this->stats.gapSum = 0;
+    for (std::size_t i = 0; i < IsrCostBins; i++) {
+        this->stats.isrCostHistogram[i] = 0;
+    }
+    this->stats.maxIsrCost = 0;
+}
+
+template <std::size_t OverflowLogSize, std::size_t IsrCostBins>
+void SerialRxStats<OverflowLogSize, IsrCostBins>::onFillLevel(std::size_t fillLevel) {
+    if (fillLevel > this->stats.fillHighWaterMark) {
+        this->stats.fillHighWaterMark = fillLevel;
+    }
+}
+
+template <std::size_t OverflowLogSize, std::size_t IsrCostBins>
+void SerialRxStats<OverflowLogSize, IsrCostBins>::onOverflow(uint32_t timestamp, unsigned int lostBytes) {
+    this->stats.overflowLog[this->stats.overflowEventCount % OverflowLogSize] = OverflowEvent{timestamp, lostBytes};
+    if (this->stats.overflowEventCount != static_cast<unsigned int>(-1)) {
+        this->stats.overflowEventCount++;
+    }
+}
+
+template <std::size_t OverflowLogSize, std::size_t IsrCostBins>
+void SerialRxStats<OverflowLogSize, IsrCostBins>::onRxEvent(uint32_t timestamp) {
+    if (this->stats.rxEventCount > 0) {
+        uint32_t gap = timestamp - this->stats.lastRxTimestamp; /* Unsigned arithmetic handles one wrap-around of the timestamp */
+        if (gap < this->stats.minGap) {
+            this->stats.minGap = gap;
+        }
+        if (gap > this->stats.maxGap) {
+            this->stats.maxGap = gap;
+        }
+        this->stats.gapSum += gap;
+    }
+    this->stats.lastRxTimestamp = timestamp;
+    if (this->stats.rxEventCount != static_cast<unsigned int>(-1)) {
+        this->stats.rxEventCount++;
+    }
+}
+
+template <std::size_t OverflowLogSize, std::size_t IsrCostBins>
+std::size_t SerialRxStats<OverflowLogSize, IsrCostBins>::getIsrCostBin(uint32_t cost) {
+    std::size_t bin = 0;
+    while (cost > 1 && bin < IsrCostBins - 1) {
+        cost >>= 1;
+        bin++;
+    }
+    return bin;
+}
+
+template <std::size_t OverflowLogSize, std::size_t IsrCostBins>
+void SerialRxStats<OverflowLogSize, IsrCostBins>::onIsrCost(uint32_t cost) {
+    this->stats.isrCostHistogram[getIsrCostBin(cost)]++;
+    if (cost > this->stats.maxIsrCost) {
+        this->stats.maxIsrCost = cost;
+    }
+}
+
+template <std::size_t OverflowLogSize, std::size_t IsrCostBins>
+typename SerialRxStats<OverflowLogSize, IsrCostBins>::Snapshot SerialRxStats<OverflowLogSize, IsrCostBins>::getSnapshot() const {
+    return this->stats;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef> // For std::size_t
+#include <cstdint>
+
+#include "SpscByteRing.h" // For SpscByteRingRegion
+
+/**
+ * @brief Abstract source of serial bytes (the TIC serial link)
+ *
+ * This is the consumer-side API used by the TIC ingest pipeline. On target, it is implemented by Stm32SerialDriver.
+ * On a host, captures or pseudo-terminals can be used instead, so that the whole pipeline can be run without any hardware.
+ */
+class SerialSource {
+public:
+/* Types */
+    typedef SpscByteRingRegion RxRegion;  /*!< A contiguous region of received bytes, as returned by peek() */
+
+/* Methods */
+    virtual ~SerialSource() {}
+
+    /**
+     * @brief Collect the new data bytes received and store them in the caller's buffer
+     *
+     * @param buffer The buffer where new data bytes will be written
+     * @param maxLen The maximum number of bytes that can be stored in @p buffer
+     *
+     * @return The number of bytes actually copied to @p buffer (will be <= maxLen, can be 0 if no data was available)
+     */
+    virtual std::size_t read(uint8_t* buffer, std::size_t maxLen) = 0;
+
+    /**
+     * @brief Get the received bytes in place, without consuming them
+     *
+     * Bytes returned here must be released using commit() once processed.
+     *
+     * @param[out] regions The (at most two) contiguous regions of received bytes, in reception order
+     * @return The number of non-empty regions in @p regions (0 if no data was available)
+     */
+    virtual unsigned int peek(RxRegion (&regions)[2]) = 0;
+
+    /**
+     * @brief Release bytes obtained using peek()
+     *
+     * @param len The number of bytes processed (counting from the first byte of the first region)
+     */
+    virtual void commit(std::size_t len) = 0;
+
+    /**
+     * @brief Get the number of received bytes lost because they were not collected fast enough
+     *
+     * @param reset Shall we reset the counter once returned?
+     */
+    virtual unsigned int getRxOverflowCount(bool reset = false) = 0;
+
+    /**
+     * @brief Get the total number of bytes received so far
+     */
+    virtual unsigned long getRxBytesTotal() const = 0;
+
+    /**
+     * @brief Get the number of line errors (parity, framing or noise errors) detected on reception
+     *
+     * @note Sources that cannot detect line errors (captures, pseudo-terminals) always report 0
+     *
+     * @param reset Shall we reset the counter once returned?
+     */
+    virtual unsigned int getRxLineErrorCount(bool reset = false) { return 0; }
+
+    /**
+     * @brief Check if received bytes were lost right before the next byte returned by peek(), and acknowledge it
+     *
+     * peek() never returns bytes across such a gap, so the caller can resynchronize its decoding exactly where bytes are missing.
+     *
+     * @note Sources that never lose bytes always return false
+     *
+     * @return true if there is a gap in the received byte stream at the current read position
+     */
+    virtual bool takeRxGap() { return false; }
+};
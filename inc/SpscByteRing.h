@@ -0,0 +1,405 @@
+#pragma once
+#include <atomic>
+#include <cstddef> // For std::size_t
+#include <cstdint>
+#include <cstring> // For memcpy()
+
+/**
+ * @brief A contiguous region of readable bytes, directly inside a ring storage
+ */
+struct SpscByteRingRegion {
+    const uint8_t* buf; /*!< The first byte of the region */
+    std::size_t len;    /*!< The number of bytes in the region */
+};
+
+/**
+ * @brief Wait-free single-producer/single-consumer byte ring
+ *
+ * The producer (typically an interrupt handler) only writes the head index, the consumer (typically the main loop) only writes the tail index.
+ * Both indices are free-running counters (they are never wrapped, only masked when accessing the storage), so that a full ring and an empty ring
+ * can be told apart without any extra flag.
+ * Neither side ever needs to mask interrupts or to wait for the other side.
+ *
+ * When the ring is full, the producer can either drop the incoming bytes (push()), or, if allowed, evict the oldest bytes to make room for them
+ * (pushEvictingOldest(), in which case the producer also moves the tail index, and both sides then use compare-and-swap on it).
+ * Either way, the position of the resulting discontinuity in the byte stream (the gap) is recorded: peek() never returns bytes across a gap,
+ * and takeGap() tells the consumer when it has reached it, so that it can resynchronize its decoding.
+ *
+ * @tparam N The capacity of the ring (in bytes), must be a power of 2
+ */
+template <std::size_t N>
+class SpscByteRing {
+    static_assert(N != 0 && (N & (N - 1)) == 0, "SpscByteRing capacity must be a power of 2");
+    static constexpr std::size_t MASK = N - 1;
+
+public:
+/* Types */
+    typedef SpscByteRingRegion Region;
+
+/* Methods */
+    SpscByteRing();
+
+    /**
+     * @brief Empty the ring
+     *
+     * @warning This is not thread-safe, it must only be invoked when neither the producer nor the consumer is running
+     */
+    void reset();
+
+    /**
+     * @brief Allow (or forbid) the producer to evict the oldest bytes when the ring is full (see pushEvictingOldest())
+     *
+     * Eviction is forbidden by default, because when allowed, the consumer has to release bytes using compare-and-swap, which is more expensive.
+     *
+     * @warning This is not thread-safe, it must only be invoked when neither the producer nor the consumer is running
+     */
+    void setEvictionAllowed(bool allowed);
+
+    /**
+     * @brief Append one byte to the ring (producer side)
+     *
+     * @param byte The byte to append
+     * @return true if the byte was stored, false if the ring was full (the byte is then discarded, and a gap is recorded)
+     */
+    bool push(uint8_t byte);
+
+    /**
+     * @brief Append a buffer to the ring (producer side)
+     *
+     * @param buf The bytes to append
+     * @param len The number of bytes in @p buf
+     * @return The number of bytes actually stored (the first ones in @p buf), bytes that did not fit are discarded (and a gap is recorded)
+     */
+    std::size_t push(const uint8_t* buf, std::size_t len);
+
+    /**
+     * @brief Append a buffer to the ring, evicting the oldest bytes if there is not enough room (producer side)
+     *
+     * @param buf The bytes to append
+     * @param len The number of bytes in @p buf (if above the capacity, only the last ones are stored)
+     * @return The number of bytes lost (either evicted from the ring, or first bytes of @p buf that could never fit)
+     *
+     * @note If eviction is not allowed (see setEvictionAllowed()), this behaves as push(), and bytes that do not fit are the ones lost
+     *
+     * @note If bytes are evicted while the consumer is processing them in place (see peek()), they may be overwritten. A gap is recorded
+     *       at the new tail in that case, so that the consumer knows that what it has just processed was damaged.
+     */
+    std::size_t pushEvictingOldest(const uint8_t* buf, std::size_t len);
+
+    /**
+     * @brief Extract bytes from the ring (consumer side)
+     *
+     * Unlike peek(), this does not stop at gaps: bytes from before and after a gap may be returned together
+     *
+     * @param[out] buf The buffer where extracted bytes will be written
+     * @param maxLen The maximum number of bytes that can be stored in @p buf
+     * @return The number of bytes actually copied to @p buf (can be 0 if the ring is empty)
+     */
+    std::size_t pop(uint8_t* buf, std::size_t maxLen);
+
+    /**
+     * @brief Get the bytes currently readable, in place, without consuming them (consumer side)
+     *
+     * Because the storage is circular, readable bytes span at most two contiguous regions: first, the bytes up to the end of the storage,
+     * then, if the data wraps around, the bytes at the beginning of the storage.
+     *
+     * @param[out] regions The readable regions, in order. Unused regions are set to a null pointer and a length of 0
+     * @return The number of non-empty regions (0 if the ring is empty, 1 or 2 otherwise)
+     *
+     * @note Readable bytes stop at the next gap, bytes after the gap will be returned once the bytes before it have been committed
+     * @note Bytes stay valid and unmodified until they are released with commit(), unless the producer evicts them (see pushEvictingOldest())
+     */
+    unsigned int peek(Region (&regions)[2]);
+
+    /**
+     * @brief Release bytes obtained from peek(), giving their storage back to the producer (consumer side)
+     *
+     * @param len The number of bytes to release (from the oldest), values above what peek() would return are clamped
+     * @return The number of bytes actually released by the consumer (bytes evicted by the producer in the meantime are not counted)
+     */
+    std::size_t commit(std::size_t len);
+
+    /**
+     * @brief Check if bytes were lost right before the next readable byte, and acknowledge it (consumer side)
+     *
+     * @return true if the consumer has reached (or gone past) a gap in the byte stream since the last call
+     */
+    bool takeGap();
+
+    std::size_t getCapacity() const;
+
+    /**
+     * @brief Get the number of bytes currently stored
+     *
+     * @note When invoked concurrently with push() or pop(), the result is a snapshot that may already be outdated when returned
+     */
+    std::size_t getCount() const;
+
+    bool isEmpty() const;
+
+private:
+    /**
+     * @brief Record a discontinuity in the byte stream (producer side)
+     *
+     * @param index The free-running index of the first byte after the discontinuity
+     */
+    void recordGap(std::size_t index);
+
+    /**
+     * @brief Get the position of the gap not yet acknowledged by the consumer, if any (consumer side)
+     *
+     * @param[out] index The free-running index of the first byte after the gap
+     * @param[out] seq The sequence number of this gap
+     * @return true if there is a pending gap
+     */
+    bool getPendingGap(std::size_t& index, unsigned int& seq) const;
+
+    /**
+     * @brief Get the number of bytes readable from a given position, up to the head or the next gap (consumer side)
+     *
+     * @param from The free-running index of the first byte to read
+     */
+    std::size_t getReadable(std::size_t from) const;
+
+    /**
+     * @brief Move the tail index forward, handing bytes back to the producer (consumer side)
+     *
+     * @param newTail The new tail index (at most the head index)
+     * @return The number of bytes actually released by the consumer (bytes evicted by the producer in the meantime are not counted)
+     */
+    std::size_t release(std::size_t newTail);
+
+/* Attributes */
+    uint8_t buf[N]; /*!< Internal storage */
+    std::atomic<std::size_t> head;  /*!< Free-running count of bytes ever pushed (only written by the producer) */
+    std::atomic<std::size_t> tail;  /*!< Free-running count of bytes ever released (written by the consumer, or by the producer when evicting) */
+    std::atomic<std::size_t> gapIndex;  /*!< Where the last gap is in the byte stream (only written by the producer) */
+    std::atomic<unsigned int> gapSeq;   /*!< Incremented by the producer each time a gap is recorded */
+    unsigned int ackedGapSeq;   /*!< The last gap sequence number acknowledged by the consumer (only accessed by the consumer) */
+    std::size_t readTail;   /*!< Where the consumer is in the byte stream, tail may be ahead of it if the producer evicted bytes (only accessed by the consumer) */
+    bool evictionAllowed;   /*!< May the producer move the tail index? (only changed when neither side is running) */
+};
+
+template <std::size_t N>
+SpscByteRing<N>::SpscByteRing() :
+    head(0),
+    tail(0),
+    gapIndex(0),
+    gapSeq(0),
+    ackedGapSeq(0),
+    readTail(0),
+    evictionAllowed(false)
+{
+}
+
+template <std::size_t N>
+void SpscByteRing<N>::reset() {
+    this->head.store(0, std::memory_order_relaxed);
+    this->tail.store(0, std::memory_order_relaxed);
+    this->gapIndex.store(0, std::memory_order_relaxed);
+    this->gapSeq.store(0, std::memory_order_relaxed);
+    this->ackedGapSeq = 0;
+    this->readTail = 0;
+}
+
+template <std::size_t N>
+void SpscByteRing<N>::setEvictionAllowed(bool allowed) {
+    this->evictionAllowed = allowed;
+}
+
+template <std::size_t N>
+void SpscByteRing<N>::recordGap(std::size_t index) {
+    this->gapIndex.store(index, std::memory_order_relaxed);
+    this->gapSeq.fetch_add(1, std::memory_order_release); /* Publishes gapIndex along with the new sequence number */
+}
+
+template <std::size_t N>
+bool SpscByteRing<N>::getPendingGap(std::size_t& index, unsigned int& seq) const {
+    seq = this->gapSeq.load(std::memory_order_acquire);
+    if (seq == this->ackedGapSeq) {
+        return false;
+    }
+    index = this->gapIndex.load(std::memory_order_relaxed); /* May already be a more recent gap than seq, which is harmless: it will be reported again */
+    return true;
+}
+
+template <std::size_t N>
+std::size_t SpscByteRing<N>::getReadable(std::size_t from) const {
+    std::size_t len = this->head.load(std::memory_order_acquire) - from;
+    std::size_t gap;
+    unsigned int gapSeq;
+    if (this->getPendingGap(gap, gapSeq)) {
+        std::size_t tail = this->tail.load(std::memory_order_acquire);
+        if (static_cast<std::ptrdiff_t>(gap - tail) > 0 && gap - from < len) {
+            len = gap - from;   /* Stop right before the gap (gaps at or behind the tail are only reported by takeGap()) */
+        }
+    }
+    return len;
+}
+
+template <std::size_t N>
+bool SpscByteRing<N>::push(uint8_t byte) {
+    std::size_t head = this->head.load(std::memory_order_relaxed);
+    std::size_t tail = this->tail.load(std::memory_order_acquire);
+    if (head - tail >= N) {
+        this->recordGap(head);
+        return false; /* Full */
+    }
+    this->buf[head & MASK] = byte;
+    this->head.store(head + 1, std::memory_order_release); /* Publish the byte to the consumer */
+    return true;
+}
+
+template <std::size_t N>
+std::size_t SpscByteRing<N>::push(const uint8_t* buf, std::size_t len) {
+    std::size_t head = this->head.load(std::memory_order_relaxed);
+    std::size_t tail = this->tail.load(std::memory_order_acquire);
+    std::size_t room = N - (head - tail);
+    if (len > room) {
+        len = room;
+        this->recordGap(head + len);
+    }
+    std::size_t offs = head & MASK;
+    std::size_t firstChunk = N - offs;
+    if (firstChunk > len) {
+        firstChunk = len;
+    }
+    memcpy(this->buf + offs, buf, firstChunk);
+    memcpy(this->buf, buf + firstChunk, len - firstChunk);
+    this->head.store(head + len, std::memory_order_release);
+    return len;
+}
+
+template <std::size_t N>
+std::size_t SpscByteRing<N>::pushEvictingOldest(const uint8_t* buf, std::size_t len) {
+    if (!this->evictionAllowed) {
+        return len - this->push(buf, len);
+    }
+    std::size_t lost = 0;
+    if (len > N) {
+        lost = len - N; /* These would be evicted by the last bytes of buf anyway */
+        buf += lost;
+        len = N;
+    }
+    std::size_t head = this->head.load(std::memory_order_relaxed);
+    std::size_t tail = this->tail.load(std::memory_order_acquire);
+    while (N - (head - tail) < len) {
+        std::size_t newTail = head + len - N;
+        if (this->tail.compare_exchange_weak(tail, newTail, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            lost += newTail - tail;
+            tail = newTail;
+        }
+        /* Otherwise, the consumer has just released some bytes (tail has been reloaded), check again */
+    }
+    if (lost > 0) {
+        this->recordGap(tail);
+    }
+    std::size_t offs = head & MASK;
+    std::size_t firstChunk = N - offs;
+    if (firstChunk > len) {
+        firstChunk = len;
+    }
+    memcpy(this->buf + offs, buf, firstChunk);
+    memcpy(this->buf, buf + firstChunk, len - firstChunk);
+    this->head.store(head + len, std::memory_order_release);
+    return lost;
+}
+
+template <std::size_t N>
+std::size_t SpscByteRing<N>::pop(uint8_t* buf, std::size_t maxLen) {
+    std::size_t len = 0;
+    while (len < maxLen) {
+        Region regions[2];
+        this->peek(regions);
+        std::size_t readable = regions[0].len + regions[1].len;
+        std::size_t chunk = (readable < maxLen - len) ? readable : maxLen - len;
+        if (chunk == 0) {
+            break;
+        }
+        std::size_t firstChunk = (regions[0].len < chunk) ? regions[0].len : chunk;
+        memcpy(buf + len, regions[0].buf, firstChunk);
+        if (chunk > firstChunk) {
+            memcpy(buf + len + firstChunk, regions[1].buf, chunk - firstChunk);
+        }
+        len += chunk;
+        this->readTail += chunk;
+        this->release(this->readTail);
+        if (chunk < readable) {
+            break;
+        }
+        /* Otherwise, peek() may have stopped at a gap, and there may be more bytes after it */
+    }
+    return len;
+}
+
+template <std::size_t N>
+unsigned int SpscByteRing<N>::peek(Region (&regions)[2]) {
+    std::size_t tail = this->tail.load(std::memory_order_acquire);
+    this->readTail = tail;  /* Catch up with bytes evicted by the producer, if any */
+    std::size_t len = this->getReadable(tail);
+    std::size_t offs = tail & MASK;
+    std::size_t firstChunk = N - offs;
+    if (firstChunk > len) {
+        firstChunk = len;
+    }
+    regions[0].buf = (firstChunk > 0) ? this->buf + offs : nullptr;
+    regions[0].len = firstChunk;
+    regions[1].buf = (len > firstChunk) ? this->buf : nullptr;
+    regions[1].len = len - firstChunk;
+    return (firstChunk > 0 ? 1 : 0) + (len > firstChunk ? 1 : 0);
+}
+
+template <std::size_t N>
+std::size_t SpscByteRing<N>::commit(std::size_t len) {
+    std::size_t readable = this->getReadable(this->readTail);
+    if (len > readable) {
+        len = readable;
+    }
+    this->readTail += len;
+    return this->release(this->readTail);
+}
+
+template <std::size_t N>
+std::size_t SpscByteRing<N>::release(std::size_t newTail) {
+    std::size_t tail = this->tail.load(std::memory_order_relaxed);
+    if (!this->evictionAllowed) {
+        this->tail.store(newTail, std::memory_order_release); /* We are the only writer of tail, hand the storage back to the producer */
+        return newTail - tail;
+    }
+    do {
+        if (static_cast<std::ptrdiff_t>(newTail - tail) <= 0) {
+            return 0; /* The producer has already evicted all these bytes */
+        }
+    } while (!this->tail.compare_exchange_weak(tail, newTail, std::memory_order_acq_rel, std::memory_order_relaxed)); /* Hand the storage back to the producer */
+    return newTail - tail;
+}
+
+template <std::size_t N>
+bool SpscByteRing<N>::takeGap() {
+    std::size_t gap;
+    unsigned int gapSeq;
+    if (!this->getPendingGap(gap, gapSeq)) {
+        return false;
+    }
+    std::size_t tail = this->tail.load(std::memory_order_acquire);
+    if (static_cast<std::ptrdiff_t>(gap - tail) > 0) {
+        return false; /* Not there yet, there are still bytes to read before the gap */
+    }
+    this->ackedGapSeq = gapSeq;
+    return true;
+}
+
+template <std::size_t N>
+std::size_t SpscByteRing<N>::getCapacity() const {
+    return N;
+}
+
+template <std::size_t N>
+std::size_t SpscByteRing<N>::getCount() const {
+    return this->head.load(std::memory_order_acquire) - this->tail.load(std::memory_order_acquire);
+}
+
+template <std::size_t N>
+bool SpscByteRing<N>::isEmpty() const {
+    return (this->getCount() == 0);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+/**
+ * @brief The table of all trace events, as X(name, argument count, format)
+ *
+ * Only the name and the argument count are expanded in the firmware (see TraceLog.h), where each event is logged as its ID followed by its binary arguments.
+ * Format strings are only expanded by the host-side decoder, that turns trace dumps back into text. They thus take no room in flash.
+ *
+ * Each argument is a 32-bit value, the conversions understood by the decoder are:
+ * - %u an unsigned decimal number
+ * - %d a signed decimal number
+ * - %x an hexadecimal number
+ * - %L a TicLabelTable::Label, printed as the label text
+ *
+ * @warning Events are identified by their position in this table, a dump must be decoded with the table of the firmware that produced it.
+ *          New events should thus be added at the end.
+ */
+#define TRACE_EVENTS(X) \
+    X(TraceRecordsDropped, 1, "%u trace record(s) dropped (trace buffer full)") \
+    X(NewFrameId, 1, "It seems we are in a new frame ID %u") \
+    X(SystemTimeAsHorodate, 3, "Using systemtime (%u:%u:%u) as horodate") \
+    X(MissingTimeGetter, 0, "Missing time getter") \
+    X(NewDayDetected, 0, "Switch to new day detected") \
+    X(NewComputedPower, 3, "onNewComputedPower([%d;%d]W) with valid horodate: %u") \
+    X(DatasetExtracted, 1, "onDatasetExtracted() called with %u bytes") \
+    X(DatasetWrongCrc, 0, "Dataset has wrong CRC") \
+    X(NewDataset, 1, "New dataset: %L") \
+    X(HistoricalDataset, 0, "Dataset above is following historical format") \
+    X(MalformedDataset, 0, "Malformed dataset or wrong CRC") \
+    X(DatasetError, 2, "Dataset error on label %L at position %u in frame") \
+    X(DatasetErrorBurst, 2, "Dataset error burst detected at frame ID %u (%u errors)")
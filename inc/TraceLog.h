@@ -0,0 +1,168 @@
+#pragma once
+#include <atomic>
+#include <cstddef> // For std::size_t
+#include <cstdint>
+#include <cstring> // For memcpy()
+
+#include "SpscByteRing.h"
+#include "TraceEvents.h"
+
+namespace Trace {
+
+typedef enum : uint8_t {
+#define TRACE_EVENT_ID(name, argCount, format) name,
+    TRACE_EVENTS(TRACE_EVENT_ID)
+#undef TRACE_EVENT_ID
+    EventCount /*!< Not an event, the number of events */
+} Event;
+
+/**
+ * @brief The number of (32-bit) arguments of each event
+ */
+constexpr uint8_t ArgCounts[] = {
+#define TRACE_EVENT_ARG_COUNT(name, argCount, format) argCount,
+    TRACE_EVENTS(TRACE_EVENT_ARG_COUNT)
+#undef TRACE_EVENT_ARG_COUNT
+};
+
+} // namespace Trace
+
+/**
+ * @brief Deferred binary trace log (singleton)
+ *
+ * Sending text to the debug console blocks for about 87µs per character at 115200 bauds, which is enough to change the timing of the code being debugged.
+ * Instead, log() only stores a binary record in a RAM ring: a marker byte, the event ID (see TraceEvents.h) and the arguments as raw 32-bit values (little endian).
+ * This takes a few dozen cycles, whatever the message. The ring is then drained to the debug console by drain(), when there is nothing more urgent to do,
+ * and the host-side decoder turns the dump back into text.
+ *
+ * Records start with RecordMarker, a control character that never appears in debug text, so records and plain text sent with Stm32DebugOutput
+ * can be mixed on the same console (as long as both are sent from the main context).
+ *
+ * When the ring is full, new records are dropped (log() never waits), and their number is reported by drain() with a TraceRecordsDropped record.
+ *
+ * @warning log() uses the single-producer side of a SpscByteRing, so it must only be invoked from one context (the main context, not interrupt handlers)
+ */
+class TraceLog {
+public:
+/* Types */
+    static constexpr std::size_t Capacity = 1024; /*!< The size of the ring, in bytes */
+    static constexpr uint8_t RecordMarker = 0x1e; /*!< ASCII record separator, starts each binary record */
+    static constexpr std::size_t RecordHeaderSize = 2; /*!< The marker and the event ID */
+
+    typedef void(*FOutputFunc)(const uint8_t* buf, std::size_t len, void* context); /*!< The prototype of functions receiving drained bytes */
+
+/* Methods */
+    TraceLog();
+
+    /**
+     * @brief Singleton instance getter
+     *
+     * @return The trace log used by the TRACE() macro
+     */
+    static TraceLog& get();
+
+    /**
+     * @brief Log an event
+     *
+     * @tparam event The event to log
+     * @param args The arguments of the event (their number is checked at compile time against TraceEvents.h), converted to 32-bit values
+     * @return true if the record has been stored, false if it has been dropped because the ring is full
+     */
+    template <Trace::Event event, typename... Args>
+    bool log(Args... args);
+
+    /**
+     * @brief Output logged records (consumer side)
+     *
+     * @param output The function to invoke on drained bytes (it may be invoked several times)
+     * @param context A user-defined pointer that will be passed as last argument when invoking @p output
+     * @param maxBytes The number of bytes after which to stop, so that a slow output does not delay other processing for too long
+     * @return The number of bytes output
+     *
+     * @note Output always stops at a record boundary: the last record started is output whole, even if this exceeds @p maxBytes
+     *       (by less than one record). Plain text can thus safely be sent to the same console between two calls
+     */
+    std::size_t drain(FOutputFunc output, void* context, std::size_t maxBytes = Capacity);
+
+    /**
+     * @brief Is there anything to drain?
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Get the total number of records dropped because the ring was full
+     */
+    unsigned int getDroppedCount() const;
+
+private:
+    /**
+     * @brief Append an argument to a record being built
+     *
+     * @param[in,out] pos Where to store the argument, moved past it
+     * @param value The argument
+     */
+    static void storeArg(uint8_t*& pos, uint32_t value);
+
+    /**
+     * @brief Get the size of the record starting at a given position of the ring (consumer side)
+     *
+     * @param regions The readable bytes, as returned by SpscByteRing::peek()
+     * @param offset The offset of the record start in @p regions
+     * @return The size of the record (header included)
+     */
+    static std::size_t getRecordSize(const SpscByteRing<Capacity>::Region (&regions)[2], std::size_t offset);
+
+    /**
+     * @brief Store a whole record, or drop it if it does not fit (producer side)
+     *
+     * @param record The record bytes
+     * @param len The number of bytes in @p record
+     * @return true if the record has been stored
+     */
+    bool pushRecord(const uint8_t* record, std::size_t len);
+
+/* Attributes */
+    static TraceLog instance;    /*!< Lazy singleton instance */
+    SpscByteRing<Capacity> ring;    /*!< The records waiting to be drained */
+    std::atomic<unsigned int> droppedCount;  /*!< The number of records dropped so far (only written by the producer) */
+    unsigned int reportedDroppedCount;  /*!< The number of dropped records already reported by drain() (only accessed by the consumer) */
+};
+
+template <Trace::Event event, typename... Args>
+inline bool TraceLog::log(Args... args) {
+    static_assert(event < Trace::EventCount, "Unknown trace event");
+    static_assert(sizeof...(Args) == Trace::ArgCounts[event], "Wrong number of arguments for this trace event (see TraceEvents.h)");
+    uint8_t record[RecordHeaderSize + sizeof...(Args) * sizeof(uint32_t)];
+    record[0] = RecordMarker;
+    record[1] = event;
+    uint8_t* argPos = record + RecordHeaderSize;
+    const int expandArgs[] = { 0, (storeArg(argPos, static_cast<uint32_t>(args)), 0)... };  /* Stores each argument in order (the leading 0 avoids a zero-sized array) */
+    (void)expandArgs;
+    (void)argPos;   /* Unused for events without arguments */
+    return this->pushRecord(record, sizeof(record));
+}
+
+inline void TraceLog::storeArg(uint8_t*& pos, uint32_t value) {
+    memcpy(pos, &value, sizeof(value));   /* Our targets are little endian, as expected by the decoder */
+    pos += sizeof(value);
+}
+
+inline bool TraceLog::pushRecord(const uint8_t* record, std::size_t len) {
+    if (this->ring.getCapacity() - this->ring.getCount() < len) {   /* Only the consumer may run concurrently, and it can only make more room */
+        this->droppedCount.store(this->droppedCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+    }
+    this->ring.push(record, len);
+    return true;
+}
+
+/**
+ * @brief Log a trace event (see TraceEvents.h), if the debug console is enabled
+ *
+ * For example: TRACE(NewFrameId, frameNb);
+ */
+#ifdef EMBEDDED_DEBUG_CONSOLE
+#define TRACE(event, ...) TraceLog::get().log<Trace::event>(__VA_ARGS__)
+#else
+#define TRACE(event, ...) do { } while (0)
+#endif
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef> // For std::size_t
+#include <cstdint>
+
+#include "TicLabelTable.h"
+
+/**
+ * @brief Statistics on the TIC datasets that failed to decode (wrong checksum or malformed)
+ *
+ * Each error is attributed:
+ * - to a label, when the label bytes are intact (that is when they match a label we know, see findLabel()), or to TicLabelTable::Unknown otherwise
+ * - to the position of the dataset in its frame (0 for the first dataset)
+ *
+ * Errors are also counted per frame, over a sliding window of the last burstWindowFrames frames, to detect error bursts:
+ * a burst starts when the window holds at least burstThreshold errors, and ends once a whole window of frames went without any error.
+ *
+ * Errors spread over random labels and positions with no burst point to wiring noise, while bursts (or errors always hitting the same positions)
+ * point to a systematic problem, like a degraded optocoupler edge at the current baud rate.
+ *
+ * Everything is stored in a Snapshot, that can be copied out as a whole by the consumer.
+ */
+class DatasetErrorStats {
+public:
+/* Types */
+    static constexpr unsigned int MaxPositions = 32; /*!< The number of per-position counters, the last one counts all datasets at position MaxPositions-1 or above */
+    static constexpr unsigned int MaxBurstWindowFrames = 32; /*!< The longest burst detection window, in frames */
+
+    struct Burst {
+        unsigned int startFrame; /*!< The frame count (see Snapshot::frameCount) when the burst was detected */
+        unsigned int endFrame; /*!< The frame count when the burst ended (meaningless while the burst is still ongoing) */
+        unsigned int errorCount; /*!< How many errors belong to the burst (including those of the window that triggered it) */
+    };
+
+    struct Snapshot {
+        unsigned int errorCount; /*!< How many dataset errors occurred in total */
+        unsigned int perLabel[TicLabelTable::LabelCount]; /*!< Errors per label (perLabel[TicLabelTable::Unknown] counts errors that could not be attributed) */
+        unsigned int perPosition[MaxPositions]; /*!< Errors per dataset position in the frame */
+        unsigned int frameCount; /*!< How many frames have been completed */
+        unsigned int framesWithErrors; /*!< How many completed frames had at least one dataset error */
+        unsigned int burstCount; /*!< How many error bursts have been detected (including the ongoing one, if any) */
+        bool inBurst; /*!< Are we currently in an error burst? */
+        Burst lastBurst; /*!< The ongoing burst if inBurst, or else the last burst (only meaningful if burstCount > 0) */
+
+        /**
+         * @brief Get the label with the most errors
+         *
+         * @return The label, or TicLabelTable::Unknown if no error has been attributed to a label
+         */
+        TicLabelTable::Label getWorstLabel() const;
+    };
+
+/* Methods */
+    /**
+     * @brief Construct a new DatasetErrorStats object
+     *
+     * @param burstThreshold How many errors within @p burstWindowFrames frames make a burst (at least 1)
+     * @param burstWindowFrames The length of the burst detection window, in frames (between 1 and MaxBurstWindowFrames, clamped)
+     */
+    DatasetErrorStats(unsigned int burstThreshold = 3, unsigned int burstWindowFrames = 8);
+
+    /**
+     * @brief Clear all statistics (the burst detection settings are kept)
+     */
+    void reset();
+
+    /**
+     * @brief Record a dataset error
+     *
+     * @param label The label of the dataset (TicLabelTable::Unknown if it could not be attributed)
+     * @param positionInFrame The position of the dataset in its frame (0 for the first dataset)
+     * @return true if this error started a new burst
+     */
+    bool onDatasetError(TicLabelTable::Label label, unsigned int positionInFrame);
+
+    /**
+     * @brief Record the end of a frame, and slide the burst detection window
+     */
+    void onFrameComplete();
+
+    /**
+     * @brief Get a copy of all statistics
+     */
+    Snapshot getSnapshot() const;
+
+    /**
+     * @brief Find the label of a dataset whose decoding failed
+     *
+     * The label is the text before the first separator (tab or space). It is considered intact only if it is a label we know.
+     *
+     * @param buf The dataset bytes, without start and end markers
+     * @param len The number of bytes in @p buf
+     * @return The label, or TicLabelTable::Unknown if the label bytes are damaged or unknown
+     */
+    static TicLabelTable::Label findLabel(const uint8_t* buf, std::size_t len);
+
+/* Attributes */
+    unsigned int burstThreshold; /*!< How many errors within the window make a burst */
+    unsigned int burstWindowFrames; /*!< The length of the burst detection window, in frames */
+    Snapshot stats; /*!< The statistics collected so far */
+    unsigned int windowErrors[MaxBurstWindowFrames]; /*!< Errors per frame over the window, windowErrors[frameCount % burstWindowFrames] is the frame being received */
+    unsigned int windowErrorCount; /*!< The sum of windowErrors */
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <stdint.h>
+
+#include "FixedSizeRingBuffer.h"
+#include "TicFrameParser.h" // For TicEvaluatedPower
+#include "TimeOfDay.h"
+
+/**
+ * @brief Integrate power over time into withdrawn and injected energy totals, per hour and per day
+ *
+ * Each power measurement is held until the next one, and integrated over the real interval between their timestamps (to the millisecond when known).
+ * Power measurements are ranges (see TicEvaluatedPower), so both their lower and upper bounds are integrated, giving an energy range.
+ * Intervals longer than maxIntervalMs (missing frames) or going backwards in time are not integrated, as we do not know the power during them.
+ *
+ * Totals are updated incrementally, so reading today's total (or any hour of today) is O(1).
+ * When the day is over (see onDayOver()), today's total is kept in a ring of the last PastDays days.
+ */
+class EnergyAccounting {
+public:
+/* Types */
+    static constexpr unsigned int HoursPerDay = 24;
+    static constexpr std::size_t PastDays = 7; /*!< The number of past daily totals we keep */
+    static constexpr unsigned int DefaultMaxIntervalSeconds = 60; /*!< The default longest interval between two power measurements that we integrate */
+
+    /**
+     * @brief An energy known within a range
+     */
+    struct EnergyRange {
+        EnergyRange();
+
+        /**
+         * @brief Get the lower bound of the energy, rounded down to the Wh
+         */
+        uint32_t getMinWh() const;
+
+        /**
+         * @brief Get the upper bound of the energy, rounded up to the Wh
+         */
+        uint32_t getMaxWh() const;
+
+    /* Attributes */
+        uint64_t minWattMs; /*!< The lower bound of the energy, in W.ms */
+        uint64_t maxWattMs; /*!< The upper bound of the energy, in W.ms */
+    };
+
+    struct EnergyTotals {
+    /* Attributes */
+        EnergyRange withdrawn; /*!< The energy withdrawn from the grid */
+        EnergyRange injected; /*!< The energy injected to the grid */
+    };
+
+/* Methods */
+    /**
+     * @brief Construct a new energy accounting
+     *
+     * @param maxIntervalSeconds The longest interval between two power measurements that we integrate, in seconds
+     */
+    EnergyAccounting(unsigned int maxIntervalSeconds = DefaultMaxIntervalSeconds);
+
+    /**
+     * @brief Clear all totals, including past days
+     */
+    void reset();
+
+    /**
+     * @brief Integrate the previous power measurement up to a new one
+     *
+     * @param power The new power measurement (signed, positive if withdrawn), ignored if invalid
+     * @param timestamp The timestamp of @p power, ignored if invalid
+     *
+     * @note The interval is accounted to the hour of @p timestamp
+     */
+    void onNewPowerData(const TicEvaluatedPower& power, const TimeOfDay& timestamp);
+
+    /**
+     * @brief Close the current day: its total is kept as a past day, and today's totals start from 0
+     */
+    void onDayOver();
+
+    /**
+     * @brief Get the energy totals since the beginning of the day
+     */
+    const EnergyTotals& getToday() const;
+
+    /**
+     * @brief Get the energy totals for one hour of the current day
+     *
+     * @param hour The hour (0 to 23)
+     * @return The totals (all 0 if @p hour is out of range)
+     */
+    const EnergyTotals& getHour(unsigned int hour) const;
+
+    /**
+     * @brief Get the energy totals of a past day
+     *
+     * @param daysAgo 1 for yesterday, up to PastDays
+     * @param[out] result The totals of that day
+     * @return false if that day is not known
+     */
+    bool getPastDay(unsigned int daysAgo, EnergyTotals& result) const;
+
+    /**
+     * @brief Get the number of past days currently known
+     */
+    std::size_t getPastDayCount() const;
+
+private:
+    /**
+     * @brief Add the energy of a power held during some time to totals
+     *
+     * @param totals The totals to update
+     * @param power The power
+     * @param durationMs The duration, in ms
+     */
+    static void integrate(EnergyTotals& totals, const TicEvaluatedPower& power, uint32_t durationMs);
+
+public:
+/* Attributes */
+    uint32_t maxIntervalMs; /*!< The longest interval between two power measurements that we integrate, in ms */
+    TicEvaluatedPower lastPower; /*!< The last power measurement, held until the next one */
+    uint32_t lastTimeMs; /*!< The time of lastPower, in milliseconds since midnight (only meaningful if lastPower is valid) */
+    unsigned int skippedIntervals; /*!< How many intervals were not integrated, because they were too long or went backwards */
+    EnergyTotals today; /*!< The totals since the beginning of the day */
+    EnergyTotals hours[HoursPerDay]; /*!< The totals for each hour of the day */
+    FixedSizeRingBuffer<EnergyTotals, PastDays> pastDays; /*!< The totals of the last days, the most recent last */
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <stdint.h>
+
+#include "FixedSizeRingBuffer.h"
+#include "TimeOfDay.h"
+
+/* Forward declarations */
+class TicEvaluatedPower;
+
+/**
+ * @brief Estimate the average power from the variations of the cumulative energy indices of the meter
+ *
+ * Each frame carries withdrawn (EAST, or BASE/HCHC/HCHP in historical mode) and injected (EAIT) energy indices, in Wh.
+ * Over a window between an older frame and the current frame, the variation of these indices gives the net energy exchanged, and thus the average power.
+ * Indices are truncated to the Wh, so each variation is only known to 1Wh, and the average power bounds get tighter as the window grows.
+ *
+ * refine() intersects these average bounds with an instantaneous power range (such as URMS*IRMS +/- URMS/2 when injecting), for windows ending at the current frame.
+ * This assumes the power is steady over the window, so windows during which power flowed in the other direction, or whose average does not overlap
+ * the instantaneous range (the power has changed), are ignored, and we keep the narrowest intersection.
+ *
+ * Only frames where an index changes are stored, at most one every maxWindowSeconds/MaxSamples, in a fixed-size ring,
+ * so the memory footprint and the work per frame are bounded.
+ */
+class EnergyDeltaEstimator {
+public:
+/* Types */
+    static constexpr std::size_t MaxSamples = 32; /*!< The maximum number of index variations we keep */
+    static constexpr unsigned int DefaultMaxWindowSeconds = 300; /*!< The default maximum duration of averaging windows */
+
+    struct Sample {
+        Sample();
+        Sample(uint32_t timeMs, bool preciseTime, uint32_t withdrawnIndex, uint32_t injectedIndex);
+
+    /* Attributes */
+        uint32_t timeMs; /*!< The time of the frame, in milliseconds since midnight */
+        bool preciseTime; /*!< Is @p timeMs precise to the millisecond? If not, it is precise to the second */
+        uint32_t withdrawnIndex; /*!< The cumulative withdrawn energy, in Wh */
+        uint32_t injectedIndex; /*!< The cumulative injected energy, in Wh */
+    };
+
+/* Methods */
+    /**
+     * @brief Construct a new estimator
+     *
+     * @param maxWindowSeconds The maximum duration of averaging windows, in seconds
+     */
+    EnergyDeltaEstimator(unsigned int maxWindowSeconds = DefaultMaxWindowSeconds);
+
+    /**
+     * @brief Forget all past indices
+     */
+    void reset();
+
+    /**
+     * @brief Take into account the energy indices of a complete frame
+     *
+     * @param timestamp The frame timestamp (ignored if invalid)
+     * @param withdrawnIndex The cumulative withdrawn energy, in Wh
+     * @param injectedIndex The cumulative injected energy, in Wh (0 if the meter has no injection index)
+     *
+     * @note Frames where indices go backwards (corrupted or replaced meter) are ignored
+     */
+    void onNewIndexes(const TimeOfDay& timestamp, uint32_t withdrawnIndex, uint32_t injectedIndex);
+
+    /**
+     * @brief Narrow an instantaneous power range using the average power over past windows
+     *
+     * @param timestamp The current frame timestamp
+     * @param withdrawnIndex The current cumulative withdrawn energy, in Wh
+     * @param injectedIndex The current cumulative injected energy, in Wh
+     * @param[in,out] power The instantaneous power range (signed, positive if withdrawn), narrowed on success
+     * @return true if @p power has been narrowed
+     */
+    bool refine(const TimeOfDay& timestamp, uint32_t withdrawnIndex, uint32_t injectedIndex, TicEvaluatedPower& power) const;
+
+    /**
+     * @brief Get the number of index variations currently stored
+     */
+    std::size_t getSampleCount() const;
+
+private:
+    /**
+     * @brief Convert a timestamp into a sample (without indices)
+     *
+     * @return false if @p timestamp is invalid
+     */
+    static bool toSampleTime(const TimeOfDay& timestamp, Sample& sample);
+
+/* Attributes */
+    unsigned int maxWindowMs; /*!< The maximum duration of averaging windows, in milliseconds */
+    FixedSizeRingBuffer<Sample, MaxSamples> samples; /*!< The frames where an index changed, the most recent last */
+};
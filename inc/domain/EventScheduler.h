@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+
+/**
+ * @brief Run-to-completion cooperative scheduler, driven by events posted from interrupt handlers
+ *
+ * Interrupt handlers only post() events (a pending bit per event, so several posts of the same event before it is handled are coalesced).
+ * The main context dispatches pending events one at a time, highest priority first, and each handler runs to completion.
+ * When no event is pending, the scheduler invokes an idle function, that should put the core to sleep until the next interrupt.
+ *
+ * Sequential code (like the display update cycle) waits using runUntil(), that keeps dispatching events (and sleeping in between) until a condition is met.
+ *
+ * @note This class has no hardware dependency: the time source and the idle function are provided by the owner.
+ *       On target, the clock is a microsecond counter and the idle function executes WFI, on host, both are provided by a virtual clock.
+ * @warning Handlers must not invoke runUntil() themselves (there is no nesting of handlers)
+ */
+class EventScheduler {
+public:
+/* Types */
+    typedef enum {
+        RxData = 0, /*!< New bytes have been received on the TIC serial link */
+        RxIdle, /*!< The TIC serial link went idle at the end of a burst */
+        DisplayRefreshed, /*!< The DSI host reported an end of refresh (the LCD may have switched framebuffer) */
+        Dma2dDone, /*!< A DMA2D transfer is over */
+        SecondTick, /*!< One more second elapsed on the monotonic timer */
+        EventCount /*!< Not an event, the number of events */
+    } Event;
+
+    typedef void(*FEventHandlerFunc)(void* context); /*!< The prototype of event handlers */
+    typedef uint32_t(*FClockFunc)(void* context); /*!< The prototype of the time source, returning a free-running counter (in µs on target) that may wrap around */
+    typedef void(*FIdleFunc)(void* context); /*!< The prototype of the function invoked when no event is pending */
+    typedef bool(*FConditionFunc)(void* context); /*!< The prototype of conditions waited for by runUntil() */
+
+    struct EventStats {
+        unsigned int dispatchCount; /*!< How many times the event has been dispatched */
+        unsigned int coalescedCount; /*!< How many posts occurred while the event was already pending */
+        uint32_t maxLatency; /*!< The longest time between the (first) post of the event and the start of its dispatch */
+        uint64_t totalLatency; /*!< The sum of all dispatch latencies */
+        uint32_t maxRunTime; /*!< The longest time spent in the handler */
+
+        /**
+         * @brief Get the average dispatch latency
+         *
+         * @return The average latency (0 if the event has never been dispatched)
+         */
+        uint32_t getAverageLatency() const;
+    };
+
+    static constexpr uint32_t NoTimeout = static_cast<uint32_t>(-1); /*!< Timeout value used to wait forever in runUntil() */
+    static constexpr uint8_t LowestPriority = 0; /*!< The default priority of events */
+
+/* Methods */
+    /**
+     * @brief Construct a new scheduler
+     *
+     * @param clock The time source
+     * @param clockContext A user-defined pointer that will be passed as argument when invoking clock()
+     * @param idle A function to invoke when no event is pending (nullptr to busy-wait)
+     * @param idleContext A user-defined pointer that will be passed as argument when invoking idle()
+     */
+    EventScheduler(FClockFunc clock, void* clockContext = nullptr, FIdleFunc idle = nullptr, void* idleContext = nullptr);
+
+    /**
+     * @brief Select the handler of an event
+     *
+     * @param event The event to handle
+     * @param handler The function to run when the event is dispatched (nullptr to only consume the event, for example when it is only used to wake up runUntil())
+     * @param context A user-defined pointer that will be passed as argument when invoking handler()
+     * @param priority The priority of this event, the pending event with the highest priority is dispatched first (ties are broken by event order)
+     *
+     * @warning This should be done before events start being posted
+     */
+    void setHandler(Event event, FEventHandlerFunc handler, void* context = nullptr, uint8_t priority = LowestPriority);
+
+    /**
+     * @brief Mark an event as pending
+     *
+     * @param event The event to post
+     *
+     * @note This method is safe to invoke from interrupt context
+     */
+    void post(Event event);
+
+    /**
+     * @brief Is any event pending?
+     *
+     * @note The idle function should check this with interrupts masked before going to sleep, so that no event posted in between is missed
+     */
+    bool hasPendingEvents() const;
+
+    /**
+     * @brief Dispatch the pending event with the highest priority (if any)
+     *
+     * @return true if an event has been dispatched, false if none was pending
+     */
+    bool dispatchOne();
+
+    /**
+     * @brief Dispatch pending events until none is left
+     *
+     * @note This does not sleep, it can be used to let handlers run in the middle of a long processing in the main context
+     * @return The number of events dispatched
+     */
+    unsigned int dispatchPending();
+
+    /**
+     * @brief Dispatch events (and sleep when none is pending) until a condition is met or a timeout expires
+     *
+     * @param condition The condition to wait for, checked before waiting and after each dispatch or wake up (nullptr to wait for the timeout)
+     * @param context A user-defined pointer that will be passed as argument when invoking condition()
+     * @param timeout The maximum time to wait, in clock units (NoTimeout to wait forever)
+     * @return true if the condition has been met, false if the timeout expired before
+     */
+    bool runUntil(FConditionFunc condition, void* context = nullptr, uint32_t timeout = NoTimeout);
+
+    /**
+     * @brief Get the dispatch statistics of an event
+     */
+    EventStats getStats(Event event) const;
+
+    /**
+     * @brief Clear the dispatch statistics of all events
+     */
+    void resetStats();
+
+private:
+    /**
+     * @brief Get the current time from the time source
+     */
+    uint32_t now() const;
+
+/* Attributes */
+    FClockFunc clock;   /*!< The time source */
+    void* clockContext; /*!< A context pointer passed to clock() */
+    FIdleFunc idle; /*!< The function invoked when no event is pending */
+    void* idleContext;  /*!< A context pointer passed to idle() */
+    FEventHandlerFunc handlers[EventCount]; /*!< The handler of each event */
+    void* handlerContexts[EventCount];   /*!< The context pointer passed to each handler */
+    uint8_t priorities[EventCount]; /*!< The priority of each event */
+    std::atomic<uint32_t> pending;  /*!< One bit per pending event, set from interrupt context */
+    std::atomic<uint32_t> postTimestamps[EventCount];  /*!< When each pending event was first posted */
+    std::atomic<unsigned int> coalescedCounts[EventCount];  /*!< Posts of already pending events, updated from interrupt context */
+    EventStats stats[EventCount]; /*!< Dispatch statistics, only updated from the main context */
+};
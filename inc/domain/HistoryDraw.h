@@ -12,6 +12,8 @@
  * @param width The width (in pixels) of the rectangle area to use to draw
  * @param height The height (in pixels) of the rectangle area to use to draw
  * @param history The history data to draw
+ * @param spanInSeconds The time span to draw (the zoom level), the finest history tier that fits in @p width columns is used (0 to draw the base history, one entry per column)
  * @param debugContext An optional debug context pointer to display a debug information line
+ * @return true if the history was not modified while being drawn (otherwise the graph may mix old and new entries)
  */
-void drawHistory(Stm32LcdDriver& lcd, uint16_t x, uint16_t y, uint16_t width, uint16_t height, const PowerHistory& history, void* debugContext = nullptr);
\ No newline at end of file
+bool drawHistory(Stm32LcdDriver& lcd, uint16_t x, uint16_t y, uint16_t width, uint16_t height, const PowerHistory& history, unsigned int spanInSeconds = 0, void* debugContext = nullptr);
\ No newline at end of file
@@ -1,10 +1,21 @@
 #pragma once
 
+#include <stdint.h>
+
 #include "FixedSizeRingBuffer.h"
+#include "EnergyAccounting.h"
 #include "TicProcessingContext.h"
 #include "TicFrameParser.h" // For TicEvaluatedPower
 #include "TimeOfDay.h"
 
+/**
+ * @brief The power measured over a period, built from one or more power samples
+ * 
+ * Besides the average power, an entry keeps streaming statistics on its samples, updated in O(1) per sample:
+ * - the exact sums of the min and max boundaries of all samples, so that the average does not drift, whatever the number of samples
+ * - the peak range (the lowest and highest power of all samples), so that short spikes remain visible
+ * - the sum of squared deviations (Welford's algorithm) of the middle of each sample range, to get the variance
+ */
 struct PowerHistoryEntry {
     PowerHistoryEntry();
     PowerHistoryEntry(const TicEvaluatedPower& power, const TimeOfDay& timestamp);
@@ -20,6 +31,13 @@ private:
      */
     static signed int truncateSignedLongToSignedInt(const signed long input);
 
+    /**
+     * @brief Get the middle of the range of our average power
+     * 
+     * @return The middle value, in W (the exact average if all samples are exact)
+     */
+    float getMeanMiddlePower() const;
+
 public:
     /**
      * @brief Update this object with an average between our current value and a new power measurement sample
@@ -29,11 +47,297 @@ public:
      */
     void averageWithPowerSample(const TicEvaluatedPower& power, const TimeOfDay& timestamp);
 
+    /**
+     * @brief Update this object with an average between our current value and another entry, weighted by their number of samples
+     * 
+     * @param other The entry to merge into this one (typically a finer resolution entry covering part of our period)
+     */
+    void averageWithEntry(const PowerHistoryEntry& other);
+
+    /**
+     * @brief Get the variance of the samples (taking the middle of each sample range)
+     * 
+     * @return The population variance, in W², or 0 if there are less than 2 samples
+     */
+    float getVariance() const;
+
 /* Attributes */
     TicEvaluatedPower power; /*!< A power (in multiples or fractions of W... see scale below) */
     TimeOfDay timestamp; /*!< The timestamp for the @p power entry */
     unsigned int nbSamples; /*!< The number of samples that have been averaged to produce the value in @p power */
     unsigned int scale; /*!< A divider for @p power. If scale=1000, then power is represented in mW */
+    int64_t minPowerSum; /*!< The exact sum of the min boundary of all samples (power.minValue is minPowerSum/nbSamples) */
+    int64_t maxPowerSum; /*!< The exact sum of the max boundary of all samples (power.maxValue is maxPowerSum/nbSamples) */
+    TicEvaluatedPower peakPower; /*!< The peak range: the lowest min boundary and the highest max boundary of all samples */
+    float sumOfSquaredDeviations; /*!< Welford's sum of squared deviations from the mean, on the middle of each sample range */
+};
+
+/**
+ * @brief Compact (24-byte) storage form of a PowerHistoryEntry
+ * 
+ * Only what a history entry actually needs is kept:
+ * - the timestamp as seconds since midnight (milliseconds and other TimeOfDay details are dropped)
+ * - the validity flags
+ * - the number of samples, saturated to MaxNbSamples
+ * - the power range in W, saturated to the int16_t range (+/-32kW)
+ * - the peak range in W, saturated the same way
+ * - the exact sums of the min and max boundaries of all samples, saturated to the int32_t range (more than 500kW on average over MaxNbSamples samples)
+ * - the variance of the samples
+ * 
+ * Entries are converted back to a PowerHistoryEntry on read (see unpack()), with the same statistics as when they were packed
+ * 
+ * A packed entry can also be a gap marker, standing for a run of periods without any power data (see makeGap()).
+ * It has no valid timestamp, and secondsOfDay then holds the number of missed periods
+ */
+struct PackedPowerHistoryEntry {
+    static constexpr unsigned int MaxNbSamples = (1U << 12) - 1; /*!< The highest number of samples we can store (enough for one hour of per-second samples) */
+    static constexpr unsigned int MaxGapLength = (1U << 17) - 1; /*!< The longest gap a single marker can represent, in periods (more than a day at 1 second) */
+
+    PackedPowerHistoryEntry();
+
+    /**
+     * @brief Pack a PowerHistoryEntry
+     * 
+     * @param entry The entry to pack
+     */
+    explicit PackedPowerHistoryEntry(const PowerHistoryEntry& entry);
+
+    /**
+     * @brief Decode this packed entry
+     * 
+     * @return The equivalent PowerHistoryEntry
+     */
+    PowerHistoryEntry unpack() const;
+
+    /**
+     * @brief Create a gap marker
+     * 
+     * @param nbPeriods The number of missed periods (saturated to MaxGapLength)
+     * @return The marker
+     */
+    static PackedPowerHistoryEntry makeGap(unsigned int nbPeriods);
+
+    /**
+     * @brief Get the number of missed periods this gap marker stands for
+     * 
+     * @return The number of periods, or 0 if this is not a gap marker
+     */
+    unsigned int getGapLength() const;
+
+private:
+    /**
+     * @brief Convert a signed int to a int16_t, saturating if needed
+     */
+    static int16_t saturateToInt16(int input);
+
+    /**
+     * @brief Convert a int64_t to a int32_t, saturating if needed
+     */
+    static int32_t saturateToInt32(int64_t input);
+
+public:
+/* Attributes */
+    uint32_t secondsOfDay : 17; /*!< The timestamp, in seconds since midnight if timestampValid, or else the gap length */
+    uint32_t timestampValid : 1; /*!< Is the timestamp valid? */
+    uint32_t powerValid : 1; /*!< Is the power valid? */
+    uint32_t powerExact : 1; /*!< Is the power exact (minPower==maxPower)? */
+    uint32_t nbSamples : 12; /*!< The number of samples averaged in this entry */
+    int16_t minPower; /*!< The minimum power, in W */
+    int16_t maxPower; /*!< The maximum power, in W */
+    int16_t minPeakPower; /*!< The lowest power of all samples, in W */
+    int16_t maxPeakPower; /*!< The highest power of all samples, in W */
+    int32_t minPowerSum; /*!< The sum of the min boundary of all samples, in W */
+    int32_t maxPowerSum; /*!< The sum of the max boundary of all samples, in W */
+    float variance; /*!< The variance of the samples, in W² (see PowerHistoryEntry::getVariance()) */
+};
+
+/**
+ * @brief A read-only view over the entries of a PowerHistory, read in place from its storage (see PowerHistory::getView())
+ * 
+ * The storage of a ring buffer is seen as two contiguous spans: the older entries, followed by the newer entries once the ring has wrapped.
+ * Entries are read from the most recent one with readNext(), gap markers being expanded into invalid entries (one per missed period),
+ * so that no intermediate array of entries is needed.
+ * 
+ * The view is only valid as long as the history is not modified. The history version at the time the view was taken is kept, so that a consumer
+ * can check afterwards whether it read a consistent content (see PowerHistory::hasChangedSince())
+ */
+class PowerHistoryView {
+public:
+/* Methods */
+    PowerHistoryView();
+
+    /**
+     * @brief Construct a new view
+     * 
+     * @param olderEntries The oldest packed entries (the first one being the oldest entry)
+     * @param nbOlderEntries The number of entries in @p olderEntries
+     * @param newerEntries The newest packed entries, following @p olderEntries (the last one being the most recent entry)
+     * @param nbNewerEntries The number of entries in @p newerEntries
+     * @param periodInSeconds The period of each entry
+     * @param maxEntries The max number of entries (including expanded gap periods) that readNext() will provide
+     * @param version The version of the history when the view was taken
+     */
+    PowerHistoryView(const PackedPowerHistoryEntry* olderEntries, std::size_t nbOlderEntries,
+                     const PackedPowerHistoryEntry* newerEntries, std::size_t nbNewerEntries,
+                     unsigned int periodInSeconds, unsigned int maxEntries, unsigned int version);
+
+    /**
+     * @brief Read the next entry, from the most recent one to the oldest one
+     * 
+     * @param[out] entry The entry read (an invalid entry for each period of a gap)
+     * @return true if an entry was read, false if there are no more entries to read
+     */
+    bool readNext(PowerHistoryEntry& entry);
+
+    /**
+     * @brief Restart reading from the most recent entry
+     */
+    void rewind();
+
+private:
+    /**
+     * @brief Move to the previous packed entry in the storage
+     * 
+     * @return The packed entry or nullptr if we already reached the oldest one
+     */
+    const PackedPowerHistoryEntry* fetchPrevious();
+
+public:
+/* Attributes */
+    const PackedPowerHistoryEntry* olderEntries; /*!< The oldest packed entries */
+    std::size_t nbOlderEntries; /*!< The number of entries in olderEntries */
+    const PackedPowerHistoryEntry* newerEntries; /*!< The newest packed entries (after a wrap of the ring storage) */
+    std::size_t nbNewerEntries; /*!< The number of entries in newerEntries */
+    unsigned int periodInSeconds; /*!< The period of each entry, in seconds */
+    unsigned int maxEntries; /*!< The max number of entries readNext() provides */
+    unsigned int version; /*!< The version of the history when this view was taken */
+private:
+    const PackedPowerHistoryEntry* cursor; /*!< One past the next packed entry to read */
+    bool readingNewerEntries; /*!< Is cursor within newerEntries (or else within olderEntries)? */
+    unsigned int gapPeriodsLeft; /*!< The number of invalid entries left to provide for the gap marker being expanded */
+    unsigned int entriesLeft; /*!< The number of entries readNext() can still provide */
+};
+
+/**
+ * @brief Prefix sums over the packed entries of a ring of N entries, maintained along with the ring
+ *
+ * For each entry stored, we keep the cumulative sums of the min and max powers, of the number of valid entries and of the number of periods
+ * of all entries pushed up to (and including) that one. The sums over any window of the last entries are then the difference between two
+ * cumulative sums, in O(1), instead of a scan of the window.
+ *
+ * Each valid entry weighs one period in the sums, so averages are averages over time. A gap marker only adds its missed periods.
+ *
+ * Cumulative sums are stored as uint32_t and wrap around: the difference between two of them stays exact as long as the sums over the window
+ * fit in an int32_t, which is always the case for windows of up to 65535 entries of int16_t powers.
+ */
+template <std::size_t N>
+class PowerHistoryPrefixSums {
+    static_assert(N <= 65535, "Windows of more than 65535 entries may overflow the wrapping int32_t differences of cumulative sums");
+
+public:
+/* Types */
+    /**
+     * @brief The sums over a window of entries
+     */
+    struct WindowSums {
+        WindowSums();
+
+        /**
+         * @brief Get the average power over the window
+         *
+         * @param[out] average The average of the min and max powers of the valid entries
+         * @return false if there are no valid entries in the window (@p average is then left untouched)
+         */
+        bool getAverage(TicEvaluatedPower& average) const;
+
+    /* Attributes */
+        int64_t minPowerSum; /*!< The sum of the min power of valid entries, in W */
+        int64_t maxPowerSum; /*!< The sum of the max power of valid entries, in W */
+        unsigned int nbValidEntries; /*!< The number of valid entries */
+        unsigned int nbPeriods; /*!< The number of periods covered (valid entries and missed periods) */
+    };
+
+/* Methods */
+    PowerHistoryPrefixSums();
+
+    void reset();
+
+    /**
+     * @brief Account for an entry pushed to the ring
+     *
+     * @param entry The entry
+     */
+    void push(const PackedPowerHistoryEntry& entry);
+
+    /**
+     * @brief Account for the last entry of the ring being updated in place
+     *
+     * @param entry The new content of the last entry
+     */
+    void replaceLast(const PackedPowerHistoryEntry& entry);
+
+    std::size_t getCount() const;
+
+    /**
+     * @brief Get the sums over the last entries, in O(1)
+     *
+     * @param nbEntries The number of entries (gap markers counting as one entry), saturated to the number of entries stored
+     * @return The sums
+     */
+    WindowSums getLastEntries(std::size_t nbEntries) const;
+
+    /**
+     * @brief Get the sums over the last periods
+     *
+     * @param nbPeriods The number of periods
+     * @return The sums (its nbPeriods is less than @p nbPeriods only if not enough periods are stored)
+     *
+     * @note This is O(1) if there is no gap marker within the window, O(log N) otherwise (we search for the oldest entry of the window)
+     */
+    WindowSums getLastPeriods(unsigned int nbPeriods) const;
+
+private:
+    /**
+     * @brief Cumulative sums, wrapping around
+     */
+    struct Cumulative {
+        Cumulative();
+
+    /* Attributes */
+        uint32_t minPowerSum; /*!< The cumulative sum of the min powers, in W */
+        uint32_t maxPowerSum; /*!< The cumulative sum of the max powers, in W */
+        uint32_t nbValidEntries; /*!< The cumulative number of valid entries */
+        uint32_t nbPeriods; /*!< The cumulative number of periods */
+    };
+
+    /**
+     * @brief Add an entry to cumulative sums
+     *
+     * @param previous The cumulative sums up to the previous entry
+     * @param entry The entry to add
+     * @return The cumulative sums up to @p entry
+     */
+    static Cumulative accumulate(const Cumulative& previous, const PackedPowerHistoryEntry& entry);
+
+    /**
+     * @brief Get the cumulative sums of all entries older than the last ones
+     *
+     * @param nbEntries The number of last entries to exclude (at most count)
+     */
+    const Cumulative& getCumulativeBefore(std::size_t nbEntries) const;
+
+    /**
+     * @brief Get the number of periods covered by the last entries
+     *
+     * @param nbEntries The number of last entries (at most count)
+     */
+    uint32_t getLastPeriodCount(std::size_t nbEntries) const;
+
+/* Attributes */
+    Cumulative cumulative[N]; /*!< The cumulative sums up to each entry of the ring, stored at the same rank */
+    Cumulative dropped; /*!< The cumulative sums of all entries dropped from the ring (up to the entry before the oldest one) */
+    std::size_t head; /*!< Offset where the cumulative sums of the next entry pushed will be stored */
+    std::size_t count; /*!< The number of entries accounted for in cumulative */
 };
 
 struct PowerHistory {
@@ -49,6 +353,11 @@ struct PowerHistory {
         Per5Minutes,
     } AveragingMode;
 
+    static constexpr unsigned int TierCount = 4; /*!< The number of cascaded lower-resolution tiers, above the base history */
+    static constexpr std::size_t Capacity = 24 * 60 * 60 / 5; /*!< The number of entries kept in the base history (a full day at 5 seconds) */
+    static constexpr std::size_t TierCapacity = 768; /*!< The number of entries kept in each tier (enough for a week at 15 minutes, or a month at 1 hour) */
+    static constexpr unsigned int TierPeriodsInSeconds[TierCount] = { 10, 60, 15*60, 60*60 }; /*!< The period of each tier, each one being a multiple of the previous one */
+
     /**
      * @brief Construct a new power history storage
      * 
@@ -70,6 +379,10 @@ struct PowerHistory {
      * @param power The power measurement
      * @param timestamp The timestamp associated with the @p power
      * @param frameSequenceNb The TIC frame sequence number
+     * 
+     * @note If whole periods were missed since the last power data (for example while the TIC cable was unplugged), a gap marker is recorded first,
+     *       so that the time axis of the history remains correct
+     * @note Each power measurement is also integrated into energy totals (see energy)
      */
     void onNewPowerData(const TicEvaluatedPower& power, const TimeOfDay& timestamp, unsigned int frameSequenceNb);
 
@@ -97,15 +410,20 @@ struct PowerHistory {
     unsigned int getPowerRecordsPerHour() const;
 
     /**
-     * @brief Utility function to unwrap a TicFrameParser instance and invoke onDatasetExtracted() on it
-     * It is used as a callback provided to TIC::DatasetExtractor
+     * @brief Method to invoke when a TIC frame is complete
      * 
-     * @param power The power measurement
-     * @param timestamp The timestamp associated with the @p power
-     * @param frameSequenceNb The TIC frame sequence number
-     * @param context A context as provided by TIC::DatasetExtractor, used to retrieve the wrapped TicFrameParser instance
+     * @param measurements The measurements of the whole frame (only its power and timestamp are recorded)
+     */
+    void onNewFrameMeasurements(const TicMeasurements& measurements);
+
+    /**
+     * @brief Utility function to unwrap a PowerHistory instance and invoke onNewFrameMeasurements() on it
+     * It is used as a callback provided to TicFrameParser
+     * 
+     * @param measurements The measurements of the whole frame
+     * @param context A context as provided by TicFrameParser, used to retrieve the wrapped PowerHistory instance
      */
-    static void unWrapOnNewPowerData(const TicEvaluatedPower& power, const TimeOfDay& timestamp, unsigned int frameSequenceNb, void* context);
+    static void unWrapOnNewFrameMeasurements(const TicMeasurements& measurements, void* context);
 
     /**
      * @brief Get the Last Values object
@@ -114,12 +432,216 @@ struct PowerHistory {
      * @param[out] result A C-array of results, the first one being the most recent
      * 
      * @note The timestamp of the most recent entry can be retrieved in the first element of the result array (if nb!=0 at return)
+     * @note Missed periods are expanded into invalid entries (one per period)
      */
     void getLastPower(unsigned int& nb, PowerHistoryEntry* result) const;
 
+    /**
+     * @brief Get a view over the most recent entries covering a time span, without copying them
+     * 
+     * The source history is selected like in getLastPowerOverSpan()
+     * 
+     * @param spanInSeconds The time span to cover (0 to get the last @p maxEntries base entries)
+     * @param maxEntries The max number of entries to read from the view
+     * @return The view (its periodInSeconds attribute being the period of the entries selected)
+     */
+    PowerHistoryView getView(unsigned int spanInSeconds, unsigned int maxEntries) const;
+
+    /**
+     * @brief Check if this history has been modified after a view was taken on it
+     * 
+     * @param view The view
+     * @return true if the history was modified, and the content read from @p view may thus be inconsistent
+     */
+    bool hasChangedSince(const PowerHistoryView& view) const;
+
+    /**
+     * @brief Is a tier in use with our averaging period?
+     * 
+     * A tier is only fed if its period is a multiple of (and longer than) the averaging period, so that each base entry belongs to exactly one tier entry
+     * 
+     * @param tier The tier index (0 to TierCount-1)
+     * @return true if the tier is fed
+     */
+    bool isTierActive(unsigned int tier) const;
+
+    /**
+     * @brief Get the most recent entries covering a time span, taken from the finest resolution that fits in the requested number of entries
+     * 
+     * The base history (at the averaging period) is used if it fits, otherwise the first active tier that fits both in @p nb entries and in its capacity,
+     * otherwise the coarsest active tier. No entry is recomputed, so the cost is O(@p nb)
+     * 
+     * @param spanInSeconds The time span to cover (0 to get the last @p nb base entries, like getLastPower())
+     * @param[in,out] nb The max number of entries requested, modified at return to represent the number of entries actually retrieved
+     * @param[out] result A C-array of results, the first one being the most recent
+     * @return The period (in seconds) of the entries retrieved
+     * 
+     * @note An entry is only merged into the next tier once its period is over, so each tier lags behind by the entry still open in the tier below
+     */
+    unsigned int getLastPowerOverSpan(unsigned int spanInSeconds, unsigned int& nb, PowerHistoryEntry* result) const;
+
+    /**
+     * @brief Get the average power over the last time span, in O(1) whatever the span (see PowerHistoryPrefixSums)
+     * 
+     * The average is taken from the prefix sums of the base history if it holds the whole span (the entry of the current period included),
+     * otherwise of the finest active tier that holds the whole span, otherwise of the coarsest active tier
+     * 
+     * @param spanInSeconds The time span, rounded up to a whole number of periods of the history used
+     * @param[out] average The average over time of the min and max powers during @p spanInSeconds (missed periods being ignored)
+     * @return false if there is no power data over @p spanInSeconds
+     * 
+     * @note Averages taken from a tier lag behind by the entry still open in the base history
+     */
+    bool getAverageOverLast(unsigned int spanInSeconds, TicEvaluatedPower& average) const;
+
+private:
+    /**
+     * @brief Merge a base entry whose period is over into the tiers, cascading each tier entry whose period is over into the next tier
+     * 
+     * @param closedEntry The base entry
+     */
+    void feedTiers(const PowerHistoryEntry& closedEntry);
+
+public:
+
 /* Attributes */
-    FixedSizeRingBuffer<PowerHistoryEntry, 1024> data;    /*!< The last n instantaneous power measurements */
+    FixedSizeRingBuffer<PackedPowerHistoryEntry, Capacity> data;    /*!< The last n instantaneous power measurements */
+    PowerHistoryPrefixSums<Capacity> dataSums;   /*!< The prefix sums over data, updated along with it */
+    FixedSizeRingBuffer<PackedPowerHistoryEntry, TierCapacity> tiers[TierCount];    /*!< Lower-resolution histories, tiers[i] having one entry per TierPeriodsInSeconds[i] */
     AveragingMode averagingPeriod; /*!< Which sampling period do we record (we will perform an average on all samples within the period) */
     TicProcessingContext* ticContext;   /*!< An optional context structure instance that we should refresh on new power data reception */
     TimeOfDay lastPowerTimeOfDay;    /*!< The timestamp of the last received power measurement */
+    PowerHistoryEntry openEntry;    /*!< The entry of the current period, with its exact statistics (its packed form is the last entry of data) */
+    PowerHistoryEntry openTierEntries[TierCount];   /*!< The entry of the current period of each tier, with its exact statistics (its packed form is the last entry of the tier) */
+    PowerHistoryPrefixSums<TierCapacity> tierSums[TierCount];   /*!< The prefix sums over each tier, updated along with it */
+    unsigned int version;   /*!< A counter incremented each time the entries are modified */
+    EnergyAccounting energy;    /*!< The energy withdrawn and injected, integrated from each power measurement */
 };
+
+template <std::size_t N>
+PowerHistoryPrefixSums<N>::WindowSums::WindowSums() :
+    minPowerSum(0),
+    maxPowerSum(0),
+    nbValidEntries(0),
+    nbPeriods(0)
+{
+}
+
+template <std::size_t N>
+bool PowerHistoryPrefixSums<N>::WindowSums::getAverage(TicEvaluatedPower& average) const {
+    if (this->nbValidEntries == 0)
+        return false;
+    average = TicEvaluatedPower(static_cast<signed int>(this->minPowerSum / this->nbValidEntries),
+                                static_cast<signed int>(this->maxPowerSum / this->nbValidEntries));
+    return true;
+}
+
+template <std::size_t N>
+PowerHistoryPrefixSums<N>::Cumulative::Cumulative() :
+    minPowerSum(0),
+    maxPowerSum(0),
+    nbValidEntries(0),
+    nbPeriods(0)
+{
+}
+
+template <std::size_t N>
+PowerHistoryPrefixSums<N>::PowerHistoryPrefixSums() {
+    this->reset();
+}
+
+template <std::size_t N>
+void PowerHistoryPrefixSums<N>::reset() {
+    this->dropped = Cumulative();
+    this->head = 0;
+    this->count = 0;
+}
+
+template <std::size_t N>
+typename PowerHistoryPrefixSums<N>::Cumulative PowerHistoryPrefixSums<N>::accumulate(const Cumulative& previous, const PackedPowerHistoryEntry& entry) {
+    Cumulative result = previous;
+    unsigned int gapLength = entry.getGapLength();
+    if (gapLength > 0) {
+        result.nbPeriods += gapLength;
+        return result;
+    }
+    result.nbPeriods++;
+    if (entry.powerValid) {
+        result.minPowerSum += static_cast<uint32_t>(static_cast<int32_t>(entry.minPower));  /* Wraps around, see the class description */
+        result.maxPowerSum += static_cast<uint32_t>(static_cast<int32_t>(entry.maxPower));
+        result.nbValidEntries++;
+    }
+    return result;
+}
+
+template <std::size_t N>
+const typename PowerHistoryPrefixSums<N>::Cumulative& PowerHistoryPrefixSums<N>::getCumulativeBefore(std::size_t nbEntries) const {
+    if (nbEntries >= this->count)
+        return this->dropped;
+    return this->cumulative[(this->head + 2*N - 1 - nbEntries) % N];
+}
+
+template <std::size_t N>
+uint32_t PowerHistoryPrefixSums<N>::getLastPeriodCount(std::size_t nbEntries) const {
+    return this->getCumulativeBefore(0).nbPeriods - this->getCumulativeBefore(nbEntries).nbPeriods;
+}
+
+template <std::size_t N>
+void PowerHistoryPrefixSums<N>::push(const PackedPowerHistoryEntry& entry) {
+    Cumulative previous = this->getCumulativeBefore(0);
+    if (this->count == N) {
+        this->dropped = this->cumulative[this->head];  /* The oldest entry is overwritten */
+    }
+    else {
+        this->count++;
+    }
+    this->cumulative[this->head] = accumulate(previous, entry);
+    this->head = (this->head + 1) % N;
+}
+
+template <std::size_t N>
+void PowerHistoryPrefixSums<N>::replaceLast(const PackedPowerHistoryEntry& entry) {
+    if (this->count == 0)
+        return;
+    this->cumulative[(this->head + N - 1) % N] = accumulate(this->getCumulativeBefore(1), entry);
+}
+
+template <std::size_t N>
+std::size_t PowerHistoryPrefixSums<N>::getCount() const {
+    return this->count;
+}
+
+template <std::size_t N>
+typename PowerHistoryPrefixSums<N>::WindowSums PowerHistoryPrefixSums<N>::getLastEntries(std::size_t nbEntries) const {
+    const Cumulative& last = this->getCumulativeBefore(0);
+    const Cumulative& before = this->getCumulativeBefore(nbEntries);
+    WindowSums result;
+    result.minPowerSum = static_cast<int32_t>(last.minPowerSum - before.minPowerSum);
+    result.maxPowerSum = static_cast<int32_t>(last.maxPowerSum - before.maxPowerSum);
+    result.nbValidEntries = last.nbValidEntries - before.nbValidEntries;
+    result.nbPeriods = last.nbPeriods - before.nbPeriods;
+    return result;
+}
+
+template <std::size_t N>
+typename PowerHistoryPrefixSums<N>::WindowSums PowerHistoryPrefixSums<N>::getLastPeriods(unsigned int nbPeriods) const {
+    std::size_t nbEntries = (nbPeriods < this->count) ? nbPeriods : this->count;   /* Each entry covers at least one period */
+    if (this->getLastPeriodCount(nbEntries) > nbPeriods) {
+        /* There are gap markers in the window, search for the fewest last entries covering nbPeriods */
+        std::size_t lowest = 1;
+        while (lowest < nbEntries) {
+            std::size_t middle = (lowest + nbEntries) / 2;
+            if (this->getLastPeriodCount(middle) >= nbPeriods) {
+                nbEntries = middle;
+            }
+            else {
+                lowest = middle + 1;
+            }
+        }
+    }
+    WindowSums result = this->getLastEntries(nbEntries);
+    if (result.nbPeriods > nbPeriods) {
+        result.nbPeriods = nbPeriods;   /* The oldest entry is a gap marker partly within the window */
+    }
+    return result;
+}
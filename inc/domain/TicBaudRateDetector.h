@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <stdint.h>
+
+/**
+ * @brief Detects whether the TIC serial link runs in historical (1200 bauds) or standard (9600 bauds) mode
+ *
+ * The detector observes the bytes received (and the line errors reported by the UART) at the current baudrate, and checks if they form
+ * valid TIC datasets (LF-delimited, with a correct checksum) and STX/ETX-delimited frames.
+ * While probing, if no valid data shows up within a probing window (or if the line error ratio is too high), the other baudrate is tried.
+ * Once valid data has been seen, the baudrate is locked. It is only unlocked again if a long window goes by with received bytes, but
+ * without any valid dataset (or with mostly line errors), for example if the meter has been switched to the other TIC mode.
+ *
+ * Each time the baudrate should change, the onBaudRateChange callback is invoked so that the UART is reconfigured.
+ *
+ * @note This class has no hardware dependency, time is provided by the caller using update()
+ */
+class TicBaudRateDetector {
+public:
+/* Types */
+    typedef void(*FOnBaudRateChangeFunc)(unsigned int baudRate, void* context); /*!< The prototype of callbacks invoked to switch the UART baudrate */
+
+    static constexpr unsigned int HistoricalBaudRate = 1200; /*!< Baudrate for historical TIC */
+    static constexpr unsigned int StandardBaudRate = 9600; /*!< Baudrate for standard TIC */
+    static constexpr uint32_t ProbeWindowMs = 3000; /*!< How long we wait for valid data at a candidate baudrate before trying the other one */
+    static constexpr uint32_t LockedWindowMs = 10000; /*!< When locked, the duration of the window over which we check that valid data is still received */
+    static constexpr unsigned int MinBytesForVerdict = 32; /*!< Minimum number of received bytes in a window before we consider error ratios or lack of valid data */
+    static constexpr unsigned int ValidDatasetsToLock = 4; /*!< How many valid datasets we need to lock on a baudrate (a valid frame locks immediately) */
+    static constexpr std::size_t MaxDatasetSize = 128; /*!< Any dataset longer than this is considered as invalid */
+
+/* Methods */
+    /**
+     * @brief Construct a new detector
+     *
+     * @param onBaudRateChange A function to invoke when the UART baudrate should be changed
+     * @param context A user-defined pointer that will be passed as last argument when invoking onBaudRateChange()
+     * @param initialBaudRate The baudrate the UART is initially configured with
+     */
+    TicBaudRateDetector(FOnBaudRateChangeFunc onBaudRateChange = nullptr, void* context = nullptr, unsigned int initialBaudRate = HistoricalBaudRate);
+
+    /**
+     * @brief Restart detection (unlocked) at the current baudrate
+     *
+     * @param nowMs The current time (in ms)
+     */
+    void start(uint32_t nowMs);
+
+    /**
+     * @brief Take new bytes received at the current baudrate into account
+     *
+     * @param buf The received bytes
+     * @param len The number of bytes in @p buf
+     */
+    void pushBytes(const uint8_t* buf, std::size_t len);
+
+    /**
+     * @brief Take line errors (parity, framing or noise errors) reported by the UART into account
+     *
+     * @param count The number of new errors
+     */
+    void pushLineErrors(unsigned int count);
+
+    /**
+     * @brief Evaluate the statistics collected so far, and switch baudrate if needed
+     *
+     * @param nowMs The current time (in ms)
+     */
+    void update(uint32_t nowMs);
+
+    /**
+     * @brief Get the baudrate currently probed or locked
+     */
+    unsigned int getBaudRate() const;
+
+    /**
+     * @brief Has the baudrate been confirmed by valid TIC data?
+     */
+    bool isLocked() const;
+
+    /**
+     * @brief Get the number of baudrate changes requested since construction
+     */
+    unsigned int getSwitchCount() const;
+
+#ifndef __UNIT_TEST__
+private:
+#endif
+    /**
+     * @brief Check if a dataset (the bytes between LF and CR) has a valid checksum, in either historical or standard format
+     *
+     * @param sum The sum of all bytes of the dataset
+     * @param len The number of bytes in the dataset
+     * @param separator The byte just before the checksum
+     * @param checksum The last byte of the dataset
+     */
+    static bool isValidDataset(unsigned int sum, std::size_t len, uint8_t separator, uint8_t checksum);
+
+private:
+    void processByte(uint8_t byte);
+    void onDatasetEnd();
+    void resetWindow(uint32_t nowMs);
+    void switchBaudRate(uint32_t nowMs);
+
+/* Attributes */
+    FOnBaudRateChangeFunc onBaudRateChange; /*!< Function invoked to switch baudrate */
+    void* onBaudRateChangeContext; /*!< A context pointer passed as argument to the above method */
+    unsigned int baudRate;  /*!< The baudrate currently in use */
+    bool locked;    /*!< Has valid data been seen at the current baudrate? */
+    unsigned int switchCount;   /*!< How many baudrate changes were requested */
+    uint32_t windowStartMs; /*!< When the current observation window started */
+    bool windowStarted; /*!< Has windowStartMs been initialized? */
+    unsigned int windowBytes;   /*!< Number of bytes received in the current window */
+    unsigned int windowLineErrors;  /*!< Number of line errors in the current window */
+    unsigned int windowValidDatasets;   /*!< Number of datasets with a valid checksum in the current window */
+    unsigned int windowValidFrames; /*!< Number of STX/ETX frames made of valid datasets in the current window */
+    bool inDataset; /*!< Are we between a LF and a CR? */
+    unsigned int datasetSum;    /*!< Sum of the bytes of the current dataset */
+    std::size_t datasetLen; /*!< Number of bytes in the current dataset */
+    uint8_t datasetLastBytes[2];    /*!< The last two bytes of the current dataset ([1] being the most recent) */
+    bool datasetCorrupted;  /*!< Did the current dataset contain non-printable bytes? */
+    bool inFrame;   /*!< Are we between a STX and an ETX? */
+    unsigned int frameValidDatasets;    /*!< Number of valid datasets in the current frame */
+    unsigned int frameInvalidDatasets;  /*!< Number of invalid datasets in the current frame */
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <stdint.h>
+
+#include "TicLabelTable.h"
+
+/**
+ * @brief Decode TIC datasets on the fly, while the bytes of a frame stream in
+ *
+ * TIC::DatasetExtractor buffers a whole dataset, and TIC::DatasetView then scans it again to check its checksum and split its fields.
+ * Here, each byte is processed once, on arrival: the checksum sum is accumulated, the label is resolved (using TicLabelTable) as soon as its separator is received,
+ * and each field is converted to a decimal number while it is being received.
+ * When the end marker arrives, the checksum is verified in constant time and the decoded dataset is immediately available.
+ *
+ * The dataset bytes are still kept, so that the few values that are not decimal (text, hexadecimal) can be decoded using a TIC::DatasetView.
+ */
+class TicDatasetStreamDecoder {
+public:
+/* Types */
+    static constexpr uint8_t StartMarker = 0x0a; /*!< Line feed, starts a dataset */
+    static constexpr uint8_t EndMarker = 0x0d; /*!< Carriage return, ends a dataset */
+    static constexpr uint8_t StandardSeparator = 0x09; /*!< Horizontal tab, separates fields in standard TIC */
+    static constexpr uint8_t HistoricalSeparator = 0x20; /*!< Space, separates fields in historical TIC */
+    static constexpr std::size_t MaxDatasetSize = 128; /*!< Longer datasets are discarded */
+    static constexpr unsigned int MaxSeparators = 4; /*!< Label, horodate and value separators, plus a checksum that may itself be a space in historical TIC */
+
+    struct DecodedDataset {
+        bool isValid; /*!< Is the dataset well-formed, with a correct checksum? */
+        bool isHistorical; /*!< Is this a historical TIC dataset (fields separated by spaces, no horodate)? */
+        TicLabelTable::Label label; /*!< The label (TicLabelTable::Unknown if we do not handle it) */
+        uint32_t value; /*!< The value as an unsigned decimal number, or (uint32_t)-1 if it is empty or not a decimal number */
+        const uint8_t* horodate; /*!< The horodate field (standard TIC only), or nullptr if there is none */
+        std::size_t horodateSz; /*!< The number of bytes in @p horodate */
+        const uint8_t* buffer; /*!< The whole dataset, without start and end markers (as expected by TIC::DatasetView) */
+        std::size_t size; /*!< The number of bytes in @p buffer */
+    };
+
+    typedef void(*FOnDatasetDecodedFunc)(const DecodedDataset& dataset, void* context); /*!< The prototype of callbacks invoked at the end of each dataset */
+
+/* Methods */
+    /**
+     * @brief Construct a new decoder
+     *
+     * @param onDatasetDecoded A function to invoke at the end of each dataset (valid or not)
+     * @param context A user-defined pointer passed as last argument when invoking @p onDatasetDecoded
+     */
+    TicDatasetStreamDecoder(FOnDatasetDecodedFunc onDatasetDecoded = nullptr, void* context = nullptr);
+
+    /**
+     * @brief Process new bytes of a TIC frame
+     *
+     * @param buf A buffer containing new TIC frame bytes
+     * @param len The number of bytes stored inside @p buf
+     */
+    void pushBytes(const uint8_t* buf, std::size_t len);
+
+    /**
+     * @brief Discard any unterminated dataset, and wait for the next start marker
+     */
+    void reset();
+
+private:
+    /**
+     * @brief Start decoding a new dataset
+     */
+    void startDataset();
+
+    /**
+     * @brief Take into account a separator at the current position, ending the current field
+     *
+     * @param separator The separator byte
+     */
+    void onSeparator(uint8_t separator);
+
+    /**
+     * @brief Check the dataset received so far, and invoke onDatasetDecoded
+     */
+    void endDataset();
+
+/* Attributes */
+    FOnDatasetDecodedFunc onDatasetDecoded; /*!< The function invoked at the end of each dataset */
+    void* onDatasetDecodedContext; /*!< A context pointer passed as argument to the above method */
+    bool inDataset; /*!< Are we between a start marker and an end marker? */
+    uint8_t buffer[MaxDatasetSize]; /*!< The bytes of the current dataset */
+    std::size_t size; /*!< The number of bytes in buffer */
+    uint32_t sum; /*!< The sum of all bytes in buffer */
+    uint8_t separator; /*!< The field separator of the current dataset (0 until the end of the label) */
+    TicLabelTable::Label label; /*!< The label of the current dataset, resolved at the end of the label */
+    unsigned int nbSeparators; /*!< The number of separators received in the current dataset */
+    bool tooManyFields; /*!< Did the current dataset have more than MaxSeparators separators? */
+    std::size_t separatorPos[MaxSeparators]; /*!< The position of each separator in buffer */
+    uint32_t fieldValue[MaxSeparators]; /*!< The decimal value of the field ended by each separator, or (uint32_t)-1 */
+    std::size_t fieldStart; /*!< The position of the field being received in buffer */
+    uint64_t currentValue; /*!< The decimal value of the field being received (only meaningful if currentNonDigit is false) */
+    bool currentNonDigit; /*!< Does the field being received contain anything else than digits? */
+};
@@ -6,6 +6,10 @@
 #include "TIC/DatasetView.h"
 #include "TimeOfDay.h"
 #include "FixedSizeRingBuffer.h"
+#include "TicFrameRecord.h"
+#include "TicDatasetStreamDecoder.h"
+#include "EnergyDeltaEstimator.h"
+#include "DatasetErrorStats.h"
 
 /* Forward declarations */
 class TicFrameParser;
@@ -45,6 +49,10 @@ public:
 
 class TicMeasurements {
 public:
+/* Types */
+    static constexpr unsigned int MaxPhases = 3; /*!< The maximum number of phases of a meter */
+
+/* Methods */
     TicMeasurements();
 
     TicMeasurements(unsigned int fromFrameNb);
@@ -62,12 +70,14 @@ public:
     unsigned int instAbsCurrent; /*!< The instantaneous (ie within the last TIC frame) absolute current, in Amps */
     unsigned int maxSubscribedPower; /*!< The maximum allowed withdrawned power (subscribed), in Watts */
     TicEvaluatedPower instPower; /*!< The instantaneous (ie within the last TIC frame) signed power (negative if injected, positive if withdrawn), in Watts... may be an exact value or a range if approximated */
+    TicEvaluatedPower phasePower[MaxPhases]; /*!< The instantaneous signed power on each phase, in Watts (only phasePower[0] is used on single-phase meters, it is then the same as instPower) */
+    TicFrameRecord datasets; /*!< The values of all known labels received in the TIC frame */
 };
 
 class TicFrameParser {
 public:
 /* Types */
-    typedef void(*FOnNewPowerDataFunc)(const TicEvaluatedPower& power, const TimeOfDay& timestamp, unsigned int frameId, void* context); /*!< The prototype of callbacks invoked on new power data */
+    typedef void(*FOnNewFrameMeasurementsFunc)(const TicMeasurements& measurements, void* context); /*!< The prototype of callbacks invoked once per complete TIC frame, with all its measurements */
     typedef void(*FOnDayOverFunc)(void* context); /*!< The prototype of callbacks invoked when we switch to the next day */
     typedef void(*FOnDatasetErrorFunc)(void* context); /*!< The prototype of callbacks invoked when we detect an error in a dataset */
     typedef TimeOfDay(*FCurrentTimerGetterFunc)(void* context); /*!< The prototype of function to invoked to get the current TimeOfDay */
@@ -76,14 +86,14 @@ public:
     /**
      * @brief Construct a new TicFrameParser object
      * 
-     * @param onNewPowerData A FOnNewPowerData function to invoke for each new power data received
-     * @param onNewPowerDataContext A user-defined pointer that will be passed as last argument when invoking onNewPowerData()
+     * @param onNewFrameMeasurements A FOnNewFrameMeasurementsFunc function to invoke at the end of each TIC frame, with the measurements of the whole frame
+     * @param onNewFrameMeasurementsContext A user-defined pointer that will be passed as last argument when invoking onNewFrameMeasurements()
      * 
      * @note We are using C-style function pointers here (with data-encapsulation via a context pointer)
      *       This is because we don't have 100% guarantee that exceptions are allowed (especially on embedded targets) and using std::function requires enabling exceptions.
      *       We can still use non-capturing lambdas as function pointer if needed (see https://stackoverflow.com/questions/28746744/passing-capturing-lambda-as-function-pointer)
      */
-    TicFrameParser(FOnNewPowerDataFunc onNewPowerData = nullptr, void* onNewPowerDataContext = nullptr);
+    TicFrameParser(FOnNewFrameMeasurementsFunc onNewFrameMeasurements = nullptr, void* onNewFrameMeasurementsContext = nullptr);
 
     /**
      * @brief Set the method to invoke when we detect a switch to the next day
@@ -109,6 +119,23 @@ public:
     */
     void setCurrentTimeGetter(FCurrentTimerGetterFunc currentTimeGetter, void* context);
 
+    /**
+     * @brief Select how datasets are decoded from the frame bytes received by onNewFrameBytes()
+     * 
+     * @param enabled If true (the default), datasets are decoded on the fly by a TicDatasetStreamDecoder, each byte being processed once on arrival.
+     *                If false, whole datasets are extracted by a TIC::DatasetExtractor, then decoded by a TIC::DatasetView
+     * 
+     * @note Any dataset being received is discarded
+    */
+    void setStreamingDecoding(bool enabled);
+
+    /**
+     * @brief Get the statistics on datasets that failed to decode (per label, per position in the frame, and error bursts)
+     * 
+     * @return A copy of the statistics collected so far
+    */
+    DatasetErrorStats::Snapshot getDatasetErrorStats() const;
+
 protected:
     void onNewMeasurementAvailable();
 
@@ -142,6 +169,15 @@ protected:
 
     void onNewComputedPower(int minValue, int maxValue);
 
+    /**
+     * @brief Take into account the value of a valid dataset, already stored in the current frame's datasets
+     * 
+     * @param label The label of the dataset
+     * @param value The value of the dataset, as an unsigned decimal number, or (uint32_t)-1 if it is empty or not a decimal number
+     * @param horodate The horodate of the dataset (only used for DATE)
+     */
+    void onNewDatasetValue(TicLabelTable::Label label, uint32_t value, const TIC::Horodate& horodate);
+
     /**
      * @brief Take into account a refreshed instantenous withdrawn power measurement
      * 
@@ -164,15 +200,58 @@ protected:
     void onNewInstCurrentMeasurement(uint32_t current);
 
     /**
-     * @brief Try to compute the current withdrawn or injected power as soon as we have collected enough values (power, abs current, rms voltage)
+     * @brief Take into account a refreshed per-phase measurement (rms voltage, rms current or withdrawn power) already stored in the current frame's datasets
+     * 
+     * @param phase The phase index (0 to TicMeasurements::MaxPhases-1)
+     */
+    void onNewPhaseMeasurement(unsigned int phase);
+
+    /**
+     * @brief Get the number of phases of the meter, based on the labels received in the current frame
+     * 
+     * @return 3 if any phase 2 or 3 specific label has been received, 1 otherwise
+     */
+    unsigned int getPhaseCount() const;
+
+    /**
+     * @brief Evaluate the signed power on one phase, from the labels received in the current frame
+     * 
+     * A strictly positive withdrawn power is exact. A null withdrawn power means we may be injecting, the injected power range is then estimated from the rms voltage and current.
+     * 
+     * @param phase The phase index (0 to TicMeasurements::MaxPhases-1)
+     * @param frameComplete Is the frame over? If so, a phase with known voltage and current but unknown withdrawn power is evaluated as a range covering both withdrawn and injected power
+     * @param[out] power The evaluated power
+     * @return true if @p power has been evaluated, false if we are still missing data
+     */
+    bool evaluatePhasePower(unsigned int phase, bool frameComplete, TicEvaluatedPower& power) const;
+
+    /**
+     * @brief Get the cumulative energy indices received in the current frame
+     * 
+     * @param[out] withdrawnIndex The withdrawn energy index (EAST, or the sum of BASE, HCHC and HCHP in historical mode), in Wh
+     * @param[out] injectedIndex The injected energy index (EAIT, or 0 if absent), in Wh
+     * @return false if the current frame carries no withdrawn energy index
+     */
+    bool getEnergyIndexes(uint32_t& withdrawnIndex, uint32_t& injectedIndex) const;
+
+    /**
+     * @brief Try to compute the current withdrawn or injected power as soon as we have collected enough values (power, and per-phase abs current and rms voltage)
      * 
      * @param source The measurement type to take into account
      * @param value The instantaneous value corresponding to @p source
      */
     void mayComputePower(unsigned int source, unsigned int value);
 
+    /**
+     * @brief Account for a dataset that failed to decode, and notify onDatasetErrorFunc
+     * 
+     * @param buf The dataset bytes, used to attribute the error to a label if the label bytes are intact
+     * @param len The number of bytes in @p buf
+     */
+    void onDatasetError(const uint8_t* buf, std::size_t len);
+
 public:
-    /* The 3 methods below are invoked as callbacks by TIC::Unframer and TIC::DatasetExtractor durig the TIC decoding process */
+    /* The methods below are invoked as callbacks by TIC::Unframer, TIC::DatasetExtractor and TicDatasetStreamDecoder durig the TIC decoding process */
     /**
      * @brief Method invoked on new bytes received inside a TIC frame
      * 
@@ -186,11 +265,22 @@ public:
     /**
      * @brief Method invoked when we reach the end of a TIC frame
      * 
+     * The measurements collected during the frame are committed to lastFrameMeasurements and published at once through onNewFrameMeasurements
+     * 
      * @warning When reaching the end of a frame, it is mandatory to reset the encapsulated dataset extractor state, so that it starts from scratch on the next frame.
      *          Not doing so would mix datasets content accross two successive frames if we have unterminated datasets, which may happen in historical TIC streams
      */
     void onFrameComplete();
 
+    /**
+     * @brief Drop the frame being received, without publishing anything from it
+     * 
+     * This is invoked when bytes of the frame were lost (see TicProcessingContext::resyncUnframer()): the measurements collected so far are
+     * discarded, partial datasets are dropped, and the remaining bytes of the frame are ignored up to its end.
+     * The energy estimator is thus only fed by complete frames
+     */
+    void abortFrame();
+
     /**
      * @brief Method invoken when a new dataset has been extracted from the TIC stream
      * 
@@ -199,8 +289,15 @@ public:
      */
     void onDatasetExtracted(const uint8_t* buf, unsigned int cnt);
 
-    /* The 3 commodity functions below are used as callbacks to retrieve a TicFrameParser casted as a context */
-    /* They are retrieving our instance on TicFrameParser, and invoking the 3 above corresponding methods of TicFrameParser, forwarding their arguments */
+    /**
+     * @brief Method invoked when a new dataset has been decoded on the fly from the TIC stream
+     * 
+     * @param dataset The decoded dataset
+     */
+    void onDatasetDecoded(const TicDatasetStreamDecoder::DecodedDataset& dataset);
+
+    /* The commodity functions below are used as callbacks to retrieve a TicFrameParser casted as a context */
+    /* They are retrieving our instance on TicFrameParser, and invoking the above corresponding methods of TicFrameParser, forwarding their arguments */
     /**
      * @brief Utility function to unwrap a TicFrameParser instance and invoke onNewFrameBytes() on it
      * It is used as a callback provided to TIC::Unframer
@@ -227,9 +324,18 @@ public:
      */
     static void ticFrameParserUnWrapDatasetExtractor(const uint8_t* buf, unsigned int cnt, void* context);
 
+    /**
+     * @brief Utility function to unwrap a TicFrameParser instance and invoke onDatasetDecoded() on it
+     * It is used as a callback provided to TicDatasetStreamDecoder
+     * 
+     * @param dataset The decoded dataset
+     * @param context A context as provided by TicDatasetStreamDecoder, used to retrieve the wrapped TicFrameParser instance
+     */
+    static void unwrapInvokeOnDatasetDecoded(const TicDatasetStreamDecoder::DecodedDataset& dataset, void* context);
+
 /* Attributes */
-    FOnNewPowerDataFunc onNewPowerData; /*!< Pointer to a function invoked at each new power data (withdrawn or injected) computed from a TIC frame */
-    void* onNewPowerDataContext; /*!< A context pointer passed to onNewFrameBytes() and onFrameComplete() at invokation */
+    FOnNewFrameMeasurementsFunc onNewFrameMeasurements; /*!< Pointer to a function invoked once per complete TIC frame, with the frame's measurements */
+    void* onNewFrameMeasurementsContext; /*!< A context pointer passed as argument to the above method */
     FOnDayOverFunc onDayOverFunc; /*!< Pointer to a function invoked when we detect switching to the next day */
     void* onDayOverFuncContext; /*!< A context pointer passed as argument to the above method */
     FOnDatasetErrorFunc onDatasetErrorFunc; /*!< Pointer to a function invoked when we detect an error in a dataset */
@@ -238,8 +344,18 @@ public:
     void* currentTimeGetterFuncContext; /*!< A context pointer passed as argument to the above method */
     unsigned int nbFramesParsed; /*!< Total number of complete frames parsed */
     TIC::DatasetExtractor de;   /*!< The encapsulated dataset extractor instance (programmed to call us back on newly decoded datasets) */
-    TicMeasurements lastFrameMeasurements;    /*!< Gathers all interesting measurement of the last frame */
+    TicDatasetStreamDecoder sd;   /*!< The encapsulated streaming dataset decoder (programmed to call us back on newly decoded datasets) */
+    bool streamingDecoding; /*!< Are frame bytes decoded by sd (true) or by de (false)? */
+    TicMeasurements currentFrameMeasurements;    /*!< Gathers all interesting measurements of the frame being received */
+    TicMeasurements lastFrameMeasurements;    /*!< The measurements of the last complete frame, unchanged until the next frame is complete */
     uint32_t lastKnownMaxPower; /*!< The last max power known from the content of a TIC frame (or 0 if unknown) */
+    bool powerKnownForCurrentFrame; /*!< Has the power already been computed (and published) for the current frame? */
+    bool mayInject; /*!< Is the withdrawn power 0 in the current frame (we may then be injecting)? */
+    EnergyDeltaEstimator energyEstimator; /*!< Narrows approximated power ranges using the variations of energy indices across frames */
+    unsigned int datasetsInFrame; /*!< How many datasets (valid or not) have been received in the current frame */
+    bool inFrame; /*!< Have bytes of the current frame been received (since the end of the previous frame)? */
+    bool frameAborted; /*!< Was the current frame aborted (its remaining bytes are then ignored up to its end)? */
+    DatasetErrorStats errorStats; /*!< Statistics on datasets that failed to decode */
 };
 
 #ifdef __UNIT_TEST__
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <stdint.h>
+
+#include "TIC/DatasetView.h"
+#include "TicLabelTable.h"
+
+/* Forward declarations */
+class TicFrameRecord;
+namespace std {
+     void swap(TicFrameRecord& first, TicFrameRecord& second);
+}
+
+/**
+ * @brief Fixed-layout record of the values of all labels received in one TIC frame
+ *
+ * There is one slot per TicLabelTable::Label, and a presence bitmask tells which slots have been filled since the last reset().
+ * Slots are never cleared, so reset() only clears the bitmask and swapWith() moves a fixed amount of memory, whatever the frame content.
+ *
+ * Most labels carry a decimal value, stored as a uint32_t. STGE is stored as a uint32_t too (it is hexadecimal).
+ * ADSC, PRM, NGTF and LTARF are stored as text.
+ * DATE is not stored (see TicMeasurements::timestamp), neither are the long text labels MSG1, MSG2, PJOURF+1 and PPOINTE.
+ * For horodated labels (SMAXSN, CCASN, DPM1...), only the value is stored, not the horodate.
+ */
+class TicFrameRecord {
+public:
+/* Types */
+    typedef enum {
+        NotStored,  /*!< The label is recognized, but its value is not kept */
+        Decimal,    /*!< The value is an unsigned decimal number */
+        Hexadecimal,    /*!< The value is an unsigned hexadecimal number */
+        Text,   /*!< The value is kept as text */
+    } ValueKind;
+
+    static constexpr std::size_t MaxTextSize = 16; /*!< The longest text value we store (NGTF and LTARF) */
+    static constexpr std::size_t TextSlotCount = 4; /*!< The number of labels stored as text */
+    static constexpr std::size_t PresenceWordCount = (TicLabelTable::LabelCount + 31) / 32; /*!< The number of 32-bit words in the presence bitmask */
+
+/* Methods */
+    TicFrameRecord();
+
+    /**
+     * @brief Forget all values (constant-time, only the presence bitmask is cleared)
+     */
+    void reset();
+
+    void swapWith(TicFrameRecord& other);
+
+    friend void ::std::swap(TicFrameRecord& first, TicFrameRecord& second);
+
+    /**
+     * @brief Has a value been stored for a label since the last reset()?
+     */
+    bool has(TicLabelTable::Label label) const;
+
+    /**
+     * @brief Get the number of labels for which a value is stored
+     */
+    unsigned int getCount() const;
+
+    /**
+     * @brief Get the numeric value of a label
+     *
+     * @param label The label to read
+     * @return The value, or (uint32_t)-1 if the label is absent or not numeric
+     */
+    uint32_t getValue(TicLabelTable::Label label) const;
+
+    /**
+     * @brief Get the text value of a label
+     *
+     * @param label The label to read
+     * @return The '\0'-terminated value, or nullptr if the label is absent or not stored as text
+     */
+    const char* getText(TicLabelTable::Label label) const;
+
+    /**
+     * @brief Store the numeric value of a label
+     *
+     * @return false if @p label does not hold a numeric value
+     */
+    bool setValue(TicLabelTable::Label label, uint32_t value);
+
+    /**
+     * @brief Store the text value of a label
+     *
+     * @param label The label to write
+     * @param text The value characters (not '\0'-terminated)
+     * @param len The number of characters in @p text
+     * @return false if @p label is not stored as text, or if @p text is longer than MaxTextSize
+     */
+    bool setText(TicLabelTable::Label label, const uint8_t* text, std::size_t len);
+
+    /**
+     * @brief Store the value carried by a valid dataset
+     *
+     * @param label The label of the dataset, as found by TicLabelTable::lookup()
+     * @param dv The decoded dataset
+     * @return true if the value has been stored, false if it is malformed or not stored for this label
+     */
+    bool store(TicLabelTable::Label label, const TIC::DatasetView& dv);
+
+    /**
+     * @brief Get how the value of a label is stored
+     */
+    static ValueKind getValueKind(TicLabelTable::Label label);
+
+private:
+    /**
+     * @brief Get the text slot used by a label stored as text
+     *
+     * @return The index in texts, or TextSlotCount if the label is not stored as text
+     */
+    static std::size_t getTextSlot(TicLabelTable::Label label);
+
+    void markPresent(TicLabelTable::Label label);
+
+/* Attributes */
+    uint32_t presence[PresenceWordCount]; /*!< One bit per TicLabelTable::Label, set when the corresponding value is stored */
+    uint32_t values[TicLabelTable::LabelCount]; /*!< The numeric values, indexed by TicLabelTable::Label (only meaningful if the presence bit is set) */
+    char texts[TextSlotCount][MaxTextSize + 1]; /*!< The '\0'-terminated text values (only meaningful if the presence bit is set) */
+};
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstddef>
+#include <stdint.h>
+
+/**
+ * @brief Compile-time perfect hash table of the TIC dataset labels we handle
+ *
+ * Each known label hashes (FNV-1a) to its own bucket, this is checked at compile time, so a lookup costs one hash and at most one comparison:
+ * a label falling into an empty bucket is rejected without any comparison, and a label falling into a used bucket is compared to the only candidate.
+ *
+ * All labels of the standard and historical TICs are known, so that datasets (and errors on them) can be attributed to their label.
+ * To handle a new label, add it to the Label enum (before LabelCount) and to the definitions table in TicLabelTable.cpp.
+ * If the build then fails on a bucket collision, search for another HashSeed by trying successive values (or increase BucketCount).
+ */
+class TicLabelTable {
+public:
+/* Types */
+    typedef enum : uint8_t {
+        Unknown = 0,    /*!< Not a label we handle */
+        /* Standard TIC labels, in the order they appear in frames */
+        ADSC,   /*!< Secondary address of the meter */
+        VTIC,   /*!< Version of the TIC */
+        DATE,   /*!< Date and time of the frame */
+        NGTF,   /*!< Name of the supplier's tariff calendar */
+        LTARF,  /*!< Label of the current tariff */
+        EAST,   /*!< Total withdrawn active energy, in Wh */
+        EASF01, /*!< Withdrawn active energy on supplier index 01, in Wh */
+        EASF02, /*!< Withdrawn active energy on supplier index 02, in Wh */
+        EASF03, /*!< Withdrawn active energy on supplier index 03, in Wh */
+        EASF04, /*!< Withdrawn active energy on supplier index 04, in Wh */
+        EASF05, /*!< Withdrawn active energy on supplier index 05, in Wh */
+        EASF06, /*!< Withdrawn active energy on supplier index 06, in Wh */
+        EASF07, /*!< Withdrawn active energy on supplier index 07, in Wh */
+        EASF08, /*!< Withdrawn active energy on supplier index 08, in Wh */
+        EASF09, /*!< Withdrawn active energy on supplier index 09, in Wh */
+        EASF10, /*!< Withdrawn active energy on supplier index 10, in Wh */
+        EASD01, /*!< Withdrawn active energy on distributor index 01, in Wh */
+        EASD02, /*!< Withdrawn active energy on distributor index 02, in Wh */
+        EASD03, /*!< Withdrawn active energy on distributor index 03, in Wh */
+        EASD04, /*!< Withdrawn active energy on distributor index 04, in Wh */
+        EAIT,   /*!< Total injected active energy, in Wh */
+        ERQ1,   /*!< Total reactive energy Q1, in VArh */
+        ERQ2,   /*!< Total reactive energy Q2, in VArh */
+        ERQ3,   /*!< Total reactive energy Q3, in VArh */
+        ERQ4,   /*!< Total reactive energy Q4, in VArh */
+        IRMS1,  /*!< RMS current on phase 1, in A */
+        IRMS2,  /*!< RMS current on phase 2, in A */
+        IRMS3,  /*!< RMS current on phase 3, in A */
+        URMS1,  /*!< RMS voltage on phase 1, in V */
+        URMS2,  /*!< RMS voltage on phase 2, in V */
+        URMS3,  /*!< RMS voltage on phase 3, in V */
+        PREF,   /*!< Reference (subscribed) apparent power, in kVA */
+        PCOUP,  /*!< Apparent power cut-off threshold, in kVA */
+        SINSTS, /*!< Instantaneous withdrawn apparent power, in VA */
+        SINSTS1,    /*!< Instantaneous withdrawn apparent power on phase 1, in VA */
+        SINSTS2,    /*!< Instantaneous withdrawn apparent power on phase 2, in VA */
+        SINSTS3,    /*!< Instantaneous withdrawn apparent power on phase 3, in VA */
+        SMAXSN, /*!< Maximum withdrawn apparent power of the day, in VA */
+        SMAXSN1,    /*!< Maximum withdrawn apparent power of the day on phase 1, in VA */
+        SMAXSN2,    /*!< Maximum withdrawn apparent power of the day on phase 2, in VA */
+        SMAXSN3,    /*!< Maximum withdrawn apparent power of the day on phase 3, in VA */
+        SMAXSN_M1,  /*!< SMAXSN-1: maximum withdrawn apparent power of the previous day, in VA */
+        SMAXSN1_M1, /*!< SMAXSN1-1: maximum withdrawn apparent power of the previous day on phase 1, in VA */
+        SMAXSN2_M1, /*!< SMAXSN2-1: maximum withdrawn apparent power of the previous day on phase 2, in VA */
+        SMAXSN3_M1, /*!< SMAXSN3-1: maximum withdrawn apparent power of the previous day on phase 3, in VA */
+        SINSTI, /*!< Instantaneous injected apparent power, in VA */
+        SMAXIN, /*!< Maximum injected apparent power of the day, in VA */
+        SMAXIN_M1,  /*!< SMAXIN-1: maximum injected apparent power of the previous day, in VA */
+        CCASN,  /*!< Withdrawn active load curve point, in W */
+        CCASN_M1,   /*!< CCASN-1: previous withdrawn active load curve point, in W */
+        CCAIN,  /*!< Injected active load curve point, in W */
+        CCAIN_M1,   /*!< CCAIN-1: previous injected active load curve point, in W */
+        UMOY1,  /*!< Average voltage on phase 1, in V */
+        UMOY2,  /*!< Average voltage on phase 2, in V */
+        UMOY3,  /*!< Average voltage on phase 3, in V */
+        STGE,   /*!< Status register (hexadecimal) */
+        DPM1,   /*!< Start of mobile peak period 1 */
+        FPM1,   /*!< End of mobile peak period 1 */
+        DPM2,   /*!< Start of mobile peak period 2 */
+        FPM2,   /*!< End of mobile peak period 2 */
+        DPM3,   /*!< Start of mobile peak period 3 */
+        FPM3,   /*!< End of mobile peak period 3 */
+        MSG1,   /*!< Short message */
+        MSG2,   /*!< Very short message */
+        PRM,    /*!< Delivery point reference */
+        RELAIS, /*!< Relays status */
+        NTARF,  /*!< Index of the current tariff */
+        NJOURF, /*!< Current day number in the supplier's calendar */
+        NJOURF_P1,  /*!< NJOURF+1: next day number in the supplier's calendar */
+        PJOURF_P1,  /*!< PJOURF+1: next day profile */
+        PPOINTE,    /*!< Next peak day profile */
+        /* Historical TIC labels */
+        PAPP,   /*!< Instantaneous withdrawn apparent power, in VA */
+        PMAX,   /*!< Maximum withdrawn power of the day, in W (on some meters) */
+        BASE,   /*!< Withdrawn energy index of the BASE tariff option, in Wh */
+        HCHC,   /*!< Withdrawn energy index during off-peak hours, in Wh */
+        HCHP,   /*!< Withdrawn energy index during peak hours, in Wh */
+        ADCO,   /*!< Address of the meter */
+        OPTARIF,    /*!< Chosen tariff option */
+        ISOUSC, /*!< Subscribed current, in A */
+        EJPHN,  /*!< Withdrawn energy index of the EJP option during normal hours, in Wh */
+        EJPHPM, /*!< Withdrawn energy index of the EJP option during mobile peak hours, in Wh */
+        BBRHCJB,    /*!< Withdrawn energy index of the Tempo option during off-peak hours of blue days, in Wh */
+        BBRHPJB,    /*!< Withdrawn energy index of the Tempo option during peak hours of blue days, in Wh */
+        BBRHCJW,    /*!< Withdrawn energy index of the Tempo option during off-peak hours of white days, in Wh */
+        BBRHPJW,    /*!< Withdrawn energy index of the Tempo option during peak hours of white days, in Wh */
+        BBRHCJR,    /*!< Withdrawn energy index of the Tempo option during off-peak hours of red days, in Wh */
+        BBRHPJR,    /*!< Withdrawn energy index of the Tempo option during peak hours of red days, in Wh */
+        PEJP,   /*!< Notice before the start of an EJP period, in minutes */
+        PTEC,   /*!< Current tariff period */
+        DEMAIN, /*!< Color of the next day (Tempo option) */
+        IINST,  /*!< Instantaneous current, in A */
+        IINST1, /*!< Instantaneous current on phase 1, in A */
+        IINST2, /*!< Instantaneous current on phase 2, in A */
+        IINST3, /*!< Instantaneous current on phase 3, in A */
+        ADPS,   /*!< Subscribed power exceeded warning, current in A */
+        IMAX,   /*!< Maximum current, in A */
+        IMAX1,  /*!< Maximum current on phase 1, in A */
+        IMAX2,  /*!< Maximum current on phase 2, in A */
+        IMAX3,  /*!< Maximum current on phase 3, in A */
+        HHPHC,  /*!< Peak/off-peak hours schedule */
+        MOTDETAT,   /*!< Meter status word */
+        PPOT,   /*!< Presence of voltages on phases */
+        ADIR1,  /*!< Current overrun warning on phase 1, in A */
+        ADIR2,  /*!< Current overrun warning on phase 2, in A */
+        ADIR3,  /*!< Current overrun warning on phase 3, in A */
+        LabelCount  /*!< Not a label, the number of entries in this enum */
+    } Label;
+
+    static constexpr std::size_t BucketCount = 512; /*!< The number of buckets of the hash table (a power of 2) */
+    static constexpr uint32_t HashSeed = 2166222635U; /*!< The initial value of the hash, the first value above the FNV-1a offset basis giving one bucket per label */
+    static constexpr std::size_t MaxLabelSize = 9; /*!< The longest TIC label (anything longer is rejected without hashing) */
+
+/* Methods */
+    /**
+     * @brief Find the label matching some bytes
+     *
+     * @param label The label bytes (not '\0'-terminated)
+     * @param len The number of bytes in @p label
+     * @return The matching label, or Unknown
+     */
+    static Label lookup(const uint8_t* label, std::size_t len);
+
+    /**
+     * @brief Get the text of a label
+     *
+     * @return The '\0'-terminated label, or an empty string for Unknown
+     */
+    static const char* getName(Label label);
+
+    /**
+     * @brief Get the bucket a label falls into
+     *
+     * @param label The label characters
+     * @param len The number of characters in @p label
+     *
+     * @note This is constexpr so that the table can be built and checked at compile time
+     */
+    template <typename CharType>
+    static constexpr std::size_t getBucket(const CharType* label, std::size_t len);
+
+private:
+    /**
+     * @brief FNV-1a hash of a label
+     */
+    template <typename CharType>
+    static constexpr uint32_t hash(const CharType* label, std::size_t len);
+};
+
+template <typename CharType>
+constexpr uint32_t TicLabelTable::hash(const CharType* label, std::size_t len) {
+    uint32_t value = HashSeed;
+    for (std::size_t pos = 0; pos < len; pos++) {
+        value = (value ^ static_cast<uint8_t>(label[pos])) * 16777619U;
+    }
+    return value;
+}
+
+template <typename CharType>
+constexpr std::size_t TicLabelTable::getBucket(const CharType* label, std::size_t len) {
+    uint32_t value = hash(label, len);
+    return (value ^ (value >> 15)) & (BucketCount - 1);  /* Fold the high bits, the low bits of FNV-1a are not well mixed */
+}
@@ -3,11 +3,21 @@
 #include "TIC/Unframer.h"
 #include "TicFrameParser.h" // For TicEvaluatedPower
 #include "TimeOfDay.h"
+#include "SerialSource.h"
+#include "TicBaudRateDetector.h"
 #ifndef __UNIT_TEST__
 #include "../hal/Stm32SerialDriver.h"
 #else
-struct Stm32SerialDriver {
+/**
+ * @brief Placeholder for the target serial driver in unit tests, a source that never receives anything
+ */
+struct Stm32SerialDriver : public SerialSource {
     Stm32SerialDriver() {}
+    std::size_t read(uint8_t* buffer, std::size_t maxLen) override { return 0; }
+    unsigned int peek(RxRegion (&regions)[2]) override { regions[0] = regions[1] = RxRegion{nullptr, 0}; return 0; }
+    void commit(std::size_t len) override {}
+    unsigned int getRxOverflowCount(bool reset = false) override { return 0; }
+    unsigned long getRxBytesTotal() const override { return 0; }
 };
 #endif
 #include <stdint.h>
@@ -32,13 +42,36 @@ struct TicProcessingContext {
      * @param ticSerial The serial byte receive instance
      * @param ticUnframer A TIC frame delimiter instance
      */
-    TicProcessingContext(Stm32SerialDriver& ticSerial, TIC::Unframer& ticUnframer);
+    TicProcessingContext(SerialSource& ticSerial, TIC::Unframer& ticUnframer);
+
+    /**
+     * @brief Forward all bytes currently received on the TIC serial link to the unframer
+     * 
+     * Bytes are processed in place (see SerialSource::peek()), and only those accepted by the unframer are consumed from the serial source.
+     * Lost bytes (either on the serial source or refused by the unframer) are accounted for in lostTicBytes and serialRxOverflowCount
+     * When the serial source reports a gap (lost bytes) at the current read position, the unframer is resynchronized first (see resyncUnframer())
+     * If a baudRateDetector is set, consumed bytes and line errors reported by the serial source are also forwarded to it
+     * 
+     * @return The number of bytes consumed from the serial source
+     */
+    std::size_t forwardSerialRxBytesToUnframer();
+
+    /**
+     * @brief Drop the frame currently being received, after bytes were lost on the serial link
+     * 
+     * The frame parser (if set in ticParser) aborts the frame (see TicFrameParser::abortFrame()), so that the missing bytes only cost the frame they belong to,
+     * instead of producing datasets that mix bytes from before and after the loss, or publishing a partial frame
+     */
+    void resyncUnframer();
 
 /* Attributes */
-    Stm32SerialDriver& ticSerial; /*!< The encapsulated TIC serial bytes receive handler */
+    SerialSource& ticSerial; /*!< The encapsulated TIC serial bytes receive handler */
     TIC::Unframer& ticUnframer;   /*!< The encapsulated TIC frame delimiter handler */
+    TicBaudRateDetector* baudRateDetector; /*!< An optional baudrate detector fed with all bytes received (or nullptr) */
+    TicFrameParser* ticParser; /*!< The optional frame parser fed by ticUnframer, that aborts its frame on resyncUnframer() (or nullptr) */
     unsigned int lostTicBytes;    /*!< How many TIC bytes were lost due to forwarding queue overflow? */
-    unsigned int serialRxOverflowCount;  /*!< How many times we didnot read fast enough the serial buffer and bytes where thus lost due to incoming serial buffer overflow */
+    unsigned int serialRxOverflowCount;  /*!< How many incoming bytes were lost because we did not read the serial reception buffer fast enough */
+    unsigned int unframerResyncCount;   /*!< How many times the unframer was resynchronized because of lost bytes */
     unsigned int datasetsWithErrors; /*!< How many times did we fail to decode a dataset due to format errors */
     TicEvaluatedPower instantaneousPower;    /*!< A place to store the instantaneous power measurement */
     unsigned int lastParsedFrameNb; /*!< The ID of the last received TIC frame */
@@ -17,6 +17,7 @@
 
 extern "C" {
 DSI_HandleTypeDef* get_hdsi(void); // C-linkage exported getter for hdsi handler
+DMA2D_HandleTypeDef* get_hdma2d(void); // C-linkage exported getter for hdma2d handler
 void HAL_DSI_EndOfRefreshCallback(DSI_HandleTypeDef *hdsi);
 }
 
@@ -34,7 +35,7 @@ public:
         SwitchToDraftIsPending = 0,
         DisplayingDraft,
         CopyingDraftToFinalIsPending,
-        CopyDraftToFinalIsDone, /* Unused, would be nice not to poll on DMA2D while copying */
+        CopyDraftToFinalIsDone, /* Only used by startCopyDraftToFinal(), copyDraftToFinal() polls on DMA2D */
         SwitchToFinalIsPending,
         DisplayingFinal
     } LCD_Display_Update_State;
@@ -55,7 +56,13 @@ public:
         None = static_cast<uint32_t>(0x00ffffff)
     } LCD_Color;
 
+    typedef enum {
+        EndOfRefresh = 0, /*!< The DSI host completed a refresh of the LCD */
+        Dma2dTransferComplete, /*!< A DMA2D transfer started by startCopyDraftToFinal() is over */
+    } DisplayEvent;
+
     typedef void(*FWaitForDisplayRefreshFunc)(void* context);
+    typedef void(*FOnDisplayEventFunc)(DisplayEvent event, void* context); /*!< The prototype of callbacks invoked (in interrupt context) on display events */
 
     /**
      * @brief Singleton instance getter
@@ -86,6 +93,39 @@ public:
 
     void copyDraftToFinal();
 
+    /**
+     * @brief Start copying the draft framebuffer to the final framebuffer in interrupt mode, and return immediately
+     * 
+     * @note The end of the copy is reported by isCopyDraftToFinalDone() and by a Dma2dTransferComplete display event
+     *       No other drawing should be done until the copy is over
+     */
+    void startCopyDraftToFinal();
+
+    /**
+     * @brief Is the LCD displaying the draft framebuffer?
+     */
+    bool isDraftDisplayed() const;
+
+    /**
+     * @brief Is the LCD displaying the final framebuffer?
+     */
+    bool isFinalDisplayed() const;
+
+    /**
+     * @brief Is the copy started by startCopyDraftToFinal() over?
+     */
+    bool isCopyDraftToFinalDone() const;
+
+    /**
+     * @brief Select a function to invoke on display events (end of refresh, end of a DMA2D transfer)
+     * 
+     * @param onDisplayEvent The function to invoke
+     * @param context An optional argument to provide to function onDisplayEvent()
+     * 
+     * @warning The function provided as argument will be run in interruption context
+     */
+    void setOnDisplayEvent(FOnDisplayEventFunc onDisplayEvent = nullptr, void* context = nullptr);
+
     uint16_t getWidth() const;
 
     uint16_t getHeight() const;
@@ -163,7 +203,8 @@ public:
     friend void HAL_DSI_EndOfRefreshCallback(DSI_HandleTypeDef *hdsi); /* This interrupt hanlder accesses our display state */
 
 private:
-    void hdma2dCopyFramebuffer(const void* src, void* dst, uint16_t x, uint16_t y, uint16_t xsize, uint16_t ysize);
+    void hdma2dCopyFramebuffer(const void* src, void* dst, uint16_t x, uint16_t y, uint16_t xsize, uint16_t ysize, bool inInterruptMode = false);
+    static void onDma2dTransferOver(DMA2D_HandleTypeDef* hdma2d); /* DMA2D completion (or error) callback in interrupt mode */
     void LL_FillBuffer(uint32_t LayerIndex, void *pDst, uint32_t xSize, uint32_t ySize, uint32_t OffLine, uint32_t ColorIndex);
 
 private:
@@ -177,6 +218,8 @@ private:
     volatile LCD_Display_Update_State displayState;  /*!< Used to keep track of state transitions between buffers on LCD driver */
     static void* const draftFramebuffer;    /*!< A pointer to the beginning of the draft frambuffer */
     static void* const finalFramebuffer;    /*!< A pointer to the beginning of the final frambuffer */
+    FOnDisplayEventFunc onDisplayEvent; /*!< An optional function invoked on display events */
+    void* onDisplayEventContext;    /*!< A context pointer passed to onDisplayEvent() */
 
 public:
     LTDC_HandleTypeDef& hltdc;  /*!< Handle on the LCD/TFT display controller (LTDC), it is unfortunately external to us, defined in stm32469i_discovery_lcd.c */
@@ -8,6 +8,13 @@
 #include "stm32f7xx_hal.h"
 #endif
 #include <cstdint>
+#include <atomic>
+#include "DmaRxRing.h"
+#include "SpscByteRing.h"
+#include "SerialSource.h"
+#ifdef SERIAL_RX_STATS
+#include "SerialRxStats.h"
+#endif
 #ifdef USE_ALLOCATION
 #include <string>
 #endif
@@ -32,6 +39,13 @@
 #define USART6_RX_PIN                    GPIO_PIN_7
 #define USART6_RX_GPIO_PORT              GPIOC
 #define USART6_RX_AF                     GPIO_AF8_USART6
+/**
+ * USART6_RX is served by DMA2 Stream1 Channel5 (see DMA2 request mapping in the reference manual)
+ */
+#define USART6_RX_DMA_CLK_ENABLE()       __HAL_RCC_DMA2_CLK_ENABLE()
+#define USART6_RX_DMA_STREAM             DMA2_Stream1
+#define USART6_RX_DMA_CHANNEL            DMA_CHANNEL_5
+#define USART6_RX_DMA_IRQn               DMA2_Stream1_IRQn
 
 #define USART_TIC                        USART6
 #define USART_TIC_CLK_ENABLE()           USART6_CLK_ENABLE()
@@ -47,6 +61,10 @@
 #define USART_TIC_RX_GPIO_PORT           USART6_RX_GPIO_PORT
 #define USART_TIC_RX_AF                  USART6_RX_AF
 #define USART_TIC_IRQn                   USART6_IRQn
+#define USART_TIC_RX_DMA_CLK_ENABLE()    USART6_RX_DMA_CLK_ENABLE()
+#define USART_TIC_RX_DMA_STREAM          USART6_RX_DMA_STREAM
+#define USART_TIC_RX_DMA_CHANNEL         USART6_RX_DMA_CHANNEL
+#define USART_TIC_RX_DMA_IRQn            USART6_RX_DMA_IRQn
 #endif
 
 /* Definition for the USART forwarded to ST-Link's virtual com port */
@@ -122,13 +140,33 @@
 
 extern "C" {
 UART_HandleTypeDef* get_huart6(void);   // C-linkage exported getter for huart6 handler
+DMA_HandleTypeDef* get_hdma_usart6_rx(void);   // C-linkage exported getter for the DMA handler serving huart6 reception
 }
 
 /**
  * @brief Serial link communication class (singleton)
  */
-class Stm32SerialDriver {
+class Stm32SerialDriver : public SerialSource {
 public:
+/* Types */
+    typedef enum {
+        InterruptPerByte = 0, /*!< One interrupt per received byte (HAL_UART_Receive_IT() re-armed after each byte) */
+        CircularDma, /*!< The USART fills-in a circular DMA ring, we get one interrupt per burst (idle line) or per half ring */
+    } RxMode;
+
+    typedef enum {
+        DropNewest = 0, /*!< When the reception ring is full, incoming bytes are discarded */
+        DropOldest, /*!< When the reception ring is full, the oldest bytes not yet processed are discarded to make room for incoming bytes */
+    } RxOverflowPolicy;
+
+    typedef void(*FOnRxEventFunc)(bool idle, void* context); /*!< The prototype of callbacks invoked (in interrupt context) when new bytes are available, @p idle is true at the end of a burst */
+
+    static constexpr std::size_t DmaRxRingSize = 128; /*!< The size of the DMA reception ring used in CircularDma mode */
+    static constexpr std::size_t RxRingSize = 256; /*!< The size of the reception ring between interrupt context and read() or peek() */
+#ifdef SERIAL_RX_STATS
+    typedef SerialRxStats<8, 16> RxStats; /*!< Reception path statistics (overflow timestamps in ms, gaps and interrupt costs in CPU cycles) */
+#endif
+
     /**
      * @brief Singleton instance getter
      * 
@@ -140,8 +178,45 @@ public:
      * @brief Initialize the serial link and start receiving data from it
      * 
      * @param baudrate The baudrate to use on the serial port
+     * @param rxMode How received bytes are collected from the USART
      */
-    void start(uint32_t baudrate);
+    void start(uint32_t baudrate, RxMode rxMode = InterruptPerByte);
+
+    /**
+     * @brief Select what happens to received bytes when the reception ring is full
+     * 
+     * @param policy The overflow policy to apply
+     * 
+     * @warning This must be invoked before start()
+     */
+    void setRxOverflowPolicy(RxOverflowPolicy policy);
+
+    /**
+     * @brief Select a function to invoke each time new bytes have been stored in the reception ring
+     * 
+     * @param onRxEvent The function to invoke
+     * @param context An optional argument to provide to function onRxEvent()
+     * 
+     * @warning The function provided as argument will be run in interruption context, it should only signal the consumer (the bytes are to be collected using read() or peek())
+     */
+    void setOnRxEvent(FOnRxEventFunc onRxEvent = nullptr, void* context = nullptr);
+
+    /**
+     * @brief Change the baudrate of the serial link on the fly, keeping the current reception mode
+     * 
+     * The ongoing reception is aborted, the USART is reconfigured and reception is restarted.
+     * Bytes received at the previous baudrate and not read yet are discarded, and the DMA ring restarts from its first byte.
+     * 
+     * @param baudrate The new baudrate to use on the serial port
+     * 
+     * @note The consumer should resynchronize its decoding (see TicProcessingContext::resyncUnframer()), as the frame being received is cut
+     */
+    void setBaudRate(uint32_t baudrate);
+
+    /**
+     * @brief Get the baudrate currently configured on the serial port
+     */
+    uint32_t getBaudRate() const;
 
     /**
      * @brief Reset the reception buffer overflow counter
@@ -152,16 +227,50 @@ public:
      * @brief Get the reception buffer overflow count
      * 
      * @param reset Shall we reset the overflow flag once returned?
-     * @return The number of times the internal reception buffer overflowed since the last reset of this counter (incoming data bytes have been lost)
+     * @return The exact number of incoming data bytes lost because the internal reception buffer was full (whatever the overflow policy), since the last reset of this counter
      */
-    unsigned int getRxOverflowCount(bool reset = false);
+    unsigned int getRxOverflowCount(bool reset = false) override;
 
     /**
      * @brief Get the total number of received bytes on the serial port since the last reset
      * 
      * @return The number of received bytes
      */
-    unsigned long getRxBytesTotal() const;
+    unsigned long getRxBytesTotal() const override;
+
+    /**
+     * @brief Get the number of line errors (parity, framing or noise errors) reported by the USART
+     * 
+     * @param reset Shall we reset the counter once returned?
+     * @return The number of line errors since the last reset of this counter
+     */
+    unsigned int getRxLineErrorCount(bool reset = false) override;
+
+    /**
+     * @brief Account for a line error reported by the USART
+     * 
+     * This method is to be used as the callback for HAL reception errors
+     */
+    void onRxLineError();
+
+#ifdef SERIAL_RX_STATS
+    /**
+     * @brief Get a consistent copy of the reception path statistics
+     */
+    RxStats::Snapshot getRxStats() const;
+
+    /**
+     * @brief Clear the reception path statistics
+     */
+    void resetRxStats();
+
+    /**
+     * @brief Account for the time spent in a reception interrupt handler
+     * 
+     * @param cycles The number of CPU cycles spent in the handler
+     */
+    void onRxIsrCost(uint32_t cycles);
+#endif
 
     /**
      * @brief Write the human-readable hexadecimal value of a data byte to the serial link (formatted as ASCII)
@@ -195,6 +304,26 @@ public:
      */
     void pushReceivedByte(uint8_t incomingByte);
 
+    /**
+     * @brief Receive a burst of data bytes from the serial link
+     * 
+     * This method is to be used as the callback for new data bursts collected by DMA on the serial link
+     * 
+     * @param buffer The new data bytes
+     * @param len The number of bytes in @p buffer
+     */
+    void pushReceivedBytes(const uint8_t* buffer, std::size_t len);
+
+    /**
+     * @brief Process a reception event raised by the DMA in CircularDma mode
+     * 
+     * This method is to be used as the callback for HAL reception events (half-transfer, transfer complete, idle line)
+     * 
+     * @param event The event raised
+     * @param writePos The current DMA write position in the reception ring
+     */
+    void onDmaRxEvent(DmaRxRing<DmaRxRingSize>::Event event, std::size_t writePos);
+
     /**
      * @brief Collect the new data bytes read from the serial link and store them in the caller's buffer
      * 
@@ -203,7 +332,31 @@ public:
      * 
      * @return The number of bytes actually copied to @p buffer (will be <= maxLen, can be 0 if no data was available)
      */
-    size_t read(uint8_t* buffer, size_t maxLen);
+    size_t read(uint8_t* buffer, size_t maxLen) override;
+
+    /**
+     * @brief Get the received bytes in place, inside the internal reception buffer, without consuming them
+     * 
+     * This is a zero-copy alternative to read(). Bytes returned here must be released using commit() once processed.
+     * 
+     * @param[out] regions The (at most two) contiguous regions of received bytes, in reception order
+     * @return The number of non-empty regions in @p regions (0 if no data was available)
+     */
+    unsigned int peek(RxRegion (&regions)[2]) override;
+
+    /**
+     * @brief Release bytes obtained using peek(), making room for new incoming bytes
+     * 
+     * @param len The number of bytes processed (counting from the first byte of the first region)
+     */
+    void commit(std::size_t len) override;
+
+    /**
+     * @brief Check if received bytes were lost (because of an overflow) right before the next byte returned by peek(), and acknowledge it
+     * 
+     * @return true if there is a gap in the received byte stream at the current read position
+     */
+    bool takeRxGap() override;
 
     /**
      * @brief Get the low-level serial link handler object
@@ -212,6 +365,13 @@ public:
      */
     friend UART_HandleTypeDef* getTicUartHandle();
 
+    /**
+     * @brief (Re-)arm the reception on the serial link, according to the configured reception mode
+     * 
+     * @note This is invoked at start, and from interrupt context whenever the HAL aborts the reception (on errors)
+     */
+    void startReception();
+
 private:
     Stm32SerialDriver& operator= (const Stm32SerialDriver&) { return *this; }
     Stm32SerialDriver(const Stm32SerialDriver&) {}
@@ -220,11 +380,19 @@ private:
     ~Stm32SerialDriver();
 
     static Stm32SerialDriver instance;    /*!< Lazy singleton instance */
-    unsigned char serialRxBuffer[256];    /*!< Internal serial reception buffer */
-    unsigned int serialRxBufferLen;   /*!< Length of valid data bytes in the above buffer */
-    unsigned int serialRxBufferOverflowCount;  /*!< How many times the serial reception buffer overflowed since last reset */
-    unsigned long serialRxBytesTotal;   /*!< How many bytes were received since last reset? */
+    SpscByteRing<RxRingSize> serialRxRing;    /*!< Internal serial reception ring (filled-in from interrupt context, emptied by read() or commit()) */
+    std::atomic<unsigned int> serialRxBufferOverflowCount;  /*!< How many received bytes were dropped because the reception ring was full, since last reset */
+    std::atomic<unsigned long> serialRxBytesTotal;   /*!< How many bytes were received since last reset? */
+    std::atomic<unsigned int> serialRxLineErrorCount;   /*!< How many line errors (parity, framing, noise) were reported by the USART since last reset */
+    RxMode rxMode;  /*!< How received bytes are collected from the USART */
+    RxOverflowPolicy rxOverflowPolicy;    /*!< What to drop when the reception ring is full */
+    DmaRxRing<DmaRxRingSize> dmaRxRing;  /*!< The ring filled-in by DMA when in CircularDma mode */
     UART_HandleTypeDef huart;  /*!< Internal STM32 low level UART handle */
+    FOnRxEventFunc onRxEvent;   /*!< An optional function invoked when new bytes are available */
+    void* onRxEventContext; /*!< A context pointer passed to onRxEvent() */
+#ifdef SERIAL_RX_STATS
+    RxStats rxStats;    /*!< Reception path statistics, updated from interrupt context */
+#endif
 };
 
 #endif // _STM32SERIALDRIVER_H_
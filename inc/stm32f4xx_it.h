@@ -41,6 +41,7 @@ void PendSV_Handler(void);
 void SysTick_Handler(void);
 void LTDC_IRQHandler(void);
 void DSI_IRQHandler(void);
+void DMA2D_IRQHandler(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,64 @@
+#include "TraceLog.h"
+
+TraceLog::TraceLog() :
+    ring(),
+    droppedCount(0),
+    reportedDroppedCount(0)
+{
+}
+
+TraceLog& TraceLog::get() {
+    return TraceLog::instance;
+}
+
+std::size_t TraceLog::getRecordSize(const SpscByteRing<Capacity>::Region (&regions)[2], std::size_t offset) {
+    std::size_t eventOffset = offset + 1; /* The event ID follows the marker, possibly in the second region */
+    uint8_t event = (eventOffset < regions[0].len) ? regions[0].buf[eventOffset] : regions[1].buf[eventOffset - regions[0].len];
+    return RecordHeaderSize + Trace::ArgCounts[event] * sizeof(uint32_t);
+}
+
+std::size_t TraceLog::drain(FOutputFunc output, void* context, std::size_t maxBytes) {
+    SpscByteRing<Capacity>::Region regions[2];
+    this->ring.peek(regions);
+    std::size_t available = regions[0].len + regions[1].len;
+
+    /* Only whole records are pushed to the ring, so walk them to stop at the end of the record in which maxBytes falls */
+    std::size_t toDrain = 0;
+    while (toDrain < maxBytes && toDrain < available) {
+        toDrain += getRecordSize(regions, toDrain);
+    }
+
+    std::size_t drained = 0;
+    for (const SpscByteRing<Capacity>::Region& region : regions) {
+        std::size_t len = (region.len < toDrain - drained) ? region.len : toDrain - drained;
+        if (len > 0) {
+            output(region.buf, len, context);
+            drained += len;
+        }
+    }
+    this->ring.commit(drained);
+
+    /* Report dropped records once all records logged before have been output (drops only occur when the ring is full) */
+    unsigned int droppedCount = this->droppedCount.load(std::memory_order_relaxed);
+    if (droppedCount != this->reportedDroppedCount && this->ring.isEmpty() && drained < maxBytes) {
+        uint32_t lostRecords = droppedCount - this->reportedDroppedCount;
+        uint8_t record[RecordHeaderSize + sizeof(uint32_t)];
+        record[0] = RecordMarker;
+        record[1] = Trace::TraceRecordsDropped;
+        memcpy(record + RecordHeaderSize, &lostRecords, sizeof(lostRecords));
+        output(record, sizeof(record), context);
+        drained += sizeof(record);
+        this->reportedDroppedCount = droppedCount;
+    }
+    return drained;
+}
+
+bool TraceLog::isEmpty() const {
+    return this->ring.isEmpty() && this->droppedCount.load(std::memory_order_relaxed) == this->reportedDroppedCount;
+}
+
+unsigned int TraceLog::getDroppedCount() const {
+    return this->droppedCount.load(std::memory_order_relaxed);
+}
+
+TraceLog TraceLog::instance;
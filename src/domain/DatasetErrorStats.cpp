@@ -0,0 +1,83 @@
+#include "DatasetErrorStats.h"
+
+#include <cstring> // For memset()
+
+TicLabelTable::Label DatasetErrorStats::Snapshot::getWorstLabel() const {
+    TicLabelTable::Label worst = TicLabelTable::Unknown;
+    unsigned int worstCount = 0;    /* Unattributed errors are not compared */
+    for (unsigned int label = TicLabelTable::Unknown + 1; label < TicLabelTable::LabelCount; label++) {
+        if (this->perLabel[label] > worstCount) {
+            worst = static_cast<TicLabelTable::Label>(label);
+            worstCount = this->perLabel[label];
+        }
+    }
+    return worst;
+}
+
+DatasetErrorStats::DatasetErrorStats(unsigned int burstThreshold, unsigned int burstWindowFrames) :
+    burstThreshold(burstThreshold > 0 ? burstThreshold : 1),
+    burstWindowFrames(burstWindowFrames == 0 ? 1 : (burstWindowFrames > MaxBurstWindowFrames ? MaxBurstWindowFrames : burstWindowFrames)),
+    stats(),
+    windowErrors(),
+    windowErrorCount(0)
+{
+    this->reset();
+}
+
+void DatasetErrorStats::reset() {
+    memset(&this->stats, 0, sizeof(this->stats));
+    memset(this->windowErrors, 0, sizeof(this->windowErrors));
+    this->windowErrorCount = 0;
+}
+
+bool DatasetErrorStats::onDatasetError(TicLabelTable::Label label, unsigned int positionInFrame) {
+    if (label >= TicLabelTable::LabelCount) {
+        label = TicLabelTable::Unknown;
+    }
+    this->stats.errorCount++;
+    this->stats.perLabel[label]++;
+    this->stats.perPosition[(positionInFrame < MaxPositions) ? positionInFrame : MaxPositions - 1]++;
+    this->windowErrors[this->stats.frameCount % this->burstWindowFrames]++;
+    this->windowErrorCount++;
+    if (this->stats.inBurst) {
+        this->stats.lastBurst.errorCount++;
+        return false;
+    }
+    if (this->windowErrorCount < this->burstThreshold) {
+        return false;
+    }
+    this->stats.inBurst = true;
+    this->stats.burstCount++;
+    this->stats.lastBurst.startFrame = this->stats.frameCount;
+    this->stats.lastBurst.endFrame = this->stats.frameCount;
+    this->stats.lastBurst.errorCount = this->windowErrorCount;
+    return true;
+}
+
+void DatasetErrorStats::onFrameComplete() {
+    if (this->windowErrors[this->stats.frameCount % this->burstWindowFrames] > 0) {
+        this->stats.framesWithErrors++;
+    }
+    this->stats.frameCount++;
+    if (this->stats.inBurst && this->windowErrorCount == 0) {   /* A whole window without errors */
+        this->stats.inBurst = false;
+        this->stats.lastBurst.endFrame = this->stats.frameCount;
+    }
+    /* Slide the window: forget the errors of the oldest frame, its slot is reused for the next frame */
+    unsigned int& nextFrameErrors = this->windowErrors[this->stats.frameCount % this->burstWindowFrames];
+    this->windowErrorCount -= nextFrameErrors;
+    nextFrameErrors = 0;
+}
+
+DatasetErrorStats::Snapshot DatasetErrorStats::getSnapshot() const {
+    return this->stats;
+}
+
+TicLabelTable::Label DatasetErrorStats::findLabel(const uint8_t* buf, std::size_t len) {
+    for (std::size_t pos = 0; pos < len && pos <= TicLabelTable::MaxLabelSize; pos++) {
+        if (buf[pos] == '\t' || buf[pos] == ' ') {
+            return TicLabelTable::lookup(buf, pos);
+        }
+    }
+    return TicLabelTable::Unknown;   /* No separator where one was expected */
+}
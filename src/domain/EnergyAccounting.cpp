@@ -0,0 +1,118 @@
+#include "EnergyAccounting.h"
+
+namespace {
+constexpr uint32_t MsPerDay = 24UL * 3600UL * 1000UL;
+constexpr uint64_t WattMsPerWh = 3600ULL * 1000ULL;
+
+/**
+ * @brief Get the positive part of a power
+ */
+uint64_t positivePart(int power) {
+    return (power > 0) ? static_cast<uint64_t>(power) : 0;
+}
+
+/**
+ * @brief Get the positive part of the opposite of a power
+ */
+uint64_t negativePart(int power) {
+    return (power < 0) ? static_cast<uint64_t>(-static_cast<int64_t>(power)) : 0;
+}
+} // namespace
+
+EnergyAccounting::EnergyRange::EnergyRange() :
+    minWattMs(0),
+    maxWattMs(0)
+{
+}
+
+uint32_t EnergyAccounting::EnergyRange::getMinWh() const {
+    return static_cast<uint32_t>(this->minWattMs / WattMsPerWh);
+}
+
+uint32_t EnergyAccounting::EnergyRange::getMaxWh() const {
+    return static_cast<uint32_t>((this->maxWattMs + WattMsPerWh - 1) / WattMsPerWh);
+}
+
+EnergyAccounting::EnergyAccounting(unsigned int maxIntervalSeconds) :
+    maxIntervalMs(maxIntervalSeconds * 1000U),
+    lastPower(),
+    lastTimeMs(0),
+    skippedIntervals(0),
+    today(),
+    hours(),
+    pastDays()
+{
+}
+
+void EnergyAccounting::reset() {
+    this->lastPower = TicEvaluatedPower();
+    this->lastTimeMs = 0;
+    this->skippedIntervals = 0;
+    this->today = EnergyTotals();
+    for (unsigned int hour = 0; hour < HoursPerDay; hour++) {
+        this->hours[hour] = EnergyTotals();
+    }
+    this->pastDays.reset();
+}
+
+void EnergyAccounting::integrate(EnergyTotals& totals, const TicEvaluatedPower& power, uint32_t durationMs) {
+    /* Withdrawn energy is the positive part of the power, injected energy the negative part, each bound of the power range giving a bound of the energy */
+    totals.withdrawn.minWattMs += positivePart(power.minValue) * durationMs;
+    totals.withdrawn.maxWattMs += positivePart(power.maxValue) * durationMs;
+    totals.injected.minWattMs += negativePart(power.maxValue) * durationMs;
+    totals.injected.maxWattMs += negativePart(power.minValue) * durationMs;
+}
+
+void EnergyAccounting::onNewPowerData(const TicEvaluatedPower& power, const TimeOfDay& timestamp) {
+    if (!power.isValid || !timestamp.isValid || timestamp.hour >= HoursPerDay) {
+        return;
+    }
+    uint32_t timeMs = timestamp.toSeconds() * 1000U;
+    if (timestamp.knownMilliseconds) {
+        timeMs += timestamp.millisecond;
+    }
+    if (this->lastPower.isValid) {
+        uint32_t intervalMs = (timeMs + MsPerDay - this->lastTimeMs) % MsPerDay;  /* Across midnight as well */
+        if (intervalMs > this->maxIntervalMs) { /* Missing frames, or time going backwards */
+            this->skippedIntervals++;
+        }
+        else {
+            integrate(this->today, this->lastPower, intervalMs);
+            integrate(this->hours[timestamp.hour], this->lastPower, intervalMs);
+        }
+    }
+    this->lastPower = power;
+    this->lastTimeMs = timeMs;
+}
+
+void EnergyAccounting::onDayOver() {
+    this->pastDays.push(this->today);
+    this->today = EnergyTotals();
+    for (unsigned int hour = 0; hour < HoursPerDay; hour++) {
+        this->hours[hour] = EnergyTotals();
+    }
+}
+
+const EnergyAccounting::EnergyTotals& EnergyAccounting::getToday() const {
+    return this->today;
+}
+
+const EnergyAccounting::EnergyTotals& EnergyAccounting::getHour(unsigned int hour) const {
+    static const EnergyTotals NoTotals; /* Returned for out of range hours */
+    if (hour >= HoursPerDay) {
+        return NoTotals;
+    }
+    return this->hours[hour];
+}
+
+bool EnergyAccounting::getPastDay(unsigned int daysAgo, EnergyTotals& result) const {
+    if (daysAgo == 0 || daysAgo > this->pastDays.getCount()) {
+        return false;
+    }
+    result = this->pastDays.getReverse(daysAgo - 1);
+    return true;
+}
+
+std::size_t EnergyAccounting::getPastDayCount() const {
+    return this->pastDays.getCount();
+}
@@ -0,0 +1,137 @@
+#include "EnergyDeltaEstimator.h"
+#include "TicFrameParser.h" // For TicEvaluatedPower
+
+namespace {
+constexpr uint32_t MsPerDay = 24UL * 3600UL * 1000UL;
+constexpr int64_t MsWattPerWh = 3600LL * 1000LL; /* 1Wh over 1ms is 3600000W */
+
+int64_t floorDiv(int64_t numerator, int64_t denominator) {
+    int64_t quotient = numerator / denominator;
+    if ((numerator % denominator != 0) && (numerator < 0)) {
+        quotient--;
+    }
+    return quotient;
+}
+
+int64_t ceilDiv(int64_t numerator, int64_t denominator) {
+    int64_t quotient = numerator / denominator;
+    if ((numerator % denominator != 0) && (numerator > 0)) {
+        quotient++;
+    }
+    return quotient;
+}
+} // namespace
+
+EnergyDeltaEstimator::Sample::Sample() :
+    timeMs(0),
+    preciseTime(false),
+    withdrawnIndex(0),
+    injectedIndex(0)
+{
+}
+
+EnergyDeltaEstimator::Sample::Sample(uint32_t timeMs, bool preciseTime, uint32_t withdrawnIndex, uint32_t injectedIndex) :
+    timeMs(timeMs),
+    preciseTime(preciseTime),
+    withdrawnIndex(withdrawnIndex),
+    injectedIndex(injectedIndex)
+{
+}
+
+EnergyDeltaEstimator::EnergyDeltaEstimator(unsigned int maxWindowSeconds) :
+    maxWindowMs(maxWindowSeconds * 1000U),
+    samples()
+{
+}
+
+void EnergyDeltaEstimator::reset() {
+    this->samples.reset();
+}
+
+bool EnergyDeltaEstimator::toSampleTime(const TimeOfDay& timestamp, Sample& sample) {
+    if (!timestamp.isValid) {
+        return false;
+    }
+    sample.timeMs = timestamp.toSeconds() * 1000U;
+    sample.preciseTime = timestamp.knownMilliseconds;
+    if (timestamp.knownMilliseconds) {
+        sample.timeMs += timestamp.millisecond;
+    }
+    return true;
+}
+
+void EnergyDeltaEstimator::onNewIndexes(const TimeOfDay& timestamp, uint32_t withdrawnIndex, uint32_t injectedIndex) {
+    Sample sample(0, false, withdrawnIndex, injectedIndex);
+    if (!toSampleTime(timestamp, sample)) {
+        return;
+    }
+    if (!this->samples.isEmpty()) {
+        Sample last = this->samples.getReverse(0);
+        if (withdrawnIndex < last.withdrawnIndex || injectedIndex < last.injectedIndex) {
+            return; /* Indices never decrease, this frame is corrupted */
+        }
+        if (withdrawnIndex == last.withdrawnIndex && injectedIndex == last.injectedIndex) {
+            return; /* Only store variations, the last stored sample remains a valid window start */
+        }
+        uint32_t elapsedMs = (sample.timeMs + MsPerDay - last.timeMs) % MsPerDay;
+        if (elapsedMs < this->maxWindowMs / MaxSamples) {
+            return; /* Keep stored samples spread over the whole window */
+        }
+    }
+    this->samples.push(sample);
+}
+
+bool EnergyDeltaEstimator::refine(const TimeOfDay& timestamp, uint32_t withdrawnIndex, uint32_t injectedIndex, TicEvaluatedPower& power) const {
+    Sample now(0, false, withdrawnIndex, injectedIndex);
+    if (!power.isValid || !toSampleTime(timestamp, now)) {
+        return false;
+    }
+    int64_t bestMin = power.minValue;
+    int64_t bestMax = power.maxValue;
+    bool refined = false;
+    for (std::size_t rank = 0; rank < this->samples.getCount(); rank++) {
+        Sample start = this->samples.getReverse(rank);
+        uint32_t elapsedMs = (now.timeMs + MsPerDay - start.timeMs) % MsPerDay; /* Handles windows over midnight */
+        if (elapsedMs > this->maxWindowMs) {
+            break;  /* Older samples are even further away */
+        }
+        uint32_t toleranceMs = (now.preciseTime && start.preciseTime) ? 0 : 1000;
+        if (elapsedMs <= toleranceMs || withdrawnIndex < start.withdrawnIndex || injectedIndex < start.injectedIndex) {
+            continue;
+        }
+        if ((power.maxValue <= 0 && withdrawnIndex != start.withdrawnIndex) || (power.minValue >= 0 && injectedIndex != start.injectedIndex)) {
+            break;  /* The power flowed in the other direction during this window (and thus during all older ones), it was not steady */
+        }
+        /* Indices are truncated to the Wh: a variation of n Wh means an actual variation in ]n-1;n+1[ Wh, and at least 0
+         * When the power range has a known sign, nothing flowed in the other direction during this steady window */
+        int64_t withdrawnDelta = static_cast<int64_t>(withdrawnIndex - start.withdrawnIndex);
+        int64_t injectedDelta = static_cast<int64_t>(injectedIndex - start.injectedIndex);
+        int64_t withdrawnUncertainty = (power.maxValue <= 0) ? 0 : 1;
+        int64_t injectedUncertainty = (power.minValue >= 0) ? 0 : 1;
+        int64_t minNetWh = (withdrawnDelta > 0 ? withdrawnDelta - withdrawnUncertainty : 0) - (injectedDelta + injectedUncertainty);
+        int64_t maxNetWh = (withdrawnDelta + withdrawnUncertainty) - (injectedDelta > 0 ? injectedDelta - injectedUncertainty : 0);
+        int64_t shortestMs = elapsedMs - toleranceMs;
+        int64_t longestMs = elapsedMs + toleranceMs;
+        int64_t minAverage = floorDiv(minNetWh * MsWattPerWh, (minNetWh < 0) ? shortestMs : longestMs);
+        int64_t maxAverage = ceilDiv(maxNetWh * MsWattPerWh, (maxNetWh > 0) ? shortestMs : longestMs);
+
+        int64_t intersectionMin = (minAverage > power.minValue) ? minAverage : power.minValue;
+        int64_t intersectionMax = (maxAverage < power.maxValue) ? maxAverage : power.maxValue;
+        if (intersectionMin > intersectionMax) {
+            continue;   /* The power changed during this window, its average is not relevant */
+        }
+        if (intersectionMax - intersectionMin < bestMax - bestMin) {
+            bestMin = intersectionMin;
+            bestMax = intersectionMax;
+            refined = true;
+        }
+    }
+    if (refined) {
+        power.setMinMax(static_cast<int>(bestMin), static_cast<int>(bestMax));
+    }
+    return refined;
+}
+
+std::size_t EnergyDeltaEstimator::getSampleCount() const {
+    return this->samples.getCount();
+}
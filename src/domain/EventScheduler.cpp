@@ -0,0 +1,140 @@
+#include "EventScheduler.h"
+
+uint32_t EventScheduler::EventStats::getAverageLatency() const {
+    if (this->dispatchCount == 0) {
+        return 0;
+    }
+    return static_cast<uint32_t>(this->totalLatency / this->dispatchCount);
+}
+
+EventScheduler::EventScheduler(FClockFunc clock, void* clockContext, FIdleFunc idle, void* idleContext) :
+    clock(clock),
+    clockContext(clockContext),
+    idle(idle),
+    idleContext(idleContext),
+    handlers(),
+    handlerContexts(),
+    priorities(),
+    pending(0),
+    postTimestamps(),
+    coalescedCounts(),
+    stats()
+{
+    for (unsigned int event = 0; event < EventCount; event++) {
+        this->handlers[event] = nullptr;
+        this->handlerContexts[event] = nullptr;
+        this->priorities[event] = LowestPriority;
+        this->postTimestamps[event].store(0);
+    }
+    this->resetStats();
+}
+
+uint32_t EventScheduler::now() const {
+    if (this->clock == nullptr) {
+        return 0;
+    }
+    return this->clock(this->clockContext);
+}
+
+void EventScheduler::setHandler(Event event, FEventHandlerFunc handler, void* context, uint8_t priority) {
+    if (event >= EventCount) {
+        return;
+    }
+    this->handlers[event] = handler;
+    this->handlerContexts[event] = context;
+    this->priorities[event] = priority;
+}
+
+void EventScheduler::post(Event event) {
+    /* This code may be called in an interrupt context */
+    if (event >= EventCount) {
+        return;
+    }
+    uint32_t mask = static_cast<uint32_t>(1) << event;
+    if ((this->pending.load() & mask) != 0) {
+        this->coalescedCounts[event].fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    /* The timestamp is stored before the pending bit is set, so that the dispatcher never reads a stale timestamp */
+    this->postTimestamps[event].store(this->now());
+    this->pending.fetch_or(mask);
+}
+
+bool EventScheduler::hasPendingEvents() const {
+    return (this->pending.load() != 0);
+}
+
+bool EventScheduler::dispatchOne() {
+    uint32_t pendingMask = this->pending.load();
+    if (pendingMask == 0) {
+        return false;
+    }
+    unsigned int selected = EventCount;
+    for (unsigned int event = 0; event < EventCount; event++) {
+        if ((pendingMask & (static_cast<uint32_t>(1) << event)) != 0) {
+            if (selected == EventCount || this->priorities[event] > this->priorities[selected]) {
+                selected = event;
+            }
+        }
+    }
+    if (selected == EventCount) {
+        return false;
+    }
+    /* Read the timestamp before clearing the pending bit: any post in between is coalesced and does not overwrite it */
+    uint32_t postTimestamp = this->postTimestamps[selected].load();
+    this->pending.fetch_and(~(static_cast<uint32_t>(1) << selected));
+
+    uint32_t dispatchStart = this->now();
+    EventStats& eventStats = this->stats[selected];
+    uint32_t latency = dispatchStart - postTimestamp; /* Unsigned arithmetic handles one wrap-around of the clock */
+    if (latency > eventStats.maxLatency) {
+        eventStats.maxLatency = latency;
+    }
+    eventStats.totalLatency += latency;
+    eventStats.dispatchCount++;
+
+    if (this->handlers[selected] != nullptr) {
+        this->handlers[selected](this->handlerContexts[selected]);
+        uint32_t runTime = this->now() - dispatchStart;
+        if (runTime > eventStats.maxRunTime) {
+            eventStats.maxRunTime = runTime;
+        }
+    }
+    return true;
+}
+
+unsigned int EventScheduler::dispatchPending() {
+    unsigned int dispatched = 0;
+    while (this->dispatchOne()) {
+        dispatched++;
+    }
+    return dispatched;
+}
+
+bool EventScheduler::runUntil(FConditionFunc condition, void* context, uint32_t timeout) {
+    uint32_t start = this->now();
+    while (true) {
+        if (condition != nullptr && condition(context)) {
+            return true;
+        }
+        if (timeout != NoTimeout && this->now() - start >= timeout) {
+            return false;
+        }
+        if (!this->dispatchOne() && this->idle != nullptr) {
+            this->idle(this->idleContext);  /* Nothing to do, sleep until the next interrupt */
+        }
+    }
+}
+
+EventScheduler::EventStats EventScheduler::getStats(Event event) const {
+    EventStats result = this->stats[event];
+    result.coalescedCount = this->coalescedCounts[event].load(std::memory_order_relaxed);
+    return result;
+}
+
+void EventScheduler::resetStats() {
+    for (unsigned int event = 0; event < EventCount; event++) {
+        this->stats[event] = EventStats{0, 0, 0, 0, 0};
+        this->coalescedCounts[event].store(0);
+    }
+}
@@ -104,9 +104,9 @@ void drawDebugLine(Stm32LcdDriver& lcd, uint16_t y, const PowerHistory& history,
     lcd.drawText(0, y, statusLine, Font24.Width, Font24.Height, get_font24_ptr, Stm32LcdDriver::LCD_Color::White, Stm32LcdDriver::LCD_Color::Black);
 }
 
-void drawHistory(Stm32LcdDriver& lcd, uint16_t x, uint16_t y, uint16_t width, uint16_t height, const PowerHistory& history, void* debugContext) {
+bool drawHistory(Stm32LcdDriver& lcd, uint16_t x, uint16_t y, uint16_t width, uint16_t height, const PowerHistory& history, unsigned int spanInSeconds, void* debugContext) {
     if (width == 0 || height == 0)
-        return;
+        return true;
     
     if (debugContext) { /* If the debug line needs to be drawn, reduce the history graph area height accordinly */
         height -= Font24.Height;
@@ -114,13 +114,9 @@ void drawHistory(Stm32LcdDriver& lcd, uint16_t x, uint16_t y, uint16_t width, ui
     
     uint16_t xright = x + width - 1;
 
-    unsigned int nbHistoryEntries = width; /* Initially try to fill-in the full width of the area */
-
-    PowerHistoryEntry powerMeasurements[nbHistoryEntries];
-    history.getLastPower(nbHistoryEntries, powerMeasurements);
-    if (nbHistoryEntries > width) {    /* Sanity, overflow , exclude oldest entries to fit on display */
-        nbHistoryEntries = width;
-    }
+    PowerHistoryView historyView = history.getView(spanInSeconds, width); /* Try to fill-in the full width of the area, entries are read in place, one per column */
+    unsigned int entryPeriodInSeconds = historyView.periodInSeconds;
+    unsigned int nbHistoryEntries = 0;  /* Updated while drawing, with the number of entries actually read */
 
     uint16_t debugX = UINT16_MAX;
     uint16_t debugYtop = UINT16_MAX;
@@ -133,16 +129,24 @@ void drawHistory(Stm32LcdDriver& lcd, uint16_t x, uint16_t y, uint16_t width, ui
     const int minPower = -2100;
     uint16_t zeroSampleAbsoluteY = y;
     zeroSampleAbsoluteY += static_cast<uint16_t>(static_cast<unsigned long int>(maxPower) * static_cast<unsigned long int>(height) / static_cast<unsigned long int>(maxPower - minPower));
-    for (unsigned int measurementAge = 0; measurementAge < nbHistoryEntries; measurementAge++) {
+    auto powerToClampedAbsoluteY = [y, height, zeroSampleAbsoluteY](int power) -> uint16_t {  /* Powers out of the displayed range stick to the top or bottom of the area */
+        if (power >= maxPower)
+            return y;
+        if (power <= minPower)
+            return y + height - 1;
+        signed long int relativeY = static_cast<signed long int>(power) * static_cast<signed long int>(height);
+        relativeY /= static_cast<signed long int>(maxPower - minPower);
+        return static_cast<uint16_t>(static_cast<signed long int>(zeroSampleAbsoluteY) - relativeY);
+    };
+    PowerHistoryEntry thisSampleEntry;
+    for (unsigned int measurementAge = 0; measurementAge < width && historyView.readNext(thisSampleEntry); measurementAge++) {
+        nbHistoryEntries = measurementAge + 1;
         uint16_t thisSampleAbsoluteX = xright - measurementAge;   /* First measurement sample is at the extreme right of the allocated area, next samples will be placed to the left */
         if (debugX == UINT16_MAX) debugX = thisSampleAbsoluteX;
-        PowerHistoryEntry& thisSampleEntry = powerMeasurements[measurementAge];
         TicEvaluatedPower& thisSamplePower = thisSampleEntry.power;
 
         if (debugValue == INT_MIN) {
-            if (nbHistoryEntries>0) {
-                debugValue = thisSampleEntry.nbSamples;
-            }
+            debugValue = thisSampleEntry.nbSamples;
         }
         if (debugPower == INT_MIN) {
             if (thisSamplePower.isValid) {
@@ -167,6 +171,12 @@ void drawHistory(Stm32LcdDriver& lcd, uint16_t x, uint16_t y, uint16_t width, ui
             }
         }
 
+        if (thisSampleEntry.peakPower.isValid && !thisSampleEntry.peakPower.isExact) {   /* Draw a whisker covering the peak range of the samples, the average will be drawn over it */
+            uint16_t peakTopAbsoluteY = powerToClampedAbsoluteY(thisSampleEntry.peakPower.maxValue);
+            uint16_t peakBottomAbsoluteY = powerToClampedAbsoluteY(thisSampleEntry.peakPower.minValue);
+            if (peakBottomAbsoluteY > peakTopAbsoluteY)
+                lcd.drawVerticalLine(thisSampleAbsoluteX, peakTopAbsoluteY, peakBottomAbsoluteY-peakTopAbsoluteY, Stm32LcdDriver::Grey);
+        }
         if (thisSamplePower.isValid) {
             /* TODO: Review the code below */
             if (thisSamplePower.maxValue > 0) { /* Positive value, even if range, display the highest value of the range (worst case) */
@@ -253,24 +263,45 @@ void drawHistory(Stm32LcdDriver& lcd, uint16_t x, uint16_t y, uint16_t width, ui
     if (drawLabels) /* Draw label above the line (substracting text height from y) */
         lcd.drawText(gridX + 2, gridY - 22, "-2000W", Font24.Width, Font24.Height, get_font24_ptr, Stm32LcdDriver::LCD_Color::Black, Stm32LcdDriver::LCD_Color::Transparent); /* Draw above the line (substracting text height from y) */
 
-    debugValue = nbHistoryEntries * (4*3) / history.getPowerRecordsPerHour(); /* We divide hours in 12 steps, thus each step is 5 mins */
-    for (unsigned int fiveMinStep = 1; fiveMinStep <= nbHistoryEntries * (4*3) / history.getPowerRecordsPerHour(); fiveMinStep++) {
+    /* Vertical grid: light grey minor steps, black medium steps and double black major steps, depending on the resolution of the entries drawn */
+    unsigned int minorStepInSeconds = 5*60;
+    unsigned int mediumStepInSeconds = 15*60;
+    unsigned int majorStepInSeconds = 60*60;
+    if (entryPeriodInSeconds >= 60*60) {
+        minorStepInSeconds = mediumStepInSeconds = 24*60*60;
+        majorStepInSeconds = 7*24*60*60;
+    }
+    else if (entryPeriodInSeconds >= 15*60) {
+        minorStepInSeconds = 3*60*60;
+        mediumStepInSeconds = 6*60*60;
+        majorStepInSeconds = 24*60*60;
+    }
+    else if (entryPeriodInSeconds >= 60) {
+        minorStepInSeconds = 15*60;
+        mediumStepInSeconds = 60*60;
+        majorStepInSeconds = 6*60*60;
+    }
+    unsigned int nbMinorSteps = (entryPeriodInSeconds == 0) ? 0 : nbHistoryEntries * entryPeriodInSeconds / minorStepInSeconds;
+    debugValue = nbMinorSteps;
+    for (unsigned int minorStep = 1; minorStep <= nbMinorSteps; minorStep++) {
         uint16_t gridX = width;
-        if (gridX >= history.getPowerRecordsPerHour() * fiveMinStep / (4*3)) {
-            gridX -= history.getPowerRecordsPerHour() * fiveMinStep / (4*3);
-            if (fiveMinStep % 12 == 0) { /* gridX is pointing to the edge a hour */
-                lcd.drawVerticalLine(gridX, y, height, Stm32LcdDriver::Black); /* Draw each hour, with a double line */
+        unsigned int stepOffset = minorStep * minorStepInSeconds / entryPeriodInSeconds;   /* In columns */
+        if (gridX >= stepOffset) {
+            gridX -= stepOffset;
+            if ((minorStep * minorStepInSeconds) % majorStepInSeconds == 0) { /* gridX is pointing to a major step (an hour at the base resolution) */
+                lcd.drawVerticalLine(gridX, y, height, Stm32LcdDriver::Black); /* Draw each major step, with a double line */
                 if (gridX > x)
-                    lcd.drawVerticalLine(gridX-1, y, height, Stm32LcdDriver::Black); /* Draw each hour, with a double line */
+                    lcd.drawVerticalLine(gridX-1, y, height, Stm32LcdDriver::Black); /* Draw each major step, with a double line */
             }
-            else if (fiveMinStep % 3 == 0)  /* gridX is pointing to the edge of a quarter of an hour */
-                lcd.drawVerticalLine(gridX, y, height, Stm32LcdDriver::Black); /* Draw each other quarter */
+            else if ((minorStep * minorStepInSeconds) % mediumStepInSeconds == 0)  /* gridX is pointing to a medium step (a quarter of an hour at the base resolution) */
+                lcd.drawVerticalLine(gridX, y, height, Stm32LcdDriver::Black); /* Draw each medium step */
             else
-                lcd.drawVerticalLine(gridX, y, height, Stm32LcdDriver::LightGrey); /* Draw each other step of 5 mins */
+                lcd.drawVerticalLine(gridX, y, height, Stm32LcdDriver::LightGrey); /* Draw each other minor step (5 mins at the base resolution) */
         }
     }
     if (debugContext) {
         /* If debug line needs to be drawn, draw it just under the history graph */
         drawDebugLine(lcd, y+height, history, nbHistoryEntries, debugX, debugYtop, debugYbottom, debugPower, debugPowerIsExact, debugValue, debugContext);
     }
+    return !history.hasChangedSince(historyView);  /* Entries are read in place, they should not have been modified while drawing */
 }
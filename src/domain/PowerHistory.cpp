@@ -4,18 +4,28 @@
 #endif
 
 #include <climits>
+#include <algorithm> // For std::min() and std::max()
+#include <utility> // For std::swap()
 
 PowerHistoryEntry::PowerHistoryEntry() :
     power(),
     timestamp(),
-    nbSamples(0)
+    nbSamples(0),
+    minPowerSum(0),
+    maxPowerSum(0),
+    peakPower(),
+    sumOfSquaredDeviations(0)
 {
 }
 
 PowerHistoryEntry::PowerHistoryEntry(const TicEvaluatedPower& power, const TimeOfDay& timestamp) :
     power(power),
     timestamp(timestamp),
-    nbSamples(1)
+    nbSamples(1),
+    minPowerSum(power.isValid ? power.minValue : 0),
+    maxPowerSum(power.isValid ? power.maxValue : 0),
+    peakPower(power),
+    sumOfSquaredDeviations(0)
 {
 }
 
@@ -34,59 +44,248 @@ signed int PowerHistoryEntry::truncateSignedLongToSignedInt(const signed long in
     }
 }
 
+float PowerHistoryEntry::getMeanMiddlePower() const {
+    if (this->nbSamples == 0)
+        return 0;
+    return static_cast<float>(this->minPowerSum + this->maxPowerSum) / (2.0f * static_cast<float>(this->nbSamples));
+}
+
 void PowerHistoryEntry::averageWithPowerSample(const TicEvaluatedPower& power, const TimeOfDay& timestamp) {
-    PowerHistoryEntry result;
+    this->averageWithEntry(PowerHistoryEntry(power, timestamp));
+}
 
+void PowerHistoryEntry::averageWithEntry(const PowerHistoryEntry& other) {
     /* If any of the two provided data instances are invalid, discard it and directly return the second one */
     if (!this->power.isValid) {
-        this->power = power;
-        this->timestamp = timestamp;
-        this->nbSamples = 1;
+        *this = other;
         return;
     }
-    if (!power.isValid)
+    if (!other.power.isValid || other.nbSamples == 0)
         return; /* New sample is invalid: do nothing, no new calculation should be performed */
 
-    if (timestamp > this->timestamp)
-        this->timestamp = timestamp;  /* Update our internal timestamp */
-
-    if (this->power.isExact && power.isExact) {
-        /* Averaging two exact measurements */
-        unsigned int totalNbSample = this->nbSamples + 1;
-        /* Note: in the line below, division should be done in a separate instruction rather than on one calculation line. */
-        /* If we don't do that, on some buggy compilers, the result would overflow to high positive when dividing negative values */
-        signed long int averagePower = static_cast<signed long int>(this->power.minValue) * this->nbSamples;
-        averagePower += static_cast<signed long int>(power.minValue);
-        averagePower /= static_cast<signed long int>(totalNbSample);
-        this->power.set(truncateSignedLongToSignedInt(averagePower));
-        this->nbSamples = totalNbSample;
-        return;
-    }
+    if (other.timestamp > this->timestamp)
+        this->timestamp = other.timestamp;  /* Update our internal timestamp */
 
-    /* Either first, second or both are no exact values but ranges, the calculation is a bit mode complex */
-    unsigned int totalNbSample = this->nbSamples + 1;
+    unsigned int totalNbSample = this->nbSamples + other.nbSamples;
 
+    /* Merge the sums of squared deviations (Chan et al.), this is Welford's update when other is a single sample */
+    float meanDelta = other.getMeanMiddlePower() - this->getMeanMiddlePower();
+    this->sumOfSquaredDeviations += other.sumOfSquaredDeviations
+                                    + meanDelta * meanDelta * (static_cast<float>(this->nbSamples) * static_cast<float>(other.nbSamples) / static_cast<float>(totalNbSample));
+
+    if (!this->peakPower.isValid) {
+        this->peakPower = other.peakPower;
+    }
+    else if (other.peakPower.isValid) {
+        this->peakPower.setMinMax(std::min(this->peakPower.minValue, other.peakPower.minValue), std::max(this->peakPower.maxValue, other.peakPower.maxValue));
+    }
+
+    this->minPowerSum += other.minPowerSum;
+    this->maxPowerSum += other.maxPowerSum;
     /* Note: in the lines below, division should be done in a separate instruction rather than on one calculation line. */
     /* If we don't do that, on some buggy compilers, the result would overflow to high positive when dividing negative values */
-    signed long int averageMinPower = static_cast<signed long int>(this->power.minValue) * this->nbSamples;
-    averageMinPower += static_cast<signed long int>(power.minValue);
-    averageMinPower /= static_cast<signed long int>(totalNbSample);
-    signed long int averageMaxPower = static_cast<signed long int>(this->power.maxValue) * this->nbSamples;
-    averageMaxPower += static_cast<signed long int>(power.maxValue);
-    averageMaxPower /= static_cast<signed long int>(totalNbSample);
-    /* We now get a high and low boundary (a range) for power value */
-
-    /* Prior average and/or the new value are estimations, take min and max as they have been calculated */
-    this->power.setMinMax(truncateSignedLongToSignedInt(averageMinPower), truncateSignedLongToSignedInt(averageMaxPower));
+    int64_t averageMinPower = this->minPowerSum;
+    averageMinPower /= static_cast<int64_t>(totalNbSample);
+    int64_t averageMaxPower = this->maxPowerSum;
+    averageMaxPower /= static_cast<int64_t>(totalNbSample);
+    /* Averages of int values always fit in a signed long */
+    if (this->power.isExact && other.power.isExact) {  /* Averaging exact measurements */
+        this->power.set(truncateSignedLongToSignedInt(static_cast<signed long>(averageMinPower)));
+    }
+    else {  /* Prior average and/or the new value are estimations, take min and max as they have been calculated */
+        this->power.setMinMax(truncateSignedLongToSignedInt(static_cast<signed long>(averageMinPower)), truncateSignedLongToSignedInt(static_cast<signed long>(averageMaxPower)));
+    }
     this->nbSamples = totalNbSample;
-    return;
 }
 
+float PowerHistoryEntry::getVariance() const {
+    if (this->nbSamples < 2)
+        return 0;
+    return this->sumOfSquaredDeviations / static_cast<float>(this->nbSamples);
+}
+
+PackedPowerHistoryEntry::PackedPowerHistoryEntry() :
+    secondsOfDay(0),
+    timestampValid(0),
+    powerValid(0),
+    powerExact(0),
+    nbSamples(0),
+    minPower(0),
+    maxPower(0),
+    minPeakPower(0),
+    maxPeakPower(0),
+    minPowerSum(0),
+    maxPowerSum(0),
+    variance(0)
+{
+}
+
+PackedPowerHistoryEntry::PackedPowerHistoryEntry(const PowerHistoryEntry& entry) :
+    secondsOfDay(entry.timestamp.isValid ? entry.timestamp.toSeconds() : 0),
+    timestampValid(entry.timestamp.isValid ? 1 : 0),
+    powerValid(entry.power.isValid ? 1 : 0),
+    powerExact(entry.power.isExact ? 1 : 0),
+    nbSamples(entry.nbSamples < MaxNbSamples ? entry.nbSamples : MaxNbSamples),
+    minPower(saturateToInt16(entry.power.minValue)),
+    maxPower(saturateToInt16(entry.power.maxValue)),
+    minPeakPower(saturateToInt16(entry.peakPower.isValid ? entry.peakPower.minValue : entry.power.minValue)),
+    maxPeakPower(saturateToInt16(entry.peakPower.isValid ? entry.peakPower.maxValue : entry.power.maxValue)),
+    minPowerSum(saturateToInt32(entry.minPowerSum)),
+    maxPowerSum(saturateToInt32(entry.maxPowerSum)),
+    variance(entry.getVariance())
+{
+}
+
+int16_t PackedPowerHistoryEntry::saturateToInt16(int input) {
+    if (input > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (input < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return static_cast<int16_t>(input);
+}
+
+int32_t PackedPowerHistoryEntry::saturateToInt32(int64_t input) {
+    if (input > INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (input < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return static_cast<int32_t>(input);
+}
+
+PowerHistoryEntry PackedPowerHistoryEntry::unpack() const {
+    PowerHistoryEntry entry;
+    if (this->timestampValid) {
+        entry.timestamp = TimeOfDay(this->secondsOfDay / 3600, (this->secondsOfDay / 60) % 60, this->secondsOfDay % 60);
+    }
+    if (this->powerValid) {
+        entry.power.setMinMax(this->minPower, this->maxPower);
+        entry.power.isExact = this->powerExact;  /* A saturated range may have collapsed to a single value, it is still an approximation */
+        entry.peakPower.setMinMax(this->minPeakPower, this->maxPeakPower);
+    }
+    entry.nbSamples = this->nbSamples;
+    entry.minPowerSum = this->minPowerSum;
+    entry.maxPowerSum = this->maxPowerSum;
+    entry.sumOfSquaredDeviations = this->variance * static_cast<float>(entry.nbSamples);  /* So that getVariance() gives the stored variance back, even if nbSamples saturated */
+    return entry;
+}
+
+PackedPowerHistoryEntry PackedPowerHistoryEntry::makeGap(unsigned int nbPeriods) {
+    PackedPowerHistoryEntry gap;
+    gap.secondsOfDay = (nbPeriods < MaxGapLength) ? nbPeriods : MaxGapLength;
+    return gap;
+}
+
+unsigned int PackedPowerHistoryEntry::getGapLength() const {
+    if (this->timestampValid)
+        return 0;
+    return this->secondsOfDay;
+}
+
+namespace {
+/**
+ * @brief Count the periods without any entry between two timestamps
+ * 
+ * @param last The timestamp of the last entry
+ * @param next The timestamp of the new entry
+ * @param periodInSeconds The duration of a period
+ * @return The number of periods strictly between the periods of @p last and @p next
+ * 
+ * @note Timestamps carry no date, so a new entry less than half a day before the last one is considered as time going backwards (after a clock adjustment), not as a gap
+ */
+unsigned int countMissedPeriods(const TimeOfDay& last, const TimeOfDay& next, unsigned int periodInSeconds) {
+    if (periodInSeconds == 0 || !last.isValid || !next.isValid)
+        return 0;
+    const unsigned int periodsPerDay = 24 * 60 * 60 / periodInSeconds;
+    unsigned int lastPeriod = last.toSeconds() / periodInSeconds;
+    unsigned int nextPeriod = next.toSeconds() / periodInSeconds;
+    unsigned int elapsedPeriods = (nextPeriod + periodsPerDay - lastPeriod) % periodsPerDay;    /* Across midnight as well */
+    if (elapsedPeriods < 2 || elapsedPeriods > periodsPerDay / 2)
+        return 0;
+    return elapsedPeriods - 1;
+}
+}
+
+PowerHistoryView::PowerHistoryView() :
+    PowerHistoryView(nullptr, 0, nullptr, 0, 0, 0, 0)
+{
+}
+
+PowerHistoryView::PowerHistoryView(const PackedPowerHistoryEntry* olderEntries, std::size_t nbOlderEntries,
+                                   const PackedPowerHistoryEntry* newerEntries, std::size_t nbNewerEntries,
+                                   unsigned int periodInSeconds, unsigned int maxEntries, unsigned int version) :
+    olderEntries(olderEntries),
+    nbOlderEntries(nbOlderEntries),
+    newerEntries(newerEntries),
+    nbNewerEntries(nbNewerEntries),
+    periodInSeconds(periodInSeconds),
+    maxEntries(maxEntries),
+    version(version),
+    cursor(nullptr),
+    readingNewerEntries(true),
+    gapPeriodsLeft(0),
+    entriesLeft(0)
+{
+    this->rewind();
+}
+
+void PowerHistoryView::rewind() {
+    this->readingNewerEntries = true;
+    this->cursor = this->newerEntries + this->nbNewerEntries;
+    this->gapPeriodsLeft = 0;
+    this->entriesLeft = this->maxEntries;
+}
+
+const PackedPowerHistoryEntry* PowerHistoryView::fetchPrevious() {
+    if (this->readingNewerEntries && this->cursor == this->newerEntries) {  /* Continue with the older span */
+        this->readingNewerEntries = false;
+        this->cursor = this->olderEntries + this->nbOlderEntries;
+    }
+    if (!this->readingNewerEntries && this->cursor == this->olderEntries)
+        return nullptr;
+    this->cursor--;
+    return this->cursor;
+}
+
+bool PowerHistoryView::readNext(PowerHistoryEntry& entry) {
+    if (this->entriesLeft == 0)
+        return false;
+    if (this->gapPeriodsLeft == 0) {
+        const PackedPowerHistoryEntry* packedEntry = this->fetchPrevious();
+        if (packedEntry == nullptr) {
+            this->entriesLeft = 0;
+            return false;
+        }
+        this->gapPeriodsLeft = packedEntry->getGapLength();
+        if (this->gapPeriodsLeft == 0) {
+            entry = packedEntry->unpack();
+            this->entriesLeft--;
+            return true;
+        }
+    }
+    entry = PowerHistoryEntry(); /* One invalid entry per missed period */
+    this->gapPeriodsLeft--;
+    this->entriesLeft--;
+    return true;
+}
+
+constexpr unsigned int PowerHistory::TierPeriodsInSeconds[];
+
 PowerHistory::PowerHistory(AveragingMode averagingPeriod, TicProcessingContext* context) :
     data(),
+    dataSums(),
+    tiers(),
     averagingPeriod(averagingPeriod),
     ticContext(context),
-    lastPowerTimeOfDay()
+    lastPowerTimeOfDay(),
+    openEntry(),
+    openTierEntries(),
+    tierSums(),
+    version(0),
+    energy()
 {
 }
 
@@ -104,32 +303,40 @@ void PowerHistory::onNewPowerData(const TicEvaluatedPower& power, const TimeOfDa
         this->ticContext->lastParsedFrameNb = frameSequenceNb;
     }
 
+    this->energy.onNewPowerData(power, timestamp);
+
     if (timestamp.isValid) {
         if (this->timestampsAreInSamePeriodSample(timestamp, this->lastPowerTimeOfDay)) {
-            PowerHistoryEntry* lastEntry = this->data.getPtrToLast();
-            if (lastEntry != nullptr) {
-                lastEntry->averageWithPowerSample(power, timestamp);
+            PackedPowerHistoryEntry* lastPackedEntry = this->data.getPtrToLast();
+            if (lastPackedEntry != nullptr && this->openEntry.power.isValid) {
+                this->openEntry.averageWithPowerSample(power, timestamp);   /* Statistics are updated in openEntry, without saturation, and its packed form is refreshed */
+                *lastPackedEntry = PackedPowerHistoryEntry(this->openEntry);
+                this->dataSums.replaceLast(*lastPackedEntry);
                 this->lastPowerTimeOfDay = timestamp;
+                this->version++;
                 return;
             }
             /* If lastEntry is not valid, create a new entry by falling-through the following code */
         }
         /* If lastEntry is not valid, create a new entry by falling-through the following code */
     }
-    if (false && this->lastPowerTimeOfDay.isValid) { /* If we already store some historical data, make sure last timestamp and new timestamp are consecutive (in periods), or otherwise pad */
-        TimeOfDay forwardTimeOfDay = this->lastPowerTimeOfDay;
-        for (unsigned int padding = 0; padding < this->data.getCapacity(); padding++) {
-            forwardTimeOfDay.addSeconds(this->getAveragingPeriodInSeconds());  /* Check what would happen if timestamp was in the next averaging period */
-            if (this->timestampsAreInSamePeriodSample(timestamp, forwardTimeOfDay))
-                break;
-            /* If that timestamp slot does not match the timestamp passed as argument, we have a hole in our history entries, pad it */
-            this->data.push(PowerHistoryEntry());   /* Push an invalid power history entry to pad the history */
-        }
-    }
     /* Warning: these lines are not reached when the new power is in the same average period as a previously valid entry (see the above return statement) */
     /* If code needs to be executed systematically, put it at the top of this function, not here... */
-    this->data.push(PowerHistoryEntry(power, timestamp)); /* First sample in this period */
+    if (this->data.getPtrToLast() != nullptr) {
+        this->feedTiers(this->openEntry);  /* The period of the last entry is over, it will not change anymore */
+    }
+    if (this->lastPowerTimeOfDay.isValid) {
+        unsigned int missedPeriods = countMissedPeriods(this->lastPowerTimeOfDay, timestamp, this->getAveragingPeriodInSeconds());
+        if (missedPeriods > 0) {
+            this->data.push(PackedPowerHistoryEntry::makeGap(missedPeriods));   /* A single marker, whatever the length of the gap */
+            this->dataSums.push(*this->data.getPtrToLast());
+        }
+    }
+    this->openEntry = PowerHistoryEntry(power, timestamp); /* First sample in this period */
+    this->data.push(PackedPowerHistoryEntry(this->openEntry));
+    this->dataSums.push(*this->data.getPtrToLast());
     this->lastPowerTimeOfDay = timestamp;
+    this->version++;
 }
 
 bool PowerHistory::timestampsAreInSamePeriodSample(const TimeOfDay& first, const TimeOfDay& second) {
@@ -185,18 +392,121 @@ unsigned int PowerHistory::getPowerRecordsPerHour() const {
     return (60 * 60 / averagingPeriodInSeconds);
 }
 
-void PowerHistory::unWrapOnNewPowerData(const TicEvaluatedPower& power, const TimeOfDay& timestamp, unsigned int frameSequenceNb, void* context) {
+void PowerHistory::onNewFrameMeasurements(const TicMeasurements& measurements) {
+    this->onNewPowerData(measurements.instPower, measurements.timestamp, measurements.fromFrameNb);
+}
+
+void PowerHistory::unWrapOnNewFrameMeasurements(const TicMeasurements& measurements, void* context) {
     if (context == nullptr)
         return; /* Failsafe, discard if no context */
     PowerHistory* powerHistoryInstance = static_cast<PowerHistory*>(context);
-    /* We have finished parsing a frame, if there is an open dataset, we should discard it and start over at the following frame */
-    powerHistoryInstance->onNewPowerData(power, timestamp, frameSequenceNb);
+    powerHistoryInstance->onNewFrameMeasurements(measurements);
 }
 
 void PowerHistory::getLastPower(unsigned int& nb, PowerHistoryEntry* result) const {
-    if (nb > this->data.getCount())
-        nb = this->data.getCount();   /* Saturate to the number of actual values we hold */
-    for (unsigned int reversePos = 0; reversePos < nb; reversePos++) {
-        result[reversePos] = this->data.getReverse(reversePos);
+    PowerHistoryView view = this->getView(0, nb);
+    for (nb = 0; view.readNext(result[nb]); nb++);
+}
+
+bool PowerHistory::isTierActive(unsigned int tier) const {
+    unsigned int averagingPeriodInSeconds = this->getAveragingPeriodInSeconds();
+    if (tier >= TierCount || averagingPeriodInSeconds == 0)
+        return false;
+    return (TierPeriodsInSeconds[tier] > averagingPeriodInSeconds && TierPeriodsInSeconds[tier] % averagingPeriodInSeconds == 0);
+}
+
+void PowerHistory::feedTiers(const PowerHistoryEntry& closedEntry) {
+    if (!closedEntry.power.isValid || !closedEntry.timestamp.isValid)
+        return;
+    PowerHistoryEntry entry = closedEntry;
+    for (unsigned int tier = 0; tier < TierCount; tier++) {
+        if (!this->isTierActive(tier))
+            continue;
+        PowerHistoryEntry& openTierEntry = this->openTierEntries[tier];
+        PackedPowerHistoryEntry* lastPackedTierEntry = this->tiers[tier].getPtrToLast();
+        if (lastPackedTierEntry == nullptr || !openTierEntry.power.isValid) {
+            openTierEntry = entry;
+            this->tiers[tier].push(PackedPowerHistoryEntry(openTierEntry));
+            this->tierSums[tier].push(*this->tiers[tier].getPtrToLast());
+            return;
+        }
+        if (openTierEntry.timestamp.toSeconds() / TierPeriodsInSeconds[tier] == entry.timestamp.toSeconds() / TierPeriodsInSeconds[tier]) {
+            openTierEntry.averageWithEntry(entry); /* Same tier period, the last tier entry stays open */
+            *lastPackedTierEntry = PackedPowerHistoryEntry(openTierEntry);
+            this->tierSums[tier].replaceLast(*lastPackedTierEntry);
+            return;
+        }
+        unsigned int missedPeriods = countMissedPeriods(openTierEntry.timestamp, entry.timestamp, TierPeriodsInSeconds[tier]);
+        if (missedPeriods > 0) {
+            this->tiers[tier].push(PackedPowerHistoryEntry::makeGap(missedPeriods));
+            this->tierSums[tier].push(*this->tiers[tier].getPtrToLast());
+        }
+        this->tiers[tier].push(PackedPowerHistoryEntry(entry));
+        this->tierSums[tier].push(*this->tiers[tier].getPtrToLast());
+        std::swap(openTierEntry, entry);  /* The period of the last tier entry is over, cascade it to the next tier */
+    }
+}
+
+PowerHistoryView PowerHistory::getView(unsigned int spanInSeconds, unsigned int maxEntries) const {
+    unsigned int periodInSeconds = this->getAveragingPeriodInSeconds();
+    const FixedSizeRingBuffer<PackedPowerHistoryEntry, TierCapacity>* source = nullptr;    /* nullptr for the base history */
+    if (periodInSeconds != 0 && spanInSeconds > periodInSeconds * maxEntries) { /* The base history would need more than maxEntries entries */
+        for (unsigned int tier = 0; tier < TierCount; tier++) {
+            if (!this->isTierActive(tier))
+                continue;
+            source = &this->tiers[tier];
+            periodInSeconds = TierPeriodsInSeconds[tier];
+            unsigned int neededEntries = (spanInSeconds + periodInSeconds - 1) / periodInSeconds;
+            if (neededEntries <= maxEntries && neededEntries <= TierCapacity)
+                break;  /* Finest tier that fits, otherwise we end up with the coarsest one */
+        }
+        if (source != nullptr) {
+            unsigned int neededEntries = (spanInSeconds + periodInSeconds - 1) / periodInSeconds;
+            if (maxEntries > neededEntries)
+                maxEntries = neededEntries;
+        }
+    }
+    const PackedPowerHistoryEntry* olderEntries = nullptr;
+    const PackedPowerHistoryEntry* newerEntries = nullptr;
+    std::size_t nbOlderEntries = 0;
+    std::size_t nbNewerEntries = 0;
+    if (source == nullptr) {
+        periodInSeconds = this->getAveragingPeriodInSeconds();
+        this->data.getSpans(olderEntries, nbOlderEntries, newerEntries, nbNewerEntries);
+    }
+    else {
+        source->getSpans(olderEntries, nbOlderEntries, newerEntries, nbNewerEntries);
+    }
+    return PowerHistoryView(olderEntries, nbOlderEntries, newerEntries, nbNewerEntries, periodInSeconds, maxEntries, this->version);
+}
+
+bool PowerHistory::hasChangedSince(const PowerHistoryView& view) const {
+    return (this->version != view.version);
+}
+
+unsigned int PowerHistory::getLastPowerOverSpan(unsigned int spanInSeconds, unsigned int& nb, PowerHistoryEntry* result) const {
+    PowerHistoryView view = this->getView(spanInSeconds, nb);
+    for (nb = 0; view.readNext(result[nb]); nb++);
+    return view.periodInSeconds;
+}
+
+bool PowerHistory::getAverageOverLast(unsigned int spanInSeconds, TicEvaluatedPower& average) const {
+    unsigned int averagingPeriodInSeconds = this->getAveragingPeriodInSeconds();
+    if (averagingPeriodInSeconds != 0 && spanInSeconds <= averagingPeriodInSeconds * Capacity) {
+        unsigned int nbPeriods = (spanInSeconds + averagingPeriodInSeconds - 1) / averagingPeriodInSeconds;
+        return this->dataSums.getLastPeriods(nbPeriods).getAverage(average);
+    }
+    int selectedTier = -1;
+    for (unsigned int tier = 0; tier < TierCount; tier++) {
+        if (!this->isTierActive(tier))
+            continue;
+        selectedTier = static_cast<int>(tier);
+        if (spanInSeconds <= TierPeriodsInSeconds[tier] * TierCapacity)
+            break;  /* Finest tier that holds the whole span, otherwise we end up with the coarsest one */
     }
+    if (selectedTier < 0)
+        return false;
+    unsigned int periodInSeconds = TierPeriodsInSeconds[selectedTier];
+    unsigned int nbPeriods = (spanInSeconds + periodInSeconds - 1) / periodInSeconds;
+    return this->tierSums[selectedTier].getLastPeriods(nbPeriods).getAverage(average);
 }
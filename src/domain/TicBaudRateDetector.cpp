@@ -0,0 +1,196 @@
+#include "TicBaudRateDetector.h"
+
+namespace {
+const uint8_t STX = 0x02; /*!< Start of frame */
+const uint8_t ETX = 0x03; /*!< End of frame */
+const uint8_t EOT = 0x04; /*!< Frame interrupted */
+const uint8_t LF = 0x0a;  /*!< Start of dataset */
+const uint8_t CR = 0x0d;  /*!< End of dataset */
+const uint8_t HT = 0x09;  /*!< Separator in standard TIC */
+const uint8_t SP = 0x20;  /*!< Separator in historical TIC */
+} // namespace
+
+TicBaudRateDetector::TicBaudRateDetector(FOnBaudRateChangeFunc onBaudRateChange, void* context, unsigned int initialBaudRate) :
+    onBaudRateChange(onBaudRateChange),
+    onBaudRateChangeContext(context),
+    baudRate(initialBaudRate),
+    locked(false),
+    switchCount(0),
+    windowStartMs(0),
+    windowStarted(false),
+    windowBytes(0),
+    windowLineErrors(0),
+    windowValidDatasets(0),
+    windowValidFrames(0),
+    inDataset(false),
+    datasetSum(0),
+    datasetLen(0),
+    datasetLastBytes{0, 0},
+    datasetCorrupted(false),
+    inFrame(false),
+    frameValidDatasets(0),
+    frameInvalidDatasets(0)
+{
+}
+
+void TicBaudRateDetector::start(uint32_t nowMs) {
+    this->locked = false;
+    this->resetWindow(nowMs);
+}
+
+void TicBaudRateDetector::resetWindow(uint32_t nowMs) {
+    this->windowStartMs = nowMs;
+    this->windowStarted = true;
+    this->windowBytes = 0;
+    this->windowLineErrors = 0;
+    this->windowValidDatasets = 0;
+    this->windowValidFrames = 0;
+}
+
+bool TicBaudRateDetector::isValidDataset(unsigned int sum, std::size_t len, uint8_t separator, uint8_t checksum) {
+    if (len < 4) {   /* At least a 1-byte label, a separator, a separator and a checksum */
+        return false;
+    }
+    if (separator == SP) {
+        /* Historical TIC: the checksum covers all bytes up to (but excluding) the separator before the checksum */
+        return (((sum - checksum - separator) & 0x3f) + 0x20 == checksum);
+    }
+    if (separator == HT) {
+        /* Standard TIC: the checksum covers all bytes up to (and including) the separator before the checksum */
+        return (((sum - checksum) & 0x3f) + 0x20 == checksum);
+    }
+    return false;
+}
+
+void TicBaudRateDetector::onDatasetEnd() {
+    bool valid = !this->datasetCorrupted && isValidDataset(this->datasetSum, this->datasetLen, this->datasetLastBytes[0], this->datasetLastBytes[1]);
+    if (valid) {
+        this->windowValidDatasets++;
+        this->frameValidDatasets++;
+    }
+    else {
+        this->frameInvalidDatasets++;
+    }
+}
+
+void TicBaudRateDetector::processByte(uint8_t byte) {
+    byte &= 0x7f;   /* TIC bytes are 7-bit, the MSB (if any) is the parity bit */
+    switch (byte) {
+        case STX:
+            this->inFrame = true;
+            this->inDataset = false;
+            this->frameValidDatasets = 0;
+            this->frameInvalidDatasets = 0;
+            return;
+        case ETX:
+            if (this->inFrame && this->frameValidDatasets > this->frameInvalidDatasets) {
+                this->windowValidFrames++;
+            }
+            this->inFrame = false;
+            this->inDataset = false;
+            return;
+        case EOT:
+            this->inFrame = false;
+            this->inDataset = false;
+            return;
+        case LF:
+            this->inDataset = true;
+            this->datasetSum = 0;
+            this->datasetLen = 0;
+            this->datasetCorrupted = false;
+            return;
+        case CR:
+            if (this->inDataset) {
+                this->onDatasetEnd();
+            }
+            this->inDataset = false;
+            return;
+        default:
+            break;
+    }
+    if (!this->inDataset) {
+        return;
+    }
+    if ((byte < SP && byte != HT) || byte == 0x7f) {
+        this->datasetCorrupted = true;
+    }
+    this->datasetSum += byte;
+    this->datasetLastBytes[0] = this->datasetLastBytes[1];
+    this->datasetLastBytes[1] = byte;
+    this->datasetLen++;
+    if (this->datasetLen > MaxDatasetSize) {
+        this->inDataset = false;
+        this->frameInvalidDatasets++;
+    }
+}
+
+void TicBaudRateDetector::pushBytes(const uint8_t* buf, std::size_t len) {
+    for (std::size_t pos = 0; pos < len; pos++) {
+        this->processByte(buf[pos]);
+    }
+    this->windowBytes += static_cast<unsigned int>(len);
+}
+
+void TicBaudRateDetector::pushLineErrors(unsigned int count) {
+    this->windowLineErrors += count;
+}
+
+void TicBaudRateDetector::switchBaudRate(uint32_t nowMs) {
+    this->baudRate = (this->baudRate == HistoricalBaudRate) ? StandardBaudRate : HistoricalBaudRate;
+    this->switchCount++;
+    this->locked = false;
+    this->inFrame = false;
+    this->inDataset = false;
+    this->resetWindow(nowMs);
+    if (this->onBaudRateChange != nullptr) {
+        this->onBaudRateChange(this->baudRate, this->onBaudRateChangeContext);
+    }
+}
+
+void TicBaudRateDetector::update(uint32_t nowMs) {
+    if (!this->windowStarted) {
+        this->resetWindow(nowMs);
+    }
+    uint32_t elapsedMs = nowMs - this->windowStartMs;
+    bool enoughBytes = (this->windowBytes >= MinBytesForVerdict);
+    bool mostlyLineErrors = enoughBytes && (this->windowLineErrors * 2 > this->windowBytes);
+
+    if (!this->locked) {
+        if (this->windowValidFrames > 0 || this->windowValidDatasets >= ValidDatasetsToLock) {
+            this->locked = true;
+            this->resetWindow(nowMs);
+            return;
+        }
+        bool highErrorRatio = enoughBytes && (this->windowLineErrors * 4 > this->windowBytes);
+        if (highErrorRatio && this->windowValidDatasets == 0) {
+            this->switchBaudRate(nowMs);    /* Obviously garbage, no need to wait for the end of the window */
+            return;
+        }
+        if (elapsedMs >= ProbeWindowMs) {
+            this->switchBaudRate(nowMs);
+        }
+        return;
+    }
+
+    /* Locked */
+    if (elapsedMs < LockedWindowMs) {
+        return;
+    }
+    if (enoughBytes && (this->windowValidDatasets == 0 || mostlyLineErrors)) {
+        this->switchBaudRate(nowMs);    /* Data keeps coming in, but we cannot decode it anymore */
+        return;
+    }
+    this->resetWindow(nowMs);   /* Still fine (or the line is silent, in which case there is no reason to change anything) */
+}
+
+unsigned int TicBaudRateDetector::getBaudRate() const {
+    return this->baudRate;
+}
+
+bool TicBaudRateDetector::isLocked() const {
+    return this->locked;
+}
+
+unsigned int TicBaudRateDetector::getSwitchCount() const {
+    return this->switchCount;
+}
@@ -0,0 +1,158 @@
+#include "TicDatasetStreamDecoder.h"
+
+#include <string.h>
+
+namespace {
+constexpr std::size_t MaxDecimalDigits = 10; /* Enough for any uint32_t */
+}
+
+TicDatasetStreamDecoder::TicDatasetStreamDecoder(FOnDatasetDecodedFunc onDatasetDecoded, void* context) :
+    onDatasetDecoded(onDatasetDecoded),
+    onDatasetDecodedContext(context),
+    inDataset(false),
+    buffer(),
+    size(0),
+    sum(0),
+    separator(0),
+    label(TicLabelTable::Unknown),
+    nbSeparators(0),
+    tooManyFields(false),
+    separatorPos(),
+    fieldValue(),
+    fieldStart(0),
+    currentValue(0),
+    currentNonDigit(false)
+{
+}
+
+void TicDatasetStreamDecoder::reset() {
+    this->inDataset = false;
+}
+
+void TicDatasetStreamDecoder::startDataset() {
+    this->inDataset = true;
+    this->size = 0;
+    this->sum = 0;
+    this->separator = 0;
+    this->label = TicLabelTable::Unknown;
+    this->nbSeparators = 0;
+    this->tooManyFields = false;
+    this->fieldStart = 0;
+    this->currentValue = 0;
+    this->currentNonDigit = false;
+}
+
+void TicDatasetStreamDecoder::pushBytes(const uint8_t* buf, std::size_t len) {
+    std::size_t pos = 0;
+    while (pos < len) {
+        if (!this->inDataset) { /* Skip to the start of the next dataset */
+            const uint8_t* start = static_cast<const uint8_t*>(memchr(buf + pos, StartMarker, len - pos));
+            if (start == nullptr) {
+                return;
+            }
+            pos = static_cast<std::size_t>(start - buf) + 1;
+            this->startDataset();
+            continue;
+        }
+        /* The most frequent case: characters inside a field (markers and separators are all below)
+         * The state is copied to local variables, as writing to buffer could otherwise alias any attribute and force reloading it for each byte */
+        std::size_t size = this->size;
+        uint32_t sum = this->sum;
+        uint64_t value = this->currentValue;
+        bool nonDigit = this->currentNonDigit;
+        while (pos < len && buf[pos] > HistoricalSeparator && size < MaxDatasetSize) {
+            uint8_t byte = buf[pos++];
+            this->buffer[size++] = byte;
+            sum += byte;
+            uint32_t digit = static_cast<uint32_t>(byte) - '0';
+            value = value * 10 + digit;   /* Meaningless if a non-digit has been found, but that is cheaper than testing first */
+            nonDigit |= (digit > 9);
+        }
+        this->size = size;
+        this->sum = sum;
+        this->currentValue = value;
+        this->currentNonDigit = nonDigit;
+        if (pos >= len) {
+            return;
+        }
+
+        uint8_t byte = buf[pos++];
+        if (byte == StartMarker) {
+            this->startDataset();
+        }
+        else if (byte == EndMarker) {
+            this->endDataset();
+        }
+        else if (this->size >= MaxDatasetSize) {
+            this->inDataset = false;    /* Too long, this is not a dataset we can decode */
+        }
+        else {
+            this->buffer[this->size++] = byte;
+            this->sum += byte;
+            if (byte == this->separator || (this->separator == 0 && (byte == StandardSeparator || byte == HistoricalSeparator))) {
+                this->onSeparator(byte);
+            }
+            else {
+                this->currentNonDigit = true;   /* A space inside a standard TIC field, or a control character */
+            }
+        }
+    }
+}
+
+void TicDatasetStreamDecoder::onSeparator(uint8_t separator) {
+    std::size_t separatorPos = this->size - 1;
+    if (this->separator == 0) {   /* End of the label, it also tells us whether this is a standard or historical dataset */
+        this->separator = separator;
+        this->label = TicLabelTable::lookup(this->buffer, separatorPos);
+    }
+    if (this->nbSeparators >= MaxSeparators) {
+        this->tooManyFields = true;
+    }
+    else {
+        std::size_t nbDigits = separatorPos - this->fieldStart;
+        bool isDecimal = (!this->currentNonDigit && nbDigits > 0 && nbDigits <= MaxDecimalDigits && this->currentValue < static_cast<uint32_t>(-1));
+        this->separatorPos[this->nbSeparators] = separatorPos;
+        this->fieldValue[this->nbSeparators] = isDecimal ? static_cast<uint32_t>(this->currentValue) : static_cast<uint32_t>(-1);
+        this->nbSeparators++;
+    }
+    this->fieldStart = this->size;
+    this->currentValue = 0;
+    this->currentNonDigit = false;
+}
+
+void TicDatasetStreamDecoder::endDataset() {
+    this->inDataset = false;
+    DecodedDataset dataset;
+    dataset.isValid = false;
+    dataset.isHistorical = (this->separator == HistoricalSeparator);
+    dataset.label = TicLabelTable::Unknown;
+    dataset.value = static_cast<uint32_t>(-1);
+    dataset.horodate = nullptr;
+    dataset.horodateSz = 0;
+    dataset.buffer = this->buffer;
+    dataset.size = this->size;
+
+    /* The last byte is the checksum, preceded by a separator */
+    if (this->size >= 3 && this->separator != 0 && !this->tooManyFields && this->buffer[this->size - 2] == this->separator) {
+        uint8_t checksum = this->buffer[this->size - 1];
+        unsigned int nbFields = this->nbSeparators;    /* Fields before the checksum, label included */
+        if (this->separatorPos[nbFields - 1] == this->size - 1) {
+            nbFields--; /* The checksum is a space in a historical dataset, it has been taken for a separator */
+        }
+        /* Standard TIC checksums include the separator before the checksum, historical TIC checksums do not */
+        uint32_t checkedSum = this->sum - checksum - (dataset.isHistorical ? this->separator : 0);
+        bool checksumOk = (((checkedSum & 0x3f) + 0x20) == checksum);
+        if (checksumOk && this->separatorPos[0] > 0 && nbFields >= 2 && nbFields <= 3) {
+            dataset.isValid = true;
+            dataset.label = this->label;
+            dataset.value = this->fieldValue[nbFields - 1];
+            if (nbFields == 3) {
+                dataset.horodate = this->buffer + this->separatorPos[0] + 1;
+                dataset.horodateSz = this->separatorPos[1] - this->separatorPos[0] - 1;
+            }
+        }
+    }
+    if (this->onDatasetDecoded != nullptr) {
+        this->onDatasetDecoded(dataset, this->onDatasetDecodedContext);
+    }
+}
@@ -1,15 +1,15 @@
 #include "TicFrameParser.h"
+#include "TicLabelTable.h"
 
 #include <climits>
 #include <string.h>
 #include <utility> // For std::swap()
 
-#ifdef EMBEDDED_DEBUG_CONSOLE
-#include "Stm32DebugOutput.h"
-#endif
+#include "TraceLog.h"
 
 TicEvaluatedPower::TicEvaluatedPower() :
     isValid(false),
+    isExact(false),
     minValue(INT_MIN),
     maxValue(INT_MAX)
 {
@@ -17,6 +17,7 @@ TicEvaluatedPower::TicEvaluatedPower() :
 
 TicEvaluatedPower::TicEvaluatedPower(int minValue, int maxValue) :
     isValid(true),
+    isExact(false),
     minValue(INT_MIN), /* Note: we don't set actual min and max here, but using the utility method setMinMax() below */
     maxValue(INT_MAX)
 {
@@ -65,6 +66,7 @@ std::string TicEvaluatedPower::toString() const {
 
 void TicEvaluatedPower::swapWith(TicEvaluatedPower& other) {
     std::swap(this->isValid, other.isValid);
+    std::swap(this->isExact, other.isExact);
     std::swap(this->minValue, other.minValue);
     std::swap(this->maxValue, other.maxValue);
 }
@@ -84,7 +86,9 @@ TicMeasurements::TicMeasurements() :
     timestamp(),
     instVoltage(static_cast<unsigned int>(-1)),
     instAbsCurrent(static_cast<unsigned int>(-1)),
-    instPower()
+    instPower(),
+    phasePower(),
+    datasets()
 {
 }
 
@@ -93,7 +97,9 @@ TicMeasurements::TicMeasurements(unsigned int fromFrameNb) :
     timestamp(),
     instVoltage(static_cast<unsigned int>(-1)),
     instAbsCurrent(static_cast<unsigned int>(-1)),
-    instPower()
+    instPower(),
+    phasePower(),
+    datasets()
 {
 }
 
@@ -103,6 +109,10 @@ void TicMeasurements::reset() {
     this->instVoltage = static_cast<unsigned int>(-1);
     this->instAbsCurrent = static_cast<unsigned int>(-1);
     this->instPower = TicEvaluatedPower();
+    for (unsigned int phase = 0; phase < MaxPhases; phase++) {
+        this->phasePower[phase] = TicEvaluatedPower();
+    }
+    this->datasets.reset();
 }
 
 void TicMeasurements::swapWith(TicMeasurements& other) {
@@ -112,15 +122,19 @@ void TicMeasurements::swapWith(TicMeasurements& other) {
     std::swap(this->instAbsCurrent, other.instAbsCurrent);
     std::swap(this->maxSubscribedPower, other.maxSubscribedPower);
     std::swap(this->instPower, other.instPower);
+    for (unsigned int phase = 0; phase < MaxPhases; phase++) {
+        std::swap(this->phasePower[phase], other.phasePower[phase]);
+    }
+    std::swap(this->datasets, other.datasets);
 }
 
 void std::swap(TicMeasurements& first, TicMeasurements& second) {
     first.swapWith(second);
 }
 
-TicFrameParser::TicFrameParser(FOnNewPowerDataFunc onNewPowerData, void* onNewPowerDataContext) :
-    onNewPowerData(onNewPowerData),
-    onNewPowerDataContext(onNewPowerDataContext),
+TicFrameParser::TicFrameParser(FOnNewFrameMeasurementsFunc onNewFrameMeasurements, void* onNewFrameMeasurementsContext) :
+    onNewFrameMeasurements(onNewFrameMeasurements),
+    onNewFrameMeasurementsContext(onNewFrameMeasurementsContext),
     onDayOverFunc(nullptr),
     onDayOverFuncContext(nullptr),
     onDatasetErrorFunc(nullptr),
@@ -129,117 +143,220 @@ TicFrameParser::TicFrameParser(FOnNewPowerDataFunc onNewPowerData, void* onNewPo
     currentTimeGetterFuncContext(nullptr),
     nbFramesParsed(0),
     de(ticFrameParserUnWrapDatasetExtractor, this),
+    sd(unwrapInvokeOnDatasetDecoded, this),
+    streamingDecoding(true),
+    currentFrameMeasurements(),
     lastFrameMeasurements(),
-    lastKnownMaxPower(0)
+    lastKnownMaxPower(0),
+    powerKnownForCurrentFrame(false),
+    mayInject(false),
+    energyEstimator(),
+    datasetsInFrame(0),
+    inFrame(false),
+    frameAborted(false),
+    errorStats()
 {
 }
 
 #define RESET 0
 #define WITHDRAWN_POWER 1
-#define RMS_VOLTAGE 2
-#define ABS_CURRENT 3
+#define PHASE_MEASUREMENT 2
+#define FRAME_COMPLETE 3
+
+namespace {
+/* The per-phase labels, indexed by phase */
+const TicLabelTable::Label phaseVoltageLabels[TicMeasurements::MaxPhases] = { TicLabelTable::URMS1, TicLabelTable::URMS2, TicLabelTable::URMS3 };
+const TicLabelTable::Label phaseCurrentLabels[TicMeasurements::MaxPhases] = { TicLabelTable::IRMS1, TicLabelTable::IRMS2, TicLabelTable::IRMS3 };
+const TicLabelTable::Label phaseWithdrawnPowerLabels[TicMeasurements::MaxPhases] = { TicLabelTable::SINSTS1, TicLabelTable::SINSTS2, TicLabelTable::SINSTS3 };
+
+/* The largest values the meter can send, given the number of digits of these datasets. Larger values can only come from corrupted datasets that
+   still have a valid checksum, they are ignored. This also keeps power computations (3 phases of voltage*current) far from int overflows */
+const uint32_t MaxWithdrawnPower = 99999; /* SINSTS, SINSTSx and PAPP have 5 digits, in VA */
+const uint32_t MaxPhaseVoltage = 999; /* URMSx has 3 digits, in V */
+const uint32_t MaxPhaseCurrent = 999; /* IRMSx has 3 digits, in A */
+
+/**
+ * @brief Get the phase index a per-phase label relates to
+ *
+ * @return The phase index (0 to TicMeasurements::MaxPhases-1), or 0 if @p label is not a per-phase label
+ */
+unsigned int getPhaseIndex(TicLabelTable::Label label) {
+    for (unsigned int phase = 0; phase < TicMeasurements::MaxPhases; phase++) {
+        if (label == phaseVoltageLabels[phase] || label == phaseCurrentLabels[phase] || label == phaseWithdrawnPowerLabels[phase]) {
+            return phase;
+        }
+    }
+    return 0;
+}
+}
 
 void TicFrameParser::onNewWithdrawnPowerMesurement(uint32_t power) {
     this->onNewMeasurementAvailable();
     this->mayComputePower(WITHDRAWN_POWER, static_cast<unsigned int>(power));
+    if (this->getPhaseCount() == 1) {
+        this->onNewPhaseMeasurement(0); /* On single-phase meters, the total withdrawn power is also phase 1's */
+    }
 }
 
-void TicFrameParser::mayComputePower(unsigned int source, unsigned int value) {
-    static bool powerKnownForCurrentFrame = false;
-    static bool mayInject = false;
-    static unsigned int knownRmsVoltage = static_cast<unsigned int>(-1);
-    static unsigned int knownAbsCurrent = static_cast<unsigned int>(-1);
+void TicFrameParser::onNewPhaseMeasurement(unsigned int phase) {
+    this->onNewMeasurementAvailable();
+    TicEvaluatedPower power;
+    if (this->evaluatePhasePower(phase, false, power)) {
+        this->currentFrameMeasurements.phasePower[phase] = power;
+    }
+    this->mayComputePower(PHASE_MEASUREMENT, phase);
+}
+
+unsigned int TicFrameParser::getPhaseCount() const {
+    const TicFrameRecord& datasets = this->currentFrameMeasurements.datasets;
+    for (unsigned int phase = 1; phase < TicMeasurements::MaxPhases; phase++) {
+        if (datasets.has(phaseVoltageLabels[phase]) || datasets.has(phaseCurrentLabels[phase]) || datasets.has(phaseWithdrawnPowerLabels[phase])) {
+            return TicMeasurements::MaxPhases;
+        }
+    }
+    return 1;
+}
+
+bool TicFrameParser::evaluatePhasePower(unsigned int phase, bool frameComplete, TicEvaluatedPower& power) const {
+    const TicFrameRecord& datasets = this->currentFrameMeasurements.datasets;
+    uint32_t withdrawnPower;
+    if (this->getPhaseCount() > 1) {
+        withdrawnPower = datasets.getValue(phaseWithdrawnPowerLabels[phase]);
+    }
+    else if (phase == 0) {
+        withdrawnPower = datasets.has(TicLabelTable::SINSTS) ? datasets.getValue(TicLabelTable::SINSTS) : datasets.getValue(TicLabelTable::PAPP);
+    }
+    else {
+        return false;
+    }
+    if (withdrawnPower != static_cast<uint32_t>(-1) && withdrawnPower > MaxWithdrawnPower) {
+        return false;
+    }
+    if (withdrawnPower != static_cast<uint32_t>(-1) && withdrawnPower > 0) {
+        power.set(static_cast<int>(withdrawnPower));
+        return true;
+    }
+    /* Withdrawn power is 0 (we may actually inject) or unknown, use voltage and current */
+    uint32_t urms = datasets.getValue(phaseVoltageLabels[phase]);
+    uint32_t irms = datasets.getValue(phaseCurrentLabels[phase]);
+    if (urms == static_cast<uint32_t>(-1) || irms == static_cast<uint32_t>(-1) || urms > MaxPhaseVoltage || irms > MaxPhaseCurrent) {
+        return false;
+    }
+    /* We have both voltage and current, we can grossly approximate the power (the current is rounded to the nearest Ampere) */
+    unsigned int avg = irms * urms;
+    unsigned int min = 0;
+    if (avg >= urms/2) {
+        min = avg - urms/2;
+    }
+    /* If average - urms/2 becomes negative, assume a minimum power of 0 instead of that negative value */
+    unsigned int max = avg + urms/2;
+    if (withdrawnPower == 0) {
+        power.setMinMax(-static_cast<int>(max), -static_cast<int>(min)); /* min and max are *positive* minimum and maximum injected power values, we thus negate them */
+        return true;
+    }
+    if (frameComplete) {
+        power.setMinMax(-static_cast<int>(max), static_cast<int>(max)); /* No withdrawn power in this frame, this phase may be withdrawing or injecting */
+        return true;
+    }
+    return false; /* The withdrawn power may still come later in this frame */
+}
+
+bool TicFrameParser::getEnergyIndexes(uint32_t& withdrawnIndex, uint32_t& injectedIndex) const {
+    const TicFrameRecord& datasets = this->currentFrameMeasurements.datasets;
+    if (datasets.has(TicLabelTable::EAST)) {   /* Standard TIC */
+        withdrawnIndex = datasets.getValue(TicLabelTable::EAST);
+        injectedIndex = datasets.has(TicLabelTable::EAIT) ? datasets.getValue(TicLabelTable::EAIT) : 0;
+        return true;
+    }
+    /* Historical TIC, only one of these indices increases at a time, depending on the tariff period */
+    const TicLabelTable::Label historicalIndexLabels[] = { TicLabelTable::BASE, TicLabelTable::HCHC, TicLabelTable::HCHP };
+    bool found = false;
+    withdrawnIndex = 0;
+    injectedIndex = 0;
+    for (TicLabelTable::Label label : historicalIndexLabels) {
+        if (datasets.has(label)) {
+            withdrawnIndex += datasets.getValue(label);
+            found = true;
+        }
+    }
+    return found;
+}
 
+void TicFrameParser::mayComputePower(unsigned int source, unsigned int value) {
     if (source == RESET) {
-        if (!powerKnownForCurrentFrame) {
+        if (!this->powerKnownForCurrentFrame) {
            //this->ctx.tic.lastValidWithdrawnPower = INT32_MIN; /* Unknown power */
         }
-        powerKnownForCurrentFrame = false;
-        mayInject = false;
-        knownRmsVoltage = static_cast<unsigned int>(-1);
-        knownAbsCurrent = static_cast<unsigned int>(-1);
+        this->powerKnownForCurrentFrame = false;
+        this->mayInject = false;
         return;
     }
-    if (powerKnownForCurrentFrame)
+    if (this->powerKnownForCurrentFrame)
         return;
 
     if (source == WITHDRAWN_POWER) {
+        if (value > MaxWithdrawnPower) {
+            return;
+        }
         if (value > 0) {
-            powerKnownForCurrentFrame = true;
+            this->powerKnownForCurrentFrame = true;
             this->onNewComputedPower(value, value);
             return;
         }
         else { /* Withdrawn power is 0, we may actually inject */
-            mayInject = true;
+            this->mayInject = true;
         }
     }
-    else if (source == RMS_VOLTAGE) {
-        knownRmsVoltage = value;
-    }
-    else if (source == ABS_CURRENT) {
-        knownAbsCurrent = value;
-    }
-    if (!powerKnownForCurrentFrame &&
-        mayInject &&
-        knownRmsVoltage != static_cast<unsigned int>(-1) &&
-        knownAbsCurrent != static_cast<unsigned int>(-1)) {
-        /* We are able to estimate the injected power */
-        /* We have both voltage and current, we can grossly approximate the power (withdrawn or injected) */
-        unsigned int& urms = knownRmsVoltage;
-        unsigned int& irms = knownAbsCurrent;
-        unsigned int avg = irms * urms;
-        unsigned int min = 0;
-        if (avg >= urms/2) {
-            min = avg - urms/2;
-        }
-        /* If average - urms/2 becomes negative, assume a minimum power of 0 instead of that negative value */
-
-        unsigned int max = avg + urms/2;
-        
-        powerKnownForCurrentFrame = true;
-        this->onNewComputedPower(-max, -min); /* min and max are *positive* minimum and maximum injected power values, we thus negate them before storing in the instantaneous power */
+    if (!this->mayInject) {
         return;
     }
+    /* We are able to estimate the injected power once we have an evaluation for each phase */
+    /* Bounds add up: the total is within the sum of the per-phase minimums and the sum of the per-phase maximums */
+    int minTotal = 0;
+    int maxTotal = 0;
+    unsigned int nbPhases = this->getPhaseCount();
+    for (unsigned int phase = 0; phase < nbPhases; phase++) {
+        TicEvaluatedPower phasePower;
+        if (!this->evaluatePhasePower(phase, (source == FRAME_COMPLETE), phasePower)) {
+            return; /* Still missing data for this phase */
+        }
+        minTotal += phasePower.minValue;
+        maxTotal += phasePower.maxValue;
+    }
+    if (maxTotal > 0) {
+        maxTotal = 0;   /* The total withdrawn power is 0, so we are not withdrawing overall */
+    }
+    if (minTotal > maxTotal) {
+        minTotal = maxTotal;
+    }
+    this->powerKnownForCurrentFrame = true;
+    this->onNewComputedPower(minTotal, maxTotal);
 }
 
 void TicFrameParser::onNewMeasurementAvailable() {
-    if (this->lastFrameMeasurements.fromFrameNb != this->nbFramesParsed) {
-        TicMeasurements blankMeasurements(this->nbFramesParsed);
-        std::swap(this->lastFrameMeasurements, blankMeasurements);  /* Create a new empty measurement datastore for the new frame */
+    if (this->currentFrameMeasurements.fromFrameNb != this->nbFramesParsed) {
+        this->currentFrameMeasurements.reset();  /* Start from an empty measurement datastore for the new frame (constant-time, labels values are only flagged as absent) */
+        this->currentFrameMeasurements.fromFrameNb = this->nbFramesParsed;
         mayComputePower(RESET, 0); /* Reset the computed power, we will need to collect all data again from the new frame */
     }
 }
 
 void TicFrameParser::onNewDate(const TIC::Horodate& horodate) {
     this->onNewMeasurementAvailable();
-    this->lastFrameMeasurements.timestamp = TimeOfDay(horodate);
+    this->currentFrameMeasurements.timestamp = TimeOfDay(horodate);
 }
 
 void TicFrameParser::guessFrameArrivalTime() {
     this->onNewMeasurementAvailable();
-    if (this->lastFrameMeasurements.fromFrameNb != this->nbFramesParsed) {
-#ifdef EMBEDDED_DEBUG_CONSOLE
-        Stm32DebugOutput::get().send("It seems we are in a new frame ID ");
-        Stm32DebugOutput::get().send(static_cast<unsigned int>(this->nbFramesParsed));
-        Stm32DebugOutput::get().send("\n");
-#endif
+    if (this->currentFrameMeasurements.fromFrameNb != this->nbFramesParsed) {
+        TRACE(NewFrameId, this->nbFramesParsed);
     }
     if (this->currentTimeGetterFunc) {
-        this->lastFrameMeasurements.timestamp = this->currentTimeGetterFunc(this->currentTimeGetterFuncContext);
-#ifdef EMBEDDED_DEBUG_CONSOLE
-        Stm32DebugOutput::get().send("Using systemtime (");
-        Stm32DebugOutput::get().send(static_cast<unsigned int>(this->lastFrameMeasurements.timestamp.hour));
-        Stm32DebugOutput::get().send(":");
-        Stm32DebugOutput::get().send(static_cast<unsigned int>(this->lastFrameMeasurements.timestamp.minute));
-        Stm32DebugOutput::get().send(":");
-        Stm32DebugOutput::get().send(static_cast<unsigned int>(this->lastFrameMeasurements.timestamp.second));
-        Stm32DebugOutput::get().send(") as horodate\n");
-#endif
+        this->currentFrameMeasurements.timestamp = this->currentTimeGetterFunc(this->currentTimeGetterFuncContext);
+        TRACE(SystemTimeAsHorodate, this->currentFrameMeasurements.timestamp.hour, this->currentFrameMeasurements.timestamp.minute, this->currentFrameMeasurements.timestamp.second);
     }
     else {
-#ifdef EMBEDDED_DEBUG_CONSOLE
-        Stm32DebugOutput::get().send("Missing time getter\n");
-#endif
+        TRACE(MissingTimeGetter);
     }
 }
 
@@ -248,6 +365,16 @@ void TicFrameParser::invokeWhenDayOver(FOnDayOverFunc dayOverFunc, void* context
     this->onDayOverFuncContext = context;
 }
 
+void TicFrameParser::setStreamingDecoding(bool enabled) {
+    this->streamingDecoding = enabled;
+    this->de.reset();
+    this->sd.reset();
+}
+
+DatasetErrorStats::Snapshot TicFrameParser::getDatasetErrorStats() const {
+    return this->errorStats.getSnapshot();
+}
+
 void TicFrameParser::invokeOnDatasetError(FOnDatasetErrorFunc datasetErrorFunc, void* context) {
     this->onDatasetErrorFunc = datasetErrorFunc;
     this->onDatasetErrorFuncContext = context;
@@ -264,9 +391,7 @@ void TicFrameParser::onRefPowerInfo(uint32_t power) {
 
 void TicFrameParser::onMaxPowerInfo(uint32_t maxPower) {
     if (maxPower < this->lastKnownMaxPower) { /* Daily max power reduces (probably 0), this means we are starting a new day, we are at midnight */
-#ifdef EMBEDDED_DEBUG_CONSOLE
-        Stm32DebugOutput::get().send("Switch to new day detected\n");
-#endif
+        TRACE(NewDayDetected);
         if (this->onDayOverFunc) {
             this->onDayOverFunc(this->onDayOverFuncContext);
         }
@@ -276,142 +401,205 @@ void TicFrameParser::onMaxPowerInfo(uint32_t maxPower) {
 
 void TicFrameParser::onNewInstVoltageMeasurement(uint32_t voltage) {
     this->onNewMeasurementAvailable();
-    this->lastFrameMeasurements.instVoltage = voltage;
-    this->mayComputePower(RMS_VOLTAGE, static_cast<unsigned int>(voltage));
+    this->currentFrameMeasurements.instVoltage = voltage;
+    this->onNewPhaseMeasurement(0);
 }
 
 void TicFrameParser::onNewInstCurrentMeasurement(uint32_t current) {
     this->onNewMeasurementAvailable();
-    this->lastFrameMeasurements.instAbsCurrent = current;
-    this->mayComputePower(ABS_CURRENT, static_cast<unsigned int>(current));
+    this->currentFrameMeasurements.instAbsCurrent = current;
+    this->onNewPhaseMeasurement(0);
 }
 
 void TicFrameParser::onNewFrameBytes(const uint8_t* buf, unsigned int cnt) {
-    this->de.pushBytes(buf, cnt);   /* Forward the bytes to the dataset extractor */
+    this->inFrame = true;
+    if (this->frameAborted) {
+        return; /* The rest of an aborted frame */
+    }
+    if (this->streamingDecoding) {
+        this->sd.pushBytes(buf, cnt);   /* Decode datasets as their bytes arrive */
+    }
+    else {
+        this->de.pushBytes(buf, cnt);   /* Forward the bytes to the dataset extractor */
+    }
 }
 
 void TicFrameParser::onNewComputedPower(int minValue, int maxValue) {
     
-#ifdef EMBEDDED_DEBUG_CONSOLE
-    Stm32DebugOutput::get().send("onNewComputedPower(");
-    if (minValue != maxValue)
-        Stm32DebugOutput::get().send("[");
-    {
-        if (minValue < 0) {
-            Stm32DebugOutput::get().send("-");
-            Stm32DebugOutput::get().send(static_cast<unsigned int>(-minValue));
-        }
-        else {
-            Stm32DebugOutput::get().send(static_cast<unsigned int>(minValue));
-        }
+    TRACE(NewComputedPower, minValue, maxValue, this->currentFrameMeasurements.timestamp.isValid);
+    this->currentFrameMeasurements.instPower.setMinMax(minValue, maxValue); /* Published with the whole frame, in onFrameComplete() */
+}
+
+void TicFrameParser::onFrameComplete() {
+    if (this->frameAborted) {
+        /* End of an aborted frame, everything it contained was already dropped in abortFrame() */
+        this->frameAborted = false;
+        this->inFrame = false;
+        this->errorStats.onFrameComplete();
+        return;
     }
-    if (minValue != maxValue) {
-        Stm32DebugOutput::get().send(";");
-        if (maxValue < 0) {
-            Stm32DebugOutput::get().send("-");
-            Stm32DebugOutput::get().send(static_cast<unsigned int>(-maxValue));
+    if (this->currentFrameMeasurements.fromFrameNb == this->nbFramesParsed) {
+        /* Evaluate phases with a missing withdrawn power, now that we know it will not come */
+        for (unsigned int phase = 0; phase < this->getPhaseCount(); phase++) {
+            if (!this->currentFrameMeasurements.phasePower[phase].isValid) {
+                this->evaluatePhasePower(phase, true, this->currentFrameMeasurements.phasePower[phase]);
+            }
         }
-        else {
-            Stm32DebugOutput::get().send(static_cast<unsigned int>(maxValue));
+        this->mayComputePower(FRAME_COMPLETE, 0);
+        uint32_t withdrawnIndex;
+        uint32_t injectedIndex;
+        if (this->getEnergyIndexes(withdrawnIndex, injectedIndex)) {
+            TicMeasurements& measurements = this->currentFrameMeasurements;
+            if (measurements.instPower.isValid && !measurements.instPower.isExact) {
+                /* Narrow the range using the average power given by the energy indices over the last frames */
+                this->energyEstimator.refine(measurements.timestamp, withdrawnIndex, injectedIndex, measurements.instPower);
+            }
+            this->energyEstimator.onNewIndexes(measurements.timestamp, withdrawnIndex, injectedIndex);
+        }
+        /* Commit the whole frame at once, lastFrameMeasurements then remains unchanged until the next frame is complete */
+        std::swap(this->lastFrameMeasurements, this->currentFrameMeasurements);
+        if (this->onNewFrameMeasurements != nullptr) {
+            this->onNewFrameMeasurements(this->lastFrameMeasurements, this->onNewFrameMeasurementsContext);
         }
-        Stm32DebugOutput::get().send("]");
-    }
-    Stm32DebugOutput::get().send("W) with ");
-    if (this->lastFrameMeasurements.timestamp.isValid) {
-        Stm32DebugOutput::get().send("a valid");
-    }
-    else {
-        Stm32DebugOutput::get().send("no");
-    }
-    Stm32DebugOutput::get().send("horodate\n");
-#endif
-    this->lastFrameMeasurements.instPower.setMinMax(minValue, maxValue);
-    if (this->onNewPowerData != nullptr) {
-        this->onNewPowerData(this->lastFrameMeasurements.instPower, this->lastFrameMeasurements.timestamp, this->nbFramesParsed, onNewPowerDataContext);
     }
+    this->de.reset();
+    this->sd.reset();
+    this->errorStats.onFrameComplete();
+    this->datasetsInFrame = 0;
+    this->inFrame = false;
+    this->nbFramesParsed++;
 }
 
-void TicFrameParser::onFrameComplete() {
+void TicFrameParser::abortFrame() {
+    this->currentFrameMeasurements.reset();   /* Its frame number is reset too, so that the next frame starts from scratch */
+    this->mayComputePower(RESET, 0);
     this->de.reset();
-    this->nbFramesParsed++;
+    this->sd.reset();
+    this->datasetsInFrame = 0;
+    /* If we were not inside a frame, the bytes that were lost did not belong to any frame we started, so the next frame is kept */
+    this->frameAborted = this->inFrame;
+}
+
+void TicFrameParser::onDatasetError(const uint8_t* buf, std::size_t len) {
+    TicLabelTable::Label label = DatasetErrorStats::findLabel(buf, len);
+    TRACE(DatasetError, label, this->datasetsInFrame - 1);
+    if (this->errorStats.onDatasetError(label, this->datasetsInFrame - 1)) {
+        TRACE(DatasetErrorBurst, this->nbFramesParsed, this->errorStats.stats.lastBurst.errorCount);
+    }
+    if (this->onDatasetErrorFunc) {
+        this->onDatasetErrorFunc(this->onDatasetErrorFuncContext);
+    }
 }
 
 void TicFrameParser::onDatasetExtracted(const uint8_t* buf, unsigned int cnt) {
     /* This is our actual parsing of a newly received dataset */
     //std::cout << "Entering TicFrameParser::onDatasetExtracted() with a " << std::dec << cnt << " byte(s) long dataset\n";
 
-#ifdef EMBEDDED_DEBUG_CONSOLE
-    Stm32DebugOutput::get().send("onDatasetExtracted() called with ");
-    Stm32DebugOutput::get().send(static_cast<unsigned int>(cnt));
-    Stm32DebugOutput::get().send(" bytes\n");
-#endif
+    TRACE(DatasetExtracted, cnt);
+    this->datasetsInFrame++;
     TIC::DatasetView dv(buf, cnt);    /* Decode the TIC dataset using a dataset view object */
-#ifdef EMBEDDED_DEBUG_CONSOLE
     if (dv.decodedType == TIC::DatasetView::WrongCRC) {
-        Stm32DebugOutput::get().send("Dataset has wrong CRC\n");
+        TRACE(DatasetWrongCrc);
     }
-#endif
     //std::cout << "Above dataset is " << std::string(dv.isValid()?"":"in") << "valid\n";
     if (!dv.isValid()) {
-        if (this->onDatasetErrorFunc) {
-            this->onDatasetErrorFunc(this->onDatasetErrorFuncContext);
-        }
+        this->onDatasetError(buf, cnt);
     }
     else {
-#ifdef EMBEDDED_DEBUG_CONSOLE
-        Stm32DebugOutput::get().send("New dataset: ");
-        Stm32DebugOutput::get().send(dv.labelBuffer, dv.labelSz);
-        Stm32DebugOutput::get().send("\n");
-#endif
+        TicLabelTable::Label label = TicLabelTable::lookup(dv.labelBuffer, dv.labelSz);  /* O(1) dispatch, unknown labels are rejected after at most one comparison */
+        TRACE(NewDataset, label);
         if (dv.decodedType == TIC::DatasetView::ValidHistorical) {  /* In this case, we will have no horodate, evaluate time instead */
-#ifdef EMBEDDED_DEBUG_CONSOLE
-            Stm32DebugOutput::get().send("Dataset above is following historical format\n");
-#endif
+            TRACE(HistoricalDataset);
             this->guessFrameArrivalTime();
         }
         //std::vector<uint8_t> datasetLabel(dv.labelBuffer, dv.labelBuffer+dv.labelSz);
         //std::cout << "Dataset has label \"" << std::string(datasetLabel.begin(), datasetLabel.end()) << "\"\n";
-        if (dv.labelEquals("DATE")) {
-            if (dv.horodate.isValid) {
-                this->onNewDate(dv.horodate);
-            }
+        if (label != TicLabelTable::Unknown) {
+            this->onNewMeasurementAvailable();
+            this->currentFrameMeasurements.datasets.store(label, dv);
         }
-        /* Search for withdrawn power labels */
-        else if (dv.labelEquals("SINSTS") || dv.labelEquals("PAPP")) {
-            //std::cout << "Found inst power dataset\n";
-            if (dv.dataSz > 0) {
-                //std::vector<uint8_t> datasetValue(dv.dataBuffer, dv.dataBuffer+dv.dataSz);
-                //std::cout << "Power data received: \"" << std::string(datasetValue.begin(), datasetValue.end()) << "\"\n";
-                uint32_t withdrawnPower = dv.dataToUint32();
-                //std::cout << "interpreted as " << withdrawnPower << "W\n";
-                if (withdrawnPower != (uint32_t)-1)
-                    this->onNewWithdrawnPowerMesurement(withdrawnPower);
+        this->onNewDatasetValue(label, (dv.dataSz > 0) ? dv.dataToUint32() : static_cast<uint32_t>(-1), dv.horodate);
+    }
+}
+
+void TicFrameParser::onDatasetDecoded(const TicDatasetStreamDecoder::DecodedDataset& dataset) {
+    this->datasetsInFrame++;
+    if (!dataset.isValid) {
+        TRACE(MalformedDataset);
+        this->onDatasetError(dataset.buffer, dataset.size);
+        return;
+    }
+    TRACE(NewDataset, dataset.label);
+    if (dataset.isHistorical) {  /* In this case, we will have no horodate, evaluate time instead */
+        TRACE(HistoricalDataset);
+        this->guessFrameArrivalTime();
+    }
+    if (dataset.label != TicLabelTable::Unknown) {
+        this->onNewMeasurementAvailable();
+        TicFrameRecord::ValueKind kind = TicFrameRecord::getValueKind(dataset.label);
+        if (kind == TicFrameRecord::Decimal) {
+            if (dataset.value != static_cast<uint32_t>(-1)) {
+                this->currentFrameMeasurements.datasets.setValue(dataset.label, dataset.value);  /* Already decoded while streaming, no second pass */
             }
         }
-        /* Search for rms voltage value */
-        else if (dv.labelEquals("URMS1")) {
-            uint32_t urms1 = dv.dataToUint32();
-            if (urms1 != (uint32_t)-1)
-                this->onNewInstVoltageMeasurement(urms1);
-        }
-        /* Search for rms current value */
-        else if (dv.labelEquals("IRMS1")) {
-            uint32_t irms1 = dv.dataToUint32();
-            if (irms1 != (uint32_t)-1)
-                this->onNewInstCurrentMeasurement(irms1);
-        }
-        /* Search for PREF */
-        else if (dv.labelEquals("PREF")) {
-            uint32_t pref = dv.dataToUint32();
-            if (pref != (uint32_t)-1)
-                this->onRefPowerInfo(pref);
-        }
-        else if (dv.labelEquals("PMAX") || dv.labelEquals("SMAXSN")) {
-            uint32_t pmax = dv.dataToUint32();
-            if (pmax != (uint32_t)-1)
-                this->onMaxPowerInfo(pmax);
+        else if (kind != TicFrameRecord::NotStored) {
+            this->currentFrameMeasurements.datasets.store(dataset.label, TIC::DatasetView(dataset.buffer, dataset.size));   /* Text or hexadecimal values, only a few per frame */
         }
     }
+    TIC::Horodate horodate;
+    if (dataset.label == TicLabelTable::DATE && dataset.horodate != nullptr) {
+        horodate = TIC::Horodate::fromLabelBytes(dataset.horodate, static_cast<unsigned int>(dataset.horodateSz));
+    }
+    this->onNewDatasetValue(dataset.label, dataset.value, horodate);
+}
+
+void TicFrameParser::onNewDatasetValue(TicLabelTable::Label label, uint32_t value, const TIC::Horodate& horodate) {
+    switch (label) {
+        case TicLabelTable::DATE:
+            if (horodate.isValid) {
+                this->onNewDate(horodate);
+            }
+            break;
+        /* Withdrawn power labels */
+        case TicLabelTable::SINSTS:
+        case TicLabelTable::PAPP:
+            if (value != (uint32_t)-1)
+                this->onNewWithdrawnPowerMesurement(value);
+            break;
+        /* Per-phase values (three-phase meters), already stored in the frame's datasets */
+        case TicLabelTable::SINSTS1:
+        case TicLabelTable::IRMS2:
+        case TicLabelTable::URMS2:
+        case TicLabelTable::SINSTS2:
+        case TicLabelTable::IRMS3:
+        case TicLabelTable::URMS3:
+        case TicLabelTable::SINSTS3:
+            if (this->currentFrameMeasurements.datasets.has(label)) {
+                this->onNewPhaseMeasurement(getPhaseIndex(label));
+            }
+            break;
+        /* Rms voltage value */
+        case TicLabelTable::URMS1:
+            if (value != (uint32_t)-1)
+                this->onNewInstVoltageMeasurement(value);
+            break;
+        /* Rms current value */
+        case TicLabelTable::IRMS1:
+            if (value != (uint32_t)-1)
+                this->onNewInstCurrentMeasurement(value);
+            break;
+        case TicLabelTable::PREF:
+            if (value != (uint32_t)-1)
+                this->onRefPowerInfo(value);
+            break;
+        case TicLabelTable::PMAX:
+        case TicLabelTable::SMAXSN:
+            if (value != (uint32_t)-1)
+                this->onMaxPowerInfo(value);
+            break;
+        default:
+            break;  /* A label we do not use */
+    }
 }
 
 void TicFrameParser::unwrapInvokeOnFrameNewBytes(const uint8_t* buf, unsigned int cnt, void* context) {
@@ -442,3 +630,10 @@ void TicFrameParser::ticFrameParserUnWrapDatasetExtractor(const uint8_t* buf, un
     /* We have finished parsing a frame, if there is an open dataset, we should discard it and start over at the following frame */
     ticFrameParserInstance->onDatasetExtracted(buf, cnt);
 }
+
+void TicFrameParser::unwrapInvokeOnDatasetDecoded(const TicDatasetStreamDecoder::DecodedDataset& dataset, void* context) {
+    if (context == nullptr)
+        return; /* Failsafe, discard if no context */
+    TicFrameParser* ticFrameParserInstance = static_cast<TicFrameParser*>(context);
+    ticFrameParserInstance->onDatasetDecoded(dataset);
+}
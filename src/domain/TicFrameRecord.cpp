@@ -0,0 +1,186 @@
+#include "TicFrameRecord.h"
+
+#include <string.h>
+#include <utility> // For std::swap()
+
+namespace {
+/**
+ * @brief Parse an unsigned hexadecimal value (such as STGE)
+ *
+ * @param buf The hexadecimal digits
+ * @param len The number of digits in @p buf
+ * @param[out] value The parsed value
+ * @return false if the text is empty, too long or not hexadecimal
+ */
+bool hexToUint32(const uint8_t* buf, std::size_t len, uint32_t& value) {
+    if (buf == nullptr || len == 0 || len > 8) {
+        return false;
+    }
+    value = 0;
+    for (std::size_t pos = 0; pos < len; pos++) {
+        uint8_t c = buf[pos];
+        uint32_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        }
+        else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        }
+        else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        }
+        else {
+            return false;
+        }
+        value = (value << 4) | digit;
+    }
+    return true;
+}
+} // namespace
+
+TicFrameRecord::TicFrameRecord() :
+    presence(),
+    values(),
+    texts()
+{
+}
+
+void TicFrameRecord::reset() {
+    for (std::size_t word = 0; word < PresenceWordCount; word++) {
+        this->presence[word] = 0;
+    }
+}
+
+void TicFrameRecord::swapWith(TicFrameRecord& other) {
+    std::swap(this->presence, other.presence);
+    std::swap(this->values, other.values);
+    std::swap(this->texts, other.texts);
+}
+
+void std::swap(TicFrameRecord& first, TicFrameRecord& second) {
+    first.swapWith(second);
+}
+
+bool TicFrameRecord::has(TicLabelTable::Label label) const {
+    if (label >= TicLabelTable::LabelCount) {
+        return false;
+    }
+    return (this->presence[label / 32] & (static_cast<uint32_t>(1) << (label % 32))) != 0;
+}
+
+unsigned int TicFrameRecord::getCount() const {
+    unsigned int count = 0;
+    for (std::size_t word = 0; word < PresenceWordCount; word++) {
+        count += __builtin_popcount(this->presence[word]);
+    }
+    return count;
+}
+
+uint32_t TicFrameRecord::getValue(TicLabelTable::Label label) const {
+    ValueKind kind = getValueKind(label);
+    if ((kind != Decimal && kind != Hexadecimal) || !this->has(label)) {
+        return static_cast<uint32_t>(-1);
+    }
+    return this->values[label];
+}
+
+const char* TicFrameRecord::getText(TicLabelTable::Label label) const {
+    std::size_t slot = getTextSlot(label);
+    if (slot == TextSlotCount || !this->has(label)) {
+        return nullptr;
+    }
+    return this->texts[slot];
+}
+
+bool TicFrameRecord::setValue(TicLabelTable::Label label, uint32_t value) {
+    ValueKind kind = getValueKind(label);
+    if (kind != Decimal && kind != Hexadecimal) {
+        return false;
+    }
+    this->values[label] = value;
+    this->markPresent(label);
+    return true;
+}
+
+bool TicFrameRecord::setText(TicLabelTable::Label label, const uint8_t* text, std::size_t len) {
+    std::size_t slot = getTextSlot(label);
+    if (slot == TextSlotCount || len > MaxTextSize || (text == nullptr && len != 0)) {
+        return false;
+    }
+    if (len > 0) {
+        memcpy(this->texts[slot], text, len);
+    }
+    this->texts[slot][len] = '\0';
+    this->markPresent(label);
+    return true;
+}
+
+bool TicFrameRecord::store(TicLabelTable::Label label, const TIC::DatasetView& dv) {
+    switch (getValueKind(label)) {
+        case Decimal: {
+            uint32_t value = dv.dataToUint32();
+            if (value == static_cast<uint32_t>(-1)) {
+                return false;
+            }
+            return this->setValue(label, value);
+        }
+        case Hexadecimal: {
+            uint32_t value;
+            if (!hexToUint32(dv.dataBuffer, dv.dataSz, value)) {
+                return false;
+            }
+            return this->setValue(label, value);
+        }
+        case Text:
+            return this->setText(label, dv.dataBuffer, dv.dataSz);
+        default:
+            return false;
+    }
+}
+
+TicFrameRecord::ValueKind TicFrameRecord::getValueKind(TicLabelTable::Label label) {
+    switch (label) {
+        case TicLabelTable::Unknown:
+        case TicLabelTable::DATE:
+        case TicLabelTable::MSG1:
+        case TicLabelTable::MSG2:
+        case TicLabelTable::PJOURF_P1:
+        case TicLabelTable::PPOINTE:
+        case TicLabelTable::ADCO:   /* 12 digits, more than a uint32_t */
+        case TicLabelTable::OPTARIF:
+        case TicLabelTable::PTEC:
+        case TicLabelTable::DEMAIN:
+        case TicLabelTable::HHPHC:
+        case TicLabelTable::MOTDETAT:
+        case TicLabelTable::LabelCount:
+            return NotStored;
+        case TicLabelTable::ADSC:
+        case TicLabelTable::PRM:
+        case TicLabelTable::NGTF:
+        case TicLabelTable::LTARF:
+            return Text;
+        case TicLabelTable::STGE:
+            return Hexadecimal;
+        default:
+            return (label < TicLabelTable::LabelCount) ? Decimal : NotStored;
+    }
+}
+
+std::size_t TicFrameRecord::getTextSlot(TicLabelTable::Label label) {
+    switch (label) {
+        case TicLabelTable::ADSC:
+            return 0;
+        case TicLabelTable::PRM:
+            return 1;
+        case TicLabelTable::NGTF:
+            return 2;
+        case TicLabelTable::LTARF:
+            return 3;
+        default:
+            return TextSlotCount;
+    }
+}
+
+void TicFrameRecord::markPresent(TicLabelTable::Label label) {
+    this->presence[label / 32] |= (static_cast<uint32_t>(1) << (label % 32));
+}
@@ -0,0 +1,191 @@
+#include "TicLabelTable.h"
+
+#include <string.h>
+
+namespace {
+constexpr std::size_t constStrlen(const char* str) {
+    std::size_t len = 0;
+    while (str[len] != '\0') {
+        len++;
+    }
+    return len;
+}
+
+struct Definition {
+    constexpr Definition(const char* name, TicLabelTable::Label label) : name(name), len(constStrlen(name)), label(label) {}
+
+    const char* name;   /*!< The label, as found in TIC datasets */
+    std::size_t len;    /*!< The number of characters in name */
+    TicLabelTable::Label label; /*!< The corresponding entry in the Label enum */
+};
+
+/* The labels we handle, in the order of the Label enum */
+constexpr Definition definitions[] = {
+    { "ADSC", TicLabelTable::ADSC },
+    { "VTIC", TicLabelTable::VTIC },
+    { "DATE", TicLabelTable::DATE },
+    { "NGTF", TicLabelTable::NGTF },
+    { "LTARF", TicLabelTable::LTARF },
+    { "EAST", TicLabelTable::EAST },
+    { "EASF01", TicLabelTable::EASF01 },
+    { "EASF02", TicLabelTable::EASF02 },
+    { "EASF03", TicLabelTable::EASF03 },
+    { "EASF04", TicLabelTable::EASF04 },
+    { "EASF05", TicLabelTable::EASF05 },
+    { "EASF06", TicLabelTable::EASF06 },
+    { "EASF07", TicLabelTable::EASF07 },
+    { "EASF08", TicLabelTable::EASF08 },
+    { "EASF09", TicLabelTable::EASF09 },
+    { "EASF10", TicLabelTable::EASF10 },
+    { "EASD01", TicLabelTable::EASD01 },
+    { "EASD02", TicLabelTable::EASD02 },
+    { "EASD03", TicLabelTable::EASD03 },
+    { "EASD04", TicLabelTable::EASD04 },
+    { "EAIT", TicLabelTable::EAIT },
+    { "ERQ1", TicLabelTable::ERQ1 },
+    { "ERQ2", TicLabelTable::ERQ2 },
+    { "ERQ3", TicLabelTable::ERQ3 },
+    { "ERQ4", TicLabelTable::ERQ4 },
+    { "IRMS1", TicLabelTable::IRMS1 },
+    { "IRMS2", TicLabelTable::IRMS2 },
+    { "IRMS3", TicLabelTable::IRMS3 },
+    { "URMS1", TicLabelTable::URMS1 },
+    { "URMS2", TicLabelTable::URMS2 },
+    { "URMS3", TicLabelTable::URMS3 },
+    { "PREF", TicLabelTable::PREF },
+    { "PCOUP", TicLabelTable::PCOUP },
+    { "SINSTS", TicLabelTable::SINSTS },
+    { "SINSTS1", TicLabelTable::SINSTS1 },
+    { "SINSTS2", TicLabelTable::SINSTS2 },
+    { "SINSTS3", TicLabelTable::SINSTS3 },
+    { "SMAXSN", TicLabelTable::SMAXSN },
+    { "SMAXSN1", TicLabelTable::SMAXSN1 },
+    { "SMAXSN2", TicLabelTable::SMAXSN2 },
+    { "SMAXSN3", TicLabelTable::SMAXSN3 },
+    { "SMAXSN-1", TicLabelTable::SMAXSN_M1 },
+    { "SMAXSN1-1", TicLabelTable::SMAXSN1_M1 },
+    { "SMAXSN2-1", TicLabelTable::SMAXSN2_M1 },
+    { "SMAXSN3-1", TicLabelTable::SMAXSN3_M1 },
+    { "SINSTI", TicLabelTable::SINSTI },
+    { "SMAXIN", TicLabelTable::SMAXIN },
+    { "SMAXIN-1", TicLabelTable::SMAXIN_M1 },
+    { "CCASN", TicLabelTable::CCASN },
+    { "CCASN-1", TicLabelTable::CCASN_M1 },
+    { "CCAIN", TicLabelTable::CCAIN },
+    { "CCAIN-1", TicLabelTable::CCAIN_M1 },
+    { "UMOY1", TicLabelTable::UMOY1 },
+    { "UMOY2", TicLabelTable::UMOY2 },
+    { "UMOY3", TicLabelTable::UMOY3 },
+    { "STGE", TicLabelTable::STGE },
+    { "DPM1", TicLabelTable::DPM1 },
+    { "FPM1", TicLabelTable::FPM1 },
+    { "DPM2", TicLabelTable::DPM2 },
+    { "FPM2", TicLabelTable::FPM2 },
+    { "DPM3", TicLabelTable::DPM3 },
+    { "FPM3", TicLabelTable::FPM3 },
+    { "MSG1", TicLabelTable::MSG1 },
+    { "MSG2", TicLabelTable::MSG2 },
+    { "PRM", TicLabelTable::PRM },
+    { "RELAIS", TicLabelTable::RELAIS },
+    { "NTARF", TicLabelTable::NTARF },
+    { "NJOURF", TicLabelTable::NJOURF },
+    { "NJOURF+1", TicLabelTable::NJOURF_P1 },
+    { "PJOURF+1", TicLabelTable::PJOURF_P1 },
+    { "PPOINTE", TicLabelTable::PPOINTE },
+    /* Historical TIC labels */
+    { "PAPP", TicLabelTable::PAPP },
+    { "PMAX", TicLabelTable::PMAX },
+    { "BASE", TicLabelTable::BASE },
+    { "HCHC", TicLabelTable::HCHC },
+    { "HCHP", TicLabelTable::HCHP },
+    { "ADCO", TicLabelTable::ADCO },
+    { "OPTARIF", TicLabelTable::OPTARIF },
+    { "ISOUSC", TicLabelTable::ISOUSC },
+    { "EJPHN", TicLabelTable::EJPHN },
+    { "EJPHPM", TicLabelTable::EJPHPM },
+    { "BBRHCJB", TicLabelTable::BBRHCJB },
+    { "BBRHPJB", TicLabelTable::BBRHPJB },
+    { "BBRHCJW", TicLabelTable::BBRHCJW },
+    { "BBRHPJW", TicLabelTable::BBRHPJW },
+    { "BBRHCJR", TicLabelTable::BBRHCJR },
+    { "BBRHPJR", TicLabelTable::BBRHPJR },
+    { "PEJP", TicLabelTable::PEJP },
+    { "PTEC", TicLabelTable::PTEC },
+    { "DEMAIN", TicLabelTable::DEMAIN },
+    { "IINST", TicLabelTable::IINST },
+    { "IINST1", TicLabelTable::IINST1 },
+    { "IINST2", TicLabelTable::IINST2 },
+    { "IINST3", TicLabelTable::IINST3 },
+    { "ADPS", TicLabelTable::ADPS },
+    { "IMAX", TicLabelTable::IMAX },
+    { "IMAX1", TicLabelTable::IMAX1 },
+    { "IMAX2", TicLabelTable::IMAX2 },
+    { "IMAX3", TicLabelTable::IMAX3 },
+    { "HHPHC", TicLabelTable::HHPHC },
+    { "MOTDETAT", TicLabelTable::MOTDETAT },
+    { "PPOT", TicLabelTable::PPOT },
+    { "ADIR1", TicLabelTable::ADIR1 },
+    { "ADIR2", TicLabelTable::ADIR2 },
+    { "ADIR3", TicLabelTable::ADIR3 },
+};
+constexpr std::size_t DefinitionCount = sizeof(definitions) / sizeof(definitions[0]);
+constexpr uint8_t NoDefinition = 0xff; /*!< Marks an empty bucket */
+
+struct BucketTable {
+    uint8_t definitionIndex[TicLabelTable::BucketCount]; /*!< For each bucket, the index of the only definition falling into it, or NoDefinition */
+    bool collisionFree; /*!< Does each definition have its own bucket? */
+};
+
+constexpr BucketTable makeBucketTable() {
+    BucketTable table = {{}, true};
+    for (std::size_t bucket = 0; bucket < TicLabelTable::BucketCount; bucket++) {
+        table.definitionIndex[bucket] = NoDefinition;
+    }
+    for (std::size_t index = 0; index < DefinitionCount; index++) {
+        std::size_t bucket = TicLabelTable::getBucket(definitions[index].name, definitions[index].len);
+        if (table.definitionIndex[bucket] != NoDefinition) {
+            table.collisionFree = false;
+        }
+        table.definitionIndex[bucket] = static_cast<uint8_t>(index);
+    }
+    return table;
+}
+
+constexpr bool definitionsAreValid() {
+    for (std::size_t index = 0; index < DefinitionCount; index++) {
+        if (definitions[index].label != index + 1 || definitions[index].len == 0 || definitions[index].len > TicLabelTable::MaxLabelSize) {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr BucketTable buckets = makeBucketTable();
+
+static_assert(DefinitionCount == TicLabelTable::LabelCount - 1, "Each label of the Label enum needs exactly one definition");
+static_assert(DefinitionCount < NoDefinition, "Too many labels for 8-bit bucket entries");
+static_assert(definitionsAreValid(), "Definitions must follow the Label enum order, and be at most MaxLabelSize long");
+static_assert(buckets.collisionFree, "Two TIC labels fall into the same bucket, change TicLabelTable::HashSeed (or increase BucketCount)");
+} // namespace
+
+TicLabelTable::Label TicLabelTable::lookup(const uint8_t* label, std::size_t len) {
+    if (label == nullptr || len == 0 || len > MaxLabelSize) {
+        return Unknown;
+    }
+    uint8_t index = buckets.definitionIndex[getBucket(label, len)];
+    if (index == NoDefinition) {
+        return Unknown;
+    }
+    const Definition& candidate = definitions[index];
+    if (candidate.len != len || memcmp(candidate.name, label, len) != 0) {  /* The only comparison */
+        return Unknown;
+    }
+    return candidate.label;
+}
+
+const char* TicLabelTable::getName(Label label) {
+    if (label == Unknown || label >= LabelCount) {
+        return "";
+    }
+    return definitions[label - 1].name;
+}
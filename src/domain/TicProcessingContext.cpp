@@ -12,11 +12,30 @@ void SystemCurrentTime::startNewDayAtMidnight() {
     this->relativeToBoot = false;
 }
 
-TicProcessingContext::TicProcessingContext(Stm32SerialDriver& ticSerial, TIC::Unframer& ticUnframer) :
+/**
+ * @brief Add a value to a counter, saturating instead of wrapping around
+ * 
+ * @param[in,out] counter The counter to increment
+ * @param value The value to add
+ */
+static void saturatingAdd(unsigned int& counter, std::size_t value) {
+    if (value > static_cast<unsigned int>(-1) || static_cast<unsigned int>(-1) - value < counter) {
+        /* Adding value will imply an overflow of our counter */
+        counter = static_cast<unsigned int>(-1); /* Maxmimize our counter, we can't do better than this */
+    }
+    else {
+        counter += value;
+    }
+}
+
+TicProcessingContext::TicProcessingContext(SerialSource& ticSerial, TIC::Unframer& ticUnframer) :
     ticSerial(ticSerial),
     ticUnframer(ticUnframer),
+    baudRateDetector(nullptr),
+    ticParser(nullptr),
     lostTicBytes(0),
     serialRxOverflowCount(0),
+    unframerResyncCount(0),
     datasetsWithErrors(0),
     instantaneousPower(),
     lastParsedFrameNb(static_cast<unsigned int>(-1)),
@@ -26,3 +45,42 @@ TicProcessingContext::TicProcessingContext(Stm32SerialDriver& ticSerial, TIC::Un
 {
 }
 
+void TicProcessingContext::resyncUnframer() {
+    /* The unframer has no reset hook, it keeps forwarding the rest of the frame, that the parser ignores up to the end of the frame */
+    if (this->ticParser != nullptr) {
+        this->ticParser->abortFrame();
+    }
+    saturatingAdd(this->unframerResyncCount, 1);
+}
+
+std::size_t TicProcessingContext::forwardSerialRxBytesToUnframer() {
+    if (this->ticSerial.takeRxGap()) {
+        this->resyncUnframer(); /* Bytes were lost right before the bytes we are about to forward */
+    }
+    SerialSource::RxRegion rxRegions[2];
+    unsigned int nbRxRegions = this->ticSerial.peek(rxRegions); /* Received bytes are processed in place, directly inside the serial reception buffer */
+    std::size_t consumedBytesCount = 0;
+    for (unsigned int region = 0; region < nbRxRegions; region++) {
+        std::size_t processedBytesCount = this->ticUnframer.pushBytes(rxRegions[region].buf, rxRegions[region].len);
+        bool stop = (processedBytesCount < rxRegions[region].len);  /* Unprocessed bytes stay in the serial reception buffer, they will be offered again on next call */
+        if (processedBytesCount == 0) {
+            /* The unframer did not accept any byte, drop this region rather than stalling the serial reception buffer forever */
+            processedBytesCount = rxRegions[region].len;
+            saturatingAdd(this->lostTicBytes, processedBytesCount);
+        }
+        if (this->baudRateDetector != nullptr) {
+            this->baudRateDetector->pushBytes(rxRegions[region].buf, processedBytesCount);
+        }
+        consumedBytesCount += processedBytesCount;
+        if (stop)
+            break;
+    }
+    if (this->baudRateDetector != nullptr) {
+        this->baudRateDetector->pushLineErrors(this->ticSerial.getRxLineErrorCount(true));
+    }
+    if (consumedBytesCount == 0)
+        return 0;
+    this->ticSerial.commit(consumedBytesCount);
+    saturatingAdd(this->serialRxOverflowCount, this->ticSerial.getRxOverflowCount(true));
+    return consumedBytesCount;
+}
@@ -3,6 +3,7 @@
 
 TimeOfDay::TimeOfDay():
     isValid(false),
+    estimatedTime(false),
     hour(static_cast<unsigned int>(-1)),
     minute(static_cast<unsigned int>(-1)),
     second(static_cast<unsigned int>(-1)),
@@ -91,6 +91,9 @@ void HAL_DSI_EndOfRefreshCallback(DSI_HandleTypeDef *hdsi) {
         BSP_LED_On(LED_LCD_REFRESH);
 #endif
     }
+    if (Stm32LcdDriver::get().onDisplayEvent != nullptr) {
+        Stm32LcdDriver::get().onDisplayEvent(Stm32LcdDriver::EndOfRefresh, Stm32LcdDriver::get().onDisplayEventContext);
+    }
 }
 
 /**
@@ -292,6 +295,8 @@ static uint8_t LCD_Init(DSI_HandleTypeDef* hdsi, LTDC_HandleTypeDef* hltdc) {
 
 Stm32LcdDriver::Stm32LcdDriver() :
 displayState(SwitchToDraftIsPending),
+onDisplayEvent(nullptr),
+onDisplayEventContext(nullptr),
 hltdc(board_hltdc),
 hdsi(board_hdsi)
 {
@@ -314,6 +319,10 @@ bool Stm32LcdDriver::start() {
     BSP_LCD_LayerDefaultInit(0, (uint32_t)(this->draftFramebuffer));
     BSP_LCD_SelectLayer(0); 
 
+    /* DMA2D interrupts are only raised by transfers started in interrupt mode (see startCopyDraftToFinal()) */
+    HAL_NVIC_SetPriority(DMA2D_IRQn, 3, 0);
+    HAL_NVIC_EnableIRQ(DMA2D_IRQn);
+
     this->fillRect(0, 0, this->getWidth(), this->getHeight(), LCD_Color::White);
 
     this->displayState = SwitchToDraftIsPending;
@@ -375,6 +384,39 @@ void Stm32LcdDriver::copyDraftToFinal() {
     this->hdma2dCopyFramebuffer(this->draftFramebuffer, this->finalFramebuffer, 0, 0, LCDWidth, LCDHeight);
 }
 
+void Stm32LcdDriver::startCopyDraftToFinal() {
+    this->displayState = CopyingDraftToFinalIsPending;
+    this->hdma2dCopyFramebuffer(this->draftFramebuffer, this->finalFramebuffer, 0, 0, LCDWidth, LCDHeight, true);
+}
+
+bool Stm32LcdDriver::isDraftDisplayed() const {
+    return (this->displayState == DisplayingDraft);
+}
+
+bool Stm32LcdDriver::isFinalDisplayed() const {
+    return (this->displayState == DisplayingFinal);
+}
+
+bool Stm32LcdDriver::isCopyDraftToFinalDone() const {
+    return (this->displayState == CopyDraftToFinalIsDone);
+}
+
+void Stm32LcdDriver::setOnDisplayEvent(FOnDisplayEventFunc onDisplayEvent, void* context) {
+    this->onDisplayEvent = onDisplayEvent;
+    this->onDisplayEventContext = context;
+}
+
+void Stm32LcdDriver::onDma2dTransferOver(DMA2D_HandleTypeDef* hdma2d) {
+    /* This code is called in an interrupt context, on transfer complete, but also on transfer errors, so that nobody waits forever */
+    Stm32LcdDriver& lcd = Stm32LcdDriver::get();
+    if (lcd.displayState == CopyingDraftToFinalIsPending) {
+        lcd.displayState = CopyDraftToFinalIsDone;
+    }
+    if (lcd.onDisplayEvent != nullptr) {
+        lcd.onDisplayEvent(Dma2dTransferComplete, lcd.onDisplayEventContext);
+    }
+}
+
 uint16_t Stm32LcdDriver::getWidth() const {
     return LCDWidth;
 }
@@ -499,7 +541,7 @@ void Stm32LcdDriver::fillRect(uint16_t x, uint16_t y, uint16_t width, uint16_t h
     // }
 }
 
-void Stm32LcdDriver::hdma2dCopyFramebuffer(const void* src, void* dst, uint16_t x, uint16_t y, uint16_t xsize, uint16_t ysize) {
+void Stm32LcdDriver::hdma2dCopyFramebuffer(const void* src, void* dst, uint16_t x, uint16_t y, uint16_t xsize, uint16_t ysize, bool inInterruptMode) {
     uint32_t destination_addr = (uint32_t)dst + (y * LCDWidth + x) * 4;
     uint32_t source_addr      = (uint32_t)src;
 
@@ -509,7 +551,8 @@ void Stm32LcdDriver::hdma2dCopyFramebuffer(const void* src, void* dst, uint16_t
     this->hdma2d.Init.OutputOffset = LCDWidth - xsize;
 
     /*##-2- DMA2D Callbacks Configuration ######################################*/
-    this->hdma2d.XferCpltCallback  = NULL;
+    this->hdma2d.XferCpltCallback  = inInterruptMode ? Stm32LcdDriver::onDma2dTransferOver : NULL;
+    this->hdma2d.XferErrorCallback = inInterruptMode ? Stm32LcdDriver::onDma2dTransferOver : NULL;
 
     /*##-3- Foreground Configuration ###########################################*/
     this->hdma2d.LayerCfg[1].AlphaMode = DMA2D_NO_MODIF_ALPHA;
@@ -522,7 +565,12 @@ void Stm32LcdDriver::hdma2dCopyFramebuffer(const void* src, void* dst, uint16_t
     /* DMA2D Initialization */
     if (HAL_DMA2D_Init(&(this->hdma2d)) == HAL_OK) {
         if (HAL_DMA2D_ConfigLayer(&(this->hdma2d), 1) == HAL_OK) {
-            if (HAL_DMA2D_Start(&(this->hdma2d), source_addr, destination_addr, xsize, ysize) == HAL_OK) {
+            if (inInterruptMode) {
+                if (HAL_DMA2D_Start_IT(&(this->hdma2d), source_addr, destination_addr, xsize, ysize) == HAL_OK) {
+                    return; /* The end of the transfer will be reported by onDma2dTransferOver(), invoked from DMA2D_IRQHandler() */
+                }
+            }
+            else if (HAL_DMA2D_Start(&(this->hdma2d), source_addr, destination_addr, xsize, ysize) == HAL_OK) {
                 /* Polling For DMA transfer */
                 HAL_DMA2D_PollForTransfer(&(this->hdma2d), 100);
 #if 0
@@ -584,6 +632,9 @@ void Stm32LcdDriver::hdma2dCopyFramebuffer(const void* src, void* dst, uint16_t
             }
         }
     }
+    if (inInterruptMode) {
+        Stm32LcdDriver::onDma2dTransferOver(&(this->hdma2d)); /* The transfer could not be started, do not leave anybody waiting for it */
+    }
 }
 
 void Stm32LcdDriver::LL_FillBuffer(uint32_t LayerIndex, void *pDst, uint32_t xSize, uint32_t ySize, uint32_t OffLine, uint32_t ColorIndex) {
@@ -622,5 +673,9 @@ LTDC_HandleTypeDef* get_hltdc() {
 DSI_HandleTypeDef* get_hdsi() {
     return getLcdDsiHandle();
 }
+
+DMA2D_HandleTypeDef* get_hdma2d() {
+    return &(Stm32LcdDriver::get().hdma2d);
+}
 } // extern "C"
 
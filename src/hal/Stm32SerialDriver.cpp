@@ -4,7 +4,18 @@ extern "C" {
 }
 
 static uint8_t UART_TIC_rxBuffer[1] = {0};   /* Our incoming serial buffer, filled-in by the receive interrupt handler */
+static DMA_HandleTypeDef hdma_usart_tic_rx;   /* The DMA stream handle serving USART_TIC reception in CircularDma mode */
 static void onTicUartRx(uint8_t incomingByte);
+static void onTicUartDmaRx(const uint8_t* buf, std::size_t len, void* context);
+
+#ifdef SERIAL_RX_STATS
+/**
+ * @brief Get the current value of the CPU cycle counter (DWT), used to timestamp reception events and measure interrupt costs
+ */
+static inline uint32_t getCycleCount() {
+    return DWT->CYCCNT;
+}
+#endif
 
 extern "C" {
 
@@ -51,6 +62,26 @@ void HAL_UART_MspInit(UART_HandleTypeDef *huart) {
         GPIO_InitStruct.Alternate = USART_TIC_RX_AF;
         HAL_GPIO_Init(USART_TIC_RX_GPIO_PORT, &GPIO_InitStruct);
 
+        /* USART_TIC RX DMA Init (only used in CircularDma reception mode) */
+        USART_TIC_RX_DMA_CLK_ENABLE();
+        hdma_usart_tic_rx.Instance = USART_TIC_RX_DMA_STREAM;
+        hdma_usart_tic_rx.Init.Channel = USART_TIC_RX_DMA_CHANNEL;
+        hdma_usart_tic_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+        hdma_usart_tic_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+        hdma_usart_tic_rx.Init.MemInc = DMA_MINC_ENABLE;
+        hdma_usart_tic_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+        hdma_usart_tic_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+        hdma_usart_tic_rx.Init.Mode = DMA_CIRCULAR;
+        hdma_usart_tic_rx.Init.Priority = DMA_PRIORITY_HIGH;
+        hdma_usart_tic_rx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+        if (HAL_DMA_Init(&hdma_usart_tic_rx) != HAL_OK) {
+            OnError_Handler(1);
+        }
+        __HAL_LINKDMA(huart, hdmarx, hdma_usart_tic_rx);
+
+        HAL_NVIC_SetPriority(USART_TIC_RX_DMA_IRQn, 0, 0);
+        HAL_NVIC_EnableIRQ(USART_TIC_RX_DMA_IRQn);
+
         /* USART_TIC interrupt Init */
         HAL_NVIC_SetPriority(USART_TIC_IRQn, 0, 0);
         HAL_NVIC_EnableIRQ(USART_TIC_IRQn);
@@ -91,6 +122,9 @@ void HAL_UART_MspDeInit(UART_HandleTypeDef *huart) {
         /* De-Initialize USART TIC Tx and RX */
         HAL_GPIO_DeInit(USART_TIC_TX_GPIO_PORT, USART_TIC_TX_PIN);
         HAL_GPIO_DeInit(USART_TIC_RX_GPIO_PORT, USART_TIC_RX_PIN);
+        /* USART_TIC RX DMA DeInit */
+        HAL_DMA_DeInit(huart->hdmarx);
+        HAL_NVIC_DisableIRQ(USART_TIC_RX_DMA_IRQn);
         /* USART_TIC interrupt DeInit */
         HAL_NVIC_DisableIRQ(USART_TIC_IRQn);
     }
@@ -114,20 +148,80 @@ inline void UART_TIC_Enable_interrupt_callback(UART_HandleTypeDef* huart) {
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef* huart)
 {
     if (huart->Instance==USART_TIC) {
+#ifdef SERIAL_RX_STATS
+        uint32_t isrStartCycles = getCycleCount();
+#endif
         unsigned char Received_Data = UART_TIC_rxBuffer[0];
         onTicUartRx((uint8_t)Received_Data);
 #ifdef LED_SERIAL_RX
         BSP_LED_Toggle(LED_SERIAL_RX); // Toggle the orange LED when new serial data is received on the TIC UART
 #endif
         UART_TIC_Enable_interrupt_callback(huart);
+#ifdef SERIAL_RX_STATS
+        Stm32SerialDriver::get().onRxIsrCost(getCycleCount() - isrStartCycles);
+#endif
+    }
+}
+
+/**
+ * @brief Reception event callback, invoked by the HAL in CircularDma mode on half-transfer, transfer complete and idle line events
+ * 
+ * @param huart The UART handle
+ * @param Size The current DMA write position in the reception ring
+ */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+    if (huart->Instance==USART_TIC) {
+#ifdef SERIAL_RX_STATS
+        uint32_t isrStartCycles = getCycleCount();
+#endif
+        DmaRxRing<Stm32SerialDriver::DmaRxRingSize>::Event event = DmaRxRing<Stm32SerialDriver::DmaRxRingSize>::IdleLine;
+        switch (HAL_UARTEx_GetRxEventType(huart)) {
+            case HAL_UART_RXEVENT_HT:
+                event = DmaRxRing<Stm32SerialDriver::DmaRxRingSize>::HalfTransfer;
+                break;
+            case HAL_UART_RXEVENT_TC:
+                event = DmaRxRing<Stm32SerialDriver::DmaRxRingSize>::TransferComplete;
+                break;
+            default:
+                break;
+        }
+        Stm32SerialDriver::get().onDmaRxEvent(event, Size);
+#ifdef LED_SERIAL_RX
+        BSP_LED_Toggle(LED_SERIAL_RX); // Toggle the orange LED when a new burst of serial data is received on the TIC UART
+#endif
+#ifdef SERIAL_RX_STATS
+        Stm32SerialDriver::get().onRxIsrCost(getCycleCount() - isrStartCycles);
+#endif
+    }
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+    if (huart->Instance==USART_TIC) {
+        if ((huart->ErrorCode & (HAL_UART_ERROR_PE | HAL_UART_ERROR_FE | HAL_UART_ERROR_NE)) != 0) {
+            Stm32SerialDriver::get().onRxLineError(); /* Bursts of these are a hint that we are not using the right baudrate */
+        }
+        /* On blocking errors (overrun, or any error in DMA mode), the HAL aborts the ongoing reception, restart it */
+        if (huart->RxState == HAL_UART_STATE_READY) {
+            Stm32SerialDriver::get().startReception();
+        }
     }
 }
 } // extern "C"
 
 Stm32SerialDriver::Stm32SerialDriver() :
-serialRxBufferLen(0),
-serialRxBufferOverflowCount(0) {
-    memset(this->serialRxBuffer, 0, sizeof(this->serialRxBuffer));
+serialRxRing(),
+serialRxBufferOverflowCount(0),
+serialRxBytesTotal(0),
+serialRxLineErrorCount(0),
+rxMode(InterruptPerByte),
+rxOverflowPolicy(DropNewest),
+dmaRxRing(onTicUartDmaRx, nullptr),
+onRxEvent(nullptr),
+onRxEventContext(nullptr)
+#ifdef SERIAL_RX_STATS
+, rxStats()
+#endif
+{
 }
 
 Stm32SerialDriver Stm32SerialDriver::instance=Stm32SerialDriver();
@@ -140,71 +234,174 @@ Stm32SerialDriver& Stm32SerialDriver::get() {
     return Stm32SerialDriver::instance;
 }
 
-void Stm32SerialDriver::start(uint32_t baudrate) {
+void Stm32SerialDriver::start(uint32_t baudrate, RxMode rxMode) {
+    this->rxMode = rxMode;
+#ifdef SERIAL_RX_STATS
+    /* Enable the DWT cycle counter, used to measure reception timings */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+#ifdef STM32F769xx
+    DWT->LAR = 0xC5ACCE55; /* Unlock write access to the DWT registers */
+#endif
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
     MX_USART_TIC_UART_Init(&(this->huart), baudrate);
-    UART_TIC_Enable_interrupt_callback(&(this->huart));
+    this->startReception();
 }
 
-void Stm32SerialDriver::resetRxOverflowCount() {
-    uint32_t primask = __get_PRIMASK(); /* Read PRIMASK register, will contain 0 if interrupts are enabled, or non-zero if disabled */
-    __disable_irq();
-    this->serialRxBufferOverflowCount = 0;
-    if (!primask) {
-        __enable_irq();
+void Stm32SerialDriver::setRxOverflowPolicy(RxOverflowPolicy policy) {
+    this->rxOverflowPolicy = policy;
+    this->serialRxRing.setEvictionAllowed(policy == DropOldest);
+}
+
+void Stm32SerialDriver::setOnRxEvent(FOnRxEventFunc onRxEvent, void* context) {
+    this->onRxEvent = onRxEvent;
+    this->onRxEventContext = context;
+}
+
+void Stm32SerialDriver::setBaudRate(uint32_t baudrate) {
+    if (HAL_UART_AbortReceive(&(this->huart)) != HAL_OK) {
+        OnError_Handler(1);
+    }
+    /* Reception is stopped, so the interrupt context does not touch the rings anymore and we can reset them from here */
+    this->serialRxRing.reset();   /* Bytes received at the previous baudrate are garbage at the new one */
+    this->dmaRxRing.reset();
+    MX_USART_TIC_UART_Init(&(this->huart), baudrate);
+    this->serialRxLineErrorCount.store(0); /* Errors seen at the previous baudrate are meaningless now */
+    this->startReception();
+}
+
+uint32_t Stm32SerialDriver::getBaudRate() const {
+    return this->huart.Init.BaudRate;
+}
+
+void Stm32SerialDriver::startReception() {
+    if (this->rxMode == CircularDma) {
+        this->dmaRxRing.reset();
+        if (HAL_UARTEx_ReceiveToIdle_DMA(&(this->huart), this->dmaRxRing.getStorage(), this->dmaRxRing.getCapacity()) != HAL_OK) {
+            OnError_Handler(1);
+        }
+    }
+    else {
+        UART_TIC_Enable_interrupt_callback(&(this->huart));
+    }
+}
+
+void Stm32SerialDriver::onDmaRxEvent(DmaRxRing<DmaRxRingSize>::Event event, std::size_t writePos) {
+    /* This code is called in an interrupt context */
+#ifdef STM32F769xx
+    /* The DMA writes to memory behind the data cache, make sure we read the actual ring content */
+    SCB_InvalidateDCache_by_Addr(reinterpret_cast<uint32_t*>(this->dmaRxRing.getStorage()), this->dmaRxRing.getCapacity());
+#endif
+#ifdef SERIAL_RX_STATS
+    this->rxStats.onRxEvent(getCycleCount());   /* In CircularDma mode, gaps are measured between DMA events (bursts), not between bytes */
+#endif
+    this->dmaRxRing.onDmaEvent(event, writePos);
+    if (this->onRxEvent != nullptr) {
+        this->onRxEvent(event == DmaRxRing<DmaRxRingSize>::IdleLine, this->onRxEventContext);
     }
 }
 
+void Stm32SerialDriver::resetRxOverflowCount() {
+    this->serialRxBufferOverflowCount.store(0);
+}
+
 unsigned int Stm32SerialDriver::getRxOverflowCount(bool reset) {
-    uint32_t primask = __get_PRIMASK(); /* Read PRIMASK register, will contain 0 if interrupts are enabled, or non-zero if disabled */
-    __disable_irq();
-    unsigned int result = this->serialRxBufferOverflowCount;
     if (reset) {
-        this->resetRxOverflowCount();
+        return this->serialRxBufferOverflowCount.exchange(0); /* Atomic read and reset, so that no overflow reported by the ISR in between can be lost */
     }
-    if (!primask) {
-		__enable_irq();
-	}
-    return result;
+    return this->serialRxBufferOverflowCount.load();
 }
 
 void Stm32SerialDriver::pushReceivedByte(uint8_t incomingByte) {
     /* This code is called in an interrupt context */
-    this->serialRxBytesTotal++;
-    this->serialRxBuffer[this->serialRxBufferLen] = incomingByte;
-    this->serialRxBufferLen++;
-    if (this->serialRxBufferLen >= sizeof(this->serialRxBuffer)) {
-        this->serialRxBufferOverflowCount++;
-        this->serialRxBufferLen = 0;	/* FIXME: Wrap around in case of buffer overflow */
+#ifdef SERIAL_RX_STATS
+    this->rxStats.onRxEvent(getCycleCount());
+#endif
+    this->pushReceivedBytes(&incomingByte, 1);
+    if (this->onRxEvent != nullptr) {
+        this->onRxEvent(false, this->onRxEventContext);
     }
 }
 
+void Stm32SerialDriver::pushReceivedBytes(const uint8_t* buffer, std::size_t len) {
+    /* This code is called in an interrupt context */
+    this->serialRxBytesTotal.fetch_add(len, std::memory_order_relaxed);
+    std::size_t lost;
+    if (this->rxOverflowPolicy == DropOldest) {
+        lost = this->serialRxRing.pushEvictingOldest(buffer, len); /* If the reception ring is full, the oldest bytes are evicted */
+    }
+    else {
+        lost = len - this->serialRxRing.push(buffer, len); /* If the reception ring is full, the bytes that do not fit are discarded */
+    }
+    if (lost > 0) {
+        this->serialRxBufferOverflowCount.fetch_add(lost, std::memory_order_relaxed);
+#ifdef SERIAL_RX_STATS
+        this->rxStats.onOverflow(HAL_GetTick(), static_cast<unsigned int>(lost));
+#endif
+    }
+#ifdef SERIAL_RX_STATS
+    this->rxStats.onFillLevel(this->serialRxRing.getCount());
+#endif
+}
+
 unsigned long Stm32SerialDriver::getRxBytesTotal() const {
-    unsigned long result;
+    return this->serialRxBytesTotal.load(std::memory_order_relaxed);
+}
+
+unsigned int Stm32SerialDriver::getRxLineErrorCount(bool reset) {
+    if (reset) {
+        return this->serialRxLineErrorCount.exchange(0);
+    }
+    return this->serialRxLineErrorCount.load();
+}
+
+void Stm32SerialDriver::onRxLineError() {
+    /* This code is called in an interrupt context */
+    this->serialRxLineErrorCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+#ifdef SERIAL_RX_STATS
+Stm32SerialDriver::RxStats::Snapshot Stm32SerialDriver::getRxStats() const {
     uint32_t primask = __get_PRIMASK(); /* Read PRIMASK register, will contain 0 if interrupts are enabled, or non-zero if disabled */
-    __disable_irq();
-    result = this->serialRxBytesTotal;
+    __disable_irq();    /* The snapshot is updated from interrupt context, make sure we do not copy it half-way through an update */
+    RxStats::Snapshot result = this->rxStats.getSnapshot();
     if (!primask) {
         __enable_irq();
     }
     return result;
 }
-size_t Stm32SerialDriver::read(uint8_t* buffer, size_t maxLen) {
-    uint32_t primask = __get_PRIMASK(); /* Read PRIMASK register, will contain 0 if interrupts are enabled, or non-zero if disabled */
+
+void Stm32SerialDriver::resetRxStats() {
+    uint32_t primask = __get_PRIMASK();
     __disable_irq();
-    size_t copiedBytesCount = this->serialRxBufferLen;
-    if (copiedBytesCount > 0) {
-        if (copiedBytesCount > maxLen) {    /* Too many pending bytes, won't fit in the provided buffer */
-            copiedBytesCount = maxLen;
-        }
-        /* FIXME: race condition with interrupt here */
-        memcpy(static_cast<void *>(buffer), static_cast<void *>(this->serialRxBuffer), copiedBytesCount);
-        memmove(static_cast<void *>(this->serialRxBuffer), static_cast<void *>(this->serialRxBuffer + copiedBytesCount), this->serialRxBufferLen - copiedBytesCount);
-        this->serialRxBufferLen -= copiedBytesCount;
-    }
+    this->rxStats.reset();
     if (!primask) {
         __enable_irq();
     }
-    return copiedBytesCount;
+}
+
+void Stm32SerialDriver::onRxIsrCost(uint32_t cycles) {
+    /* This code is called in an interrupt context */
+    this->rxStats.onIsrCost(cycles);
+}
+#endif
+
+size_t Stm32SerialDriver::read(uint8_t* buffer, size_t maxLen) {
+    /* The ISR only moves the ring head, we only move its tail, so there is no need to mask interrupts here */
+    return this->serialRxRing.pop(buffer, maxLen);
+}
+
+unsigned int Stm32SerialDriver::peek(RxRegion (&regions)[2]) {
+    return this->serialRxRing.peek(regions);
+}
+
+void Stm32SerialDriver::commit(std::size_t len) {
+    this->serialRxRing.commit(len);
+}
+
+bool Stm32SerialDriver::takeRxGap() {
+    return this->serialRxRing.takeGap();
 }
 
 void Stm32SerialDriver::writeByteHexdump(unsigned char byte) {
@@ -239,8 +436,16 @@ void onTicUartRx(uint8_t incomingByte) {
     Stm32SerialDriver::get().pushReceivedByte(incomingByte);
 }
 
+void onTicUartDmaRx(const uint8_t* buf, std::size_t len, void* context) {
+    Stm32SerialDriver::get().pushReceivedBytes(buf, len);
+}
+
 extern "C" {
 UART_HandleTypeDef* get_huart6() {
     return getTicUartHandle();
 }
+
+DMA_HandleTypeDef* get_hdma_usart6_rx() {
+    return &hdma_usart_tic_rx;
+}
 } // extern "C"
@@ -3,9 +3,12 @@
 #include "Stm32LcdDriver.h"
 #include "Stm32TimerDriver.h"
 #include "Stm32DebugOutput.h"
+#include "TraceLog.h"
 #include "Stm32MonotonicTimeDriver.h"
 #include "TIC/Unframer.h"
 #include "TicProcessingContext.h"
+#include "TicBaudRateDetector.h"
+#include "EventScheduler.h"
 #include "PowerHistory.h"
 #include "TicFrameParser.h"
 #include "HistoryDraw.h"
@@ -16,6 +19,7 @@ extern "C" {
 #include "main.h"
 #include <stdio.h>
 #include <string.h> // For strlen()
+#include <new> // For placement new
 #include "font58.h"
 
 static void SystemClock_Config(void); /* Defined below */
@@ -31,6 +35,11 @@ const unsigned int LCDWidth = 800;
 const unsigned int LCDHeight = 480;
 const unsigned int BytesPerPixel = 4; /* For ARGB8888 mode */
 
+/* The power history (a full day) does not fit in the internal RAM next to the rest (320kB on the STM32F469), so it lives in the SDRAM,
+   right after the draft and final framebuffers (see Stm32LcdDriver) */
+const uint32_t PowerHistoryAddress = LCD_FB_START_ADDRESS + 2 * LCDWidth * LCDHeight * BytesPerPixel;
+static_assert(PowerHistoryAddress + sizeof(PowerHistory) <= SDRAM_DEVICE_ADDR + SDRAM_DEVICE_SIZE, "The power history does not fit in the SDRAM");
+
 #define VSYNC               1 
 #define VBP                 1 
 #define VFP                 1
@@ -143,6 +152,157 @@ const char* getStatusString(unsigned int lcdRefreshCount, unsigned int framesCou
     return statusLine;
 }
 
+#ifdef SERIAL_RX_STATS
+/**
+ * @brief Dump the TIC serial reception path statistics to the debug console
+ */
+static void dumpSerialRxStats() {
+    Stm32SerialDriver::RxStats::Snapshot stats = Stm32SerialDriver::get().getRxStats();
+    Stm32DebugOutput& debug = Stm32DebugOutput::get();
+    debug.send("RX high-water mark: ");
+    debug.send(static_cast<unsigned int>(stats.fillHighWaterMark));
+    debug.send("/");
+    debug.send(static_cast<unsigned int>(Stm32SerialDriver::RxRingSize));
+    debug.send(", overflows: ");
+    debug.send(stats.overflowEventCount);
+    for (unsigned int age = 0; stats.getOverflowEvent(age) != nullptr; age++) {
+        debug.send(age == 0 ? " (" : ", ");
+        debug.send(stats.getOverflowEvent(age)->lostBytes);
+        debug.send("B@");
+        debug.send(static_cast<unsigned int>(stats.getOverflowEvent(age)->timestamp));
+        debug.send("ms");
+    }
+    debug.send(stats.overflowEventCount > 0 ? ")\n" : "\n");
+    debug.send("RX gaps (cycles) min/avg/max: ");
+    debug.send(stats.rxEventCount > 1 ? static_cast<unsigned int>(stats.minGap) : 0U);
+    debug.send("/");
+    debug.send(static_cast<unsigned int>(stats.getAverageGap()));
+    debug.send("/");
+    debug.send(static_cast<unsigned int>(stats.maxGap));
+    debug.send("\nRX ISR cost (cycles, log2 bins):");
+    for (std::size_t bin = 0; bin < sizeof(stats.isrCostHistogram)/sizeof(stats.isrCostHistogram[0]); bin++) {
+        debug.send(" ");
+        debug.send(stats.isrCostHistogram[bin]);
+    }
+    debug.send(", max ");
+    debug.send(static_cast<unsigned int>(stats.maxIsrCost));
+    debug.send("\n");
+}
+
+/**
+ * @brief Dump the TIC reception event dispatch latencies to the debug console
+ */
+static void dumpSchedulerRxLatency(const EventScheduler& scheduler) {
+    Stm32DebugOutput& debug = Stm32DebugOutput::get();
+    EventScheduler::EventStats rxData = scheduler.getStats(EventScheduler::RxData);
+    EventScheduler::EventStats rxIdle = scheduler.getStats(EventScheduler::RxIdle);
+    debug.send("RX dispatch latency (us) avg/max: ");
+    debug.send(static_cast<unsigned int>(rxData.getAverageLatency()));
+    debug.send("/");
+    debug.send(static_cast<unsigned int>(rxData.maxLatency));
+    debug.send(", on idle line: ");
+    debug.send(static_cast<unsigned int>(rxIdle.getAverageLatency()));
+    debug.send("/");
+    debug.send(static_cast<unsigned int>(rxIdle.maxLatency));
+    debug.send("\n");
+}
+
+/**
+ * @brief Dump the statistics on TIC datasets that failed to decode to the debug console
+ */
+static void dumpDatasetErrorStats(const TicFrameParser& ticParser) {
+    Stm32DebugOutput& debug = Stm32DebugOutput::get();
+    DatasetErrorStats::Snapshot stats = ticParser.getDatasetErrorStats();
+    debug.send("Dataset errors: ");
+    debug.send(stats.errorCount);
+    debug.send(" in ");
+    debug.send(stats.framesWithErrors);
+    debug.send("/");
+    debug.send(stats.frameCount);
+    debug.send(" frames, unattributed: ");
+    debug.send(stats.perLabel[TicLabelTable::Unknown]);
+    TicLabelTable::Label worstLabel = stats.getWorstLabel();
+    if (worstLabel != TicLabelTable::Unknown) {
+        debug.send(", worst label: ");
+        debug.send(TicLabelTable::getName(worstLabel));
+        debug.send(" (");
+        debug.send(stats.perLabel[worstLabel]);
+        debug.send(")");
+    }
+    debug.send(", bursts: ");
+    debug.send(stats.burstCount);
+    if (stats.burstCount > 0) {
+        debug.send(stats.inBurst ? " (ongoing since frame " : " (last at frame ");
+        debug.send(stats.lastBurst.startFrame);
+        debug.send(", ");
+        debug.send(stats.lastBurst.errorCount);
+        debug.send(" errors)");
+    }
+    debug.send("\nDataset errors per position:");
+    for (unsigned int position = 0; position < DatasetErrorStats::MaxPositions; position++) {
+        if (stats.perPosition[position] > 0) {
+            debug.send(" ");
+            debug.send(position);
+            debug.send(":");
+            debug.send(stats.perPosition[position]);
+        }
+    }
+    debug.send("\n");
+}
+#endif
+
+/**
+ * @brief Get a free-running microsecond counter, based on the HAL millisecond tick and the SysTick down-counter
+ * 
+ * @note This is the time source of the event scheduler, it is also invoked from interrupt context
+ */
+static uint32_t getMicroseconds(void* context) {
+    uint32_t ms;
+    uint32_t sysTickValue;
+    do {
+        ms = HAL_GetTick();
+        sysTickValue = SysTick->VAL;
+    } while (ms != HAL_GetTick());  /* Make sure the SysTick did not reload in between */
+    uint32_t sysTickPeriod = SysTick->LOAD + 1;
+    return ms * 1000 + ((sysTickPeriod - 1 - sysTickValue) * 1000) / sysTickPeriod;
+}
+
+#ifdef EMBEDDED_DEBUG_CONSOLE
+static const std::size_t TraceDrainChunkSize = 16; /* Rounded up to the end of a record, so at most 29 bytes (about 2.5ms of blocking output at 115200 bauds), so that pending events are not delayed for long */
+
+/**
+ * @brief Send drained TraceLog bytes to the debug console (see TraceLog::FOutputFunc)
+ */
+static void sendTraceToDebugConsole(const uint8_t* buf, std::size_t len, void* context) {
+    Stm32DebugOutput::get().send(buf, static_cast<unsigned int>(len));
+}
+#endif
+
+/**
+ * @brief Sleep until the next interrupt, unless an event is already pending
+ * 
+ * When the debug console is enabled, pending traces (see TraceLog) are output first, one chunk per call, instead of sleeping
+ * 
+ * @param context A pointer to the EventScheduler
+ * 
+ * @note Interrupts are masked while checking for pending events, so that an event posted right before WFI cannot be missed:
+ *       an interrupt that becomes pending while masked still wakes up the core, and is serviced as soon as interrupts are unmasked
+ */
+static void sleepUntilNextInterrupt(void* context) {
+    EventScheduler* scheduler = static_cast<EventScheduler*>(context);
+#ifdef EMBEDDED_DEBUG_CONSOLE
+    if (!TraceLog::get().isEmpty()) {
+        TraceLog::get().drain(sendTraceToDebugConsole, nullptr, TraceDrainChunkSize); /* Nothing more urgent to do, output pending traces instead of sleeping */
+        return;
+    }
+#endif
+    __disable_irq();
+    if (!scheduler->hasPendingEvents()) {
+        __WFI();
+    }
+    __enable_irq();
+}
+
 /**
  * @brief Genenate a system time string
  * 
@@ -337,8 +497,9 @@ int main(void) {
 
     Stm32SerialDriver& ticSerial = Stm32SerialDriver::get();
 
-    //ticSerial.start(9600); /* For standard TIC */
-    ticSerial.start(1200); /* For historical TIC */
+    /* Start with historical TIC, the baudrate detector will switch to standard TIC if needed */
+    ticSerial.setRxOverflowPolicy(Stm32SerialDriver::DropOldest); /* If we ever stall for too long, keep the most recent TIC data */
+    ticSerial.start(TicBaudRateDetector::HistoricalBaudRate, Stm32SerialDriver::CircularDma);
 
     Stm32LcdDriver& lcd = Stm32LcdDriver::get();
 
@@ -346,9 +507,9 @@ int main(void) {
     /* Initialize the LCD */
     OnError_Handler(!lcd.start());
 
-    PowerHistory powerHistory(PowerHistory::Per5Seconds);
+    static PowerHistory& powerHistory = *new ((void *)PowerHistoryAddress) PowerHistory(PowerHistory::Per5Seconds);  /* In SDRAM, now that it has been initialized (static so that lambdas can use it) */
 
-    TicFrameParser ticParser(PowerHistory::unWrapOnNewPowerData, (void *)(&powerHistory));
+    TicFrameParser ticParser(PowerHistory::unWrapOnNewFrameMeasurements, (void *)(&powerHistory));
 
     auto onFrameCompleteBlinkGreenLedAndInvokeHandler = [](void* context) {
 #ifdef LED_TIC_FRAME_RX
@@ -364,9 +525,20 @@ int main(void) {
 
     TicProcessingContext ticContext(ticSerial, ticUnframer);
 
+    auto onTicBaudRateChange = [](unsigned int baudRate, void* context) {
+        Stm32DebugOutput::get().send(baudRate == TicBaudRateDetector::StandardBaudRate ? "Trying standard TIC\n" : "Trying historical TIC\n");
+        Stm32SerialDriver::get().setBaudRate(baudRate);
+        static_cast<TicProcessingContext*>(context)->resyncUnframer();   /* Pending bytes were flushed, drop the frame they belonged to */
+    };
+    TicBaudRateDetector ticBaudRateDetector(onTicBaudRateChange, static_cast<void*>(&ticContext), TicBaudRateDetector::HistoricalBaudRate);
+    ticBaudRateDetector.start(HAL_GetTick());
+    ticContext.baudRateDetector = &ticBaudRateDetector;
+    ticContext.ticParser = &ticParser;   /* Frames cut by lost bytes are dropped by the parser */
+
     auto performAtMidnight = [](void* context) {
         TicProcessingContext* ticContext = static_cast<TicProcessingContext*>(context);
         ticContext->currentTime.startNewDayAtMidnight();
+        powerHistory.energy.onDayOver();    /* Keep today's energy totals as a past day */
     };
     ticParser.invokeWhenDayOver(performAtMidnight, static_cast<void*>(&ticContext));
     auto currentTimeGetter = [](void* context) -> TimeOfDay {
@@ -385,14 +557,19 @@ int main(void) {
 
     Stm32DebugOutput::get().send("Waiting for TIC data...\n");
 
+    /* All work is done in the main context, in event handlers run by the scheduler, interrupt handlers only post events */
+    EventScheduler scheduler(getMicroseconds, nullptr, sleepUntilNextInterrupt, static_cast<void*>(&scheduler));
+
     auto onSecondElapsed = [](void* context) {
         if (context == nullptr)
             return;
         TicProcessingContext* ticContext = static_cast<TicProcessingContext*>(context);
         ticContext->currentTime.time.addSeconds(1);
+        if (ticContext->baudRateDetector != nullptr) {
+            ticContext->baudRateDetector->update(HAL_GetTick()); /* Keep probing baudrates even if nothing is received */
+        }
     };
-    Stm32MonotonicTimeDriver::get().setOnPeriodElapsed(onSecondElapsed, static_cast<void*>(&ticContext));
-    Stm32MonotonicTimeDriver::get().start();
+    scheduler.setHandler(EventScheduler::SecondTick, onSecondElapsed, static_cast<void*>(&ticContext), 2);
 
 #ifdef SIMULATE_POWER_VALUES_WITHOUT_TIC
     auto streamTicRxBytesToUnframer = [](void* context) { }; /* Discard any TIC data */
@@ -401,63 +578,53 @@ int main(void) {
         if (context == nullptr)
             return;
         TicProcessingContext* ticContext = static_cast<TicProcessingContext*>(context);
-        uint8_t streamedBytesBuffer[256];  /* We allow copies of max 256 bytes at a time */
-        size_t incomingBytesCount = ticContext->ticSerial.read(streamedBytesBuffer, sizeof(streamedBytesBuffer));
-        if (incomingBytesCount == 0)
-            return;
-        // char countAsStr[4];
-        // unsigned int pos = 0;
-        // if (incomingBytesCount >= 1000) {
-        //     countAsStr[0]='+';
-        //     countAsStr[1]='+';
-        //     countAsStr[2]='+';
-        //     countAsStr[3]='\0';
-        // }
-        // else {
-        //     if (incomingBytesCount >= 100) {
-        //         countAsStr[pos++] = '0' + (incomingBytesCount / 100)%10;
-        //     }
-        //     if (incomingBytesCount >= 10) {
-        //         countAsStr[pos++] = '0' + (incomingBytesCount / 10)%10;
-        //     }
-        //     countAsStr[pos++] = '0' + (incomingBytesCount / 1)%10;
-        //     countAsStr[pos++] = '\0';
-        // }
-        // Stm32DebugOutput::get().send("TIC RX ");
-        // Stm32DebugOutput::get().send(countAsStr);
-        // Stm32DebugOutput::get().send(" bytes: ");
-        // Stm32DebugOutput::get().hexdumpBuffer(streamedBytesBuffer, incomingBytesCount);
-        // Stm32DebugOutput::get().send("\n");
-        std::size_t processedBytesCount = ticContext->ticUnframer.pushBytes(streamedBytesBuffer, incomingBytesCount);
-        if (processedBytesCount < incomingBytesCount) {
-            size_t lostBytesCount = incomingBytesCount - processedBytesCount;
-            if (lostBytesCount > static_cast<unsigned int>(-1)) {
-                lostBytesCount = static_cast<unsigned int>(-1); /* Does not fit in an unsigned int! */
-            }
-            if (static_cast<unsigned int>(-1) - lostBytesCount < ticContext->lostTicBytes) {
-                /* Adding lostBytesCount will imply an overflow an overflow of our counter */
-                ticContext->lostTicBytes = static_cast<unsigned int>(-1); /* Maxmimize our counter, we can't do better than this */
-            }
-            else {
-                ticContext->lostTicBytes += lostBytesCount;
-            }
-        }
-        unsigned int serialRxOverflowCount = ticContext->ticSerial.getRxOverflowCount(true);
-        if (static_cast<unsigned int>(-1) - serialRxOverflowCount < ticContext->serialRxOverflowCount) {
-            /* Adding serialRxOverflowBytes will imply an overflow of our counter */
-            ticContext->serialRxOverflowCount = static_cast<unsigned int>(-1); /* Maxmimize our counter, we can't do better than this */
-        }
-        else {
-            ticContext->serialRxOverflowCount += serialRxOverflowCount;
+        ticContext->forwardSerialRxBytesToUnframer();
+        if (ticContext->baudRateDetector != nullptr) {
+            ticContext->baudRateDetector->update(HAL_GetTick());
         }
     };
 #endif
+    /* Received bytes are handled first, the display events have no handler, they only wake up the display cycle below */
+    scheduler.setHandler(EventScheduler::RxData, streamTicRxBytesToUnframer, static_cast<void*>(&ticContext), 3);
+    scheduler.setHandler(EventScheduler::RxIdle, streamTicRxBytesToUnframer, static_cast<void*>(&ticContext), 3);
+    scheduler.setHandler(EventScheduler::DisplayRefreshed, nullptr, nullptr, 1);
+    scheduler.setHandler(EventScheduler::Dma2dDone, nullptr, nullptr, 1);
+
+    auto postRxEvent = [](bool idle, void* context) {
+        static_cast<EventScheduler*>(context)->post(idle ? EventScheduler::RxIdle : EventScheduler::RxData);
+    };
+    ticSerial.setOnRxEvent(postRxEvent, static_cast<void*>(&scheduler));
+    auto postDisplayEvent = [](Stm32LcdDriver::DisplayEvent event, void* context) {
+        static_cast<EventScheduler*>(context)->post(event == Stm32LcdDriver::EndOfRefresh ? EventScheduler::DisplayRefreshed : EventScheduler::Dma2dDone);
+    };
+    lcd.setOnDisplayEvent(postDisplayEvent, static_cast<void*>(&scheduler));
+    auto postSecondTick = [](void* context) {
+        static_cast<EventScheduler*>(context)->post(EventScheduler::SecondTick);
+    };
+    Stm32MonotonicTimeDriver::get().setOnPeriodElapsed(postSecondTick, static_cast<void*>(&scheduler));
+    Stm32MonotonicTimeDriver::get().start();
+
     auto isNoNewPowerReceivedSinceLastDisplay = [](void* context) -> bool {
         if (context == nullptr)
             return true;
         TicProcessingContext* ticContext = static_cast<TicProcessingContext*>(context);
         return (ticContext->lastParsedFrameNb == ticContext->lastDisplayedPowerFrameNb);
     };
+    auto isNewPowerReceivedSinceLastDisplay = [](void* context) -> bool {
+        if (context == nullptr)
+            return false;
+        TicProcessingContext* ticContext = static_cast<TicProcessingContext*>(context);
+        return (ticContext->lastParsedFrameNb != ticContext->lastDisplayedPowerFrameNb);
+    };
+    auto isDraftDisplayed = [](void* context) -> bool {
+        return static_cast<Stm32LcdDriver*>(context)->isDraftDisplayed();
+    };
+    auto isFinalDisplayed = [](void* context) -> bool {
+        return static_cast<Stm32LcdDriver*>(context)->isFinalDisplayed();
+    };
+    auto isCopyDraftToFinalDone = [](void* context) -> bool {
+        return static_cast<Stm32LcdDriver*>(context)->isCopyDraftToFinalDone();
+    };
 
     unsigned int lcdRefreshCount = 0;
 #ifdef SIMULATE_POWER_VALUES_WITHOUT_TIC
@@ -466,9 +633,16 @@ int main(void) {
 
     TicEvaluatedPower lastReceivedPower;
 
+    /* History zoom levels: the base history (one entry per column), then a day, a week and a month (drawn from cascaded history tiers) */
+    const unsigned int historySpansInSeconds[] = { 0, 24*60*60, 7*24*60*60, 31*24*60*60 };
+    unsigned int historyZoomLevel = 0;
+#ifdef USE_STM32F769I_DISCO
+    bool zoomButtonWasPressed = false;
+#endif
+
     uint32_t debugContext = 0;
     while (1) {
-        lcd.waitForFinalDisplayed(streamTicRxBytesToUnframer, static_cast<void*>(&ticContext)); /* Wait until the LCD displays the final framebuffer */
+        scheduler.runUntil(isFinalDisplayed, static_cast<void*>(&lcd)); /* Wait until the LCD displays the final framebuffer, handling incoming TIC bytes meanwhile */
         //debugTerm.send("Display refresh\r\n");
 
         Stm32MeasurementTimer fullDisplayCycleTimeMs(true);
@@ -542,7 +716,17 @@ int main(void) {
         }
         currentPencilYPos += 120; /* Skip the area where last received power was drawn */
         currentPencilYPos -= 15; /* We are not using letters that go below the baseline on font58 (except for the semicolon ';'), so we can afford to go up a bit into that area */
-        drawHistory(lcd, 1, currentPencilYPos, lcd.getWidth()-2, lcd.getHeight() - currentPencilYPos - 1, powerHistory, nullptr/*static_cast<void*>(&debugContext)*/);
+        scheduler.dispatchPending(); /* Drawing the history is long, handle what has been received so far */
+#ifdef USE_STM32F769I_DISCO
+        bool zoomButtonIsPressed = (BSP_PB_GetState(BUTTON_WAKEUP) != 0);
+        if (zoomButtonIsPressed && !zoomButtonWasPressed) { /* Each press on the push-button switches to the next zoom level */
+            historyZoomLevel = (historyZoomLevel + 1) % (sizeof(historySpansInSeconds) / sizeof(historySpansInSeconds[0]));
+        }
+        zoomButtonWasPressed = zoomButtonIsPressed;
+#endif
+        if (!drawHistory(lcd, 1, currentPencilYPos, lcd.getWidth()-2, lcd.getHeight() - currentPencilYPos - 1, powerHistory, historySpansInSeconds[historyZoomLevel], nullptr/*static_cast<void*>(&debugContext)*/)) {
+            Stm32DebugOutput::get().send("History modified while drawing\n");
+        }
 
         debugContext = fullDisplayCycleTimeMs.get();
         /* Counts to 121-157ms depending on the number of columns drawn */
@@ -551,13 +735,15 @@ int main(void) {
 
         {
             Stm32MeasurementTimer displayTimer(true);
-            lcd.displayDraft(streamTicRxBytesToUnframer, static_cast<void*>(&ticContext)); /* While waiting, continue forwarding incoming TIC bytes to the unframer */
+            lcd.requestDisplayDraft();
+            scheduler.runUntil(isDraftDisplayed, static_cast<void*>(&lcd)); /* While waiting, continue forwarding incoming TIC bytes to the unframer */
             //debugContext = displayTimer.get(); /* Counts to 9-10ms */
         }
 
         {
             Stm32MeasurementTimer fbCopyTimer(true);
-            lcd.copyDraftToFinal(); /* 25643 loops without any forced read/write, or 20691 (read+write) loops in the HAL_DMA2D_PollForTransfer() subroutine */
+            lcd.startCopyDraftToFinal(); /* Used to take 25643 loops without any forced read/write, or 20691 (read+write) loops in the HAL_DMA2D_PollForTransfer() subroutine */
+            scheduler.runUntil(isCopyDraftToFinalDone, static_cast<void*>(&lcd)); /* Now in interrupt mode, we handle incoming TIC bytes (or sleep) during the copy */
             //debugContext = fbCopyTimer.get(); /* Counts to 16-17ms */
         }
 
@@ -567,7 +753,7 @@ int main(void) {
         /* But inject a condition to immediately exit the loop to refresh the display if a new power measurement is received from TIC before the expiration of the wait delay */
         /* The 5s delay should never been reached because TIC data on power comes in more frequently */
 #ifndef SIMULATE_POWER_VALUES_WITHOUT_TIC
-        waitDelayAndCondition(5000, streamTicRxBytesToUnframer, isNoNewPowerReceivedSinceLastDisplay, static_cast<void*>(&ticContext));
+        scheduler.runUntil(isNewPowerReceivedSinceLastDisplay, static_cast<void*>(&ticContext), 5000 * 1000);
 #endif
         {
             unsigned int seconds = ticContext.currentTime.time.toSeconds();
@@ -580,6 +766,19 @@ int main(void) {
                 }
                 Stm32DebugOutput::get().send(seconds);
                 Stm32DebugOutput::get().send("s\n");
+                const EnergyAccounting::EnergyTotals& energyToday = powerHistory.energy.getToday();
+                Stm32DebugOutput::get().send("Energy today: ");
+                Stm32DebugOutput::get().send(energyToday.withdrawn.getMinWh());
+                Stm32DebugOutput::get().send("Wh withdrawn, ");
+                Stm32DebugOutput::get().send(energyToday.injected.getMinWh());
+                Stm32DebugOutput::get().send("-");
+                Stm32DebugOutput::get().send(energyToday.injected.getMaxWh());
+                Stm32DebugOutput::get().send("Wh injected\n");
+#ifdef SERIAL_RX_STATS
+                dumpSerialRxStats();
+                dumpSchedulerRxLatency(scheduler);
+                dumpDatasetErrorStats(ticParser);
+#endif
             }
         }
         lcdRefreshCount++;
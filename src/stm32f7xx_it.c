@@ -39,7 +39,9 @@
 /* Private function prototypes -----------------------------------------------*/
 LTDC_HandleTypeDef* get_hltdc(void); // C-linkage exported getter for hltdc handler
 DSI_HandleTypeDef* get_hdsi(void); // C-linkage exported getter for hdsi handler
+DMA2D_HandleTypeDef* get_hdma2d(void); // C-linkage exported getter for hdma2d handler
 extern UART_HandleTypeDef* get_huart6(void);
+extern DMA_HandleTypeDef* get_hdma_usart6_rx(void);
 /* Private functions ---------------------------------------------------------*/
 
 /******************************************************************************/
@@ -160,6 +162,14 @@ void USART6_IRQHandler(void)
   HAL_UART_IRQHandler(huart6_ptr);
 }
 
+/**
+  * @brief This function handles DMA2 Stream1 global interrupt (USART6 RX in circular DMA mode).
+  */
+void DMA2_Stream1_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(get_hdma_usart6_rx());
+}
+
 /**
   * @brief  This function handles DSI Handler.
   * @param  None
@@ -170,6 +180,16 @@ void DSI_IRQHandler(void)
   HAL_DSI_IRQHandler(get_hdsi());
 }
 
+/**
+  * @brief  This function handles DMA2D interrupt request (framebuffer copies started in interrupt mode).
+  * @param  None
+  * @retval None
+  */
+void DMA2D_IRQHandler(void)
+{
+  HAL_DMA2D_IRQHandler(get_hdma2d());
+}
+
 /**
   * @}
   */
@@ -0,0 +1,58 @@
+#include "Benchmark.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+struct RegisteredBenchmark {
+    const char* name;
+    Benchmark::FBenchmarkFunc func;
+};
+
+std::vector<RegisteredBenchmark>& getRegistry() {
+    static std::vector<RegisteredBenchmark> registry;   /* Function-local to avoid static initialization order issues between translation units */
+    return registry;
+}
+
+} // namespace
+
+Benchmark::Registration::Registration(const char* name, FBenchmarkFunc func) {
+    getRegistry().push_back(RegisteredBenchmark{name, func});
+}
+
+void Benchmark::report(const std::string& label, unsigned long iterations, double elapsedNs, unsigned long long bytesProcessed) {
+    double nsPerIteration = (iterations == 0) ? 0 : elapsedNs / iterations;
+    if (bytesProcessed != 0 && elapsedNs > 0) {
+        double mbPerSecond = (static_cast<double>(bytesProcessed) / (1024.0 * 1024.0)) / (elapsedNs / 1e9);
+        printf("  %-60s %12lu iter %12.2f ns/iter %10.2f MiB/s\n", label.c_str(), iterations, nsPerIteration, mbPerSecond);
+    }
+    else {
+        printf("  %-60s %12lu iter %12.2f ns/iter\n", label.c_str(), iterations, nsPerIteration);
+    }
+}
+
+void Benchmark::reportValue(const std::string& label, double value, const char* unit) {
+    printf("  %-60s %12.2f %s\n", label.c_str(), value, unit);
+}
+
+/**
+ * @brief Run all registered benchmarks, or only those whose name contains one of the command line arguments
+ */
+int main(int argc, char* argv[]) {
+    for (const RegisteredBenchmark& benchmark : getRegistry()) {
+        bool selected = (argc <= 1);
+        for (int arg = 1; arg < argc; arg++) {
+            if (strstr(benchmark.name, argv[arg]) != nullptr) {
+                selected = true;
+            }
+        }
+        if (!selected) {
+            continue;
+        }
+        printf("[ RUN ] %s\n", benchmark.name);
+        benchmark.func();
+    }
+    return 0;
+}
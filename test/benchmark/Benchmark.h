@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Minimal host benchmark harness
+ *
+ * Each benchmark is a function declared with BENCHMARK(group, name) and registered automatically.
+ * Inside a benchmark, results are reported using Benchmark::report()
+ */
+namespace Benchmark {
+
+typedef void(*FBenchmarkFunc)(void);
+
+/**
+ * @brief Registers a benchmark at static initialization time (use the BENCHMARK() macro rather than this class directly)
+ */
+struct Registration {
+    Registration(const char* name, FBenchmarkFunc func);
+};
+
+/**
+ * @brief Wall clock stopwatch with nanosecond resolution
+ */
+class Stopwatch {
+public:
+    Stopwatch() : startTime(std::chrono::steady_clock::now()) {}
+
+    void restart() {
+        this->startTime = std::chrono::steady_clock::now();
+    }
+
+    /**
+     * @brief Get the time elapsed since construction or last restart()
+     *
+     * @return The elapsed time in ns
+     */
+    double elapsedNs() const {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - this->startTime).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point startTime;
+};
+
+/**
+ * @brief Report a benchmark result
+ *
+ * @param label A description of the measurement
+ * @param iterations The number of iterations measured
+ * @param elapsedNs The total time spent in these iterations (in ns)
+ * @param bytesProcessed The total number of bytes processed during these iterations (0 to omit throughput)
+ */
+void report(const std::string& label, unsigned long iterations, double elapsedNs, unsigned long long bytesProcessed = 0);
+
+/**
+ * @brief Report a raw value (a size, a ratio...) that is not a timing
+ *
+ * @param label A description of the value
+ * @param value The value
+ * @param unit The unit of the value
+ */
+void reportValue(const std::string& label, double value, const char* unit);
+
+/**
+ * @brief Prevent the compiler from optimizing away a computed value
+ */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+} // namespace Benchmark
+
+#define BENCHMARK(group, name) \
+    static void group##_##name(); \
+    static Benchmark::Registration group##_##name##_registration(#group "." #name, group##_##name); \
+    static void group##_##name()
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Tools.h"
+
+/**
+ * @brief TIC captures shared by benchmarks (paths are relative to the repository root, where benchmarks are run from)
+ */
+namespace Benchmark {
+
+constexpr const char* HistoricalSample = "./ticdecodecpp/test/samples/continuous_linky_3P_historical_TIC_2024_sample.bin"; /*!< A three-phase historical TIC capture */
+constexpr const char* StandardSample = "./ticdecodecpp/test/samples/linky_1P_midnight.bin"; /*!< A single-phase standard TIC capture */
+
+/**
+ * @brief Load a capture
+ *
+ * @param samplePath The path to the capture
+ * @return The bytes of the capture
+ */
+inline std::vector<uint8_t> loadSample(const char* samplePath) {
+    return readVectorFromDisk(samplePath);
+}
+
+/**
+ * @brief Get the name of a capture, to label results
+ *
+ * @param samplePath The path to the capture
+ * @return The file name of the capture
+ */
+inline std::string sampleName(const char* samplePath) {
+    std::string path(samplePath);
+    return path.substr(path.find_last_of('/') + 1);
+}
+
+} // namespace Benchmark
@@ -0,0 +1,112 @@
+#include "Benchmark.h"
+#include "BenchmarkSamples.h"
+
+#include <string>
+#include <vector>
+
+#include "TIC/Unframer.h"
+#include "TIC/DatasetExtractor.h"
+#include "TIC/DatasetView.h"
+#include "TicFrameParser.h"
+#include "TicDatasetStreamDecoder.h"
+
+/**
+ * @brief Measure the time spent in TicFrameParser for a capture (unframing excluded), decoding datasets either on the fly or using TIC::DatasetExtractor and TIC::DatasetView
+ *
+ * @return The elapsed time, in ns
+ */
+static double measureParser(const std::vector<uint8_t>& capture, bool streamingDecoding, unsigned long nbReplays) {
+    /* Unframe once, so that only the parser is measured */
+    struct FrameCollector {
+        static void onFrameNewBytes(const uint8_t* buf, unsigned int cnt, void* context) {
+            static_cast<FrameCollector*>(context)->frames.back().insert(static_cast<FrameCollector*>(context)->frames.back().end(), buf, buf + cnt);
+        }
+        static void onFrameComplete(void* context) {
+            static_cast<FrameCollector*>(context)->frames.push_back(std::vector<uint8_t>());
+        }
+        std::vector<std::vector<uint8_t>> frames = std::vector<std::vector<uint8_t>>(1);
+    } collector;
+    TIC::Unframer unframer(FrameCollector::onFrameNewBytes, FrameCollector::onFrameComplete, &collector);
+    unframer.pushBytes(capture.data(), capture.size());
+
+    TicFrameParser parser;
+    parser.setStreamingDecoding(streamingDecoding);
+    Benchmark::Stopwatch stopwatch;
+    for (unsigned long replay = 0; replay < nbReplays; replay++) {
+        for (const std::vector<uint8_t>& frame : collector.frames) {
+            parser.onNewFrameBytes(frame.data(), static_cast<unsigned int>(frame.size()));
+            parser.onFrameComplete();
+        }
+    }
+    double elapsedNs = stopwatch.elapsedNs();
+    Benchmark::doNotOptimize(parser.lastFrameMeasurements);
+    return elapsedNs;
+}
+
+/**
+ * @brief Decode datasets the way TicFrameParser::onDatasetExtracted() does: checksum and fields from a TIC::DatasetView, then label lookup and value conversion
+ */
+static void decodeExtractedDataset(const uint8_t* buf, unsigned int cnt, void* context) {
+    TIC::DatasetView dv(buf, cnt);
+    if (dv.isValid()) {
+        *static_cast<uint64_t*>(context) += TicLabelTable::lookup(dv.labelBuffer, dv.labelSz) + dv.dataToUint32();
+    }
+}
+
+static void onDatasetDecoded(const TicDatasetStreamDecoder::DecodedDataset& dataset, void* context) {
+    if (dataset.isValid) {
+        *static_cast<uint64_t*>(context) += dataset.label + dataset.value;
+    }
+}
+
+/**
+ * @brief Measure the decoding of datasets alone (label and decimal value), from frame bytes
+ */
+static void compareDatasetDecoders(const char* samplePath) {
+    std::vector<uint8_t> capture = Benchmark::loadSample(samplePath);
+    static const unsigned long nbReplays = 200;
+    uint64_t extractorResult = 0;
+    uint64_t streamingResult = 0;
+    TIC::DatasetExtractor de(decodeExtractedDataset, &extractorResult);
+    TicDatasetStreamDecoder sd(onDatasetDecoded, &streamingResult);
+
+    Benchmark::Stopwatch extractorStopwatch;
+    for (unsigned long replay = 0; replay < nbReplays; replay++) {
+        de.pushBytes(capture.data(), capture.size());
+    }
+    double extractorElapsedNs = extractorStopwatch.elapsedNs();
+    Benchmark::Stopwatch streamingStopwatch;
+    for (unsigned long replay = 0; replay < nbReplays; replay++) {
+        sd.pushBytes(capture.data(), capture.size());
+    }
+    double streamingElapsedNs = streamingStopwatch.elapsedNs();
+    Benchmark::doNotOptimize(extractorResult);
+    Benchmark::doNotOptimize(streamingResult);
+
+    std::string label = Benchmark::sampleName(samplePath);
+    Benchmark::report(label + " DatasetExtractor+DatasetView", nbReplays, extractorElapsedNs, static_cast<unsigned long long>(capture.size()) * nbReplays);
+    Benchmark::report(label + " TicDatasetStreamDecoder", nbReplays, streamingElapsedNs, static_cast<unsigned long long>(capture.size()) * nbReplays);
+    Benchmark::reportValue(label + " speedup", extractorElapsedNs / streamingElapsedNs, "x");
+}
+
+BENCHMARK(DatasetDecoding, datasetDecoders) {
+    compareDatasetDecoders(Benchmark::HistoricalSample);
+    compareDatasetDecoders(Benchmark::StandardSample);
+}
+
+static void compareDecodings(const char* samplePath) {
+    std::vector<uint8_t> capture = Benchmark::loadSample(samplePath);
+    static const unsigned long nbReplays = 200;
+    double extractorElapsedNs = measureParser(capture, false, nbReplays);
+    double streamingElapsedNs = measureParser(capture, true, nbReplays);
+
+    std::string label = Benchmark::sampleName(samplePath);
+    Benchmark::report(label + " DatasetExtractor+DatasetView", nbReplays, extractorElapsedNs, static_cast<unsigned long long>(capture.size()) * nbReplays);
+    Benchmark::report(label + " TicDatasetStreamDecoder", nbReplays, streamingElapsedNs, static_cast<unsigned long long>(capture.size()) * nbReplays);
+    Benchmark::reportValue(label + " speedup", extractorElapsedNs / streamingElapsedNs, "x");
+}
+
+BENCHMARK(DatasetDecoding, parserRate) {
+    compareDecodings(Benchmark::HistoricalSample);
+    compareDecodings(Benchmark::StandardSample);
+}
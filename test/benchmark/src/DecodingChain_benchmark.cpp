@@ -0,0 +1,76 @@
+#include "Benchmark.h"
+#include "BenchmarkSamples.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "TIC/Unframer.h"
+#include "TIC/DatasetExtractor.h"
+#include "TIC/DatasetView.h"
+#include "TicFrameParser.h"
+
+static const std::size_t chunkSizes[] = { 1, 4, 16, 64, 256, 1024, 4096 };
+
+static void countValidDataset(const uint8_t* buf, unsigned int cnt, void* context) {
+    TIC::DatasetView dv(buf, cnt);
+    if (dv.isValid()) {
+        (*static_cast<unsigned long*>(context))++;
+    }
+}
+
+static void forwardFrameBytesToExtractor(const uint8_t* buf, unsigned int cnt, void* context) {
+    static_cast<TIC::DatasetExtractor*>(context)->pushBytes(buf, cnt);
+}
+
+static void resetExtractor(void* context) {
+    static_cast<TIC::DatasetExtractor*>(context)->reset();
+}
+
+/**
+ * @brief Count the valid datasets in a capture, outside of any measurement
+ */
+static unsigned long countValidDatasets(const std::vector<uint8_t>& capture) {
+    unsigned long nbDatasets = 0;
+    TIC::DatasetExtractor de(countValidDataset, &nbDatasets);
+    TIC::Unframer unframer(forwardFrameBytesToExtractor, resetExtractor, &de);
+    unframer.pushBytes(capture.data(), capture.size());
+    return nbDatasets;
+}
+
+/**
+ * @brief Measure the TIC::Unframer -> TicFrameParser chain (datasets decoded by TIC::DatasetExtractor or TicDatasetStreamDecoder), feeding a capture in chunks of a fixed size
+ *
+ * This mimics serial reception handing over DMA buffers of various sizes, down to one interrupt per byte
+ */
+static void measureChunkSizes(const char* samplePath, bool streamingDecoding) {
+    std::vector<uint8_t> capture = Benchmark::loadSample(samplePath);
+    unsigned long nbDatasetsPerReplay = countValidDatasets(capture);
+    static const unsigned long nbReplays = 50;
+    std::string label = Benchmark::sampleName(samplePath) + (streamingDecoding ? " streaming" : " extractor");
+
+    for (std::size_t chunkSize : chunkSizes) {
+        TicFrameParser parser;
+        parser.setStreamingDecoding(streamingDecoding);
+        TIC::Unframer unframer(TicFrameParser::unwrapInvokeOnFrameNewBytes, TicFrameParser::unwrapInvokeOnFrameComplete, &parser);
+        Benchmark::Stopwatch stopwatch;
+        for (unsigned long replay = 0; replay < nbReplays; replay++) {
+            for (std::size_t pos = 0; pos < capture.size(); pos += chunkSize) {
+                unframer.pushBytes(capture.data() + pos, std::min(chunkSize, capture.size() - pos));
+            }
+        }
+        double elapsedNs = stopwatch.elapsedNs();
+        Benchmark::doNotOptimize(parser.lastFrameMeasurements);
+
+        std::string chunkLabel = label + " chunk " + std::to_string(chunkSize);
+        Benchmark::report(chunkLabel + " (per replay)", nbReplays, elapsedNs, static_cast<unsigned long long>(capture.size()) * nbReplays);
+        Benchmark::reportValue(chunkLabel + " datasets/s", (nbDatasetsPerReplay * nbReplays) / (elapsedNs / 1e9), "datasets/s");
+    }
+}
+
+BENCHMARK(DecodingChain, chunkSizes) {
+    measureChunkSizes(Benchmark::HistoricalSample, false);
+    measureChunkSizes(Benchmark::HistoricalSample, true);
+    measureChunkSizes(Benchmark::StandardSample, false);
+    measureChunkSizes(Benchmark::StandardSample, true);
+}
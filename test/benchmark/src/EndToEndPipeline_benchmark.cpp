@@ -0,0 +1,136 @@
+#include "Benchmark.h"
+#include "BenchmarkSamples.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "FileReplaySerialSource.h"
+#include "TIC/Unframer.h"
+#include "TicProcessingContext.h"
+#include "PowerHistory.h"
+#include "TicFrameParser.h"
+
+/**
+ * @brief The full host ingest pipeline: serial source -> TicProcessingContext -> TIC::Unframer -> TicFrameParser -> PowerHistory
+ */
+struct Pipeline {
+    /**
+     * @param source The serial source to read from
+     * @param onFrameNewBytes A function to invoke on frame bytes instead of the parser's handler (it must then invoke the parser's handler itself)
+     * @param onFrameComplete A function to invoke on frame complete instead of the parser's handler (it must then invoke the parser's handler itself)
+     * @param unframerContext The context passed to both @p onFrameNewBytes and @p onFrameComplete
+     */
+    Pipeline(SerialSource& source,
+             void (*onFrameNewBytes)(const uint8_t* buf, unsigned int cnt, void* context) = nullptr,
+             void (*onFrameComplete)(void* context) = nullptr,
+             void* unframerContext = nullptr) :
+        powerHistory(PowerHistory::Per5Seconds),
+        ticParser(PowerHistory::unWrapOnNewFrameMeasurements, static_cast<void*>(&powerHistory)),
+        ticUnframer(unframerContext == nullptr ? TicFrameParser::unwrapInvokeOnFrameNewBytes : onFrameNewBytes,
+                    unframerContext == nullptr ? TicFrameParser::unwrapInvokeOnFrameComplete : onFrameComplete,
+                    unframerContext == nullptr ? static_cast<void*>(&ticParser) : unframerContext),
+        ticContext(source, ticUnframer)
+    {
+        this->powerHistory.setContext(&this->ticContext);
+    }
+
+    PowerHistory powerHistory;
+    TicFrameParser ticParser;
+    TIC::Unframer ticUnframer;
+    TicProcessingContext ticContext;
+};
+
+static void measureThroughput(const char* samplePath) {
+    std::vector<uint8_t> capture = Benchmark::loadSample(samplePath);
+    static const unsigned long nbReplays = 200;
+    double elapsedNs = 0;
+    unsigned long nbFrames = 0;
+    for (unsigned long replay = 0; replay < nbReplays; replay++) {
+        FileReplaySerialSource source(capture, 9600, FileReplaySerialSource::Unlimited);
+        Pipeline pipeline(source);
+        Benchmark::Stopwatch stopwatch;
+        while (!source.isFinished()) {
+            pipeline.ticContext.forwardSerialRxBytesToUnframer();
+        }
+        elapsedNs += stopwatch.elapsedNs();
+        nbFrames += pipeline.ticParser.nbFramesParsed;
+    }
+    std::string label = Benchmark::sampleName(samplePath);
+    Benchmark::report(label + " (per replay)", nbReplays, elapsedNs, static_cast<unsigned long long>(capture.size()) * nbReplays);
+    Benchmark::reportValue(label + " frames/s", nbFrames / (elapsedNs / 1e9), "frames/s");
+}
+
+BENCHMARK(EndToEndPipeline, throughput) {
+    measureThroughput(Benchmark::HistoricalSample);
+    measureThroughput(Benchmark::StandardSample);
+}
+
+/**
+ * @brief Context used to measure, for each frame, the delay between the reception of its last byte (ETX) and the end of its processing
+ */
+struct LatencyProbe {
+    TicFrameParser* parser;
+    const FileReplaySerialSource* source;
+    std::vector<std::size_t> etxPositions;  /*!< The offsets of all ETX bytes in the capture */
+    std::vector<double> latenciesNs;    /*!< The latency measured for each completed frame */
+};
+
+static void onFrameNewBytesMeasureLatency(const uint8_t* buf, unsigned int cnt, void* context) {
+    LatencyProbe* probe = static_cast<LatencyProbe*>(context);
+    TicFrameParser::unwrapInvokeOnFrameNewBytes(buf, cnt, static_cast<void*>(probe->parser));
+}
+
+static void onFrameCompleteMeasureLatency(void* context) {
+    LatencyProbe* probe = static_cast<LatencyProbe*>(context);
+    TicFrameParser::unwrapInvokeOnFrameComplete(static_cast<void*>(probe->parser));
+    std::size_t frameIndex = probe->latenciesNs.size();
+    if (frameIndex < probe->etxPositions.size()) {
+        std::chrono::nanoseconds latency = probe->source->now() - probe->source->getArrivalTime(probe->etxPositions[frameIndex]);
+        probe->latenciesNs.push_back(static_cast<double>(latency.count()));
+    }
+}
+
+static void measureLatency(const char* samplePath, unsigned int baudrate, double replayDurationSeconds) {
+    std::vector<uint8_t> capture = Benchmark::loadSample(samplePath);
+    double realTimeSeconds = static_cast<double>(capture.size()) * FileReplaySerialSource::BitsPerByte / baudrate;
+    double speedFactor = realTimeSeconds / replayDurationSeconds;
+    FileReplaySerialSource source(capture, baudrate, speedFactor);
+
+    LatencyProbe probe;
+    probe.source = &source;
+    bool inFrame = false;
+    for (std::size_t pos = 0; pos < capture.size(); pos++) {
+        if (capture[pos] == 0x02) {  /* STX */
+            inFrame = true;
+        }
+        else if (capture[pos] == 0x03 && inFrame) {  /* ETX (captures may start in the middle of a frame, that will never be reported) */
+            probe.etxPositions.push_back(pos);
+            inFrame = false;
+        }
+    }
+    Pipeline pipeline(source, onFrameNewBytesMeasureLatency, onFrameCompleteMeasureLatency, static_cast<void*>(&probe));
+    probe.parser = &pipeline.ticParser;
+
+    source.start();
+    while (!source.isFinished()) {  /* Busy polling main loop */
+        pipeline.ticContext.forwardSerialRxBytesToUnframer();
+    }
+
+    std::string label = Benchmark::sampleName(samplePath) + " @" + std::to_string(baudrate) + " x" + std::to_string(static_cast<unsigned int>(speedFactor));
+    if (probe.latenciesNs.empty()) {
+        Benchmark::reportValue(label + " frames completed", 0, "frames");
+        return;
+    }
+    std::vector<double> sorted = probe.latenciesNs;
+    std::sort(sorted.begin(), sorted.end());
+    Benchmark::reportValue(label + " frames completed", sorted.size(), "frames");
+    Benchmark::reportValue(label + " ETX to frame processed p50", sorted[sorted.size() / 2] / 1000, "us");
+    Benchmark::reportValue(label + " ETX to frame processed p99", sorted[(sorted.size() * 99) / 100] / 1000, "us");
+    Benchmark::reportValue(label + " ETX to frame processed max", sorted.back() / 1000, "us");
+}
+
+BENCHMARK(EndToEndPipeline, frameLatency) {
+    measureLatency(Benchmark::HistoricalSample, 1200, 1.0);
+    measureLatency(Benchmark::StandardSample, 9600, 1.0);
+}
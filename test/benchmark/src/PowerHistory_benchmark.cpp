@@ -0,0 +1,216 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "PowerHistory.h"
+
+namespace {
+constexpr std::size_t DaySlots = 24 * 60 * 60 / 5; /* A full day at 5 seconds */
+constexpr unsigned int NbScans = 200;
+
+/**
+ * @brief Build a day of history entries, a mix of exact powers and injection ranges
+ */
+std::vector<PowerHistoryEntry> makeDayOfEntries() {
+    std::vector<PowerHistoryEntry> entries;
+    entries.reserve(DaySlots);
+    TimeOfDay timestamp(0, 0, 0);
+    for (std::size_t slot = 0; slot < DaySlots; slot++) {
+        int power = static_cast<int>((slot * 37) % 6000) - 2000;
+        PowerHistoryEntry entry(power >= 0 ? TicEvaluatedPower(power, power) : TicEvaluatedPower(power, power / 2), timestamp);
+        entry.nbSamples = 1 + slot % 5;
+        entries.push_back(entry);
+        timestamp.addSeconds(5);
+    }
+    return entries;
+}
+}
+
+/**
+ * @brief Compare the footprint of a full day of history, and the cost of scanning it, with plain and packed entries
+ */
+BENCHMARK(PowerHistory, packedEntries) {
+    std::vector<PowerHistoryEntry> entries = makeDayOfEntries();
+    std::vector<PackedPowerHistoryEntry> packedEntries;
+    packedEntries.reserve(DaySlots);
+    for (const PowerHistoryEntry& entry : entries) {
+        packedEntries.push_back(PackedPowerHistoryEntry(entry));
+    }
+
+    Benchmark::reportValue("PowerHistoryEntry size", sizeof(PowerHistoryEntry), "bytes");
+    Benchmark::reportValue("PackedPowerHistoryEntry size", sizeof(PackedPowerHistoryEntry), "bytes");
+    Benchmark::reportValue("a day at 5s with PowerHistoryEntry", DaySlots * sizeof(PowerHistoryEntry) / 1024.0, "KiB");
+    Benchmark::reportValue("a day at 5s with PackedPowerHistoryEntry", DaySlots * sizeof(PackedPowerHistoryEntry) / 1024.0, "KiB");
+
+    /* Scan all entries, the way drawHistory() reads them (validity and power range of each entry) */
+    long long sum = 0;
+    Benchmark::Stopwatch stopwatch;
+    for (unsigned int scan = 0; scan < NbScans; scan++) {
+        for (const PowerHistoryEntry& entry : entries) {
+            if (entry.power.isValid) {
+                sum += entry.power.maxValue - entry.power.minValue;
+            }
+        }
+        Benchmark::doNotOptimize(sum);
+    }
+    Benchmark::report("scan PowerHistoryEntry", NbScans * DaySlots, stopwatch.elapsedNs(), NbScans * DaySlots * sizeof(PowerHistoryEntry));
+
+    long long packedSum = 0;
+    stopwatch.restart();
+    for (unsigned int scan = 0; scan < NbScans; scan++) {
+        for (const PackedPowerHistoryEntry& packedEntry : packedEntries) {
+            if (packedEntry.powerValid) {
+                packedSum += packedEntry.maxPower - packedEntry.minPower;
+            }
+        }
+        Benchmark::doNotOptimize(packedSum);
+    }
+    Benchmark::report("scan PackedPowerHistoryEntry fields", NbScans * DaySlots, stopwatch.elapsedNs(), NbScans * DaySlots * sizeof(PackedPowerHistoryEntry));
+
+    long long unpackedSum = 0;
+    stopwatch.restart();
+    for (unsigned int scan = 0; scan < NbScans; scan++) {
+        for (const PackedPowerHistoryEntry& packedEntry : packedEntries) {
+            PowerHistoryEntry entry = packedEntry.unpack();
+            if (entry.power.isValid) {
+                unpackedSum += entry.power.maxValue - entry.power.minValue;
+            }
+        }
+        Benchmark::doNotOptimize(unpackedSum);
+    }
+    Benchmark::report("scan PackedPowerHistoryEntry with unpack()", NbScans * DaySlots, stopwatch.elapsedNs(), NbScans * DaySlots * sizeof(PackedPowerHistoryEntry));
+
+    if (sum != packedSum || sum != unpackedSum) {
+        Benchmark::reportValue("MISMATCH between plain and packed scans", static_cast<double>(sum - unpackedSum), "W");
+    }
+}
+
+/**
+ * @brief Compare reading one screen width of entries by copying them into an array (getLastPowerOverSpan()) or in place (getView())
+ */
+BENCHMARK(PowerHistory, inPlaceView) {
+    constexpr unsigned int ScreenColumns = 798;  /* The widest history graph (STM32F769I-DISCO) */
+    constexpr unsigned int NbReads = 20000;
+    static PowerHistory history(PowerHistory::Per5Seconds);
+    history.data.reset();
+    for (const PowerHistoryEntry& entry : makeDayOfEntries()) {
+        history.data.push(PackedPowerHistoryEntry(entry));  /* Fill the base history directly, the way onNewPowerData() would */
+    }
+    history.data.push(PackedPowerHistoryEntry(makeDayOfEntries()[0]));  /* Make the ring storage wrap */
+
+    Benchmark::reportValue("array for one screen width", ScreenColumns * sizeof(PowerHistoryEntry) / 1024.0, "KiB");
+
+    long long copySum = 0;
+    static PowerHistoryEntry columns[ScreenColumns];
+    Benchmark::Stopwatch stopwatch;
+    for (unsigned int read = 0; read < NbReads; read++) {
+        unsigned int nb = ScreenColumns;
+        history.getLastPowerOverSpan(0, nb, columns);
+        for (unsigned int column = 0; column < nb; column++) {
+            if (columns[column].power.isValid) {
+                copySum += columns[column].power.maxValue;
+            }
+        }
+        Benchmark::doNotOptimize(copySum);
+    }
+    Benchmark::report("copy then scan a screen width", NbReads * ScreenColumns, stopwatch.elapsedNs());
+
+    long long viewSum = 0;
+    stopwatch.restart();
+    for (unsigned int read = 0; read < NbReads; read++) {
+        PowerHistoryView view = history.getView(0, ScreenColumns);
+        PowerHistoryEntry entry;
+        while (view.readNext(entry)) {
+            if (entry.power.isValid) {
+                viewSum += entry.power.maxValue;
+            }
+        }
+        Benchmark::doNotOptimize(viewSum);
+    }
+    Benchmark::report("scan a screen width in place", NbReads * ScreenColumns, stopwatch.elapsedNs());
+
+    if (copySum != viewSum) {
+        Benchmark::reportValue("MISMATCH between copied and in-place reads", static_cast<double>(copySum - viewSum), "W");
+    }
+}
+
+namespace {
+/**
+ * @brief Compare the average over windows of the last entries, from a scan of the ring or from its prefix sums
+ *
+ * @tparam N The capacity of the ring
+ */
+template <std::size_t N>
+void compareWindowAverages(const std::vector<PowerHistoryEntry>& sourceEntries) {
+    constexpr unsigned int NbQueries = 2000;
+    static FixedSizeRingBuffer<PackedPowerHistoryEntry, N> ring;
+    static PowerHistoryPrefixSums<N> sums;
+    ring.reset();
+    sums.reset();
+    for (std::size_t rank = 0; rank < N + N / 3; rank++) { /* Make the ring storage wrap */
+        PackedPowerHistoryEntry entry = (rank % 1000 == 999) ? PackedPowerHistoryEntry::makeGap(3) : PackedPowerHistoryEntry(sourceEntries[rank % sourceEntries.size()]);
+        ring.push(entry);
+        sums.push(entry);
+    }
+    const std::string size = std::to_string(N) + " entries";
+
+    /* Windows from half the ring to the whole ring */
+    long long scanSum = 0;
+    const PackedPowerHistoryEntry* older = nullptr;
+    const PackedPowerHistoryEntry* newer = nullptr;
+    std::size_t olderCount = 0;
+    std::size_t newerCount = 0;
+    ring.getSpans(older, olderCount, newer, newerCount);
+    unsigned long long scannedEntries = 0;
+    Benchmark::Stopwatch stopwatch;
+    for (unsigned int query = 0; query < NbQueries; query++) {
+        std::size_t window = N / 2 + (query * 7919) % (N / 2 + 1);
+        std::size_t fromNewer = std::min(window, newerCount);
+        long long maxPowerSum = 0;
+        unsigned int nbValidEntries = 0;
+        for (std::size_t rank = newerCount - fromNewer; rank < newerCount; rank++) {
+            if (newer[rank].powerValid) {
+                maxPowerSum += newer[rank].maxPower;
+                nbValidEntries++;
+            }
+        }
+        for (std::size_t rank = olderCount - (window - fromNewer); rank < olderCount; rank++) {
+            if (older[rank].powerValid) {
+                maxPowerSum += older[rank].maxPower;
+                nbValidEntries++;
+            }
+        }
+        scanSum += maxPowerSum / nbValidEntries;
+        scannedEntries += window;
+        Benchmark::doNotOptimize(scanSum);
+    }
+    Benchmark::report("scan window average, " + size, NbQueries, stopwatch.elapsedNs(), scannedEntries * sizeof(PackedPowerHistoryEntry));
+
+    long long prefixSum = 0;
+    stopwatch.restart();
+    for (unsigned int query = 0; query < NbQueries; query++) {
+        std::size_t window = N / 2 + (query * 7919) % (N / 2 + 1);
+        typename PowerHistoryPrefixSums<N>::WindowSums windowSums = sums.getLastEntries(window);
+        prefixSum += windowSums.maxPowerSum / windowSums.nbValidEntries;
+        Benchmark::doNotOptimize(prefixSum);
+    }
+    Benchmark::report("prefix sums window average, " + size, NbQueries, stopwatch.elapsedNs());
+
+    if (scanSum != prefixSum) {
+        Benchmark::reportValue("MISMATCH between scan and prefix sums, " + size, static_cast<double>(scanSum - prefixSum), "W");
+    }
+}
+}
+
+/**
+ * @brief Compare the cost of an average over an arbitrary window of the last entries, scanning the entries or using prefix sums (see PowerHistoryPrefixSums)
+ */
+BENCHMARK(PowerHistory, prefixSumWindows) {
+    std::vector<PowerHistoryEntry> entries = makeDayOfEntries();
+    Benchmark::reportValue("prefix sums per entry", sizeof(PowerHistoryPrefixSums<2>) - sizeof(PowerHistoryPrefixSums<1>), "bytes");
+    compareWindowAverages<1024>(entries);
+    compareWindowAverages<16384>(entries);
+    compareWindowAverages<65535>(entries); /* The largest ring prefix sums support */
+}
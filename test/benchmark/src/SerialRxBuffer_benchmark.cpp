@@ -0,0 +1,88 @@
+#include "Benchmark.h"
+
+#include <cstring>
+#include <string>
+
+#include "SpscByteRing.h"
+
+/**
+ * @brief The serial reception buffer design previously used by Stm32SerialDriver, kept as a reference
+ *
+ * The consumer copies pending bytes from the start of a linear buffer and shifts the remaining ones back with memmove().
+ * On target, read() was also masking interrupts for the whole copy, which is not accounted for here.
+ */
+class LegacyMemmoveRxBuffer {
+public:
+    LegacyMemmoveRxBuffer() : len(0), overflowCount(0) {}
+
+    void push(uint8_t byte) {
+        this->buf[this->len] = byte;
+        this->len++;
+        if (this->len >= sizeof(this->buf)) {
+            this->overflowCount++;
+            this->len = 0;
+        }
+    }
+
+    std::size_t pop(uint8_t* buffer, std::size_t maxLen) {
+        std::size_t copied = this->len;
+        if (copied > 0) {
+            if (copied > maxLen) {
+                copied = maxLen;
+            }
+            memcpy(buffer, this->buf, copied);
+            memmove(this->buf, this->buf + copied, this->len - copied);
+            this->len -= copied;
+        }
+        return copied;
+    }
+
+private:
+    uint8_t buf[256];
+    std::size_t len;
+    unsigned int overflowCount;
+};
+
+/**
+ * @brief Measure the consumer cost of draining bursts from a reception buffer
+ *
+ * Each round, the producer pushes @p burstLen bytes one at a time (as the per-byte RX interrupt would), then the consumer drains them
+ * using reads of at most @p readLen bytes. Only the consumer side is timed.
+ */
+template <typename TBuffer>
+static void measureConsumer(const char* designName, std::size_t burstLen, std::size_t readLen) {
+    static const unsigned long nbRounds = 200000;
+    TBuffer buffer;
+    uint8_t readBuf[256];
+    double consumerNs = 0;
+    unsigned long nbReads = 0;
+    unsigned long long nbBytes = 0;
+    uint8_t value = 0;
+    for (unsigned long round = 0; round < nbRounds; round++) {
+        for (std::size_t i = 0; i < burstLen; i++) {
+            buffer.push(value++);
+        }
+        Benchmark::Stopwatch stopwatch;
+        std::size_t got;
+        while ((got = buffer.pop(readBuf, readLen)) > 0) {
+            Benchmark::doNotOptimize(readBuf[0]);
+            nbBytes += got;
+            nbReads++;
+        }
+        consumerNs += stopwatch.elapsedNs();
+    }
+    Benchmark::report(std::string(designName) + " burst=" + std::to_string(burstLen) + " read=" + std::to_string(readLen), nbReads, consumerNs, nbBytes);
+}
+
+static void compareDesigns(std::size_t burstLen, std::size_t readLen) {
+    measureConsumer<LegacyMemmoveRxBuffer>("memmove", burstLen, readLen);
+    measureConsumer<SpscByteRing<256>>("spsc   ", burstLen, readLen);
+}
+
+BENCHMARK(SerialRxBuffer, consumerCost) {
+    compareDesigns(16, 256);   /* Main loop keeps up, everything read at once (the case in main.cpp) */
+    compareDesigns(200, 256);
+    compareDesigns(200, 64);   /* Partial reads, the memmove design shifts the remaining bytes after each read */
+    compareDesigns(200, 16);
+    compareDesigns(200, 1);
+}
@@ -0,0 +1,135 @@
+#include "Benchmark.h"
+#include "BenchmarkSamples.h"
+
+#include <string>
+#include <vector>
+
+#include "TIC/Unframer.h"
+#include "TIC/DatasetExtractor.h"
+#include "TIC/DatasetView.h"
+#include "TicFrameParser.h"
+#include "TicLabelTable.h"
+
+/**
+ * @brief Collects all datasets extracted from a capture
+ */
+struct DatasetCollector {
+    DatasetCollector() : de(DatasetCollector::onDatasetExtracted, this), datasets() {}
+
+    static void onDatasetExtracted(const uint8_t* buf, unsigned int cnt, void* context) {
+        static_cast<DatasetCollector*>(context)->datasets.push_back(std::vector<uint8_t>(buf, buf + cnt));
+    }
+    static void onFrameNewBytes(const uint8_t* buf, unsigned int cnt, void* context) {
+        static_cast<DatasetCollector*>(context)->de.pushBytes(buf, cnt);
+    }
+    static void onFrameComplete(void* context) {
+        static_cast<DatasetCollector*>(context)->de.reset();
+    }
+
+    TIC::DatasetExtractor de;
+    std::vector<std::vector<uint8_t>> datasets;
+};
+
+static std::vector<std::vector<uint8_t>> extractDatasets(const char* samplePath) {
+    std::vector<uint8_t> capture = Benchmark::loadSample(samplePath);
+    DatasetCollector collector;
+    TIC::Unframer unframer(DatasetCollector::onFrameNewBytes, DatasetCollector::onFrameComplete, &collector);
+    unframer.pushBytes(capture.data(), capture.size());
+    return collector.datasets;
+}
+
+/**
+ * @brief Measure the number of datasets per second handled by TicFrameParser::onDatasetExtracted() (checksum, decoding and label dispatch)
+ */
+static void measureParserDatasetRate(const char* samplePath) {
+    std::vector<std::vector<uint8_t>> datasets = extractDatasets(samplePath);
+    static const unsigned long nbReplays = 200;
+    TicFrameParser parser;
+    Benchmark::Stopwatch stopwatch;
+    for (unsigned long replay = 0; replay < nbReplays; replay++) {
+        for (const std::vector<uint8_t>& dataset : datasets) {
+            parser.onDatasetExtracted(dataset.data(), static_cast<unsigned int>(dataset.size()));
+        }
+        parser.onFrameComplete();
+    }
+    double elapsedNs = stopwatch.elapsedNs();
+    Benchmark::doNotOptimize(parser.lastFrameMeasurements);
+    Benchmark::reportValue(Benchmark::sampleName(samplePath) + " parser datasets/s", (datasets.size() * nbReplays) / (elapsedNs / 1e9), "datasets/s");
+}
+
+BENCHMARK(TicLabelDispatch, parserDatasetRate) {
+    measureParserDatasetRate(Benchmark::HistoricalSample);
+    measureParserDatasetRate(Benchmark::StandardSample);
+}
+
+/**
+ * @brief The label dispatch TicFrameParser::onDatasetExtracted() used before TicLabelTable: a chain of string comparisons
+ *
+ * @return A value identifying the label (0 if unknown)
+ */
+static unsigned int labelEqualsChainDispatch(const TIC::DatasetView& dv) {
+    if (dv.labelEquals("DATE")) {
+        return 1;
+    }
+    else if (dv.labelEquals("SINSTS") || dv.labelEquals("PAPP")) {
+        return 2;
+    }
+    else if (dv.labelEquals("URMS1")) {
+        return 3;
+    }
+    else if (dv.labelEquals("IRMS1")) {
+        return 4;
+    }
+    else if (dv.labelEquals("PREF")) {
+        return 5;
+    }
+    else if (dv.labelEquals("PMAX") || dv.labelEquals("SMAXSN")) {
+        return 6;
+    }
+    return 0;
+}
+
+/**
+ * @brief Measure the label dispatch alone (datasets are decoded beforehand), with the former comparison chain and with TicLabelTable
+ */
+static void measureLabelDispatchRate(const char* samplePath) {
+    std::vector<std::vector<uint8_t>> datasets = extractDatasets(samplePath);
+    std::vector<TIC::DatasetView> views;
+    for (const std::vector<uint8_t>& dataset : datasets) {
+        TIC::DatasetView dv(dataset.data(), static_cast<unsigned int>(dataset.size()));
+        if (dv.isValid()) {
+            views.push_back(dv);
+        }
+    }
+    static const unsigned long nbReplays = 2000;
+    unsigned long matches = 0;
+
+    Benchmark::Stopwatch chainStopwatch;
+    for (unsigned long replay = 0; replay < nbReplays; replay++) {
+        for (const TIC::DatasetView& dv : views) {
+            matches += labelEqualsChainDispatch(dv);
+        }
+    }
+    double chainElapsedNs = chainStopwatch.elapsedNs();
+    Benchmark::doNotOptimize(matches);
+
+    Benchmark::Stopwatch tableStopwatch;
+    for (unsigned long replay = 0; replay < nbReplays; replay++) {
+        for (const TIC::DatasetView& dv : views) {
+            matches += TicLabelTable::lookup(dv.labelBuffer, dv.labelSz);
+        }
+    }
+    double tableElapsedNs = tableStopwatch.elapsedNs();
+    Benchmark::doNotOptimize(matches);
+
+    std::string label = Benchmark::sampleName(samplePath);
+    double nbDispatches = static_cast<double>(views.size()) * nbReplays;
+    Benchmark::reportValue(label + " labelEquals() chain datasets/s", nbDispatches / (chainElapsedNs / 1e9), "datasets/s");
+    Benchmark::reportValue(label + " TicLabelTable datasets/s", nbDispatches / (tableElapsedNs / 1e9), "datasets/s");
+    Benchmark::reportValue(label + " speedup", chainElapsedNs / tableElapsedNs, "x");
+}
+
+BENCHMARK(TicLabelDispatch, labelDispatchRate) {
+    measureLabelDispatchRate(Benchmark::HistoricalSample);
+    measureLabelDispatchRate(Benchmark::StandardSample);
+}
@@ -0,0 +1,35 @@
+#include "Benchmark.h"
+
+#include "TraceLog.h"
+
+static void discardTrace(const uint8_t* buf, std::size_t len, void* context) {
+    Benchmark::doNotOptimize(buf[len - 1]);
+}
+
+/**
+ * @brief Measure the cost of TraceLog::log() on the hot path (the ring is drained outside of the measurement, so that no record is dropped)
+ */
+BENCHMARK(TraceLog, logCost) {
+    static TraceLog trace;
+    static const unsigned long nbBatches = 20000;
+    static const unsigned int recordsPerBatch = 32; /* 32 records of up to 14 bytes fit in the ring */
+    double noArgElapsedNs = 0;
+    double threeArgsElapsedNs = 0;
+    for (unsigned long batch = 0; batch < nbBatches; batch++) {
+        Benchmark::Stopwatch stopwatch;
+        for (unsigned int record = 0; record < recordsPerBatch; record++) {
+            trace.log<Trace::MissingTimeGetter>();
+        }
+        noArgElapsedNs += stopwatch.elapsedNs();
+        trace.drain(discardTrace, nullptr);
+        stopwatch.restart();
+        for (unsigned int record = 0; record < recordsPerBatch; record++) {
+            trace.log<Trace::NewComputedPower>(static_cast<int>(record) - 1000, static_cast<int>(batch), true);
+        }
+        threeArgsElapsedNs += stopwatch.elapsedNs();
+        trace.drain(discardTrace, nullptr);
+    }
+    Benchmark::report("log() without argument", nbBatches * recordsPerBatch, noArgElapsedNs);
+    Benchmark::report("log() with 3 arguments", nbBatches * recordsPerBatch, threeArgsElapsedNs);
+    Benchmark::reportValue("records dropped", trace.getDroppedCount(), "records");
+}
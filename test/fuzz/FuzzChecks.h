@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdlib>
+
+#include "TicFrameParser.h"
+
+/**
+ * @brief Abort if the measurements published for a frame break an invariant that the rest of the code relies on
+ *
+ * Aborting lets the fuzzer report the input that led there, as for any crash
+ */
+inline void checkFrameMeasurements(const TicMeasurements& measurements) {
+    if (measurements.instPower.isValid && measurements.instPower.minValue > measurements.instPower.maxValue) {
+        abort();
+    }
+    for (unsigned int phase = 0; phase < TicMeasurements::MaxPhases; phase++) {
+        const TicEvaluatedPower& power = measurements.phasePower[phase];
+        if (power.isValid && power.minValue > power.maxValue) {
+            abort();
+        }
+    }
+    if (measurements.datasets.getCount() > TicLabelTable::LabelCount) {
+        abort();
+    }
+}
+
+/**
+ * @brief A TicFrameParser::FOnNewFrameMeasurementsFunc running checkFrameMeasurements()
+ */
+inline void checkOnNewFrameMeasurements(const TicMeasurements& measurements, void* context) {
+    (void)context;
+    checkFrameMeasurements(measurements);
+}
@@ -0,0 +1,25 @@
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "Tools.h"
+
+/**
+ * @brief The fuzz target, as expected by libFuzzer
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size);
+
+/**
+ * @brief Run the fuzz target once on each file provided on the command line
+ *
+ * This replaces libFuzzer when the compiler does not provide it, so that a corpus or a crashing input can still be replayed (under a debugger, for example)
+ */
+int main(int argc, char* argv[]) {
+    for (int arg = 1; arg < argc; arg++) {
+        std::vector<uint8_t> input = readVectorFromDisk(argv[arg]);
+        printf("Running %s (%zu bytes)\n", argv[arg], input.size());
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+    printf("Executed %d input(s)\n", argc - 1);
+    return 0;
+}
@@ -0,0 +1,30 @@
+#include <cstddef>
+#include <cstdint>
+
+#include "TicFrameParser.h"
+#include "FuzzChecks.h"
+
+/**
+ * @brief Fuzz TicFrameParser::onDatasetExtracted() with arbitrary datasets
+ *
+ * The input is split the way a TIC frame is: the bytes between two dataset markers (LF or CR) are handed over as one dataset,
+ * and an ETX completes the frame. TIC captures (such as ticdecodecpp/test/samples) are thus meaningful seeds.
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
+    TicFrameParser parser(checkOnNewFrameMeasurements, nullptr);
+    std::size_t datasetStart = 0;
+    for (std::size_t pos = 0; pos <= size; pos++) {
+        if (pos < size && data[pos] != 0x0a && data[pos] != 0x0d && data[pos] != 0x03) {
+            continue;
+        }
+        if (pos > datasetStart) {
+            parser.onDatasetExtracted(data + datasetStart, static_cast<unsigned int>(pos - datasetStart));
+        }
+        if (pos < size && data[pos] == 0x03) {  /* ETX */
+            parser.onFrameComplete();
+        }
+        datasetStart = pos + 1;
+    }
+    parser.onFrameComplete();
+    return 0;
+}
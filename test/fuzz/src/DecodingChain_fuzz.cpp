@@ -0,0 +1,35 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "TIC/Unframer.h"
+#include "TicFrameParser.h"
+#include "FuzzChecks.h"
+
+/**
+ * @brief Fuzz the whole decoding chain: TIC::Unframer -> TicFrameParser (datasets decoded by TIC::DatasetExtractor or TicDatasetStreamDecoder)
+ *
+ * The first input byte selects the dataset decoder (bit 7) and the size of the chunks the rest of the input is pushed in (bits 0 to 6, 0 meaning all at once),
+ * so that the fuzzer also explores datasets and frames split across successive receptions.
+ * TIC captures (such as ticdecodecpp/test/samples) are thus meaningful seeds, their first byte being taken as the selector.
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
+    if (size < 1) {
+        return 0;
+    }
+    bool streamingDecoding = ((data[0] & 0x80) != 0);
+    std::size_t chunkSize = data[0] & 0x7f;
+    data++;
+    size--;
+    if (chunkSize == 0) {
+        chunkSize = std::max(size, static_cast<std::size_t>(1));
+    }
+
+    TicFrameParser parser(checkOnNewFrameMeasurements, nullptr);
+    parser.setStreamingDecoding(streamingDecoding);
+    TIC::Unframer unframer(TicFrameParser::unwrapInvokeOnFrameNewBytes, TicFrameParser::unwrapInvokeOnFrameComplete, &parser);
+    for (std::size_t pos = 0; pos < size; pos += chunkSize) {
+        unframer.pushBytes(data + pos, std::min(chunkSize, size - pos));
+    }
+    return 0;
+}
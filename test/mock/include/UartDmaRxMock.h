@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "DmaRxRing.h"
+
+/**
+ * @brief Host-side replacement for a UART whose receiver is served by a DMA channel in circular mode
+ *
+ * This mock writes incoming bytes into the storage of a DmaRxRing exactly like the DMA controller would, and raises the same events
+ * as the STM32 HAL does with HAL_UARTEx_ReceiveToIdle_DMA(): half-transfer when the write position reaches N/2, transfer complete
+ * when it reaches N (and wraps around to 0), and idle line when the line goes silent after some bytes.
+ *
+ * @tparam N The size of the DMA ring storage (in bytes)
+ */
+template <std::size_t N>
+class UartDmaRxMock {
+public:
+    UartDmaRxMock(DmaRxRing<N>& ring) :
+        ring(ring),
+        writePos(0),
+        bytesSinceLastEvent(0)
+    {
+    }
+
+    /**
+     * @brief Simulate the reception of bytes on the UART, the DMA stores them and raises half-transfer/transfer complete events as needed
+     *
+     * @param buf The bytes received on the line
+     * @param len The number of bytes in @p buf
+     */
+    void receive(const uint8_t* buf, std::size_t len) {
+        for (std::size_t i = 0; i < len; i++) {
+            this->ring.getStorage()[this->writePos] = buf[i];
+            this->writePos++;
+            this->bytesSinceLastEvent++;
+            if (this->writePos == N/2) {
+                this->fire(DmaRxRing<N>::HalfTransfer);
+            }
+            else if (this->writePos == N) {
+                this->fire(DmaRxRing<N>::TransferComplete); /* HAL reports position N on transfer complete, the DMA then restarts at 0 */
+                this->writePos = 0;
+            }
+        }
+    }
+
+    /**
+     * @brief Simulate an idle line (no start bit for one character time) after some bytes have been received
+     *
+     * @note Like the UART IDLE flag, this is a no-op when no byte was received since the previous event
+     */
+    void lineIdle() {
+        if (this->bytesSinceLastEvent != 0) {
+            this->fire(DmaRxRing<N>::IdleLine);
+        }
+    }
+
+    /**
+     * @brief Get the current simulated DMA write offset in the ring storage
+     */
+    std::size_t getWritePos() const {
+        return this->writePos;
+    }
+
+private:
+    void fire(typename DmaRxRing<N>::Event event) {
+        this->bytesSinceLastEvent = 0;
+        this->ring.onDmaEvent(event, this->writePos);
+    }
+
+    DmaRxRing<N>& ring; /*!< The ring the simulated DMA writes to */
+    std::size_t writePos;   /*!< Current DMA write offset */
+    std::size_t bytesSinceLastEvent;    /*!< How many bytes were written since the last event was raised */
+};
@@ -0,0 +1,148 @@
+#include "gmock/gmock.h"
+#include <string>
+#include <stdint.h>
+
+#include "DatasetErrorStats.h"
+
+TEST(DatasetErrorStats_tests, instanciation) {
+    DatasetErrorStats stats;
+    DatasetErrorStats::Snapshot snapshot = stats.getSnapshot();
+    EXPECT_EQ(0U, snapshot.errorCount);
+    EXPECT_EQ(0U, snapshot.frameCount);
+    EXPECT_EQ(0U, snapshot.framesWithErrors);
+    EXPECT_EQ(0U, snapshot.burstCount);
+    EXPECT_FALSE(snapshot.inBurst);
+    EXPECT_EQ(TicLabelTable::Unknown, snapshot.getWorstLabel());
+    for (unsigned int label = 0; label < TicLabelTable::LabelCount; label++) {
+        EXPECT_EQ(0U, snapshot.perLabel[label]);
+    }
+    for (unsigned int position = 0; position < DatasetErrorStats::MaxPositions; position++) {
+        EXPECT_EQ(0U, snapshot.perPosition[position]);
+    }
+}
+
+TEST(DatasetErrorStats_tests, perLabelAndPerPositionCounters) {
+    DatasetErrorStats stats;
+    stats.onDatasetError(TicLabelTable::SINSTS, 3);
+    stats.onFrameComplete();
+    stats.onDatasetError(TicLabelTable::SINSTS, 3);
+    stats.onDatasetError(TicLabelTable::URMS1, 5);
+    stats.onDatasetError(TicLabelTable::Unknown, 5);
+    stats.onFrameComplete();
+    stats.onDatasetError(TicLabelTable::Unknown, 1000);   /* Beyond the last position counter */
+    stats.onFrameComplete();
+    stats.onFrameComplete();
+
+    DatasetErrorStats::Snapshot snapshot = stats.getSnapshot();
+    EXPECT_EQ(5U, snapshot.errorCount);
+    EXPECT_EQ(2U, snapshot.perLabel[TicLabelTable::SINSTS]);
+    EXPECT_EQ(1U, snapshot.perLabel[TicLabelTable::URMS1]);
+    EXPECT_EQ(2U, snapshot.perLabel[TicLabelTable::Unknown]);
+    EXPECT_EQ(TicLabelTable::SINSTS, snapshot.getWorstLabel());
+    EXPECT_EQ(2U, snapshot.perPosition[3]);
+    EXPECT_EQ(2U, snapshot.perPosition[5]);
+    EXPECT_EQ(1U, snapshot.perPosition[DatasetErrorStats::MaxPositions - 1]);
+    EXPECT_EQ(4U, snapshot.frameCount);
+    EXPECT_EQ(3U, snapshot.framesWithErrors);
+}
+
+TEST(DatasetErrorStats_tests, spreadErrorsAreNotABurst) {
+    DatasetErrorStats stats(3, 8);
+    for (unsigned int frame = 0; frame < 100; frame++) {
+        if (frame % 4 == 0) {   /* 2 errors per window of 8 frames */
+            EXPECT_FALSE(stats.onDatasetError(TicLabelTable::Unknown, frame % 20));
+        }
+        stats.onFrameComplete();
+    }
+    DatasetErrorStats::Snapshot snapshot = stats.getSnapshot();
+    EXPECT_EQ(25U, snapshot.errorCount);
+    EXPECT_EQ(0U, snapshot.burstCount);
+    EXPECT_FALSE(snapshot.inBurst);
+}
+
+TEST(DatasetErrorStats_tests, burstDetection) {
+    DatasetErrorStats stats(3, 8);
+    for (unsigned int frame = 0; frame < 10; frame++) {
+        stats.onFrameComplete();
+    }
+    EXPECT_FALSE(stats.onDatasetError(TicLabelTable::SINSTS, 2));
+    stats.onFrameComplete();
+    stats.onFrameComplete();
+    EXPECT_FALSE(stats.onDatasetError(TicLabelTable::SINSTS, 2));
+    EXPECT_TRUE(stats.onDatasetError(TicLabelTable::SINSTS, 2));    /* 3 errors within 3 frames */
+    EXPECT_FALSE(stats.onDatasetError(TicLabelTable::SINSTS, 2));   /* Same burst */
+    stats.onFrameComplete();
+
+    DatasetErrorStats::Snapshot snapshot = stats.getSnapshot();
+    EXPECT_EQ(1U, snapshot.burstCount);
+    EXPECT_TRUE(snapshot.inBurst);
+    EXPECT_EQ(12U, snapshot.lastBurst.startFrame);
+    EXPECT_EQ(4U, snapshot.lastBurst.errorCount);
+
+    /* The burst ends after a whole window without errors */
+    for (unsigned int frame = 0; frame < 7; frame++) {
+        stats.onFrameComplete();
+    }
+    EXPECT_TRUE(stats.getSnapshot().inBurst);
+    stats.onFrameComplete();
+    snapshot = stats.getSnapshot();
+    EXPECT_FALSE(snapshot.inBurst);
+    EXPECT_EQ(21U, snapshot.lastBurst.endFrame);
+    EXPECT_EQ(4U, snapshot.lastBurst.errorCount);
+
+    /* Errors that fell out of the window do not count anymore */
+    EXPECT_FALSE(stats.onDatasetError(TicLabelTable::SINSTS, 2));
+    EXPECT_FALSE(stats.onDatasetError(TicLabelTable::SINSTS, 2));
+    EXPECT_TRUE(stats.onDatasetError(TicLabelTable::SINSTS, 2));
+    snapshot = stats.getSnapshot();
+    EXPECT_EQ(2U, snapshot.burstCount);
+    EXPECT_EQ(21U, snapshot.lastBurst.startFrame);
+    EXPECT_EQ(3U, snapshot.lastBurst.errorCount);
+}
+
+TEST(DatasetErrorStats_tests, windowIsClamped) {
+    DatasetErrorStats stats(2, 1000);
+    EXPECT_EQ(DatasetErrorStats::MaxBurstWindowFrames, stats.burstWindowFrames);
+    stats.onDatasetError(TicLabelTable::Unknown, 0);
+    for (unsigned int frame = 0; frame < DatasetErrorStats::MaxBurstWindowFrames; frame++) {
+        stats.onFrameComplete();
+    }
+    EXPECT_FALSE(stats.onDatasetError(TicLabelTable::Unknown, 0));  /* The first error is out of the window */
+    EXPECT_TRUE(stats.onDatasetError(TicLabelTable::Unknown, 0));
+
+    DatasetErrorStats singleFrame(1, 0);
+    EXPECT_EQ(1U, singleFrame.burstWindowFrames);
+    EXPECT_TRUE(singleFrame.onDatasetError(TicLabelTable::Unknown, 0));
+    singleFrame.onFrameComplete();
+    EXPECT_TRUE(singleFrame.getSnapshot().inBurst);
+    singleFrame.onFrameComplete();  /* One frame without errors */
+    EXPECT_FALSE(singleFrame.getSnapshot().inBurst);
+}
+
+TEST(DatasetErrorStats_tests, reset) {
+    DatasetErrorStats stats(1, 4);
+    stats.onDatasetError(TicLabelTable::PAPP, 1);
+    stats.onFrameComplete();
+    stats.reset();
+    DatasetErrorStats::Snapshot snapshot = stats.getSnapshot();
+    EXPECT_EQ(0U, snapshot.errorCount);
+    EXPECT_EQ(0U, snapshot.perLabel[TicLabelTable::PAPP]);
+    EXPECT_EQ(0U, snapshot.frameCount);
+    EXPECT_EQ(0U, snapshot.burstCount);
+    EXPECT_FALSE(snapshot.inBurst);
+    EXPECT_EQ(4U, stats.burstWindowFrames);  /* Settings are kept */
+}
+
+TEST(DatasetErrorStats_tests, findLabel) {
+    auto findLabel = [](const std::string& dataset) {
+        return DatasetErrorStats::findLabel(reinterpret_cast<const uint8_t*>(dataset.data()), dataset.size());
+    };
+    EXPECT_EQ(TicLabelTable::SINSTS, findLabel("SINSTS\t01400\t#"));
+    EXPECT_EQ(TicLabelTable::PAPP, findLabel("PAPP 01400 ?"));
+    EXPECT_EQ(TicLabelTable::SMAXSN1, findLabel("SMAXSN1\tE240502120000\t"));   /* Truncated, but the label is intact */
+    EXPECT_EQ(TicLabelTable::Unknown, findLabel("SINTS\t01400\t#"));    /* Damaged label */
+    EXPECT_EQ(TicLabelTable::Unknown, findLabel("SINSTS"));    /* No separator */
+    EXPECT_EQ(TicLabelTable::Unknown, findLabel("ABCDEFGHIJKLMNOP\t1\t#"));
+    EXPECT_EQ(TicLabelTable::Unknown, findLabel("\t01400\t#"));
+    EXPECT_EQ(TicLabelTable::Unknown, findLabel(""));
+}
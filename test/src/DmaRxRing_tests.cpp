@@ -0,0 +1,142 @@
+#include "gmock/gmock.h"
+#include <vector>
+#include <stdint.h>
+
+#include "DmaRxRing.h"
+#include "UartDmaRxMock.h"
+
+struct ReceivedChunks {
+    std::vector<uint8_t> bytes; /*!< All bytes forwarded, in order */
+    unsigned int nbChunks;  /*!< How many times the callback was invoked */
+    ReceivedChunks() : bytes(), nbChunks(0) {}
+};
+
+static void onDmaBytes(const uint8_t* buf, std::size_t len, void* context) {
+    ReceivedChunks* received = static_cast<ReceivedChunks*>(context);
+    received->bytes.insert(received->bytes.end(), buf, buf + len);
+    received->nbChunks++;
+}
+
+static std::vector<uint8_t> makeSequence(std::size_t len, uint8_t first = 0) {
+    std::vector<uint8_t> result;
+    for (std::size_t i = 0; i < len; i++) {
+        result.push_back(static_cast<uint8_t>(first + i));
+    }
+    return result;
+}
+
+TEST(DmaRxRing_tests, instanciation) {
+    DmaRxRing<64> ring;
+
+    EXPECT_EQ(64, ring.getCapacity());
+    EXPECT_EQ(0, ring.getEventCount(DmaRxRing<64>::IdleLine));
+}
+
+TEST(DmaRxRing_tests, shortBurstForwardedOnIdleLine) {
+    ReceivedChunks received;
+    DmaRxRing<64> ring(onDmaBytes, &received);
+    UartDmaRxMock<64> uart(ring);
+
+    std::vector<uint8_t> burst = makeSequence(20);
+    uart.receive(burst.data(), burst.size());
+    EXPECT_EQ(0, received.nbChunks);    /* No event yet, nothing forwarded */
+
+    uart.lineIdle();
+    EXPECT_EQ(1, received.nbChunks);
+    EXPECT_EQ(burst, received.bytes);
+    EXPECT_EQ(1, ring.getEventCount(DmaRxRing<64>::IdleLine));
+}
+
+TEST(DmaRxRing_tests, idleLineWithoutNewBytes) {
+    ReceivedChunks received;
+    DmaRxRing<64> ring(onDmaBytes, &received);
+
+    EXPECT_EQ(0, ring.onDmaEvent(DmaRxRing<64>::IdleLine, 0));
+    EXPECT_EQ(0, received.nbChunks);
+}
+
+TEST(DmaRxRing_tests, halfTransferThenIdle) {
+    ReceivedChunks received;
+    DmaRxRing<64> ring(onDmaBytes, &received);
+    UartDmaRxMock<64> uart(ring);
+
+    std::vector<uint8_t> burst = makeSequence(40);
+    uart.receive(burst.data(), burst.size());
+    EXPECT_EQ(1, received.nbChunks);    /* Half transfer event raised at offset 32 */
+    EXPECT_EQ(32, received.bytes.size());
+    EXPECT_EQ(1, ring.getEventCount(DmaRxRing<64>::HalfTransfer));
+
+    uart.lineIdle();
+    EXPECT_EQ(2, received.nbChunks);
+    EXPECT_EQ(burst, received.bytes);
+}
+
+TEST(DmaRxRing_tests, exactlyFullRing) {
+    ReceivedChunks received;
+    DmaRxRing<64> ring(onDmaBytes, &received);
+    UartDmaRxMock<64> uart(ring);
+
+    std::vector<uint8_t> burst = makeSequence(64);
+    uart.receive(burst.data(), burst.size());
+    EXPECT_EQ(1, ring.getEventCount(DmaRxRing<64>::HalfTransfer));
+    EXPECT_EQ(1, ring.getEventCount(DmaRxRing<64>::TransferComplete));
+    EXPECT_EQ(burst, received.bytes);
+
+    uart.lineIdle();    /* Transfer complete already flushed everything */
+    EXPECT_EQ(burst, received.bytes);
+    EXPECT_EQ(0, uart.getWritePos());
+}
+
+TEST(DmaRxRing_tests, wrapAroundIsForwardedInOrder) {
+    ReceivedChunks received;
+    DmaRxRing<64> ring(onDmaBytes, &received);
+
+    /* Drive the ring directly, simulating a late idle event that sees the DMA write position after a wrap */
+    std::vector<uint8_t> first = makeSequence(50);
+    std::copy(first.begin(), first.end(), ring.getStorage());
+    EXPECT_EQ(50, ring.onDmaEvent(DmaRxRing<64>::IdleLine, 50));
+
+    std::vector<uint8_t> second = makeSequence(24, 50);
+    for (std::size_t i = 0; i < second.size(); i++) {
+        ring.getStorage()[(50 + i) % 64] = second[i];
+    }
+    EXPECT_EQ(24, ring.onDmaEvent(DmaRxRing<64>::IdleLine, (50 + 24) % 64));
+    EXPECT_EQ(3, received.nbChunks);    /* 1 chunk for the first burst, 2 for the wrapped one */
+    EXPECT_EQ(makeSequence(74), received.bytes);
+}
+
+TEST(DmaRxRing_tests, longStreamWithRandomBursts) {
+    ReceivedChunks received;
+    DmaRxRing<128> ring(onDmaBytes, &received);
+    UartDmaRxMock<128> uart(ring);
+
+    std::vector<uint8_t> expected;
+    unsigned int seed = 1;
+    for (unsigned int burstNb = 0; burstNb < 200; burstNb++) {
+        seed = seed * 1103515245 + 12345;
+        std::size_t burstLen = (seed >> 16) % 300;
+        std::vector<uint8_t> burst = makeSequence(burstLen, static_cast<uint8_t>(expected.size()));
+        uart.receive(burst.data(), burst.size());
+        uart.lineIdle();
+        expected.insert(expected.end(), burst.begin(), burst.end());
+    }
+    EXPECT_EQ(expected, received.bytes);
+}
+
+TEST(DmaRxRing_tests, resetRestartsAtOffset0) {
+    ReceivedChunks received;
+    DmaRxRing<64> ring(onDmaBytes, &received);
+
+    ring.onDmaEvent(DmaRxRing<64>::IdleLine, 10);
+    ring.reset();
+    EXPECT_EQ(0, ring.getEventCount(DmaRxRing<64>::IdleLine));
+    EXPECT_EQ(5, ring.onDmaEvent(DmaRxRing<64>::IdleLine, 5));
+}
+
+TEST(DmaRxRing_tests, outOfBoundsWritePosIsIgnored) {
+    ReceivedChunks received;
+    DmaRxRing<64> ring(onDmaBytes, &received);
+
+    EXPECT_EQ(0, ring.onDmaEvent(DmaRxRing<64>::IdleLine, 65));
+    EXPECT_EQ(0, received.nbChunks);
+}
@@ -16,7 +16,7 @@ TEST(EndToEndDecoding_tests, TriphaseSample) {
 
     PowerHistory powerHistory(PowerHistory::Per5Seconds);
 
-    TicFrameParser ticParser(PowerHistory::unWrapOnNewPowerData, (void *)(&powerHistory));
+    TicFrameParser ticParser(PowerHistory::unWrapOnNewFrameMeasurements, (void *)(&powerHistory));
 
     auto onFrameCompleteBlinkGreenLedAndInvokeHandler = [](void* context) {
         TicFrameParser::unwrapInvokeOnFrameComplete(context);   /* Invoke the frameparser's onFrameComplete handler */
@@ -58,7 +58,7 @@ TEST(EndToEndDecoding_tests, MonophaseMidnightSample) {
 
     PowerHistory powerHistory(PowerHistory::Per5Seconds);
 
-    TicFrameParser ticParser(PowerHistory::unWrapOnNewPowerData, (void *)(&powerHistory));
+    TicFrameParser ticParser(PowerHistory::unWrapOnNewFrameMeasurements, (void *)(&powerHistory));
 
     bool newDayDetected = false;
 
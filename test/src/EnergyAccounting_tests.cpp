@@ -0,0 +1,119 @@
+#include "gmock/gmock.h"
+#include <stdint.h>
+
+#include "EnergyAccounting.h"
+#include "PowerHistory.h"
+
+/**
+ * @brief Feed a steady power to an accounting, with a measurement every @p stepSeconds seconds
+ *
+ * @return The time after the last measurement, in seconds since midnight
+ */
+static unsigned int runSteadyPower(EnergyAccounting& energy, const TicEvaluatedPower& power, unsigned int startSeconds, unsigned int durationSeconds, unsigned int stepSeconds = 2) {
+    unsigned int seconds = startSeconds;
+    for (unsigned int elapsed = 0; elapsed <= durationSeconds; elapsed += stepSeconds) {
+        energy.onNewPowerData(power, TimeOfDay(seconds / 3600, (seconds / 60) % 60, seconds % 60));
+        seconds = (seconds + stepSeconds) % (24 * 3600);
+    }
+    return seconds;
+}
+
+TEST(EnergyAccounting_tests, instanciation) {
+    EnergyAccounting energy;
+    EXPECT_EQ(0U, energy.getToday().withdrawn.getMaxWh());
+    EXPECT_EQ(0U, energy.getToday().injected.getMaxWh());
+    EXPECT_EQ(0U, energy.getPastDayCount());
+    EnergyAccounting::EnergyTotals totals;
+    EXPECT_FALSE(energy.getPastDay(1, totals));
+}
+
+TEST(EnergyAccounting_tests, steadyWithdrawal) {
+    EnergyAccounting energy;
+    runSteadyPower(energy, TicEvaluatedPower(1500, 1500), 10 * 3600, 3600);
+    const EnergyAccounting::EnergyTotals& today = energy.getToday();
+    EXPECT_EQ(1500U, today.withdrawn.getMinWh());
+    EXPECT_EQ(1500U, today.withdrawn.getMaxWh());
+    EXPECT_EQ(0U, today.injected.getMaxWh());
+    EXPECT_EQ(1499U, energy.getHour(10).withdrawn.getMinWh()); /* Each interval is accounted to the hour of the measurement ending it */
+    EXPECT_EQ(1U, energy.getHour(11).withdrawn.getMaxWh());    /* 10:59:58 to 11:00:00 */
+    EXPECT_EQ(energy.getHour(10).withdrawn.minWattMs + energy.getHour(11).withdrawn.minWattMs, today.withdrawn.minWattMs);
+    EXPECT_EQ(0U, energy.getHour(24).withdrawn.getMaxWh());
+}
+
+TEST(EnergyAccounting_tests, injectionRange) {
+    EnergyAccounting energy;
+    runSteadyPower(energy, TicEvaluatedPower(-1200, -800), 12 * 3600, 1800);
+    const EnergyAccounting::EnergyTotals& today = energy.getToday();
+    EXPECT_EQ(0U, today.withdrawn.getMaxWh());
+    EXPECT_EQ(400U, today.injected.getMinWh());
+    EXPECT_EQ(600U, today.injected.getMaxWh());
+
+    /* The direction is unknown: each bound goes to its own side */
+    runSteadyPower(energy, TicEvaluatedPower(-300, 300), 13 * 3600, 3600);
+    EXPECT_EQ(0U, today.withdrawn.getMinWh());
+    EXPECT_EQ(300U, today.withdrawn.getMaxWh());
+    EXPECT_EQ(400U, today.injected.getMinWh());
+    EXPECT_EQ(900U, today.injected.getMaxWh());
+}
+
+TEST(EnergyAccounting_tests, realIntervalToTheMillisecond) {
+    EnergyAccounting energy;
+    energy.onNewPowerData(TicEvaluatedPower(3600, 3600), TimeOfDay(8, 0, 0, 250));
+    energy.onNewPowerData(TicEvaluatedPower(0, 0), TimeOfDay(8, 0, 1, 750));   /* 3600W held for 1.5s */
+    EXPECT_EQ(3600U * 1500U, energy.getToday().withdrawn.minWattMs);
+    EXPECT_EQ(1U, energy.getToday().withdrawn.getMinWh());    /* 1.5Wh */
+    EXPECT_EQ(2U, energy.getToday().withdrawn.getMaxWh());
+}
+
+TEST(EnergyAccounting_tests, gapsAndBackwardsTimeAreNotIntegrated) {
+    EnergyAccounting energy(60);
+    energy.onNewPowerData(TicEvaluatedPower(1000, 1000), TimeOfDay(8, 0, 0));
+    energy.onNewPowerData(TicEvaluatedPower(1000, 1000), TimeOfDay(9, 0, 0));  /* No data for an hour */
+    EXPECT_EQ(0U, energy.getToday().withdrawn.maxWattMs);
+    EXPECT_EQ(1U, energy.skippedIntervals);
+    energy.onNewPowerData(TicEvaluatedPower(1000, 1000), TimeOfDay(8, 59, 0));  /* Clock adjusted backwards */
+    EXPECT_EQ(0U, energy.getToday().withdrawn.maxWattMs);
+    EXPECT_EQ(2U, energy.skippedIntervals);
+    energy.onNewPowerData(TicEvaluatedPower(), TimeOfDay(8, 59, 30));   /* Ignored */
+    energy.onNewPowerData(TicEvaluatedPower(1000, 1000), TimeOfDay(8, 59, 36));
+    EXPECT_EQ(1000U * 36000U, energy.getToday().withdrawn.maxWattMs);
+}
+
+TEST(EnergyAccounting_tests, dayOverKeepsSevenPastDays) {
+    EnergyAccounting energy;
+    unsigned int seconds = 23 * 3600;
+    for (unsigned int day = 1; day <= 9; day++) {
+        seconds = runSteadyPower(energy, TicEvaluatedPower(static_cast<int>(day) * 100, static_cast<int>(day) * 100), seconds, 3600 - 2);
+        energy.onDayOver();
+        EXPECT_EQ(0U, energy.getToday().withdrawn.maxWattMs);
+        EXPECT_EQ(0U, energy.getHour(23).withdrawn.maxWattMs);
+    }
+    EXPECT_EQ(EnergyAccounting::PastDays, energy.getPastDayCount());
+    EnergyAccounting::EnergyTotals totals;
+    ASSERT_TRUE(energy.getPastDay(1, totals));
+    EXPECT_EQ(900U, totals.withdrawn.getMaxWh());  /* Slightly less than 900Wh, as its first 2s were held at the power of the day before */
+    EXPECT_EQ(899U, totals.withdrawn.getMinWh());
+    ASSERT_TRUE(energy.getPastDay(7, totals));
+    EXPECT_EQ(300U, totals.withdrawn.getMaxWh());
+    EXPECT_FALSE(energy.getPastDay(8, totals));
+    EXPECT_FALSE(energy.getPastDay(0, totals));
+
+    energy.reset();
+    EXPECT_EQ(0U, energy.getPastDayCount());
+}
+
+TEST(EnergyAccounting_tests, acrossMidnight) {
+    EnergyAccounting energy;
+    energy.onNewPowerData(TicEvaluatedPower(1800, 1800), TimeOfDay(23, 59, 59));
+    energy.onNewPowerData(TicEvaluatedPower(1800, 1800), TimeOfDay(0, 0, 1));
+    EXPECT_EQ(1800U * 2000U, energy.getToday().withdrawn.minWattMs);
+    EXPECT_EQ(1800U * 2000U, energy.getHour(0).withdrawn.minWattMs);
+}
+
+TEST(EnergyAccounting_tests, fedByPowerHistory) {
+    PowerHistory ph(PowerHistory::Per5Seconds);
+    for (unsigned int second = 0; second <= 3600; second += 2) {
+        ph.onNewPowerData(TicEvaluatedPower(2000, 2000), TimeOfDay(15 + second / 3600, (second / 60) % 60, second % 60), second);
+    }
+    EXPECT_EQ(2000U, ph.energy.getToday().withdrawn.getMinWh());
+}
@@ -0,0 +1,139 @@
+#include "gmock/gmock.h"
+#include <stdint.h>
+
+#include "EnergyDeltaEstimator.h"
+#include "TicFrameParser.h"
+
+/**
+ * @brief A meter with a steady power between calls to run(), emitting a frame every 2 seconds
+ */
+struct SimulatedMeter {
+    SimulatedMeter(unsigned int startSeconds) :
+        timeSeconds(startSeconds),
+        withdrawnWh(1000000.0),
+        injectedWh(500000.0)
+    {
+    }
+
+    /**
+     * @brief Run the meter for some time, feeding the indices of each frame to an estimator
+     *
+     * @param power The power during that time (positive if withdrawn, negative if injected), in W
+     * @param seconds The duration
+     */
+    void run(int power, unsigned int seconds, EnergyDeltaEstimator& estimator) {
+        for (unsigned int elapsed = 0; elapsed < seconds; elapsed += 2) {
+            this->timeSeconds = (this->timeSeconds + 2) % (24 * 3600);
+            if (power > 0) {
+                this->withdrawnWh += power * 2.0 / 3600.0;
+            }
+            else {
+                this->injectedWh += -power * 2.0 / 3600.0;
+            }
+            estimator.onNewIndexes(this->now(), this->withdrawnIndex(), this->injectedIndex());
+        }
+    }
+
+    TimeOfDay now() const {
+        return TimeOfDay(this->timeSeconds / 3600, (this->timeSeconds / 60) % 60, this->timeSeconds % 60);
+    }
+    uint32_t withdrawnIndex() const {
+        return static_cast<uint32_t>(this->withdrawnWh);
+    }
+    uint32_t injectedIndex() const {
+        return static_cast<uint32_t>(this->injectedWh);
+    }
+
+    unsigned int timeSeconds;
+    double withdrawnWh;
+    double injectedWh;
+};
+
+static TicEvaluatedPower refineInjectionRange(const EnergyDeltaEstimator& estimator, const SimulatedMeter& meter) {
+    TicEvaluatedPower power(-805, -575);   /* 3A at 230V, injecting */
+    estimator.refine(meter.now(), meter.withdrawnIndex(), meter.injectedIndex(), power);
+    return power;
+}
+
+TEST(EnergyDeltaEstimator_tests, noHistoryNoRefinement) {
+    EnergyDeltaEstimator estimator;
+    SimulatedMeter meter(12 * 3600);
+
+    TicEvaluatedPower power(-805, -575);
+    EXPECT_FALSE(estimator.refine(meter.now(), meter.withdrawnIndex(), meter.injectedIndex(), power));
+    EXPECT_EQ(TicEvaluatedPower(-805, -575), power);
+}
+
+TEST(EnergyDeltaEstimator_tests, steadyInjectionNarrowsRange) {
+    EnergyDeltaEstimator estimator;
+    SimulatedMeter meter(12 * 3600);
+
+    meter.run(-700, 300, estimator);
+    TicEvaluatedPower power = refineInjectionRange(estimator, meter);
+    EXPECT_TRUE(power.isValid);
+    EXPECT_LE(power.minValue, -700);
+    EXPECT_GE(power.maxValue, -700);
+    EXPECT_LE(power.maxValue - power.minValue, 40);    /* Instead of 230 */
+}
+
+TEST(EnergyDeltaEstimator_tests, windowsAcrossAPowerChangeAreIgnored) {
+    EnergyDeltaEstimator estimator;
+    SimulatedMeter meter(12 * 3600);
+
+    meter.run(2000, 240, estimator);
+    meter.run(-700, 30, estimator);
+    TicEvaluatedPower power = refineInjectionRange(estimator, meter);
+    EXPECT_TRUE(power.isValid);
+    EXPECT_LE(power.minValue, -700);
+    EXPECT_GE(power.maxValue, -700);
+    EXPECT_LE(power.maxValue - power.minValue, 230);
+}
+
+TEST(EnergyDeltaEstimator_tests, longerWindowsGiveNarrowerRanges) {
+    EnergyDeltaEstimator shortEstimator(60);
+    EnergyDeltaEstimator longEstimator(300);
+    SimulatedMeter shortMeter(12 * 3600);
+    SimulatedMeter longMeter(12 * 3600);
+
+    shortMeter.run(-700, 300, shortEstimator);
+    longMeter.run(-700, 300, longEstimator);
+    TicEvaluatedPower shortPower = refineInjectionRange(shortEstimator, shortMeter);
+    TicEvaluatedPower longPower = refineInjectionRange(longEstimator, longMeter);
+    EXPECT_LE(shortPower.minValue, -700);
+    EXPECT_GE(shortPower.maxValue, -700);
+    EXPECT_LT(longPower.maxValue - longPower.minValue, shortPower.maxValue - shortPower.minValue);
+}
+
+TEST(EnergyDeltaEstimator_tests, windowOverMidnight) {
+    EnergyDeltaEstimator estimator;
+    SimulatedMeter meter(23 * 3600 + 58 * 60);
+
+    meter.run(-700, 240, estimator);
+    EXPECT_EQ(2 * 60U, meter.timeSeconds);
+    TicEvaluatedPower power = refineInjectionRange(estimator, meter);
+    EXPECT_LE(power.minValue, -700);
+    EXPECT_GE(power.maxValue, -700);
+    EXPECT_LE(power.maxValue - power.minValue, 50);
+}
+
+TEST(EnergyDeltaEstimator_tests, storesOnlyIndexVariations) {
+    EnergyDeltaEstimator estimator(320); /* At most one sample every 10s */
+
+    estimator.onNewIndexes(TimeOfDay(12, 0, 0), 1000, 500);
+    estimator.onNewIndexes(TimeOfDay(12, 0, 4), 1000, 500);
+    EXPECT_EQ(1U, estimator.getSampleCount());
+    estimator.onNewIndexes(TimeOfDay(12, 0, 8), 1000, 501);  /* Too close to the previous sample */
+    EXPECT_EQ(1U, estimator.getSampleCount());
+    estimator.onNewIndexes(TimeOfDay(12, 0, 20), 1000, 501);
+    EXPECT_EQ(2U, estimator.getSampleCount());
+    estimator.onNewIndexes(TimeOfDay(12, 0, 30), 1000, 0);   /* Corrupted injection index */
+    estimator.onNewIndexes(TimeOfDay(12, 0, 40), 999, 501);  /* Corrupted withdrawal index */
+    estimator.onNewIndexes(TimeOfDay(), 1001, 502); /* No timestamp */
+    EXPECT_EQ(2U, estimator.getSampleCount());
+    for (unsigned int step = 1; step <= EnergyDeltaEstimator::MaxSamples; step++) {
+        estimator.onNewIndexes(TimeOfDay(12, 1 + step / 6, (step % 6) * 10), 1000 + step, 501);
+    }
+    EXPECT_EQ(EnergyDeltaEstimator::MaxSamples, estimator.getSampleCount());
+    estimator.reset();
+    EXPECT_EQ(0U, estimator.getSampleCount());
+}
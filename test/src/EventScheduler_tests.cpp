@@ -0,0 +1,235 @@
+#include "gmock/gmock.h"
+#include <stdint.h>
+#include <vector>
+
+#include "EventScheduler.h"
+#include "../tools/VirtualClock.h"
+
+/**
+ * @brief A simulated system: a scheduler running on a virtual clock, with handlers that consume virtual time
+ */
+struct SimulatedSystem {
+    VirtualClock clock;
+    EventScheduler scheduler;
+    std::vector<EventScheduler::Event> dispatched;  /*!< All events handled, in order */
+    uint32_t handlerCost[EventScheduler::EventCount];   /*!< The virtual time consumed by each handler (in µs) */
+
+    SimulatedSystem() :
+        clock(),
+        scheduler(VirtualClock::getTime, &clock, VirtualClock::sleep, &clock),
+        dispatched(),
+        handlerCost()
+    {
+    }
+};
+
+struct HandlerBinding {
+    SimulatedSystem* system;
+    EventScheduler::Event event;
+};
+
+static void recordingHandler(void* context) {
+    HandlerBinding* binding = static_cast<HandlerBinding*>(context);
+    binding->system->dispatched.push_back(binding->event);
+    binding->system->clock.advance(binding->system->handlerCost[binding->event]);
+}
+
+struct InterruptBinding {
+    EventScheduler* scheduler;
+    EventScheduler::Event event;
+};
+
+static void postingInterrupt(void* context) {
+    InterruptBinding* binding = static_cast<InterruptBinding*>(context);
+    binding->scheduler->post(binding->event);
+}
+
+static uint32_t zeroClock(void* context) {
+    return 0;
+}
+
+static bool isFlagSet(void* context) {
+    return *static_cast<bool*>(context);
+}
+
+static void setFlag(void* context) {
+    *static_cast<bool*>(context) = true;
+}
+
+TEST(EventScheduler_tests, dispatchesPostedEvent) {
+    EventScheduler scheduler(zeroClock);
+    bool handled = false;
+    scheduler.setHandler(EventScheduler::RxData, setFlag, &handled);
+
+    EXPECT_FALSE(scheduler.hasPendingEvents());
+    EXPECT_FALSE(scheduler.dispatchOne());
+    scheduler.post(EventScheduler::RxData);
+    EXPECT_TRUE(scheduler.hasPendingEvents());
+    EXPECT_TRUE(scheduler.dispatchOne());
+    EXPECT_TRUE(handled);
+    EXPECT_FALSE(scheduler.hasPendingEvents());
+    EXPECT_FALSE(scheduler.dispatchOne());
+    EXPECT_EQ(1U, scheduler.getStats(EventScheduler::RxData).dispatchCount);
+}
+
+TEST(EventScheduler_tests, repeatedPostsAreCoalesced) {
+    EventScheduler scheduler(zeroClock);
+    unsigned int count = 0;
+    scheduler.setHandler(EventScheduler::RxData, [](void* context) { (*static_cast<unsigned int*>(context))++; }, &count);
+
+    scheduler.post(EventScheduler::RxData);
+    scheduler.post(EventScheduler::RxData);
+    scheduler.post(EventScheduler::RxData);
+    EXPECT_EQ(1U, scheduler.dispatchPending());
+    EXPECT_EQ(1U, count);
+    EXPECT_EQ(2U, scheduler.getStats(EventScheduler::RxData).coalescedCount);
+}
+
+TEST(EventScheduler_tests, eventWithoutHandlerIsConsumed) {
+    EventScheduler scheduler(zeroClock);
+    scheduler.post(EventScheduler::DisplayRefreshed);
+    EXPECT_TRUE(scheduler.dispatchOne());
+    EXPECT_FALSE(scheduler.hasPendingEvents());
+    EXPECT_EQ(1U, scheduler.getStats(EventScheduler::DisplayRefreshed).dispatchCount);
+}
+
+TEST(EventScheduler_tests, highestPriorityFirst) {
+    SimulatedSystem system;
+    HandlerBinding bindings[EventScheduler::EventCount];
+    const uint8_t priorities[EventScheduler::EventCount] = { 3, 3, 1, 1, 2 };
+    for (unsigned int event = 0; event < EventScheduler::EventCount; event++) {
+        bindings[event] = HandlerBinding{&system, static_cast<EventScheduler::Event>(event)};
+        system.scheduler.setHandler(static_cast<EventScheduler::Event>(event), recordingHandler, &bindings[event], priorities[event]);
+    }
+
+    system.scheduler.post(EventScheduler::Dma2dDone);
+    system.scheduler.post(EventScheduler::SecondTick);
+    system.scheduler.post(EventScheduler::RxIdle);
+    system.scheduler.post(EventScheduler::DisplayRefreshed);
+    system.scheduler.post(EventScheduler::RxData);
+    EXPECT_EQ(5U, system.scheduler.dispatchPending());
+
+    std::vector<EventScheduler::Event> expected = {
+        EventScheduler::RxData, EventScheduler::RxIdle, /* Same priority: event order */
+        EventScheduler::SecondTick,
+        EventScheduler::DisplayRefreshed, EventScheduler::Dma2dDone
+    };
+    EXPECT_EQ(expected, system.dispatched);
+}
+
+TEST(EventScheduler_tests, eventPostedByHandlerIsDispatchedAfterwards) {
+    EventScheduler scheduler(zeroClock);
+    struct Context {
+        EventScheduler* scheduler;
+        bool tickHandled;
+    } context = { &scheduler, false };
+    scheduler.setHandler(EventScheduler::RxIdle, [](void* context) {
+        static_cast<Context*>(context)->scheduler->post(EventScheduler::SecondTick);
+    }, &context);
+    scheduler.setHandler(EventScheduler::SecondTick, [](void* context) {
+        static_cast<Context*>(context)->tickHandled = true;
+    }, &context);
+
+    scheduler.post(EventScheduler::RxIdle);
+    EXPECT_TRUE(scheduler.dispatchOne());
+    EXPECT_FALSE(context.tickHandled);  /* Run to completion, no nesting */
+    EXPECT_TRUE(scheduler.dispatchOne());
+    EXPECT_TRUE(context.tickHandled);
+}
+
+TEST(EventScheduler_tests, runUntilSleepsUntilConditionIsMet) {
+    SimulatedSystem system;
+    bool displayed = false;
+    system.scheduler.setHandler(EventScheduler::DisplayRefreshed, setFlag, &displayed);
+    InterruptBinding dsi = { &system.scheduler, EventScheduler::DisplayRefreshed };
+    system.clock.scheduleInterrupt(16600, postingInterrupt, &dsi);
+
+    EXPECT_TRUE(system.scheduler.runUntil(isFlagSet, &displayed));
+    EXPECT_EQ(16600U, system.clock.now()); /* We woke up exactly on the end of refresh */
+    EXPECT_EQ(17U, system.clock.getIdleCount());   /* Slept, with one wake up per idle step (ms), no busy-wait */
+    EXPECT_EQ(0U, system.scheduler.getStats(EventScheduler::DisplayRefreshed).maxLatency);
+}
+
+TEST(EventScheduler_tests, runUntilTimesOut) {
+    SimulatedSystem system;
+    bool neverSet = false;
+    EXPECT_FALSE(system.scheduler.runUntil(isFlagSet, &neverSet, 5000000));
+    EXPECT_EQ(5000000U, system.clock.now());
+    EXPECT_EQ(5000U, system.clock.getIdleCount());
+}
+
+TEST(EventScheduler_tests, runUntilReturnsImmediatelyIfConditionHolds) {
+    SimulatedSystem system;
+    bool alreadySet = true;
+    EXPECT_TRUE(system.scheduler.runUntil(isFlagSet, &alreadySet, 0));
+    EXPECT_EQ(0U, system.clock.getIdleCount());
+}
+
+TEST(EventScheduler_tests, latencyIncludesLowerPriorityHandlerInProgress) {
+    SimulatedSystem system;
+    HandlerBinding rx = { &system, EventScheduler::RxData };
+    HandlerBinding tick = { &system, EventScheduler::SecondTick };
+    system.scheduler.setHandler(EventScheduler::RxData, recordingHandler, &rx, 3);
+    system.scheduler.setHandler(EventScheduler::SecondTick, recordingHandler, &tick, 1);
+    system.handlerCost[EventScheduler::RxData] = 200;
+    system.handlerCost[EventScheduler::SecondTick] = 3000;
+
+    InterruptBinding tickIrq = { &system.scheduler, EventScheduler::SecondTick };
+    InterruptBinding rxIrq = { &system.scheduler, EventScheduler::RxData };
+    system.clock.scheduleInterrupt(500, postingInterrupt, &tickIrq);
+    system.clock.scheduleInterrupt(1000, postingInterrupt, &rxIrq); /* Occurs while the tick handler runs */
+
+    system.scheduler.runUntil(nullptr, nullptr, 10000);
+
+    EventScheduler::EventStats rxStats = system.scheduler.getStats(EventScheduler::RxData);
+    EXPECT_EQ(1U, rxStats.dispatchCount);
+    EXPECT_EQ(2500U, rxStats.maxLatency);  /* Handlers are not preempted: RX waits for the end of the tick handler at 3500µs */
+    EXPECT_EQ(200U, rxStats.maxRunTime);
+    EventScheduler::EventStats tickStats = system.scheduler.getStats(EventScheduler::SecondTick);
+    EXPECT_EQ(0U, tickStats.maxLatency);
+    EXPECT_EQ(3000U, tickStats.maxRunTime);
+}
+
+TEST(EventScheduler_tests, rxLatencyUnderLoad) {
+    /* RX bursts every 10ms (DMA idle line), a 1s tick, and a display refresh every 16.6ms with a long handler */
+    SimulatedSystem system;
+    HandlerBinding bindings[EventScheduler::EventCount];
+    const uint8_t priorities[EventScheduler::EventCount] = { 3, 3, 1, 1, 2 };
+    for (unsigned int event = 0; event < EventScheduler::EventCount; event++) {
+        bindings[event] = HandlerBinding{&system, static_cast<EventScheduler::Event>(event)};
+        system.scheduler.setHandler(static_cast<EventScheduler::Event>(event), recordingHandler, &bindings[event], priorities[event]);
+    }
+    system.handlerCost[EventScheduler::RxIdle] = 150;
+    system.handlerCost[EventScheduler::SecondTick] = 50;
+    system.handlerCost[EventScheduler::DisplayRefreshed] = 4000;
+
+    InterruptBinding rxIrq = { &system.scheduler, EventScheduler::RxIdle };
+    InterruptBinding tickIrq = { &system.scheduler, EventScheduler::SecondTick };
+    InterruptBinding dsiIrq = { &system.scheduler, EventScheduler::DisplayRefreshed };
+    system.clock.scheduleInterrupt(3000, postingInterrupt, &rxIrq, 10000);
+    system.clock.scheduleInterrupt(1000000, postingInterrupt, &tickIrq, 1000000);
+    system.clock.scheduleInterrupt(0, postingInterrupt, &dsiIrq, 16600);
+
+    system.scheduler.runUntil(nullptr, nullptr, 10500000); /* 10.5s */
+
+    EventScheduler::EventStats rxStats = system.scheduler.getStats(EventScheduler::RxIdle);
+    EXPECT_EQ(1050U, rxStats.dispatchCount);   /* No RX event lost or coalesced */
+    EXPECT_EQ(0U, rxStats.coalescedCount);
+    EXPECT_LE(rxStats.maxLatency, 4000U + 50U);   /* Bounded by the longest lower priority handler */
+    EXPECT_GT(rxStats.maxLatency, 0U);
+    EXPECT_LT(rxStats.getAverageLatency(), rxStats.maxLatency);
+    EXPECT_EQ(10U, system.scheduler.getStats(EventScheduler::SecondTick).dispatchCount);
+    EXPECT_GT(system.clock.getIdleCount(), 0U);
+}
+
+TEST(EventScheduler_tests, resetStats) {
+    SimulatedSystem system;
+    system.scheduler.post(EventScheduler::RxData);
+    system.scheduler.post(EventScheduler::RxData);
+    system.scheduler.dispatchPending();
+    system.scheduler.resetStats();
+    EventScheduler::EventStats stats = system.scheduler.getStats(EventScheduler::RxData);
+    EXPECT_EQ(0U, stats.dispatchCount);
+    EXPECT_EQ(0U, stats.coalescedCount);
+    EXPECT_EQ(0U, stats.getAverageLatency());
+}
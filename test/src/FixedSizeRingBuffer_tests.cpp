@@ -185,4 +185,45 @@ TEST(FixedSizeRingBuffer_tests, toVector_empty) {
     FixedSizeRingBuffer<uint16_t, 256> rbuf;
 
     EXPECT_EQ(rbuf.toVector(), std::vector<uint16_t>());
-}
\ No newline at end of file
+}
+
+TEST(FixedSizeRingBuffer_tests, getSpans) {
+    FixedSizeRingBuffer<uint16_t, 4> rbuf;
+    const uint16_t* older = nullptr;
+    const uint16_t* newer = nullptr;
+    std::size_t olderCount = 99;
+    std::size_t newerCount = 99;
+
+    rbuf.getSpans(older, olderCount, newer, newerCount);
+    EXPECT_EQ(0U, olderCount);
+    EXPECT_EQ(0U, newerCount);
+
+    rbuf.push(1);
+    rbuf.push(2);
+    rbuf.push(3);
+    rbuf.getSpans(older, olderCount, newer, newerCount);
+    ASSERT_EQ(3U, olderCount);
+    EXPECT_EQ(0U, newerCount);
+    EXPECT_EQ(std::vector<uint16_t>({1, 2, 3}), std::vector<uint16_t>(older, older + olderCount));
+
+    rbuf.push(4);   /* Full, no wrap yet */
+    rbuf.getSpans(older, olderCount, newer, newerCount);
+    ASSERT_EQ(4U, olderCount);
+    EXPECT_EQ(0U, newerCount);
+    EXPECT_EQ(std::vector<uint16_t>({1, 2, 3, 4}), std::vector<uint16_t>(older, older + olderCount));
+
+    rbuf.push(5);
+    rbuf.push(6);   /* Full and wrapped */
+    rbuf.getSpans(older, olderCount, newer, newerCount);
+    ASSERT_EQ(2U, olderCount);
+    ASSERT_EQ(2U, newerCount);
+    EXPECT_EQ(std::vector<uint16_t>({3, 4}), std::vector<uint16_t>(older, older + olderCount));
+    EXPECT_EQ(std::vector<uint16_t>({5, 6}), std::vector<uint16_t>(newer, newer + newerCount));
+
+    EXPECT_EQ(3, rbuf.pop());   /* Not full, still wrapped */
+    rbuf.getSpans(older, olderCount, newer, newerCount);
+    ASSERT_EQ(1U, olderCount);
+    ASSERT_EQ(2U, newerCount);
+    EXPECT_EQ(4, older[0]);
+    EXPECT_EQ(std::vector<uint16_t>({5, 6}), std::vector<uint16_t>(newer, newer + newerCount));
+}
@@ -0,0 +1,142 @@
+#include "gmock/gmock.h"
+#include <thread>
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+#include "../tools/Tools.h"
+#include "TIC/Unframer.h"
+#include "TicFrameParser.h"
+
+static const char* captures[] = {
+    "./ticdecodecpp/test/samples/continuous_linky_3P_historical_TIC_2024_sample.bin",
+    "./ticdecodecpp/test/samples/continuous_linky_3P_historical_TIC_with_rx_errors.bin",
+    "./ticdecodecpp/test/samples/linky_1P_midnight.bin",
+};
+static const unsigned int nbCaptures = sizeof(captures) / sizeof(captures[0]);
+
+/**
+ * @brief A power data as published by TicFrameParser
+ */
+struct PublishedPower {
+    bool operator==(const PublishedPower& other) const {
+        bool sameTimestamp = (this->timestamp.isValid == other.timestamp.isValid) && (!this->timestamp.isValid || this->timestamp == other.timestamp); /* Two invalid TimeOfDay never compare equal */
+        return this->power == other.power && sameTimestamp && this->frameId == other.frameId;
+    }
+
+    TicEvaluatedPower power;
+    TimeOfDay timestamp;
+    unsigned int frameId;
+};
+
+/**
+ * @brief Everything we get out of the decoding of one meter's stream
+ */
+struct DecodingResult {
+    DecodingResult() : powers(), nbDatasetErrors(0), nbDaysOver(0) {}
+
+    bool operator==(const DecodingResult& other) const {
+        return this->powers == other.powers && this->nbDatasetErrors == other.nbDatasetErrors && this->nbDaysOver == other.nbDaysOver;
+    }
+
+    std::vector<PublishedPower> powers;
+    unsigned int nbDatasetErrors;
+    unsigned int nbDaysOver;
+};
+
+/**
+ * @brief A complete decoding chain (unframer and parser) for one meter
+ */
+struct MeterDecoder {
+    MeterDecoder() :
+        result(),
+        parser(MeterDecoder::onNewFrameMeasurements, this),
+        unframer(TicFrameParser::unwrapInvokeOnFrameNewBytes, TicFrameParser::unwrapInvokeOnFrameComplete, &parser)
+    {
+        this->parser.invokeOnDatasetError([](void* context) { static_cast<MeterDecoder*>(context)->result.nbDatasetErrors++; }, this);
+        this->parser.invokeWhenDayOver([](void* context) { static_cast<MeterDecoder*>(context)->result.nbDaysOver++; }, this);
+    }
+
+    static void onNewFrameMeasurements(const TicMeasurements& measurements, void* context) {
+        if (measurements.instPower.isValid) {
+            static_cast<MeterDecoder*>(context)->result.powers.push_back(PublishedPower{measurements.instPower, measurements.timestamp, measurements.fromFrameNb});
+        }
+    }
+
+    void pushBytes(const uint8_t* buf, std::size_t len) {
+        this->unframer.pushBytes(buf, len);
+    }
+
+    DecodingResult result;
+    TicFrameParser parser;
+    TIC::Unframer unframer;
+};
+
+static DecodingResult decodeCapture(const std::vector<uint8_t>& capture, std::size_t chunkSize, bool streamingDecoding = true) {
+    MeterDecoder decoder;
+    decoder.parser.setStreamingDecoding(streamingDecoding);
+    for (std::size_t pos = 0; pos < capture.size(); pos += chunkSize) {
+        decoder.pushBytes(capture.data() + pos, std::min(chunkSize, capture.size() - pos));
+    }
+    return decoder.result;
+}
+
+TEST(MultiMeterDecoding_tests, interleavedParsersDoNotInterfere) {
+    std::vector<uint8_t> production = readVectorFromDisk(captures[0]);
+    std::vector<uint8_t> consumption = readVectorFromDisk(captures[2]);
+    DecodingResult expectedProduction = decodeCapture(production, production.size());
+    DecodingResult expectedConsumption = decodeCapture(consumption, consumption.size());
+    ASSERT_FALSE(expectedProduction.powers.empty());
+    ASSERT_FALSE(expectedConsumption.powers.empty());
+
+    /* Two meters on two serial ports, their bytes are handled alternately by the same thread */
+    MeterDecoder productionDecoder;
+    MeterDecoder consumptionDecoder;
+    for (std::size_t pos = 0; pos < std::max(production.size(), consumption.size()); pos++) {
+        if (pos < production.size()) {
+            productionDecoder.pushBytes(&production[pos], 1);
+        }
+        if (pos < consumption.size()) {
+            consumptionDecoder.pushBytes(&consumption[pos], 1);
+        }
+    }
+    EXPECT_TRUE(expectedProduction == productionDecoder.result);
+    EXPECT_TRUE(expectedConsumption == consumptionDecoder.result);
+}
+
+TEST(MultiMeterDecoding_tests, concurrentDecodingMatchesSerialDecoding) {
+    static const unsigned int nbThreads = 8;
+    std::vector<std::vector<uint8_t>> captureData;
+    std::vector<DecodingResult> expected;
+    for (unsigned int capture = 0; capture < nbCaptures; capture++) {
+        captureData.push_back(readVectorFromDisk(captures[capture]));
+        expected.push_back(decodeCapture(captureData.back(), captureData.back().size()));
+        ASSERT_FALSE(expected.back().powers.empty()) << captures[capture];
+    }
+
+    std::vector<DecodingResult> results(nbThreads);
+    std::vector<std::thread> threads;
+    for (unsigned int thread = 0; thread < nbThreads; thread++) {
+        threads.emplace_back([thread, &captureData, &results]() {
+            /* Small chunks, so that threads interleave within frames */
+            results[thread] = decodeCapture(captureData[thread % nbCaptures], 1 + thread);
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for (unsigned int thread = 0; thread < nbThreads; thread++) {
+        EXPECT_TRUE(expected[thread % nbCaptures] == results[thread]) << "Thread " << thread << " decoding " << captures[thread % nbCaptures];
+    }
+}
+
+TEST(MultiMeterDecoding_tests, streamingDecodingMatchesExtractorDecoding) {
+    for (unsigned int capture = 0; capture < nbCaptures; capture++) {
+        std::vector<uint8_t> data = readVectorFromDisk(captures[capture]);
+        DecodingResult extracted = decodeCapture(data, 7, false);
+        DecodingResult streamed = decodeCapture(data, 7, true);
+        ASSERT_FALSE(extracted.powers.empty()) << captures[capture];
+        EXPECT_TRUE(extracted == streamed) << captures[capture];
+    }
+}
@@ -235,12 +235,15 @@ TEST(PowerHistory_tests, PeriodPerSecondWithOneSampleInPeriod) {
     EXPECT_EQ(tod, result[0].timestamp);
 }
 
-TEST(PowerHistory_tests, unWrapOnNewPowerData) {
+TEST(PowerHistory_tests, unWrapOnNewFrameMeasurements) {
     PowerHistory ph(PowerHistory::PerSecond);
     PowerHistoryEntry result[5];
 
     TimeOfDay tod(12, 49, 03);
-    PowerHistory::unWrapOnNewPowerData(TicEvaluatedPower(100, 100), tod, 1, static_cast<void *>(&ph));
+    TicMeasurements measurements(1);
+    measurements.timestamp = tod;
+    measurements.instPower = TicEvaluatedPower(100, 100);
+    PowerHistory::unWrapOnNewFrameMeasurements(measurements, static_cast<void *>(&ph));
 
     unsigned int nb = static_cast<unsigned int>(sizeof(result)/sizeof(result[0]));
     ph.getLastPower(nb, result);
@@ -400,3 +403,574 @@ TEST(PowerHistory_tests, AveragingPeriodPerMinute) {
     EXPECT_FALSE(ph.lastPowerTimeOfDay.isValid);
     EXPECT_EQ(60, ph.getAveragingPeriodInSeconds());
 }
+
+TEST(PowerHistoryEntry_tests, averageWithEntryIsWeighted) {
+    PowerHistoryEntry phe(TicEvaluatedPower(100, 100), TimeOfDay(0, 0, 1));
+    PowerHistoryEntry other(TicEvaluatedPower(400, 400), TimeOfDay(0, 0, 4));
+    other.averageWithPowerSample(TicEvaluatedPower(400, 400), TimeOfDay(0, 0, 5));  /* 2 samples of 400W */
+
+    phe.averageWithEntry(other);
+    EXPECT_EQ(TicEvaluatedPower(300, 300), phe.power);
+    EXPECT_EQ(3U, phe.nbSamples);
+    EXPECT_EQ(TimeOfDay(0, 0, 5), phe.timestamp);
+
+    PowerHistoryEntry range(TicEvaluatedPower(-900, -300), TimeOfDay(0, 0, 6));
+    phe.averageWithEntry(range);
+    EXPECT_EQ(TicEvaluatedPower(0, 150), phe.power);   /* (3*300 - 900)/4 and (3*300 - 300)/4 */
+    EXPECT_EQ(4U, phe.nbSamples);
+
+    PowerHistoryEntry empty;
+    empty.averageWithEntry(other);
+    EXPECT_EQ(TicEvaluatedPower(400, 400), empty.power);
+    EXPECT_EQ(2U, empty.nbSamples);
+}
+
+TEST(PowerHistoryEntry_tests, averageDoesNotDrift) {
+    PowerHistoryEntry phe;
+    for (unsigned int sample = 0; sample < 4000; sample++) {
+        phe.averageWithPowerSample(TicEvaluatedPower(sample % 2 ? 1003 : 1000, sample % 2 ? 1003 : 1000), TimeOfDay(0, 0, 0));
+    }
+    EXPECT_EQ(TicEvaluatedPower(1001, 1001), phe.power);   /* 1001.5, a running average rounding each sample would drift to 1000 */
+    EXPECT_EQ(4000U, phe.nbSamples);
+    EXPECT_EQ(2000 * 1000 + 2000 * 1003, phe.minPowerSum);
+    EXPECT_EQ(phe.minPowerSum, phe.maxPowerSum);
+}
+
+TEST(PowerHistoryEntry_tests, peakPower) {
+    PowerHistoryEntry phe(TicEvaluatedPower(500, 500), TimeOfDay(7, 0, 0));
+    phe.averageWithPowerSample(TicEvaluatedPower(6000, 6000), TimeOfDay(7, 0, 1));   /* A kettle */
+    phe.averageWithPowerSample(TicEvaluatedPower(6000, 6000), TimeOfDay(7, 0, 2));
+    phe.averageWithPowerSample(TicEvaluatedPower(-900, -300), TimeOfDay(7, 0, 3));
+    phe.averageWithPowerSample(TicEvaluatedPower(500, 500), TimeOfDay(7, 0, 4));
+    EXPECT_EQ(TicEvaluatedPower(2420, 2540), phe.power);
+    EXPECT_EQ(TicEvaluatedPower(-900, 6000), phe.peakPower);
+
+    PowerHistoryEntry unpacked = PackedPowerHistoryEntry(phe).unpack();
+    EXPECT_EQ(TicEvaluatedPower(-900, 6000), unpacked.peakPower);
+}
+
+TEST(PowerHistoryEntry_tests, variance) {
+    const int samples[] = { 2, 4, 4, 4, 5, 5, 7, 9 };   /* Mean 5, population variance 4 */
+    PowerHistoryEntry phe;
+    EXPECT_EQ(0.0f, phe.getVariance());
+    for (int sample : samples) {
+        phe.averageWithPowerSample(TicEvaluatedPower(sample, sample), TimeOfDay(0, 0, 0));
+    }
+    EXPECT_FLOAT_EQ(4.0f, phe.getVariance());
+
+    /* Merging partial entries gives the same variance */
+    PowerHistoryEntry first;
+    PowerHistoryEntry second;
+    for (unsigned int idx = 0; idx < sizeof(samples)/sizeof(samples[0]); idx++) {
+        (idx < 3 ? first : second).averageWithPowerSample(TicEvaluatedPower(samples[idx], samples[idx]), TimeOfDay(0, 0, 0));
+    }
+    first.averageWithEntry(second);
+    EXPECT_EQ(8U, first.nbSamples);
+    EXPECT_FLOAT_EQ(4.0f, first.getVariance());
+    EXPECT_EQ(TicEvaluatedPower(2, 9), first.peakPower);
+
+    /* Ranges are taken at their middle */
+    PowerHistoryEntry range(TicEvaluatedPower(-300, -100), TimeOfDay(0, 0, 0));
+    range.averageWithPowerSample(TicEvaluatedPower(100, 100), TimeOfDay(0, 0, 0));
+    EXPECT_FLOAT_EQ(150.0f * 150.0f, range.getVariance());
+}
+
+TEST(PowerHistory_tests, openEntriesKeepExactStatistics) {
+    PowerHistory ph(PowerHistory::PerMinute);
+    for (unsigned int second = 0; second < 60; second++) {
+        int power = (second == 30) ? 6000 : (second % 2 ? 1003 : 1000);
+        ph.onNewPowerData(TicEvaluatedPower(power, power), TimeOfDay(12, 0, second), second);
+    }
+    EXPECT_EQ(60U, ph.openEntry.nbSamples);
+    EXPECT_EQ(29 * 1000 + 30 * 1003 + 6000, ph.openEntry.minPowerSum);
+    EXPECT_GT(ph.openEntry.getVariance(), 0.0f);
+    PowerHistoryEntry last;
+    unsigned int nb = 1;
+    ph.getLastPower(nb, &last);
+    EXPECT_EQ(TicEvaluatedPower(1084, 1084), last.power);  /* (29*1000+30*1003+6000)/60 */
+    EXPECT_EQ(TicEvaluatedPower(1000, 6000), last.peakPower);
+    EXPECT_EQ(ph.openEntry.minPowerSum, last.minPowerSum);  /* Statistics are also kept in stored entries */
+    EXPECT_FLOAT_EQ(ph.openEntry.getVariance(), last.getVariance());
+
+    /* Closing the minute cascades the peaks to the tiers */
+    ph.onNewPowerData(TicEvaluatedPower(200, 200), TimeOfDay(12, 1, 0), 60);
+    ph.onNewPowerData(TicEvaluatedPower(200, 200), TimeOfDay(12, 15, 0), 61);
+    std::vector<PowerHistoryEntry> result(4);
+    nb = static_cast<unsigned int>(result.size());
+    EXPECT_EQ(15U * 60U, ph.getLastPowerOverSpan(3600, nb, result.data()));
+    ASSERT_EQ(1U, nb);  /* 12:00 to 12:14, the 12:15 minute is still open */
+    EXPECT_EQ(TicEvaluatedPower(200, 6000), result[0].peakPower);
+    EXPECT_EQ(61U, result[0].nbSamples);
+    EXPECT_EQ(29 * 1000 + 30 * 1003 + 6000 + 200, result[0].minPowerSum);
+    EXPECT_GT(result[0].getVariance(), 0.0f);
+    EXPECT_EQ(61U, result[0].nbSamples);
+}
+
+TEST(PowerHistory_tests, activeTiers) {
+    PowerHistory perSecond(PowerHistory::PerSecond);
+    for (unsigned int tier = 0; tier < PowerHistory::TierCount; tier++) {
+        EXPECT_TRUE(perSecond.isTierActive(tier));
+    }
+    PowerHistory per15Seconds(PowerHistory::Per15Seconds);
+    EXPECT_FALSE(per15Seconds.isTierActive(0)); /* 10s is not a multiple of 15s */
+    EXPECT_TRUE(per15Seconds.isTierActive(1));
+    PowerHistory per5Minutes(PowerHistory::Per5Minutes);
+    EXPECT_FALSE(per5Minutes.isTierActive(0));
+    EXPECT_FALSE(per5Minutes.isTierActive(1));
+    EXPECT_TRUE(per5Minutes.isTierActive(2));
+    EXPECT_TRUE(per5Minutes.isTierActive(3));
+    EXPECT_FALSE(per5Minutes.isTierActive(PowerHistory::TierCount));
+}
+
+TEST(PowerHistory_tests, tiersAreFedFromClosedPeriods) {
+    PowerHistory ph(PowerHistory::Per5Seconds);
+    TimeOfDay tod(10, 0, 0);
+    for (unsigned int second = 0; second < 2 * 3600; second++) {    /* 2 hours, one sample per second: 1000W during the first hour, then 3000W */
+        ph.onNewPowerData(TicEvaluatedPower(second < 3600 ? 1000 : 3000, second < 3600 ? 1000 : 3000), tod, second);
+        tod.addSeconds(1);
+    }
+
+    EXPECT_EQ(2 * 3600 / 5U, ph.data.getCount());
+    EXPECT_EQ(2 * 3600 / 10U, ph.tiers[0].getCount());
+    EXPECT_EQ(2 * 60U, ph.tiers[1].getCount());
+    EXPECT_EQ(2 * 4U, ph.tiers[2].getCount());
+    EXPECT_EQ(2U, ph.tiers[3].getCount());
+
+    /* The last entry of each tier is still open (it only holds closed entries from the tier below) */
+    PowerHistoryEntry firstHour = ph.tiers[3].getReverse(1).unpack();
+    EXPECT_EQ(TicEvaluatedPower(1000, 1000), firstHour.power);
+    EXPECT_EQ(3600U, firstHour.nbSamples);
+    EXPECT_EQ(TimeOfDay(10, 59, 59), firstHour.timestamp);
+    PowerHistoryEntry lastQuarter = ph.tiers[2].getReverse(0).unpack();
+    EXPECT_EQ(TicEvaluatedPower(3000, 3000), lastQuarter.power);
+    EXPECT_EQ(14U * 60U, lastQuarter.nbSamples);   /* The last minute is not over yet in the 1 minute tier */
+    PowerHistoryEntry lastClosedMinute = ph.tiers[1].getReverse(1).unpack();
+    EXPECT_EQ(60U, lastClosedMinute.nbSamples);
+    EXPECT_EQ(TimeOfDay(11, 58, 59), lastClosedMinute.timestamp);
+}
+
+TEST(PowerHistory_tests, tiersCascadeAcrossMidnight) {
+    PowerHistory ph(PowerHistory::PerMinute);
+    TimeOfDay tod(23, 0, 30);
+    for (unsigned int minute = 0; minute < 3 * 60; minute++) {
+        ph.onNewPowerData(TicEvaluatedPower(500, 500), tod, minute);
+        tod.addSeconds(60);
+    }
+    EXPECT_FALSE(ph.isTierActive(0));
+    EXPECT_EQ(0U, ph.tiers[0].getCount());
+    EXPECT_EQ(0U, ph.tiers[1].getCount());
+    EXPECT_EQ(3U * 4U, ph.tiers[2].getCount());
+    EXPECT_EQ(3U, ph.tiers[3].getCount());
+    EXPECT_EQ(TimeOfDay(23, 59, 30), ph.tiers[3].getReverse(2).unpack().timestamp);
+    EXPECT_EQ(60U, ph.tiers[3].getReverse(2).unpack().nbSamples);
+    EXPECT_EQ(TimeOfDay(0, 59, 30), ph.tiers[3].getReverse(1).unpack().timestamp);
+}
+
+TEST(PowerHistory_tests, getLastPowerOverSpanPicksFinestFittingTier) {
+    PowerHistory ph(PowerHistory::PerSecond);
+    TimeOfDay tod(0, 0, 0);
+    for (unsigned int second = 0; second < 4 * 3600; second++) {
+        ph.onNewPowerData(TicEvaluatedPower(1000, 1000), tod, second);
+        tod.addSeconds(1);
+    }
+    std::vector<PowerHistoryEntry> result(800);
+
+    unsigned int nb = 800;
+    EXPECT_EQ(1U, ph.getLastPowerOverSpan(0, nb, result.data()));   /* Base history */
+    EXPECT_EQ(800U, nb);
+    EXPECT_EQ(TimeOfDay(3, 59, 59), result[0].timestamp);
+
+    nb = 800;
+    EXPECT_EQ(1U, ph.getLastPowerOverSpan(600, nb, result.data()));   /* Fits in the base history */
+    EXPECT_EQ(800U, nb);    /* Zooming in is not the concern of the history, all requested entries are returned */
+
+    nb = 800;
+    EXPECT_EQ(10U, ph.getLastPowerOverSpan(3600, nb, result.data()));
+    EXPECT_EQ(360U, nb);
+
+    nb = 800;
+    EXPECT_EQ(60U, ph.getLastPowerOverSpan(12 * 3600, nb, result.data()));
+    EXPECT_EQ(4U * 60U, nb);  /* Only 4 hours of history */
+    EXPECT_EQ(TicEvaluatedPower(1000, 1000), result[0].power);
+
+    nb = 800;
+    EXPECT_EQ(15U * 60U, ph.getLastPowerOverSpan(7 * 24 * 3600, nb, result.data()));
+    EXPECT_EQ(4U * 4U, nb);
+
+    nb = 100;
+    EXPECT_EQ(3600U, ph.getLastPowerOverSpan(31 * 24 * 3600, nb, result.data()));   /* Too long for any tier, use the coarsest */
+    EXPECT_EQ(4U, nb);
+}
+
+TEST(PackedPowerHistoryEntry_tests, size) {
+    EXPECT_EQ(24U, sizeof(PackedPowerHistoryEntry));
+}
+
+TEST(PackedPowerHistoryEntry_tests, roundTrip) {
+    PowerHistoryEntry exact(TicEvaluatedPower(1234, 1234), TimeOfDay(23, 59, 59));
+    exact.averageWithPowerSample(TicEvaluatedPower(1234, 1234), TimeOfDay(23, 59, 59));
+    PowerHistoryEntry unpacked = PackedPowerHistoryEntry(exact).unpack();
+    EXPECT_EQ(exact.power, unpacked.power);
+    EXPECT_TRUE(unpacked.power.isExact);
+    EXPECT_EQ(exact.timestamp, unpacked.timestamp);
+    EXPECT_EQ(2U, unpacked.nbSamples);
+
+    PowerHistoryEntry range(TicEvaluatedPower(-805, -575), TimeOfDay(0, 0, 0));
+    unpacked = PackedPowerHistoryEntry(range).unpack();
+    EXPECT_EQ(range.power, unpacked.power);
+    EXPECT_FALSE(unpacked.power.isExact);
+    EXPECT_EQ(TimeOfDay(0, 0, 0), unpacked.timestamp);
+    EXPECT_EQ(1U, unpacked.nbSamples);
+
+    PowerHistoryEntry spread(TicEvaluatedPower(1000, 1000), TimeOfDay(8, 0, 0));
+    spread.averageWithPowerSample(TicEvaluatedPower(1003, 1003), TimeOfDay(8, 0, 1));
+    spread.averageWithPowerSample(TicEvaluatedPower(1005, 1005), TimeOfDay(8, 0, 2));
+    unpacked = PackedPowerHistoryEntry(spread).unpack();
+    EXPECT_EQ(TicEvaluatedPower(1002, 1002), unpacked.power);  /* The average is truncated... */
+    EXPECT_EQ(3008, unpacked.minPowerSum);  /* ...but the sums are exact */
+    EXPECT_EQ(3008, unpacked.maxPowerSum);
+    EXPECT_GT(spread.getVariance(), 0.0f);
+    EXPECT_FLOAT_EQ(spread.getVariance(), unpacked.getVariance());
+
+    unpacked = PackedPowerHistoryEntry(PowerHistoryEntry()).unpack();
+    EXPECT_FALSE(unpacked.power.isValid);
+    EXPECT_FALSE(unpacked.timestamp.isValid);
+    EXPECT_EQ(0U, unpacked.nbSamples);
+}
+
+TEST(PackedPowerHistoryEntry_tests, saturation) {
+    PowerHistoryEntry entry(TicEvaluatedPower(-40000, 40000), TimeOfDay(12, 0, 0));
+    entry.nbSamples = 100000;
+    PowerHistoryEntry unpacked = PackedPowerHistoryEntry(entry).unpack();
+    EXPECT_EQ(TicEvaluatedPower(INT16_MIN, INT16_MAX), unpacked.power);
+    EXPECT_EQ(PackedPowerHistoryEntry::MaxNbSamples, unpacked.nbSamples);
+
+    entry.minPowerSum = -40000LL * 100000;
+    entry.maxPowerSum = 40000LL * 100000;
+    unpacked = PackedPowerHistoryEntry(entry).unpack();
+    EXPECT_EQ(INT32_MIN, unpacked.minPowerSum);
+    EXPECT_EQ(INT32_MAX, unpacked.maxPowerSum);
+
+    entry = PowerHistoryEntry(TicEvaluatedPower(35000, 36000), TimeOfDay(12, 0, 0));
+    unpacked = PackedPowerHistoryEntry(entry).unpack();
+    EXPECT_EQ(INT16_MAX, unpacked.power.minValue);
+    EXPECT_EQ(INT16_MAX, unpacked.power.maxValue);
+    EXPECT_FALSE(unpacked.power.isExact);  /* Still an approximation */
+    EXPECT_EQ(TicEvaluatedPower(INT16_MAX, INT16_MAX), unpacked.peakPower);
+}
+
+TEST(PowerHistory_tests, fullDayAt5Seconds) {
+    PowerHistory ph(PowerHistory::Per5Seconds);
+    TimeOfDay tod(0, 0, 0);
+    for (unsigned int period = 0; period < 24 * 3600 / 5 + 10; period++) {
+        ph.onNewPowerData(TicEvaluatedPower(static_cast<int>(period % 1000), static_cast<int>(period % 1000)), tod, period);
+        tod.addSeconds(5);
+    }
+    EXPECT_EQ(24 * 3600 / 5U, ph.data.getCount());
+    std::vector<PowerHistoryEntry> result(24 * 3600 / 5);
+    unsigned int nb = static_cast<unsigned int>(result.size());
+    ph.getLastPower(nb, result.data());
+    ASSERT_EQ(24 * 3600 / 5U, nb);
+    EXPECT_EQ(TimeOfDay(0, 0, 45), result[0].timestamp);   /* 10 periods after the day wrapped */
+    EXPECT_EQ(TicEvaluatedPower(289, 289), result[0].power);  /* (24*3600/5+9) % 1000 */
+    EXPECT_EQ(TimeOfDay(0, 0, 50), result[nb - 1].timestamp);
+}
+
+TEST(PackedPowerHistoryEntry_tests, gapMarker) {
+    EXPECT_EQ(0U, PackedPowerHistoryEntry().getGapLength());
+    EXPECT_EQ(0U, PackedPowerHistoryEntry(PowerHistoryEntry(TicEvaluatedPower(100, 100), TimeOfDay(0, 0, 0))).getGapLength());
+    EXPECT_EQ(42U, PackedPowerHistoryEntry::makeGap(42).getGapLength());
+    EXPECT_EQ(PackedPowerHistoryEntry::MaxGapLength, PackedPowerHistoryEntry::makeGap(static_cast<unsigned int>(-1)).getGapLength());
+    EXPECT_FALSE(PackedPowerHistoryEntry::makeGap(42).unpack().power.isValid);
+}
+
+TEST(PowerHistory_tests, missedPeriodsAreRecordedAsOneGapMarker) {
+    PowerHistory ph(PowerHistory::Per5Seconds);
+    ph.onNewPowerData(TicEvaluatedPower(100, 100), TimeOfDay(10, 0, 0), 1);
+    ph.onNewPowerData(TicEvaluatedPower(200, 200), TimeOfDay(10, 0, 6), 2);  /* Next period, no gap */
+    ph.onNewPowerData(TicEvaluatedPower(300, 300), TimeOfDay(11, 0, 7), 3);  /* An hour later */
+    EXPECT_EQ(4U, ph.data.getCount());  /* The whole hour only takes one slot */
+    EXPECT_EQ(3600U / 5U - 1U, ph.data.getReverse(1).getGapLength());
+
+    std::vector<PowerHistoryEntry> result(1000);
+    unsigned int nb = static_cast<unsigned int>(result.size());
+    ph.getLastPower(nb, result.data());
+    ASSERT_EQ(2U + 3600U / 5U, nb);
+    EXPECT_EQ(TicEvaluatedPower(300, 300), result[0].power);
+    for (unsigned int age = 1; age < 3600 / 5; age++) {
+        EXPECT_FALSE(result[age].power.isValid);
+    }
+    EXPECT_EQ(TicEvaluatedPower(200, 200), result[3600 / 5].power);
+    EXPECT_EQ(TimeOfDay(10, 0, 6), result[3600 / 5].timestamp);
+    EXPECT_EQ(TicEvaluatedPower(100, 100), result[3600 / 5 + 1].power);
+
+    /* Gaps are expanded lazily, only as far as requested */
+    nb = 3;
+    ph.getLastPower(nb, result.data());
+    EXPECT_EQ(3U, nb);
+    EXPECT_EQ(TicEvaluatedPower(300, 300), result[0].power);
+    EXPECT_FALSE(result[2].power.isValid);
+}
+
+TEST(PowerHistory_tests, gapAcrossMidnight) {
+    PowerHistory ph(PowerHistory::PerMinute);
+    ph.onNewPowerData(TicEvaluatedPower(100, 100), TimeOfDay(23, 58, 0), 1);
+    ph.onNewPowerData(TicEvaluatedPower(200, 200), TimeOfDay(0, 2, 0), 2);
+    EXPECT_EQ(3U, ph.data.getCount());
+    EXPECT_EQ(3U, ph.data.getReverse(1).getGapLength());    /* 23:59, 00:00 and 00:01 */
+}
+
+TEST(PowerHistory_tests, timeGoingBackwardsIsNotAGap) {
+    PowerHistory ph(PowerHistory::Per5Seconds);
+    ph.onNewPowerData(TicEvaluatedPower(100, 100), TimeOfDay(10, 0, 30), 1);
+    ph.onNewPowerData(TicEvaluatedPower(200, 200), TimeOfDay(10, 0, 10), 2);  /* Clock adjusted backwards */
+    EXPECT_EQ(2U, ph.data.getCount());
+    EXPECT_EQ(0U, ph.data.getReverse(0).getGapLength());
+    EXPECT_EQ(0U, ph.data.getReverse(1).getGapLength());
+}
+
+TEST(PowerHistory_tests, tiersRecordGaps) {
+    PowerHistory ph(PowerHistory::PerMinute);
+    TimeOfDay tod(8, 0, 0);
+    for (unsigned int minute = 0; minute < 60; minute++) {
+        ph.onNewPowerData(TicEvaluatedPower(1000, 1000), tod, minute);
+        tod.addSeconds(60);
+    }
+    tod.addSeconds(3 * 3600);   /* The TIC cable is unplugged for 3 hours */
+    for (unsigned int minute = 0; minute < 61; minute++) {
+        ph.onNewPowerData(TicEvaluatedPower(2000, 2000), tod, minute);
+        tod.addSeconds(60);
+    }
+    std::vector<PowerHistoryEntry> result(10);
+    unsigned int nb = static_cast<unsigned int>(result.size());    /* Too few for the 15-minute tier, we get the hourly tier */
+    EXPECT_EQ(3600U, ph.getLastPowerOverSpan(10 * 3600, nb, result.data()));
+    ASSERT_EQ(5U, nb);  /* 11:00 to 11:59 (open), 3 missed hours, 08:00 to 08:59 */
+    EXPECT_EQ(TicEvaluatedPower(2000, 2000), result[0].power);
+    EXPECT_FALSE(result[1].power.isValid);
+    EXPECT_FALSE(result[3].power.isValid);
+    EXPECT_EQ(TicEvaluatedPower(1000, 1000), result[4].power);
+    EXPECT_EQ(60U, result[4].nbSamples);
+}
+
+TEST(PowerHistory_tests, viewReadsEntriesInPlace) {
+    PowerHistory ph(PowerHistory::PerSecond);
+    TimeOfDay tod(0, 0, 0);
+    const unsigned int nbEntries = PowerHistory::Capacity + 10;  /* Make the ring storage wrap */
+    for (unsigned int second = 0; second < nbEntries; second++) {
+        ph.onNewPowerData(TicEvaluatedPower(second % 1000, second % 1000), tod, second);
+        tod.addSeconds(1);
+    }
+    std::vector<PowerHistoryEntry> expected(PowerHistory::Capacity);
+    unsigned int nb = static_cast<unsigned int>(expected.size());
+    ph.getLastPower(nb, expected.data());
+    ASSERT_EQ(PowerHistory::Capacity, nb);
+
+    PowerHistoryView view = ph.getView(0, PowerHistory::Capacity + 100);
+    EXPECT_EQ(1U, view.periodInSeconds);
+    EXPECT_EQ(PowerHistory::Capacity, view.nbOlderEntries + view.nbNewerEntries);
+    EXPECT_GT(view.nbNewerEntries, 0U);
+    PowerHistoryEntry entry;
+    unsigned int nbRead = 0;
+    for (; view.readNext(entry); nbRead++) {
+        ASSERT_EQ(expected[nbRead].power, entry.power);
+        ASSERT_EQ(expected[nbRead].timestamp, entry.timestamp);
+    }
+    EXPECT_EQ(PowerHistory::Capacity, nbRead);
+    EXPECT_EQ(TicEvaluatedPower((nbEntries - 1) % 1000, (nbEntries - 1) % 1000), expected[0].power);
+    EXPECT_FALSE(view.readNext(entry));
+
+    view.rewind();
+    ASSERT_TRUE(view.readNext(entry));
+    EXPECT_EQ(expected[0].power, entry.power);
+}
+
+TEST(PowerHistory_tests, viewExpandsGapsUpToMaxEntries) {
+    PowerHistory ph(PowerHistory::Per5Seconds);
+    ph.onNewPowerData(TicEvaluatedPower(100, 100), TimeOfDay(10, 0, 0), 1);
+    ph.onNewPowerData(TicEvaluatedPower(200, 200), TimeOfDay(10, 1, 0), 2);  /* 11 periods missed */
+
+    PowerHistoryView view = ph.getView(0, 5);
+    PowerHistoryEntry entry;
+    ASSERT_TRUE(view.readNext(entry));
+    EXPECT_EQ(TicEvaluatedPower(200, 200), entry.power);
+    for (unsigned int age = 1; age < 5; age++) {
+        ASSERT_TRUE(view.readNext(entry));
+        EXPECT_FALSE(entry.power.isValid);
+    }
+    EXPECT_FALSE(view.readNext(entry));
+
+    view = ph.getView(0, 100);
+    unsigned int nbRead = 0;
+    while (view.readNext(entry)) {
+        nbRead++;
+    }
+    EXPECT_EQ(13U, nbRead);
+    EXPECT_EQ(TicEvaluatedPower(100, 100), entry.power);   /* The last one read is the oldest */
+}
+
+TEST(PowerHistory_tests, viewOnEmptyHistory) {
+    PowerHistory ph(PowerHistory::Per5Seconds);
+    PowerHistoryView view = ph.getView(24 * 3600, 800);
+    PowerHistoryEntry entry;
+    EXPECT_FALSE(view.readNext(entry));
+    EXPECT_FALSE(PowerHistoryView().readNext(entry));
+}
+
+TEST(PowerHistory_tests, viewDetectsModifications) {
+    PowerHistory ph(PowerHistory::Per5Seconds);
+    ph.onNewPowerData(TicEvaluatedPower(100, 100), TimeOfDay(10, 0, 0), 1);
+    PowerHistoryView view = ph.getView(0, 10);
+    EXPECT_FALSE(ph.hasChangedSince(view));
+    ph.onNewPowerData(TicEvaluatedPower(), TimeOfDay(10, 0, 1), 2);    /* Ignored, invalid power */
+    EXPECT_FALSE(ph.hasChangedSince(view));
+    ph.onNewPowerData(TicEvaluatedPower(200, 200), TimeOfDay(10, 0, 1), 3);   /* Averaged into the last entry */
+    EXPECT_TRUE(ph.hasChangedSince(view));
+    view = ph.getView(0, 10);
+    ph.onNewPowerData(TicEvaluatedPower(200, 200), TimeOfDay(10, 0, 5), 4);   /* New entry */
+    EXPECT_TRUE(ph.hasChangedSince(view));
+}
+
+static PackedPowerHistoryEntry makePackedEntry(int minPower, int maxPower) {
+    return PackedPowerHistoryEntry(PowerHistoryEntry(TicEvaluatedPower(minPower, maxPower), TimeOfDay(12, 0, 0)));
+}
+
+TEST(PowerHistoryPrefixSums_tests, windowsMatchScan) {
+    PowerHistoryPrefixSums<8> sums;
+    FixedSizeRingBuffer<PackedPowerHistoryEntry, 8> ring;
+    EXPECT_EQ(0U, sums.getLastEntries(3).nbPeriods);
+    for (int step = 0; step < 20; step++) {
+        PackedPowerHistoryEntry entry = (step % 7 == 3) ? PackedPowerHistoryEntry::makeGap(step) : makePackedEntry(step * 100 - 500, step * 150);
+        ring.push(entry);
+        sums.push(entry);
+        if (step % 5 == 1) {    /* The last entry being averaged in place */
+            entry = makePackedEntry(step * 10, step * 20);
+            *ring.getPtrToLast() = entry;
+            sums.replaceLast(entry);
+        }
+        ASSERT_EQ(ring.getCount(), sums.getCount());
+        for (std::size_t window = 0; window <= ring.getCount(); window++) {
+            int64_t minPowerSum = 0;
+            int64_t maxPowerSum = 0;
+            unsigned int nbValidEntries = 0;
+            unsigned int nbPeriods = 0;
+            for (std::size_t rank = 0; rank < window; rank++) {
+                PackedPowerHistoryEntry scanned = ring.getReverse(rank);
+                if (scanned.getGapLength() > 0) {
+                    nbPeriods += scanned.getGapLength();
+                    continue;
+                }
+                nbPeriods++;
+                minPowerSum += scanned.minPower;
+                maxPowerSum += scanned.maxPower;
+                nbValidEntries++;
+            }
+            PowerHistoryPrefixSums<8>::WindowSums windowSums = sums.getLastEntries(window);
+            EXPECT_EQ(minPowerSum, windowSums.minPowerSum);
+            EXPECT_EQ(maxPowerSum, windowSums.maxPowerSum);
+            EXPECT_EQ(nbValidEntries, windowSums.nbValidEntries);
+            EXPECT_EQ(nbPeriods, windowSums.nbPeriods);
+        }
+    }
+}
+
+TEST(PowerHistoryPrefixSums_tests, lastPeriodsAcrossGaps) {
+    PowerHistoryPrefixSums<16> sums;
+    sums.push(makePackedEntry(100, 100));
+    sums.push(PackedPowerHistoryEntry::makeGap(5));
+    sums.push(makePackedEntry(200, 200));
+    sums.push(makePackedEntry(300, 400));
+
+    PowerHistoryPrefixSums<16>::WindowSums windowSums = sums.getLastPeriods(2);
+    EXPECT_EQ(500, windowSums.minPowerSum);
+    EXPECT_EQ(600, windowSums.maxPowerSum);
+    EXPECT_EQ(2U, windowSums.nbValidEntries);
+    EXPECT_EQ(2U, windowSums.nbPeriods);
+    TicEvaluatedPower average;
+    EXPECT_TRUE(windowSums.getAverage(average));
+    EXPECT_EQ(TicEvaluatedPower(250, 300), average);
+
+    windowSums = sums.getLastPeriods(4);   /* Ends within the gap */
+    EXPECT_EQ(2U, windowSums.nbValidEntries);
+    EXPECT_EQ(4U, windowSums.nbPeriods);
+
+    windowSums = sums.getLastPeriods(8);
+    EXPECT_EQ(600, windowSums.minPowerSum);
+    EXPECT_EQ(3U, windowSums.nbValidEntries);
+    EXPECT_EQ(8U, windowSums.nbPeriods);
+
+    windowSums = sums.getLastPeriods(100);  /* More than stored */
+    EXPECT_EQ(3U, windowSums.nbValidEntries);
+    EXPECT_EQ(8U, windowSums.nbPeriods);
+
+    windowSums = sums.getLastPeriods(0);
+    EXPECT_EQ(0U, windowSums.nbPeriods);
+    EXPECT_FALSE(windowSums.getAverage(average));
+}
+
+TEST(PowerHistoryPrefixSums_tests, cumulativeSumsWrapAround) {
+    PowerHistoryPrefixSums<4> sums;
+    for (unsigned int step = 0; step < 200000; step++) {  /* Cumulative sums largely exceed 32 bits */
+        sums.push(makePackedEntry(-32768, 32767));
+    }
+    PowerHistoryPrefixSums<4>::WindowSums windowSums = sums.getLastEntries(4);
+    EXPECT_EQ(-4 * 32768, windowSums.minPowerSum);
+    EXPECT_EQ(4 * 32767, windowSums.maxPowerSum);
+    EXPECT_EQ(4U, windowSums.nbPeriods);
+    sums.reset();
+    EXPECT_EQ(0U, sums.getCount());
+    EXPECT_EQ(0, sums.getLastEntries(4).maxPowerSum);
+}
+
+TEST(PowerHistory_tests, averageOverLast) {
+    PowerHistory ph(PowerHistory::Per5Seconds);
+    TicEvaluatedPower average;
+    EXPECT_FALSE(ph.getAverageOverLast(3600, average));
+    TimeOfDay tod(10, 0, 0);
+    for (unsigned int second = 0; second < 2 * 3600; second++) {    /* 2 hours, one sample per second: 1000W during the first hour, then 3000W */
+        ph.onNewPowerData(TicEvaluatedPower(second < 3600 ? 1000 : 3000, second < 3600 ? 1000 : 3000), tod, second);
+        tod.addSeconds(1);
+    }
+    EXPECT_TRUE(ph.getAverageOverLast(30 * 60, average));
+    EXPECT_EQ(TicEvaluatedPower(3000, 3000), average);
+    EXPECT_TRUE(ph.getAverageOverLast(2 * 3600, average));
+    EXPECT_EQ(TicEvaluatedPower(2000, 2000), average);
+    EXPECT_TRUE(ph.getAverageOverLast(24 * 3600, average));  /* The whole base history */
+    EXPECT_EQ(TicEvaluatedPower(2000, 2000), average);
+    EXPECT_TRUE(ph.getAverageOverLast(48 * 3600, average));  /* From the 15 minute tier */
+    EXPECT_EQ(TicEvaluatedPower(2000, 2000), average);
+    EXPECT_TRUE(ph.getAverageOverLast(1, average));
+    EXPECT_EQ(TicEvaluatedPower(3000, 3000), average);
+}
+
+TEST(PowerHistory_tests, averageOverLastIncludesOpenEntry) {
+    PowerHistory ph(PowerHistory::Per5Seconds);
+    for (unsigned int second = 0; second < 60; second++) {
+        ph.onNewPowerData(TicEvaluatedPower(1000, 1000), TimeOfDay(10, 0, second), second);
+    }
+    ph.onNewPowerData(TicEvaluatedPower(3000, 3000), TimeOfDay(10, 1, 0), 60);
+    TicEvaluatedPower average;
+    EXPECT_TRUE(ph.getAverageOverLast(5, average));
+    EXPECT_EQ(TicEvaluatedPower(3000, 3000), average);  /* The current period, at the base resolution */
+    ph.onNewPowerData(TicEvaluatedPower(5000, 5000), TimeOfDay(10, 1, 1), 61);
+    EXPECT_TRUE(ph.getAverageOverLast(5, average));
+    EXPECT_EQ(TicEvaluatedPower(4000, 4000), average);  /* Updated along with the open entry */
+    EXPECT_TRUE(ph.getAverageOverLast(20, average));
+    EXPECT_EQ(TicEvaluatedPower(1750, 1750), average);  /* 3 periods at 1000W and the current one at 4000W */
+}
+
+TEST(PowerHistory_tests, averageOverLastIgnoresGaps) {
+    PowerHistory ph(PowerHistory::Per5Seconds);
+    for (unsigned int second = 0; second < 600; second++) {
+        ph.onNewPowerData(TicEvaluatedPower(1000, 1000), TimeOfDay(10, second / 60, second % 60), second);
+    }
+    for (unsigned int second = 0; second < 600; second++) {    /* 10 minutes later */
+        ph.onNewPowerData(TicEvaluatedPower(3000, 3000), TimeOfDay(10, 20 + second / 60, second % 60), second);
+    }
+    TicEvaluatedPower average;
+    EXPECT_TRUE(ph.getAverageOverLast(15 * 60, average));
+    EXPECT_EQ(TicEvaluatedPower(3000, 3000), average);   /* The end of the window is within the gap */
+    EXPECT_TRUE(ph.getAverageOverLast(40 * 60, average));
+    EXPECT_EQ(TicEvaluatedPower(2000, 2000), average);
+    EXPECT_EQ(240U, ph.dataSums.getLastPeriods(40 * 60 / 5).nbValidEntries);
+    EXPECT_EQ(120U, ph.tierSums[0].getLastPeriods(40 * 60 / 10).nbValidEntries);
+}
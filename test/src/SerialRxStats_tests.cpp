@@ -0,0 +1,100 @@
+#include "gmock/gmock.h"
+#include <stdint.h>
+
+#include "SerialRxStats.h"
+
+TEST(SerialRxStats_tests, instanciation) {
+    SerialRxStats<4, 8> stats;
+    SerialRxStats<4, 8>::Snapshot snapshot = stats.getSnapshot();
+    EXPECT_EQ(0U, snapshot.fillHighWaterMark);
+    EXPECT_EQ(0U, snapshot.overflowEventCount);
+    EXPECT_EQ(nullptr, snapshot.getOverflowEvent(0));
+    EXPECT_EQ(0U, snapshot.rxEventCount);
+    EXPECT_EQ(0U, snapshot.getAverageGap());
+    EXPECT_EQ(0U, snapshot.maxIsrCost);
+    for (unsigned int bin = 0; bin < 8; bin++) {
+        EXPECT_EQ(0U, snapshot.isrCostHistogram[bin]);
+    }
+}
+
+TEST(SerialRxStats_tests, fillHighWaterMark) {
+    SerialRxStats<> stats;
+    stats.onFillLevel(12);
+    stats.onFillLevel(200);
+    stats.onFillLevel(3);
+    EXPECT_EQ(200U, stats.getSnapshot().fillHighWaterMark);
+}
+
+TEST(SerialRxStats_tests, overflowLogKeepsLastEvents) {
+    SerialRxStats<4, 8> stats;
+    for (unsigned int i = 0; i < 6; i++) {
+        stats.onOverflow(1000 + i, i + 1);
+    }
+    SerialRxStats<4, 8>::Snapshot snapshot = stats.getSnapshot();
+    EXPECT_EQ(6U, snapshot.overflowEventCount);
+    for (unsigned int age = 0; age < 4; age++) {
+        const SerialRxStats<4, 8>::OverflowEvent* event = snapshot.getOverflowEvent(age);
+        ASSERT_NE(nullptr, event);
+        EXPECT_EQ(1005U - age, event->timestamp);
+        EXPECT_EQ(6U - age, event->lostBytes);
+    }
+    EXPECT_EQ(nullptr, snapshot.getOverflowEvent(4)); /* Older events have been overwritten */
+}
+
+TEST(SerialRxStats_tests, gapStatistics) {
+    SerialRxStats<> stats;
+    stats.onRxEvent(100);
+    EXPECT_EQ(0U, stats.getSnapshot().getAverageGap());  /* A single event, no gap yet */
+    stats.onRxEvent(110);
+    stats.onRxEvent(140);
+    stats.onRxEvent(160);
+    SerialRxStats<>::Snapshot snapshot = stats.getSnapshot();
+    EXPECT_EQ(4U, snapshot.rxEventCount);
+    EXPECT_EQ(10U, snapshot.minGap);
+    EXPECT_EQ(30U, snapshot.maxGap);
+    EXPECT_EQ(20U, snapshot.getAverageGap());
+}
+
+TEST(SerialRxStats_tests, gapAcrossTimestampWrapAround) {
+    SerialRxStats<> stats;
+    stats.onRxEvent(static_cast<uint32_t>(-5));
+    stats.onRxEvent(5);
+    SerialRxStats<>::Snapshot snapshot = stats.getSnapshot();
+    EXPECT_EQ(10U, snapshot.minGap);
+    EXPECT_EQ(10U, snapshot.maxGap);
+}
+
+TEST(SerialRxStats_tests, isrCostHistogram) {
+    EXPECT_EQ(0U, (SerialRxStats<8, 8>::getIsrCostBin(0)));
+    EXPECT_EQ(0U, (SerialRxStats<8, 8>::getIsrCostBin(1)));
+    EXPECT_EQ(1U, (SerialRxStats<8, 8>::getIsrCostBin(2)));
+    EXPECT_EQ(1U, (SerialRxStats<8, 8>::getIsrCostBin(3)));
+    EXPECT_EQ(2U, (SerialRxStats<8, 8>::getIsrCostBin(4)));
+    EXPECT_EQ(7U, (SerialRxStats<8, 8>::getIsrCostBin(128)));
+    EXPECT_EQ(7U, (SerialRxStats<8, 8>::getIsrCostBin(1000000))); /* Last bin is open-ended */
+
+    SerialRxStats<8, 8> stats;
+    stats.onIsrCost(3);
+    stats.onIsrCost(3);
+    stats.onIsrCost(300);
+    SerialRxStats<8, 8>::Snapshot snapshot = stats.getSnapshot();
+    EXPECT_EQ(2U, snapshot.isrCostHistogram[1]);
+    EXPECT_EQ(1U, snapshot.isrCostHistogram[7]);
+    EXPECT_EQ(300U, snapshot.maxIsrCost);
+}
+
+TEST(SerialRxStats_tests, reset) {
+    SerialRxStats<> stats;
+    stats.onFillLevel(42);
+    stats.onOverflow(1, 1);
+    stats.onRxEvent(1);
+    stats.onRxEvent(2);
+    stats.onIsrCost(10);
+    stats.reset();
+    SerialRxStats<>::Snapshot snapshot = stats.getSnapshot();
+    EXPECT_EQ(0U, snapshot.fillHighWaterMark);
+    EXPECT_EQ(0U, snapshot.overflowEventCount);
+    EXPECT_EQ(0U, snapshot.rxEventCount);
+    EXPECT_EQ(0U, snapshot.maxGap);
+    EXPECT_EQ(0U, snapshot.maxIsrCost);
+}
@@ -0,0 +1,331 @@
+#include "gmock/gmock.h"
+#include "../tools/Tools.h"
+#include "../tools/FileReplaySerialSource.h"
+#include "../tools/PtySerialSource.h"
+#include "TIC/Unframer.h"
+#include "TicProcessingContext.h"
+#include "PowerHistory.h"
+#include "TicFrameParser.h"
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+
+static std::chrono::nanoseconds manualClock(void* context) {
+    return *static_cast<std::chrono::nanoseconds*>(context);
+}
+
+static std::vector<uint8_t> makeSequence(std::size_t len) {
+    std::vector<uint8_t> result;
+    for (std::size_t i = 0; i < len; i++) {
+        result.push_back(static_cast<uint8_t>(i));
+    }
+    return result;
+}
+
+TEST(SerialSource_tests, FileReplayRealTime1200Bauds) {
+    std::vector<uint8_t> capture = makeSequence(100);
+    std::chrono::nanoseconds now(0);
+    FileReplaySerialSource source(capture, 1200, 1.0, manualClock, &now);
+
+    SerialSource::RxRegion regions[2];
+    EXPECT_EQ(0, source.peek(regions));
+
+    now = std::chrono::microseconds(8333); /* Just before the first byte is fully received (10 bits at 1200 bauds = 8.333ms) */
+    EXPECT_EQ(0, source.getArrivedCount());
+    now = std::chrono::microseconds(8334);
+    EXPECT_EQ(1, source.getArrivedCount());
+
+    now = std::chrono::milliseconds(100); /* 12 bytes in 100ms */
+    ASSERT_EQ(1, source.peek(regions));
+    EXPECT_EQ(12, regions[0].len);
+    EXPECT_EQ(capture.data(), regions[0].buf);  /* Zero-copy, bytes are returned in place */
+    EXPECT_EQ(0, regions[1].len);
+    EXPECT_EQ(12, source.getRxBytesTotal());
+
+    source.commit(5);
+    ASSERT_EQ(1, source.peek(regions));
+    EXPECT_EQ(7, regions[0].len);
+    EXPECT_EQ(5, regions[0].buf[0]);
+
+    now = std::chrono::seconds(10);
+    uint8_t buf[200];
+    EXPECT_EQ(95, source.read(buf, sizeof(buf)));
+    EXPECT_EQ(5, buf[0]);
+    EXPECT_TRUE(source.isFinished());
+    EXPECT_EQ(0, source.peek(regions));
+}
+
+TEST(SerialSource_tests, FileReplay9600BaudsAccelerated) {
+    std::vector<uint8_t> capture = makeSequence(10000);
+    std::chrono::nanoseconds now(0);
+    FileReplaySerialSource source(capture, 9600, 10.0, manualClock, &now);
+
+    now = std::chrono::milliseconds(100);   /* 960 bytes/s, 10 times faster, 100ms => 960 bytes */
+    EXPECT_EQ(960, source.getArrivedCount());
+    EXPECT_EQ(std::chrono::nanoseconds(100000000), source.getArrivalOffset(959));
+}
+
+TEST(SerialSource_tests, FileReplayUnlimited) {
+    std::vector<uint8_t> capture = makeSequence(1000);
+    FileReplaySerialSource source(capture, 1200, FileReplaySerialSource::Unlimited);
+
+    SerialSource::RxRegion regions[2];
+    ASSERT_EQ(1, source.peek(regions));
+    EXPECT_EQ(1000, regions[0].len);
+    EXPECT_EQ(std::chrono::nanoseconds(0), source.getArrivalOffset(999));
+}
+
+TEST(SerialSource_tests, FileReplayRestart) {
+    std::vector<uint8_t> capture = makeSequence(10);
+    std::chrono::nanoseconds now(0);
+    FileReplaySerialSource source(capture, 1200, 1.0, manualClock, &now);
+
+    now = std::chrono::seconds(1);
+    uint8_t buf[10];
+    EXPECT_EQ(10, source.read(buf, sizeof(buf)));
+    source.start();
+    EXPECT_FALSE(source.isFinished());
+    EXPECT_EQ(0, source.getArrivedCount());
+}
+
+/**
+ * @brief Decoding a capture through a SerialSource and TicProcessingContext::forwardSerialRxBytesToUnframer() must give the same result as feeding the unframer directly
+ */
+TEST(SerialSource_tests, ReplayThroughProcessingContext) {
+    std::vector<uint8_t> ticData = readVectorFromDisk("./ticdecodecpp/test/samples/continuous_linky_3P_historical_TIC_with_rx_errors.bin");
+    ASSERT_NE(0U, ticData.size());
+
+    unsigned int nbFramesDirect;
+    {
+        PowerHistory powerHistory(PowerHistory::Per5Seconds);
+        TicFrameParser ticParser(PowerHistory::unWrapOnNewFrameMeasurements, (void *)(&powerHistory));
+        TIC::Unframer ticUnframer(TicFrameParser::unwrapInvokeOnFrameNewBytes, TicFrameParser::unwrapInvokeOnFrameComplete, (void *)(&ticParser));
+        ticUnframer.pushBytes(ticData.data(), ticData.size());
+        nbFramesDirect = ticParser.nbFramesParsed;
+    }
+    EXPECT_GT(nbFramesDirect, 0U);
+
+    std::chrono::nanoseconds now(0);
+    FileReplaySerialSource source(ticData, 9600, 1.0, manualClock, &now);
+    PowerHistory powerHistory(PowerHistory::Per5Seconds);
+    TicFrameParser ticParser(PowerHistory::unWrapOnNewFrameMeasurements, (void *)(&powerHistory));
+    TIC::Unframer ticUnframer(TicFrameParser::unwrapInvokeOnFrameNewBytes, TicFrameParser::unwrapInvokeOnFrameComplete, (void *)(&ticParser));
+    TicProcessingContext ticContext(source, ticUnframer);
+    powerHistory.setContext(&ticContext);
+
+    std::size_t totalConsumed = 0;
+    while (!source.isFinished()) {
+        now += std::chrono::milliseconds(7);    /* Simulate a main loop polling the serial source every 7ms */
+        totalConsumed += ticContext.forwardSerialRxBytesToUnframer();
+    }
+    EXPECT_EQ(ticData.size(), totalConsumed);
+    EXPECT_EQ(nbFramesDirect, ticParser.nbFramesParsed);
+    EXPECT_EQ(0, ticContext.lostTicBytes);
+    EXPECT_EQ(0, ticContext.serialRxOverflowCount);
+}
+
+/**
+ * @brief All bytes consumed by TicProcessingContext::forwardSerialRxBytesToUnframer() must also be fed to the baudrate detector, if any
+ */
+TEST(SerialSource_tests, ReplayThroughProcessingContextFeedsBaudRateDetector) {
+    std::vector<uint8_t> ticData = readVectorFromDisk("./ticdecodecpp/test/samples/continuous_linky_3P_historical_TIC_2024_sample.bin");
+    ASSERT_NE(0U, ticData.size());
+
+    std::chrono::nanoseconds now(0);
+    FileReplaySerialSource source(ticData, 1200, 1.0, manualClock, &now);
+    PowerHistory powerHistory(PowerHistory::Per5Seconds);
+    TicFrameParser ticParser(PowerHistory::unWrapOnNewFrameMeasurements, (void *)(&powerHistory));
+    TIC::Unframer ticUnframer(TicFrameParser::unwrapInvokeOnFrameNewBytes, TicFrameParser::unwrapInvokeOnFrameComplete, (void *)(&ticParser));
+    TicProcessingContext ticContext(source, ticUnframer);
+    powerHistory.setContext(&ticContext);
+    TicBaudRateDetector detector;
+    detector.start(0);
+    ticContext.baudRateDetector = &detector;
+
+    while (!source.isFinished() && !detector.isLocked()) {
+        now += std::chrono::milliseconds(10);
+        ticContext.forwardSerialRxBytesToUnframer();
+        detector.update(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now).count()));
+    }
+    EXPECT_TRUE(detector.isLocked());
+    EXPECT_EQ(TicBaudRateDetector::HistoricalBaudRate, detector.getBaudRate());
+    EXPECT_EQ(0U, detector.getSwitchCount());
+}
+
+/**
+ * @brief A serial source backed by a small reception ring, that the test fills-in directly (acting as the RX ISR)
+ */
+class RingSerialSource : public SerialSource {
+public:
+    RingSerialSource(bool reportGaps) : reportGaps(reportGaps), lostBytes(0) {}
+    void receive(const uint8_t* buf, std::size_t len) { lostBytes += len - this->ring.push(buf, len); }
+    std::size_t read(uint8_t* buffer, std::size_t maxLen) override { return this->ring.pop(buffer, maxLen); }
+    unsigned int peek(RxRegion (&regions)[2]) override { return this->ring.peek(regions); }
+    void commit(std::size_t len) override { this->ring.commit(len); }
+    unsigned int getRxOverflowCount(bool reset = false) override { unsigned int result = lostBytes; if (reset) lostBytes = 0; return result; }
+    unsigned long getRxBytesTotal() const override { return 0; }
+    bool takeRxGap() override { return this->ring.takeGap() && this->reportGaps; }
+
+    bool reportGaps;    /*!< Should gaps be reported to the consumer? */
+    unsigned int lostBytes; /*!< Bytes that did not fit in the ring */
+    SpscByteRing<256> ring;
+};
+
+static void countDatasetError(void* context) {
+    (*static_cast<unsigned int*>(context))++;
+}
+
+/**
+ * @brief Decode a capture through a RingSerialSource, with the consumer regularly stalling long enough for the ring to overflow
+ *
+ * @param ticData The capture
+ * @param reportGaps Should the source report gaps (so that the unframer gets resynchronized)?
+ * @param[out] lostBytes The number of bytes lost on overflows
+ * @param[out] resyncCount The number of times the unframer was resynchronized
+ * @return The number of dataset errors
+ */
+static unsigned int decodeWithStalls(const std::vector<uint8_t>& ticData, bool reportGaps, unsigned int& lostBytes, unsigned int& resyncCount) {
+    RingSerialSource source(reportGaps);
+    PowerHistory powerHistory(PowerHistory::Per5Seconds);
+    TicFrameParser ticParser(PowerHistory::unWrapOnNewFrameMeasurements, (void *)(&powerHistory));
+    TIC::Unframer ticUnframer(TicFrameParser::unwrapInvokeOnFrameNewBytes, TicFrameParser::unwrapInvokeOnFrameComplete, (void *)(&ticParser));
+    TicProcessingContext ticContext(source, ticUnframer);
+    ticContext.ticParser = &ticParser;
+    powerHistory.setContext(&ticContext);
+    unsigned int datasetErrors = 0;
+    ticParser.invokeOnDatasetError(countDatasetError, &datasetErrors);
+
+    std::size_t pos = 0;
+    for (unsigned int step = 0; pos < ticData.size(); step++) {
+        std::size_t chunk = (step % 50 == 49) ? 700 : 32; /* Every 50 steps, the consumer stalls while 700 bytes are received */
+        if (chunk > ticData.size() - pos) {
+            chunk = ticData.size() - pos;
+        }
+        source.receive(ticData.data() + pos, chunk);
+        pos += chunk;
+        while (ticContext.forwardSerialRxBytesToUnframer() > 0);
+    }
+    lostBytes = ticContext.serialRxOverflowCount;
+    resyncCount = ticContext.unframerResyncCount;
+    return datasetErrors;
+}
+
+/**
+ * @brief Lost bytes should only cost the frame they belong to, not dataset errors
+ */
+TEST(SerialSource_tests, OverflowResyncsUnframer) {
+    std::vector<uint8_t> ticData = readVectorFromDisk("./ticdecodecpp/test/samples/continuous_linky_3P_historical_TIC_2024_sample.bin");
+    ASSERT_NE(0U, ticData.size());
+    unsigned int lostBytes;
+    unsigned int resyncCount;
+
+    unsigned int errorsWithoutResync = decodeWithStalls(ticData, false, lostBytes, resyncCount);
+    EXPECT_GT(lostBytes, 0U);
+    EXPECT_EQ(0U, resyncCount);
+    EXPECT_GT(errorsWithoutResync, 0U);
+
+    unsigned int errorsWithResync = decodeWithStalls(ticData, true, lostBytes, resyncCount);
+    EXPECT_GT(lostBytes, 0U);
+    EXPECT_GT(resyncCount, 0U);
+    EXPECT_EQ(0U, errorsWithResync);
+}
+
+/**
+ * @brief Build the bytes of a standard TIC frame (STX, datasets between LF and CR, ETX)
+ */
+static std::vector<uint8_t> standardTicFrame(const std::vector<std::vector<uint8_t>>& datasets) {
+    std::vector<uint8_t> frame(1, 0x02);
+    for (const std::vector<uint8_t>& dataset : datasets) {
+        frame.push_back(0x0a);
+        frame.insert(frame.end(), dataset.begin(), dataset.end());
+        frame.push_back(0x0d);
+    }
+    frame.push_back(0x03);
+    return frame;
+}
+
+static void countFrame(const TicMeasurements& measurements, void* context) {
+    (*static_cast<unsigned int*>(context))++;
+}
+
+/**
+ * @brief A resync in the middle of a frame drops that frame: nothing is published and the energy estimator does not see its partial indexes
+ */
+TEST(SerialSource_tests, ResyncMidFrameDropsTheFrame) {
+    RingSerialSource source(true);
+    unsigned int nbFrames = 0;
+    TicFrameParser ticParser(countFrame, &nbFrames);
+    TIC::Unframer ticUnframer(TicFrameParser::unwrapInvokeOnFrameNewBytes, TicFrameParser::unwrapInvokeOnFrameComplete, (void *)(&ticParser));
+    TicProcessingContext ticContext(source, ticUnframer);
+    ticContext.ticParser = &ticParser;
+
+    std::vector<uint8_t> firstFrame = standardTicFrame({
+        standardTicDataset("DATE", "", "E240502120000"),
+        standardTicDataset("EAST", "001000000"),
+        standardTicDataset("SINSTS", "01400"),
+    });
+    ticUnframer.pushBytes(firstFrame.data(), firstFrame.size());
+    EXPECT_EQ(1U, nbFrames);
+    EXPECT_EQ(1U, ticParser.energyEstimator.getSampleCount());
+
+    std::vector<uint8_t> cutFrame = standardTicFrame({
+        standardTicDataset("DATE", "", "E240502121000"),
+        standardTicDataset("EAST", "001000500"),
+        standardTicDataset("SINSTS", "01500"),
+        standardTicDataset("IRMS1", "006"),
+        standardTicDataset("URMS1", "231"),
+    });
+    std::size_t cutPos = cutFrame.size() / 2;  /* Within the SINSTS dataset, after the indexes */
+    ticUnframer.pushBytes(cutFrame.data(), cutPos);
+    ticContext.resyncUnframer();
+    ticUnframer.pushBytes(cutFrame.data() + cutPos + 3, cutFrame.size() - cutPos - 3);    /* 3 bytes were lost */
+    EXPECT_EQ(1U, nbFrames);
+    EXPECT_EQ(1U, ticParser.energyEstimator.getSampleCount());
+    EXPECT_EQ(0U, ticParser.getDatasetErrorStats().errorCount);
+
+    std::vector<uint8_t> nextFrame = standardTicFrame({
+        standardTicDataset("DATE", "", "E240502122000"),
+        standardTicDataset("EAST", "001000000"),    /* Would look like a decreasing index if the cut frame had been accounted for */
+        standardTicDataset("SINSTS", "01600"),
+    });
+    ticUnframer.pushBytes(nextFrame.data(), nextFrame.size());
+    EXPECT_EQ(2U, nbFrames);
+    EXPECT_EQ(TicEvaluatedPower(1600, 1600), ticParser.lastFrameMeasurements.instPower);
+    EXPECT_EQ(TimeOfDay(12, 20, 0), ticParser.lastFrameMeasurements.timestamp);
+    EXPECT_EQ(1U, ticParser.energyEstimator.getSampleCount());
+
+    /* A resync between frames does not cost the next frame */
+    ticContext.resyncUnframer();
+    ticUnframer.pushBytes(firstFrame.data(), firstFrame.size());
+    EXPECT_EQ(3U, nbFrames);
+}
+
+TEST(SerialSource_tests, PtyReception) {
+    PtySerialSource source;
+    if (!source.isOpen()) {
+        std::cout << "No pty available on this host, skipping\n";
+        return;
+    }
+    int writerFd = open(source.getSlavePath().c_str(), O_WRONLY | O_NOCTTY);
+    ASSERT_GE(writerFd, 0);
+    std::vector<uint8_t> sent = makeSequence(256);  /* Includes CR, LF and control characters, which must go through unmodified */
+    ASSERT_EQ(static_cast<ssize_t>(sent.size()), write(writerFd, sent.data(), sent.size()));
+    close(writerFd);
+
+    std::vector<uint8_t> received;
+    for (unsigned int attempt = 0; attempt < 100 && received.size() < sent.size(); attempt++) {
+        if (!source.waitForData(10)) {
+            continue;
+        }
+        SerialSource::RxRegion regions[2];
+        unsigned int nbRegions = source.peek(regions);
+        std::size_t len = 0;
+        for (unsigned int region = 0; region < nbRegions; region++) {
+            received.insert(received.end(), regions[region].buf, regions[region].buf + regions[region].len);
+            len += regions[region].len;
+        }
+        source.commit(len);
+    }
+    EXPECT_EQ(sent, received);
+    EXPECT_EQ(sent.size(), source.getRxBytesTotal());
+}
@@ -0,0 +1,437 @@
+#include "gmock/gmock.h"
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <stdint.h>
+
+#include "SpscByteRing.h"
+
+TEST(SpscByteRing_tests, instanciation) {
+    SpscByteRing<16> ring;
+
+    EXPECT_EQ(16, ring.getCapacity());
+    EXPECT_EQ(0, ring.getCount());
+    EXPECT_TRUE(ring.isEmpty());
+}
+
+TEST(SpscByteRing_tests, pushPopSingleBytes) {
+    SpscByteRing<16> ring;
+
+    EXPECT_TRUE(ring.push(0x01));
+    EXPECT_TRUE(ring.push(0x02));
+    EXPECT_EQ(2, ring.getCount());
+
+    uint8_t result[16];
+    EXPECT_EQ(2, ring.pop(result, sizeof(result)));
+    EXPECT_EQ(0x01, result[0]);
+    EXPECT_EQ(0x02, result[1]);
+    EXPECT_TRUE(ring.isEmpty());
+    EXPECT_EQ(0, ring.pop(result, sizeof(result)));
+}
+
+TEST(SpscByteRing_tests, popLimitedToMaxLen) {
+    SpscByteRing<16> ring;
+
+    for (uint8_t i = 0; i < 10; i++) {
+        ring.push(i);
+    }
+    uint8_t result[4];
+    EXPECT_EQ(4, ring.pop(result, sizeof(result)));
+    EXPECT_EQ(0, result[0]);
+    EXPECT_EQ(3, result[3]);
+    EXPECT_EQ(6, ring.getCount());
+    EXPECT_EQ(4, ring.pop(result, sizeof(result)));
+    EXPECT_EQ(4, result[0]);
+    EXPECT_EQ(2, ring.pop(result, sizeof(result)));
+    EXPECT_EQ(8, result[0]);
+    EXPECT_EQ(9, result[1]);
+}
+
+TEST(SpscByteRing_tests, pushOnFullRingIsRejected) {
+    SpscByteRing<8> ring;
+
+    for (uint8_t i = 0; i < 8; i++) {
+        EXPECT_TRUE(ring.push(i));
+    }
+    EXPECT_FALSE(ring.push(0xff));
+    EXPECT_EQ(8, ring.getCount());
+
+    uint8_t result[8];
+    EXPECT_EQ(8, ring.pop(result, sizeof(result)));
+    for (uint8_t i = 0; i < 8; i++) {
+        EXPECT_EQ(i, result[i]);  /* Oldest bytes are kept, the rejected one is not stored */
+    }
+}
+
+TEST(SpscByteRing_tests, bulkPushTruncatedOnFullRing) {
+    SpscByteRing<8> ring;
+    uint8_t input[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+    EXPECT_EQ(5, ring.push(input, 5));
+    EXPECT_EQ(3, ring.push(input + 5, 7));
+    EXPECT_EQ(0, ring.push(input + 8, 4));
+
+    uint8_t result[8];
+    EXPECT_EQ(8, ring.pop(result, sizeof(result)));
+    for (uint8_t i = 0; i < 8; i++) {
+        EXPECT_EQ(i, result[i]);
+    }
+}
+
+TEST(SpscByteRing_tests, wrapAround) {
+    SpscByteRing<8> ring;
+    uint8_t result[8];
+    uint8_t value = 0;
+    uint8_t expected = 0;
+
+    for (unsigned int round = 0; round < 50; round++) {
+        unsigned int nbPushed = (round % 7) + 1;
+        uint8_t input[8];
+        for (unsigned int i = 0; i < nbPushed; i++) {
+            input[i] = value++;
+        }
+        if (round % 2 == 0) {
+            EXPECT_EQ(nbPushed, ring.push(input, nbPushed));
+        }
+        else {
+            for (unsigned int i = 0; i < nbPushed; i++) {
+                EXPECT_TRUE(ring.push(input[i]));
+            }
+        }
+        std::size_t got = ring.pop(result, sizeof(result));
+        ASSERT_EQ(nbPushed, got);
+        for (std::size_t i = 0; i < got; i++) {
+            EXPECT_EQ(expected++, result[i]);
+        }
+    }
+}
+
+TEST(SpscByteRing_tests, reset) {
+    SpscByteRing<8> ring;
+
+    ring.push(0x55);
+    ring.push(0xaa);
+    ring.reset();
+    EXPECT_TRUE(ring.isEmpty());
+    uint8_t result[8];
+    EXPECT_EQ(0, ring.pop(result, sizeof(result)));
+}
+
+TEST(SpscByteRing_tests, peekEmptyRing) {
+    SpscByteRing<8> ring;
+    SpscByteRing<8>::Region regions[2];
+
+    EXPECT_EQ(0, ring.peek(regions));
+    EXPECT_EQ(0, regions[0].len);
+    EXPECT_EQ(nullptr, regions[0].buf);
+    EXPECT_EQ(0, regions[1].len);
+    EXPECT_EQ(nullptr, regions[1].buf);
+}
+
+TEST(SpscByteRing_tests, peekSingleRegionThenCommit) {
+    SpscByteRing<8> ring;
+    uint8_t input[5] = { 10, 11, 12, 13, 14 };
+    ring.push(input, sizeof(input));
+
+    SpscByteRing<8>::Region regions[2];
+    ASSERT_EQ(1, ring.peek(regions));
+    ASSERT_EQ(5, regions[0].len);
+    EXPECT_EQ(0, memcmp(input, regions[0].buf, sizeof(input)));
+    EXPECT_EQ(0, regions[1].len);
+    EXPECT_EQ(5, ring.getCount()); /* peek() does not consume anything */
+
+    ring.commit(2); /* Partial consumption */
+    EXPECT_EQ(3, ring.getCount());
+    ASSERT_EQ(1, ring.peek(regions));
+    ASSERT_EQ(3, regions[0].len);
+    EXPECT_EQ(12, regions[0].buf[0]);
+
+    ring.commit(100);   /* Clamped to what is readable */
+    EXPECT_TRUE(ring.isEmpty());
+}
+
+TEST(SpscByteRing_tests, peekWrappedDataReturnsTwoRegions) {
+    SpscByteRing<8> ring;
+    uint8_t input[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    ring.push(input, 6);
+    ring.commit(6);    /* Now the next byte will be stored at offset 6 */
+    ring.push(input, 5);
+
+    SpscByteRing<8>::Region regions[2];
+    ASSERT_EQ(2, ring.peek(regions));
+    ASSERT_EQ(2, regions[0].len);
+    EXPECT_EQ(0, regions[0].buf[0]);
+    EXPECT_EQ(1, regions[0].buf[1]);
+    ASSERT_EQ(3, regions[1].len);
+    EXPECT_EQ(2, regions[1].buf[0]);
+    EXPECT_EQ(4, regions[1].buf[2]);
+
+    ring.commit(3); /* Consume the first region and part of the second one */
+    ASSERT_EQ(1, ring.peek(regions));
+    ASSERT_EQ(2, regions[0].len);
+    EXPECT_EQ(3, regions[0].buf[0]);
+}
+
+TEST(SpscByteRing_tests, uncommittedBytesAreNotOverwritten) {
+    SpscByteRing<4> ring;
+    uint8_t input[4] = { 0xa0, 0xa1, 0xa2, 0xa3 };
+    ring.push(input, sizeof(input));
+
+    SpscByteRing<4>::Region regions[2];
+    ring.peek(regions);
+    EXPECT_FALSE(ring.push(0xff)); /* Peeked bytes still occupy the storage */
+    ring.commit(1);
+    EXPECT_TRUE(ring.push(0xb0));
+    EXPECT_EQ(0xa1, regions[0].buf[1]);   /* Bytes not yet committed are untouched */
+
+    uint8_t result[4];
+    EXPECT_EQ(4, ring.pop(result, sizeof(result)));
+    EXPECT_EQ(0xa1, result[0]);
+    EXPECT_EQ(0xb0, result[3]);
+}
+
+TEST(SpscByteRing_tests, peekStopsAtGapOnDropNewest) {
+    SpscByteRing<4> ring;
+    uint8_t input[6] = { 0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5 };
+    EXPECT_EQ(4, ring.push(input, sizeof(input)));   /* 0xa4 and 0xa5 are lost */
+    EXPECT_FALSE(ring.takeGap());   /* Bytes before the gap have not been read yet */
+
+    uint8_t result[4];
+    EXPECT_EQ(2, ring.pop(result, 2));
+    EXPECT_TRUE(ring.push(0xb0));
+    EXPECT_TRUE(ring.push(0xb1));
+
+    SpscByteRing<4>::Region regions[2];
+    ASSERT_EQ(1, ring.peek(regions));
+    EXPECT_EQ(2, regions[0].len);  /* 0xa2 and 0xa3 only, 0xb0 and 0xb1 come after the gap */
+    EXPECT_EQ(0xa2, regions[0].buf[0]);
+    EXPECT_EQ(2, ring.commit(100)); /* Clamped to the gap too */
+    EXPECT_TRUE(ring.takeGap());
+    EXPECT_FALSE(ring.takeGap());   /* Reported only once */
+
+    EXPECT_EQ(2, ring.pop(result, sizeof(result)));
+    EXPECT_EQ(0xb0, result[0]);
+    EXPECT_EQ(0xb1, result[1]);
+    EXPECT_FALSE(ring.takeGap());
+}
+
+TEST(SpscByteRing_tests, readersIgnoringGapsGetAllBytes) {
+    SpscByteRing<4> ring;
+    uint8_t input[4] = { 0xa0, 0xa1, 0xa2, 0xa3 };
+    ring.push(input, sizeof(input));
+    EXPECT_FALSE(ring.push(0xff));
+    uint8_t result[4];
+    EXPECT_EQ(4, ring.pop(result, sizeof(result)));
+    ring.push(input, 2);
+    EXPECT_EQ(2, ring.pop(result, sizeof(result))); /* We are at the gap, nothing is held back */
+}
+
+TEST(SpscByteRing_tests, pushEvictingOldest) {
+    SpscByteRing<4> ring;
+    ring.setEvictionAllowed(true);
+    uint8_t input[6] = { 0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5 };
+    EXPECT_EQ(0, ring.pushEvictingOldest(input, 3));
+    EXPECT_EQ(2, ring.pushEvictingOldest(input + 3, 3));    /* 0xa0 and 0xa1 are evicted */
+    EXPECT_EQ(4, ring.getCount());
+    EXPECT_TRUE(ring.takeGap());    /* The gap is right before the oldest byte remaining */
+
+    uint8_t result[4];
+    EXPECT_EQ(4, ring.pop(result, sizeof(result)));
+    EXPECT_EQ(0xa2, result[0]);
+    EXPECT_EQ(0xa5, result[3]);
+    EXPECT_FALSE(ring.takeGap());
+}
+
+TEST(SpscByteRing_tests, pushEvictingOldestNotAllowed) {
+    SpscByteRing<4> ring;
+    uint8_t input[6] = { 0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5 };
+    EXPECT_EQ(2, ring.pushEvictingOldest(input, sizeof(input)));    /* Behaves as push(): 0xa4 and 0xa5 are lost */
+    uint8_t result[4];
+    EXPECT_EQ(4, ring.pop(result, sizeof(result)));
+    EXPECT_EQ(0xa0, result[0]);
+    EXPECT_EQ(0xa3, result[3]);
+}
+
+TEST(SpscByteRing_tests, pushEvictingOldestLargerThanCapacity) {
+    SpscByteRing<4> ring;
+    ring.setEvictionAllowed(true);
+    uint8_t input[7] = { 0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6 };
+    ring.push(0x55);
+    EXPECT_EQ(4, ring.pushEvictingOldest(input, sizeof(input)));    /* 0x55, then 0xa0 to 0xa2 */
+    uint8_t result[4];
+    EXPECT_EQ(4, ring.pop(result, sizeof(result)));
+    EXPECT_EQ(0xa3, result[0]);
+    EXPECT_EQ(0xa6, result[3]);
+}
+
+TEST(SpscByteRing_tests, evictionOfPeekedBytesIsReported) {
+    SpscByteRing<4> ring;
+    ring.setEvictionAllowed(true);
+    uint8_t input[4] = { 0xa0, 0xa1, 0xa2, 0xa3 };
+    ring.push(input, sizeof(input));
+
+    SpscByteRing<4>::Region regions[2];
+    ASSERT_EQ(1, ring.peek(regions));
+    EXPECT_EQ(4, regions[0].len);
+    EXPECT_FALSE(ring.takeGap());
+
+    uint8_t late[3] = { 0xb0, 0xb1, 0xb2 };
+    EXPECT_EQ(3, ring.pushEvictingOldest(late, sizeof(late)));  /* Evicts bytes being processed by the consumer */
+    EXPECT_EQ(1, ring.commit(4));   /* Only 0xa3 was still ours to release */
+    EXPECT_TRUE(ring.takeGap());    /* What we have just processed was damaged */
+
+    uint8_t result[4];
+    EXPECT_EQ(3, ring.pop(result, sizeof(result)));
+    EXPECT_EQ(0xb0, result[0]);
+    EXPECT_EQ(0xb2, result[2]);
+}
+
+/**
+ * @brief Stress a ring with a producer thread (acting as the RX ISR) and a consumer thread (acting as the main loop)
+ *
+ * The producer never waits: bytes pushed on a full ring are lost, as they would be in the ISR. It records which bytes were accepted.
+ * The consumer output must be exactly the sequence of accepted bytes, in order.
+ */
+TEST(SpscByteRing_tests, concurrentProducerConsumerWithDrops) {
+    static const std::size_t nbBytes = 2000000;
+    SpscByteRing<64> ring;
+    std::vector<uint8_t> accepted;
+    std::vector<uint8_t> consumed;
+    std::atomic<bool> producerDone(false);
+    accepted.reserve(nbBytes);
+    consumed.reserve(nbBytes);
+
+    std::thread producer([&]() {
+        uint32_t lfsr = 0xACE1u;
+        for (std::size_t i = 0; i < nbBytes; i++) {
+            lfsr = (lfsr >> 1) ^ (-(lfsr & 1u) & 0xB400u);
+            uint8_t byte = static_cast<uint8_t>(lfsr);
+            if (ring.push(byte)) {
+                accepted.push_back(byte);
+            }
+        }
+        producerDone.store(true);
+    });
+    std::thread consumer([&]() {
+        uint8_t buf[48];
+        while (true) {
+            bool done = producerDone.load(); /* Sampled before pop() so that the last bytes pushed are collected */
+            std::size_t got = ring.pop(buf, (consumed.size() % sizeof(buf)) + 1); /* Vary the read size */
+            consumed.insert(consumed.end(), buf, buf + got);
+            if (got == 0) {
+                if (done) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+    });
+    producer.join();
+    consumer.join();
+
+    EXPECT_GT(accepted.size(), 0U);
+    EXPECT_EQ(accepted.size(), consumed.size());
+    EXPECT_TRUE(accepted == consumed);
+}
+
+/**
+ * @brief Same as above, but the producer retries when the ring is full, so that no byte is lost at all
+ */
+TEST(SpscByteRing_tests, concurrentProducerConsumerLossless) {
+    static const std::size_t nbBytes = 1000000;
+    SpscByteRing<16> ring;
+    std::vector<uint8_t> consumed;
+    consumed.reserve(nbBytes);
+
+    std::thread producer([&]() {
+        for (std::size_t i = 0; i < nbBytes; ) {
+            uint8_t chunk[5];
+            std::size_t chunkLen = (i % 5) + 1;
+            if (chunkLen > nbBytes - i) {
+                chunkLen = nbBytes - i;
+            }
+            for (std::size_t j = 0; j < chunkLen; j++) {
+                chunk[j] = static_cast<uint8_t>((i + j) * 7);
+            }
+            std::size_t pushed = ring.push(chunk, chunkLen);
+            if (pushed == 0) {
+                std::this_thread::yield();  /* Ring is full, let the consumer run */
+            }
+            i += pushed;    /* Only the bytes that fit are consumed from our input */
+        }
+    });
+    std::thread consumer([&]() {
+        uint8_t buf[16];
+        while (consumed.size() < nbBytes) {
+            std::size_t got = ring.pop(buf, sizeof(buf));
+            if (got == 0) {
+                std::this_thread::yield();  /* Ring is empty, let the producer run */
+            }
+            consumed.insert(consumed.end(), buf, buf + got);
+        }
+    });
+    producer.join();
+    consumer.join();
+
+    ASSERT_EQ(nbBytes, consumed.size());
+    for (std::size_t i = 0; i < nbBytes; i++) {
+        if (consumed[i] != static_cast<uint8_t>(i * 7)) {
+            FAIL() << "Unexpected byte at offset " << i;
+        }
+    }
+}
+
+/**
+ * @brief Stress a ring with a producer thread evicting the oldest bytes, and a consumer thread processing bytes in place
+ *
+ * Every byte pushed must be accounted for exactly once: either lost (as reported by the producer) or released by the consumer.
+ */
+TEST(SpscByteRing_tests, concurrentEvictingProducerExactAccounting) {
+    static const std::size_t nbBytes = 1000000;
+    SpscByteRing<32> ring;
+    ring.setEvictionAllowed(true);
+    std::atomic<bool> producerDone(false);
+    std::size_t lost = 0;
+    std::size_t released = 0;
+    unsigned int gaps = 0;
+
+    std::thread producer([&]() {
+        uint8_t chunk[7] = { 0 };
+        for (std::size_t i = 0; i < nbBytes; ) {
+            std::size_t chunkLen = (i % 7) + 1;
+            if (chunkLen > nbBytes - i) {
+                chunkLen = nbBytes - i;
+            }
+            lost += ring.pushEvictingOldest(chunk, chunkLen);
+            i += chunkLen;
+        }
+        producerDone.store(true);
+    });
+    std::thread consumer([&]() {
+        SpscByteRing<32>::Region regions[2];
+        while (true) {
+            bool done = producerDone.load();
+            if (ring.takeGap()) {
+                gaps++;
+            }
+            ring.peek(regions);
+            std::size_t len = regions[0].len + regions[1].len;
+            released += ring.commit(len);
+            if (len == 0) {
+                if (done) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+    });
+    producer.join();
+    consumer.join();
+
+    EXPECT_EQ(nbBytes, lost + released);
+    EXPECT_TRUE(ring.isEmpty());
+    if (lost > 0) {
+        EXPECT_GT(gaps, 0U);
+    }
+}
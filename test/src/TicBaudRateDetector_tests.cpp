@@ -0,0 +1,244 @@
+#include "gmock/gmock.h"
+#include "../tools/Tools.h"
+#include "../tools/UartLineSimulator.h"
+#include "TicBaudRateDetector.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief Build a dataset (LF ... CR) with a valid checksum
+ *
+ * @param content The dataset content, without the checksum, nor the separator before the checksum
+ * @param separator SP for historical TIC, HT for standard TIC
+ */
+static std::vector<uint8_t> makeDataset(const std::string& content, char separator) {
+    unsigned int sum = 0;
+    for (char c : content) {
+        sum += static_cast<uint8_t>(c);
+    }
+    if (separator == '\t') {
+        sum += static_cast<uint8_t>(separator);   /* Standard TIC checksum includes the last separator */
+    }
+    std::vector<uint8_t> result;
+    result.push_back('\n');
+    result.insert(result.end(), content.begin(), content.end());
+    result.push_back(separator);
+    result.push_back(static_cast<uint8_t>((sum & 0x3f) + 0x20));
+    result.push_back('\r');
+    return result;
+}
+
+struct BaudRateChanges {
+    std::vector<unsigned int> requested;    /*!< All baudrates requested, in order */
+};
+
+static void onBaudRateChange(unsigned int baudRate, void* context) {
+    static_cast<BaudRateChanges*>(context)->requested.push_back(baudRate);
+}
+
+/**
+ * @brief Drive a detector with the bytes received by a simulated UART, that is reconfigured each time the detector requests it
+ *
+ * @param detector The detector under test
+ * @param line The simulated serial line
+ * @param untilSeconds Run the simulation up to this time on the line
+ * @param timeOffsetSeconds Offset between the line time and the detector time
+ * @return The detector time (in s) at which the detector got locked for the last time, or a negative value if it ends unlocked
+ */
+static double runOnLine(TicBaudRateDetector& detector, UartLineSimulator& line, double untilSeconds, double timeOffsetSeconds = 0) {
+    static const double stepSeconds = 0.01;
+    double lockTime = detector.isLocked() ? 0 : -1;
+    for (double t = stepSeconds; t <= untilSeconds + stepSeconds / 2; t += stepSeconds) {
+        std::vector<UartReceivedByte> received = line.receiveUntil(t, detector.getBaudRate());
+        unsigned int lineErrors = 0;
+        for (const UartReceivedByte& rx : received) {
+            detector.pushBytes(&rx.byte, 1);
+            if (rx.parityError || rx.framingError) {
+                lineErrors++;
+            }
+        }
+        detector.pushLineErrors(lineErrors);
+        bool wasLocked = detector.isLocked();
+        detector.update(static_cast<uint32_t>((t + timeOffsetSeconds) * 1000));
+        if (!wasLocked && detector.isLocked()) {
+            lockTime = t + timeOffsetSeconds;
+        }
+        if (!detector.isLocked()) {
+            lockTime = -1;
+        }
+    }
+    return lockTime;
+}
+
+TEST(TicBaudRateDetector_tests, datasetChecksum) {
+    const char* contents[] = { "PAPP 01250", "ADCO 031428097115" };
+    for (const char* content : contents) {
+        for (char separator : { ' ', '\t' }) {
+            std::vector<uint8_t> dataset = makeDataset(content, separator);
+            unsigned int sum = 0;
+            for (std::size_t pos = 1; pos + 1 < dataset.size(); pos++) { /* Between LF and CR */
+                sum += dataset[pos];
+            }
+            uint8_t checksum = dataset[dataset.size() - 2];
+            EXPECT_TRUE(TicBaudRateDetector::isValidDataset(sum, dataset.size() - 2, separator, checksum));
+            EXPECT_FALSE(TicBaudRateDetector::isValidDataset(sum + 1, dataset.size() - 2, separator, checksum));
+            EXPECT_FALSE(TicBaudRateDetector::isValidDataset(sum, dataset.size() - 2, 'X', checksum));
+        }
+    }
+}
+
+TEST(TicBaudRateDetector_tests, locksOnValidDatasets) {
+    TicBaudRateDetector detector(nullptr, nullptr, TicBaudRateDetector::StandardBaudRate);
+    detector.start(0);
+
+    for (unsigned int i = 0; i < TicBaudRateDetector::ValidDatasetsToLock; i++) {
+        std::vector<uint8_t> dataset = makeDataset("SINSTS\t00" + std::to_string(100 + i), '\t');
+        detector.pushBytes(dataset.data(), dataset.size());
+    }
+    detector.update(100);
+    EXPECT_TRUE(detector.isLocked());
+    EXPECT_EQ(TicBaudRateDetector::StandardBaudRate, detector.getBaudRate());
+}
+
+TEST(TicBaudRateDetector_tests, locksOnValidFrame) {
+    TicBaudRateDetector detector;
+    detector.start(0);
+
+    std::vector<uint8_t> frame;
+    frame.push_back(0x02);
+    std::vector<uint8_t> dataset = makeDataset("PAPP 01250", ' ');
+    frame.insert(frame.end(), dataset.begin(), dataset.end());
+    frame.push_back(0x03);
+    detector.pushBytes(frame.data(), frame.size());
+    detector.update(100);
+    EXPECT_TRUE(detector.isLocked());
+    EXPECT_EQ(TicBaudRateDetector::HistoricalBaudRate, detector.getBaudRate());
+}
+
+TEST(TicBaudRateDetector_tests, corruptedDatasetsDoNotLock) {
+    TicBaudRateDetector detector;
+    detector.start(0);
+
+    for (unsigned int i = 0; i < 10; i++) {
+        std::vector<uint8_t> dataset = makeDataset("PAPP 01250", ' ');
+        dataset[3] ^= 0x01; /* Corrupt the label */
+        detector.pushBytes(dataset.data(), dataset.size());
+    }
+    detector.update(100);
+    EXPECT_FALSE(detector.isLocked());
+}
+
+TEST(TicBaudRateDetector_tests, alternatesWhileNothingValidIsReceived) {
+    BaudRateChanges changes;
+    TicBaudRateDetector detector(onBaudRateChange, &changes);
+    detector.start(0);
+
+    detector.update(TicBaudRateDetector::ProbeWindowMs - 1);
+    EXPECT_EQ(0, changes.requested.size());
+    detector.update(TicBaudRateDetector::ProbeWindowMs);
+    ASSERT_EQ(1, changes.requested.size());
+    EXPECT_EQ(TicBaudRateDetector::StandardBaudRate, changes.requested[0]);
+    detector.update(2 * TicBaudRateDetector::ProbeWindowMs);
+    ASSERT_EQ(2, changes.requested.size());
+    EXPECT_EQ(TicBaudRateDetector::HistoricalBaudRate, changes.requested[1]);
+    EXPECT_EQ(2, detector.getSwitchCount());
+    EXPECT_FALSE(detector.isLocked());
+}
+
+TEST(TicBaudRateDetector_tests, silentLineKeepsLock) {
+    BaudRateChanges changes;
+    TicBaudRateDetector detector(onBaudRateChange, &changes);
+    detector.start(0);
+    std::vector<uint8_t> dataset = makeDataset("PAPP 01250", ' ');
+    for (unsigned int i = 0; i < TicBaudRateDetector::ValidDatasetsToLock; i++) {
+        detector.pushBytes(dataset.data(), dataset.size());
+    }
+    detector.update(10);
+    ASSERT_TRUE(detector.isLocked());
+
+    for (uint32_t now = 10; now < 60000; now += 100) {  /* Meter unplugged for a minute */
+        detector.update(now);
+    }
+    EXPECT_TRUE(detector.isLocked());
+    EXPECT_EQ(0, changes.requested.size());
+}
+
+TEST(TicBaudRateDetector_tests, historicalSampleAtRightBaudRate) {
+    std::vector<uint8_t> ticData = readVectorFromDisk("./ticdecodecpp/test/samples/continuous_linky_3P_historical_TIC_2024_sample.bin");
+    UartLineSimulator line(ticData, 1200);
+    BaudRateChanges changes;
+    TicBaudRateDetector detector(onBaudRateChange, &changes, TicBaudRateDetector::HistoricalBaudRate);
+    detector.start(0);
+
+    double lockTime = runOnLine(detector, line, 30);
+    EXPECT_TRUE(detector.isLocked());
+    EXPECT_EQ(TicBaudRateDetector::HistoricalBaudRate, detector.getBaudRate());
+    EXPECT_GE(lockTime, 0);
+    EXPECT_LT(lockTime, 3.0);
+    EXPECT_EQ(0, changes.requested.size());
+}
+
+TEST(TicBaudRateDetector_tests, historicalSampleWithRxErrorsStaysLocked) {
+    std::vector<uint8_t> ticData = readVectorFromDisk("./ticdecodecpp/test/samples/continuous_linky_3P_historical_TIC_with_rx_errors.bin");
+    UartLineSimulator line(ticData, 1200);
+    BaudRateChanges changes;
+    TicBaudRateDetector detector(onBaudRateChange, &changes, TicBaudRateDetector::HistoricalBaudRate);
+    detector.start(0);
+
+    runOnLine(detector, line, line.getTransmissionEnd());
+    EXPECT_TRUE(detector.isLocked());
+    EXPECT_EQ(0, changes.requested.size());
+}
+
+TEST(TicBaudRateDetector_tests, historicalSampleStartingAtWrongBaudRate) {
+    std::vector<uint8_t> ticData = readVectorFromDisk("./ticdecodecpp/test/samples/continuous_linky_3P_historical_TIC_2024_sample.bin");
+    UartLineSimulator line(ticData, 1200);
+    BaudRateChanges changes;
+    TicBaudRateDetector detector(onBaudRateChange, &changes, TicBaudRateDetector::StandardBaudRate);
+    detector.start(0);
+
+    double lockTime = runOnLine(detector, line, 30);
+    EXPECT_TRUE(detector.isLocked());
+    EXPECT_EQ(TicBaudRateDetector::HistoricalBaudRate, detector.getBaudRate());
+    EXPECT_GE(lockTime, 0);
+    EXPECT_LT(lockTime, 6.0);
+    ASSERT_EQ(1, changes.requested.size());
+    EXPECT_EQ(TicBaudRateDetector::HistoricalBaudRate, changes.requested[0]);
+}
+
+TEST(TicBaudRateDetector_tests, standardSampleStartingAtWrongBaudRate) {
+    std::vector<uint8_t> ticData = readVectorFromDisk("./ticdecodecpp/test/samples/linky_1P_midnight.bin");
+    UartLineSimulator line(ticData, 9600);
+    BaudRateChanges changes;
+    TicBaudRateDetector detector(onBaudRateChange, &changes, TicBaudRateDetector::HistoricalBaudRate);
+    detector.start(0);
+
+    double lockTime = runOnLine(detector, line, 20);
+    EXPECT_TRUE(detector.isLocked());
+    EXPECT_EQ(TicBaudRateDetector::StandardBaudRate, detector.getBaudRate());
+    EXPECT_GE(lockTime, 0);
+    EXPECT_LT(lockTime, 5.0);
+    ASSERT_EQ(1, changes.requested.size());
+    EXPECT_EQ(TicBaudRateDetector::StandardBaudRate, changes.requested[0]);
+}
+
+TEST(TicBaudRateDetector_tests, meterSwitchedFromHistoricalToStandard) {
+    std::vector<uint8_t> historicalData = readVectorFromDisk("./ticdecodecpp/test/samples/continuous_linky_3P_historical_TIC_2024_sample.bin");
+    std::vector<uint8_t> standardData = readVectorFromDisk("./ticdecodecpp/test/samples/linky_1P_midnight.bin");
+    UartLineSimulator historicalLine(historicalData, 1200);
+    UartLineSimulator standardLine(standardData, 9600);
+    BaudRateChanges changes;
+    TicBaudRateDetector detector(onBaudRateChange, &changes, TicBaudRateDetector::HistoricalBaudRate);
+    detector.start(0);
+
+    runOnLine(detector, historicalLine, 20);
+    ASSERT_TRUE(detector.isLocked());
+    ASSERT_EQ(TicBaudRateDetector::HistoricalBaudRate, detector.getBaudRate());
+
+    /* From now on, the meter emits standard TIC */
+    double lockTime = runOnLine(detector, standardLine, 40, 20);
+    EXPECT_TRUE(detector.isLocked());
+    EXPECT_EQ(TicBaudRateDetector::StandardBaudRate, detector.getBaudRate());
+    EXPECT_LT(lockTime, 20 + TicBaudRateDetector::LockedWindowMs / 1000.0 + 5.0);
+    ASSERT_EQ(1, changes.requested.size());
+}
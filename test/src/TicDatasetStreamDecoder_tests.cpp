@@ -0,0 +1,249 @@
+#include "gmock/gmock.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "../tools/Tools.h"
+#include "TIC/Unframer.h"
+#include "TIC/DatasetExtractor.h"
+#include "TIC/DatasetView.h"
+#include "TicDatasetStreamDecoder.h"
+
+/**
+ * @brief A copy of a TicDatasetStreamDecoder::DecodedDataset, that remains valid after the callback
+ */
+struct RecordedDataset {
+    bool isValid;
+    bool isHistorical;
+    TicLabelTable::Label label;
+    uint32_t value;
+    std::string horodate;
+    std::vector<uint8_t> bytes;
+};
+
+/**
+ * @brief Records all datasets decoded by a TicDatasetStreamDecoder
+ */
+struct DecodedDatasetRecorder {
+    static void onDatasetDecoded(const TicDatasetStreamDecoder::DecodedDataset& dataset, void* context) {
+        RecordedDataset recorded;
+        recorded.isValid = dataset.isValid;
+        recorded.isHistorical = dataset.isHistorical;
+        recorded.label = dataset.label;
+        recorded.value = dataset.value;
+        if (dataset.horodate != nullptr) {
+            recorded.horodate = std::string(reinterpret_cast<const char*>(dataset.horodate), dataset.horodateSz);
+        }
+        recorded.bytes = std::vector<uint8_t>(dataset.buffer, dataset.buffer + dataset.size);
+        static_cast<DecodedDatasetRecorder*>(context)->datasets.push_back(recorded);
+    }
+
+    std::vector<RecordedDataset> datasets;
+};
+
+/**
+ * @brief Surround a dataset with its start and end markers
+ */
+static std::vector<uint8_t> frameBytes(const std::vector<uint8_t>& dataset) {
+    std::vector<uint8_t> bytes;
+    bytes.push_back(TicDatasetStreamDecoder::StartMarker);
+    bytes.insert(bytes.end(), dataset.begin(), dataset.end());
+    bytes.push_back(TicDatasetStreamDecoder::EndMarker);
+    return bytes;
+}
+
+static std::vector<RecordedDataset> decodeBytes(const std::vector<uint8_t>& bytes, std::size_t chunkSize) {
+    DecodedDatasetRecorder recorder;
+    TicDatasetStreamDecoder decoder(DecodedDatasetRecorder::onDatasetDecoded, &recorder);
+    for (std::size_t pos = 0; pos < bytes.size(); pos += chunkSize) {
+        decoder.pushBytes(bytes.data() + pos, std::min(chunkSize, bytes.size() - pos));
+    }
+    return recorder.datasets;
+}
+
+TEST(TicDatasetStreamDecoder_tests, standardDataset) {
+    std::vector<RecordedDataset> datasets = decodeBytes(frameBytes(standardTicDataset("SINSTS", "01400")), 64);
+
+    ASSERT_EQ(1U, datasets.size());
+    EXPECT_TRUE(datasets[0].isValid);
+    EXPECT_FALSE(datasets[0].isHistorical);
+    EXPECT_EQ(TicLabelTable::SINSTS, datasets[0].label);
+    EXPECT_EQ(1400U, datasets[0].value);
+    EXPECT_EQ("", datasets[0].horodate);
+    EXPECT_EQ(standardTicDataset("SINSTS", "01400"), datasets[0].bytes);
+}
+
+TEST(TicDatasetStreamDecoder_tests, standardDatasetWithHorodate) {
+    std::vector<uint8_t> bytes = frameBytes(standardTicDataset("SMAXSN", "05120", "E240501183012"));
+    std::vector<uint8_t> date = frameBytes(standardTicDataset("DATE", "", "E240502120000"));
+    bytes.insert(bytes.end(), date.begin(), date.end());
+    std::vector<RecordedDataset> datasets = decodeBytes(bytes, 64);
+
+    ASSERT_EQ(2U, datasets.size());
+    EXPECT_TRUE(datasets[0].isValid);
+    EXPECT_EQ(TicLabelTable::SMAXSN, datasets[0].label);
+    EXPECT_EQ(5120U, datasets[0].value);
+    EXPECT_EQ("E240501183012", datasets[0].horodate);
+    EXPECT_TRUE(datasets[1].isValid);
+    EXPECT_EQ(TicLabelTable::DATE, datasets[1].label);
+    EXPECT_EQ(static_cast<uint32_t>(-1), datasets[1].value);    /* Empty value */
+    EXPECT_EQ("E240502120000", datasets[1].horodate);
+}
+
+TEST(TicDatasetStreamDecoder_tests, historicalDataset) {
+    std::vector<RecordedDataset> datasets = decodeBytes(frameBytes(historicalTicDataset("PAPP", "01230")), 64);
+
+    ASSERT_EQ(1U, datasets.size());
+    EXPECT_TRUE(datasets[0].isValid);
+    EXPECT_TRUE(datasets[0].isHistorical);
+    EXPECT_EQ(TicLabelTable::PAPP, datasets[0].label);
+    EXPECT_EQ(1230U, datasets[0].value);
+}
+
+TEST(TicDatasetStreamDecoder_tests, historicalDatasetWithSpaceChecksum) {
+    std::vector<uint8_t> dataset;
+    for (unsigned int value = 0; value < 1000; value++) {
+        char valueStr[4];
+        snprintf(valueStr, sizeof(valueStr), "%03u", value);
+        dataset = historicalTicDataset("IINST", valueStr);
+        if (dataset.back() == ' ') {
+            break;
+        }
+    }
+    ASSERT_EQ(' ', dataset.back());
+    std::vector<RecordedDataset> datasets = decodeBytes(frameBytes(dataset), 64);
+
+    ASSERT_EQ(1U, datasets.size());
+    EXPECT_TRUE(datasets[0].isValid);
+    EXPECT_TRUE(datasets[0].isHistorical);
+    EXPECT_EQ(TIC::DatasetView(dataset.data(), dataset.size()).dataToUint32(), datasets[0].value);
+}
+
+TEST(TicDatasetStreamDecoder_tests, invalidDatasets) {
+    std::vector<uint8_t> wrongChecksum = standardTicDataset("SINSTS", "01400");
+    wrongChecksum.back()++;
+    std::vector<uint8_t> mixedSeparators = standardTicDataset("SINSTS", "01400");
+    mixedSeparators[mixedSeparators.size() - 2] = ' ';
+    std::vector<uint8_t> bytes = frameBytes(wrongChecksum);
+    for (const std::vector<uint8_t>& dataset : { mixedSeparators, std::vector<uint8_t>(), std::vector<uint8_t>{'A', '\t'} }) {
+        std::vector<uint8_t> datasetBytes = frameBytes(dataset);
+        bytes.insert(bytes.end(), datasetBytes.begin(), datasetBytes.end());
+    }
+    std::vector<RecordedDataset> datasets = decodeBytes(bytes, 64);
+
+    ASSERT_EQ(4U, datasets.size());
+    for (const RecordedDataset& dataset : datasets) {
+        EXPECT_FALSE(dataset.isValid);
+        EXPECT_EQ(TicLabelTable::Unknown, dataset.label);
+    }
+}
+
+TEST(TicDatasetStreamDecoder_tests, nonDecimalValues) {
+    std::vector<uint8_t> bytes;
+    for (const std::vector<uint8_t>& dataset : {
+            standardTicDataset("NGTF", "      BASE      "),
+            standardTicDataset("STGE", "003A0001"),
+            standardTicDataset("EAST", "4294967295"),   /* (uint32_t)-1 is reserved for errors */
+            standardTicDataset("EAST", "4294967294"),
+            standardTicDataset("ADCO", "012345678901") }) {
+        std::vector<uint8_t> datasetBytes = frameBytes(dataset);
+        bytes.insert(bytes.end(), datasetBytes.begin(), datasetBytes.end());
+    }
+    std::vector<RecordedDataset> datasets = decodeBytes(bytes, 64);
+
+    ASSERT_EQ(5U, datasets.size());
+    EXPECT_TRUE(datasets[0].isValid);
+    EXPECT_EQ(TicLabelTable::NGTF, datasets[0].label);
+    EXPECT_EQ(static_cast<uint32_t>(-1), datasets[0].value);
+    EXPECT_EQ(static_cast<uint32_t>(-1), datasets[1].value);
+    EXPECT_EQ(static_cast<uint32_t>(-1), datasets[2].value);
+    EXPECT_EQ(4294967294U, datasets[3].value);
+    EXPECT_TRUE(datasets[4].isValid);
+    EXPECT_EQ(TicLabelTable::ADCO, datasets[4].label);
+    EXPECT_EQ(static_cast<uint32_t>(-1), datasets[4].value);  /* Does not fit in 32 bits */
+}
+
+TEST(TicDatasetStreamDecoder_tests, oneByteAtATime) {
+    std::vector<uint8_t> bytes = frameBytes(standardTicDataset("URMS1", "231"));
+    std::vector<uint8_t> more = frameBytes(historicalTicDataset("IINST", "004"));
+    bytes.insert(bytes.end(), more.begin(), more.end());
+
+    std::vector<RecordedDataset> whole = decodeBytes(bytes, bytes.size());
+    std::vector<RecordedDataset> split = decodeBytes(bytes, 1);
+    ASSERT_EQ(2U, whole.size());
+    ASSERT_EQ(2U, split.size());
+    for (unsigned int pos = 0; pos < whole.size(); pos++) {
+        EXPECT_EQ(whole[pos].isValid, split[pos].isValid);
+        EXPECT_EQ(whole[pos].label, split[pos].label);
+        EXPECT_EQ(whole[pos].value, split[pos].value);
+        EXPECT_EQ(whole[pos].bytes, split[pos].bytes);
+    }
+    EXPECT_EQ(231U, split[0].value);
+    EXPECT_EQ(4U, split[1].value);
+}
+
+TEST(TicDatasetStreamDecoder_tests, discardedDatasets) {
+    std::vector<uint8_t> bytes(TicDatasetStreamDecoder::MaxDatasetSize + 1, 'A');
+    bytes.insert(bytes.begin(), TicDatasetStreamDecoder::StartMarker);
+    bytes.push_back(TicDatasetStreamDecoder::EndMarker);    /* Too long */
+    std::vector<uint8_t> noStart = standardTicDataset("SINSTS", "01400");
+    noStart.push_back(TicDatasetStreamDecoder::EndMarker);
+    bytes.insert(bytes.end(), noStart.begin(), noStart.end());
+    EXPECT_EQ(0U, decodeBytes(bytes, 64).size());
+
+    DecodedDatasetRecorder recorder;
+    TicDatasetStreamDecoder decoder(DecodedDatasetRecorder::onDatasetDecoded, &recorder);
+    std::vector<uint8_t> dataset = frameBytes(standardTicDataset("SINSTS", "01400"));
+    decoder.pushBytes(dataset.data(), dataset.size() - 1);
+    decoder.reset();    /* End of frame, the dataset is unterminated */
+    decoder.pushBytes(&dataset.back(), 1);
+    EXPECT_EQ(0U, recorder.datasets.size());
+}
+
+/**
+ * @brief Feeds the datasets of a capture to both a TIC::DatasetExtractor and a TicDatasetStreamDecoder
+ */
+struct BothDecoders {
+    BothDecoders() : extracted(), streamed(), de(BothDecoders::onDatasetExtracted, this), sd(DecodedDatasetRecorder::onDatasetDecoded, &streamed) {}
+
+    static void onDatasetExtracted(const uint8_t* buf, unsigned int cnt, void* context) {
+        static_cast<BothDecoders*>(context)->extracted.push_back(std::vector<uint8_t>(buf, buf + cnt));
+    }
+    static void onFrameNewBytes(const uint8_t* buf, unsigned int cnt, void* context) {
+        static_cast<BothDecoders*>(context)->de.pushBytes(buf, cnt);
+        static_cast<BothDecoders*>(context)->sd.pushBytes(buf, cnt);
+    }
+    static void onFrameComplete(void* context) {
+        static_cast<BothDecoders*>(context)->de.reset();
+        static_cast<BothDecoders*>(context)->sd.reset();
+    }
+
+    std::vector<std::vector<uint8_t>> extracted;
+    DecodedDatasetRecorder streamed;
+    TIC::DatasetExtractor de;
+    TicDatasetStreamDecoder sd;
+};
+
+TEST(TicDatasetStreamDecoder_tests, matchesDatasetViewOnCaptures) {
+    for (const char* capturePath : { "./ticdecodecpp/test/samples/continuous_linky_3P_historical_TIC_with_rx_errors.bin",
+                                     "./ticdecodecpp/test/samples/linky_1P_midnight.bin" }) {
+        std::vector<uint8_t> capture = readVectorFromDisk(capturePath);
+        BothDecoders decoders;
+        TIC::Unframer unframer(BothDecoders::onFrameNewBytes, BothDecoders::onFrameComplete, &decoders);
+        unframer.pushBytes(capture.data(), capture.size());
+
+        ASSERT_FALSE(decoders.extracted.empty()) << capturePath;
+        ASSERT_EQ(decoders.extracted.size(), decoders.streamed.datasets.size()) << capturePath;
+        for (unsigned int pos = 0; pos < decoders.extracted.size(); pos++) {
+            const RecordedDataset& streamed = decoders.streamed.datasets[pos];
+            TIC::DatasetView dv(decoders.extracted[pos].data(), decoders.extracted[pos].size());
+            EXPECT_EQ(decoders.extracted[pos], streamed.bytes);
+            EXPECT_EQ(dv.isValid(), streamed.isValid) << capturePath << " dataset " << pos;
+            if (dv.isValid() && streamed.isValid) {
+                EXPECT_EQ(dv.decodedType == TIC::DatasetView::ValidHistorical, streamed.isHistorical);
+                EXPECT_EQ(TicLabelTable::lookup(dv.labelBuffer, dv.labelSz), streamed.label);
+                EXPECT_EQ(dv.dataSz > 0 ? dv.dataToUint32() : static_cast<uint32_t>(-1), streamed.value) << capturePath << " dataset " << pos;
+            }
+        }
+    }
+}
@@ -5,6 +5,7 @@
 #include <stdint.h>
 
 #include "TicFrameParser.h"
+#include "../tools/Tools.h"
 
 TEST(TicEvaluatedPower_tests, DefaultInstanciation) {
     TicEvaluatedPower tep;
@@ -141,4 +142,307 @@ TEST(TicMeasurements_tests, DefaultInstanciation) {
 
 TEST(TicFrameParser_tests, DefaultInstanciation) {
     //FIXME: add UT here
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Records all valid power data published by a TicFrameParser
+ */
+struct PowerDataRecorder {
+    PowerDataRecorder() : powers(), nbFrames(0) {}
+
+    static void onNewFrameMeasurements(const TicMeasurements& measurements, void* context) {
+        PowerDataRecorder* recorder = static_cast<PowerDataRecorder*>(context);
+        recorder->nbFrames++;
+        if (measurements.instPower.isValid) {
+            recorder->powers.push_back(measurements.instPower);
+        }
+    }
+
+    std::vector<TicEvaluatedPower> powers;
+    unsigned int nbFrames; /*!< The number of frames published */
+};
+
+static void feedDatasets(TicFrameParser& parser, const std::vector<std::vector<uint8_t>>& datasets) {
+    for (const std::vector<uint8_t>& dataset : datasets) {
+        parser.onDatasetExtracted(dataset.data(), static_cast<unsigned int>(dataset.size()));
+    }
+}
+
+TEST(TicFrameParser_tests, singlePhaseInjection) {
+    PowerDataRecorder recorder;
+    TicFrameParser parser(PowerDataRecorder::onNewFrameMeasurements, &recorder);
+
+    feedDatasets(parser, {
+        standardTicDataset("IRMS1", "003"),
+        standardTicDataset("URMS1", "230"),
+        standardTicDataset("SINSTS", "00000"),
+    });
+    parser.onFrameComplete();
+
+    ASSERT_EQ(1U, recorder.powers.size());
+    EXPECT_EQ(TicEvaluatedPower(-805, -575), recorder.powers[0]);   /* 3A*230V, +/-0.5A */
+    EXPECT_EQ(recorder.powers[0], parser.lastFrameMeasurements.phasePower[0]);
+    EXPECT_FALSE(parser.lastFrameMeasurements.phasePower[1].isValid);
+}
+
+TEST(TicFrameParser_tests, threePhaseWithdrawal) {
+    PowerDataRecorder recorder;
+    TicFrameParser parser(PowerDataRecorder::onNewFrameMeasurements, &recorder);
+
+    feedDatasets(parser, {
+        standardTicDataset("IRMS1", "004"),
+        standardTicDataset("IRMS2", "002"),
+        standardTicDataset("IRMS3", "000"),
+        standardTicDataset("URMS1", "231"),
+        standardTicDataset("URMS2", "229"),
+        standardTicDataset("URMS3", "232"),
+        standardTicDataset("SINSTS", "01400"),
+        standardTicDataset("SINSTS1", "00920"),
+        standardTicDataset("SINSTS2", "00480"),
+        standardTicDataset("SINSTS3", "00000"),
+    });
+    parser.onFrameComplete();
+
+    ASSERT_EQ(1U, recorder.powers.size());
+    EXPECT_EQ(TicEvaluatedPower(1400, 1400), recorder.powers[0]);
+    EXPECT_EQ(TicEvaluatedPower(920, 920), parser.lastFrameMeasurements.phasePower[0]);
+    EXPECT_EQ(TicEvaluatedPower(480, 480), parser.lastFrameMeasurements.phasePower[1]);
+    EXPECT_EQ(TicEvaluatedPower(-116, 0), parser.lastFrameMeasurements.phasePower[2]);  /* Less than 0.5A, may be injecting a little */
+}
+
+TEST(TicFrameParser_tests, threePhaseInjection) {
+    PowerDataRecorder recorder;
+    TicFrameParser parser(PowerDataRecorder::onNewFrameMeasurements, &recorder);
+
+    feedDatasets(parser, {
+        standardTicDataset("IRMS1", "003"),
+        standardTicDataset("IRMS2", "002"),
+        standardTicDataset("IRMS3", "000"),
+        standardTicDataset("URMS1", "230"),
+        standardTicDataset("URMS2", "230"),
+        standardTicDataset("URMS3", "230"),
+        standardTicDataset("SINSTS", "00000"),
+    });
+    EXPECT_EQ(0U, recorder.powers.size());  /* We need all phases before evaluating the total */
+    feedDatasets(parser, {
+        standardTicDataset("SINSTS1", "00000"),
+        standardTicDataset("SINSTS2", "00000"),
+        standardTicDataset("SINSTS3", "00000"),
+    });
+    parser.onFrameComplete();
+
+    ASSERT_EQ(1U, recorder.powers.size());
+    EXPECT_EQ(TicEvaluatedPower(-805, -575), parser.lastFrameMeasurements.phasePower[0]);
+    EXPECT_EQ(TicEvaluatedPower(-575, -345), parser.lastFrameMeasurements.phasePower[1]);
+    EXPECT_EQ(TicEvaluatedPower(-115, 0), parser.lastFrameMeasurements.phasePower[2]);
+    EXPECT_EQ(TicEvaluatedPower(-1495, -920), recorder.powers[0]);  /* Sum of the per-phase bounds */
+    EXPECT_EQ(recorder.powers[0], parser.lastFrameMeasurements.instPower);
+}
+
+TEST(TicFrameParser_tests, threePhaseMixedWithdrawalAndInjection) {
+    PowerDataRecorder recorder;
+    TicFrameParser parser(PowerDataRecorder::onNewFrameMeasurements, &recorder);
+
+    feedDatasets(parser, {
+        standardTicDataset("IRMS1", "001"),
+        standardTicDataset("IRMS2", "005"),
+        standardTicDataset("IRMS3", "004"),
+        standardTicDataset("URMS1", "230"),
+        standardTicDataset("URMS2", "230"),
+        standardTicDataset("URMS3", "230"),
+        standardTicDataset("SINSTS", "00000"),
+        standardTicDataset("SINSTS1", "00300"),
+        standardTicDataset("SINSTS2", "00000"),
+        standardTicDataset("SINSTS3", "00000"),
+    });
+    parser.onFrameComplete();
+
+    ASSERT_EQ(1U, recorder.powers.size());
+    EXPECT_EQ(TicEvaluatedPower(300, 300), parser.lastFrameMeasurements.phasePower[0]);
+    EXPECT_EQ(TicEvaluatedPower(-1265, -1035), parser.lastFrameMeasurements.phasePower[1]);
+    EXPECT_EQ(TicEvaluatedPower(-1035, -805), parser.lastFrameMeasurements.phasePower[2]);
+    EXPECT_EQ(TicEvaluatedPower(-2000, -1540), recorder.powers[0]);
+}
+
+TEST(TicFrameParser_tests, threePhaseInjectionWithMissingPhasePower) {
+    PowerDataRecorder recorder;
+    TicFrameParser parser(PowerDataRecorder::onNewFrameMeasurements, &recorder);
+
+    feedDatasets(parser, {
+        standardTicDataset("IRMS1", "000"),
+        standardTicDataset("IRMS2", "001"),
+        standardTicDataset("IRMS3", "000"),
+        standardTicDataset("URMS1", "230"),
+        standardTicDataset("URMS2", "230"),
+        standardTicDataset("URMS3", "230"),
+        standardTicDataset("SINSTS", "00000"),
+        standardTicDataset("SINSTS1", "00000"),
+        standardTicDataset("SINSTS3", "00000"),    /* SINSTS2 was lost */
+    });
+    EXPECT_EQ(0U, recorder.powers.size());
+    parser.onFrameComplete();
+
+    ASSERT_EQ(1U, recorder.powers.size());  /* Evaluated at the end of the frame */
+    EXPECT_EQ(TicEvaluatedPower(-345, 345), parser.lastFrameMeasurements.phasePower[1]);  /* Unknown direction */
+    EXPECT_EQ(TicEvaluatedPower(-575, 0), recorder.powers[0]);  /* The total withdrawn power is 0, so we cannot be withdrawing overall */
+}
+
+TEST(TicFrameParser_tests, unrealisticValuesAreIgnored) {
+    PowerDataRecorder recorder;
+    TicFrameParser parser(PowerDataRecorder::onNewFrameMeasurements, &recorder);
+
+    /* Corrupted values with a valid checksum, voltage*current would overflow */
+    feedDatasets(parser, {
+        standardTicDataset("IRMS1", "0100000"),
+        standardTicDataset("IRMS2", "002"),
+        standardTicDataset("IRMS3", "000"),
+        standardTicDataset("URMS1", "4000000000"),
+        standardTicDataset("URMS2", "230"),
+        standardTicDataset("URMS3", "230"),
+        standardTicDataset("SINSTS", "00000"),
+        standardTicDataset("SINSTS1", "00000"),
+        standardTicDataset("SINSTS2", "00000"),
+        standardTicDataset("SINSTS3", "00000"),
+    });
+    parser.onFrameComplete();
+    EXPECT_EQ(0U, recorder.powers.size());
+    EXPECT_FALSE(parser.lastFrameMeasurements.phasePower[0].isValid);
+    EXPECT_EQ(TicEvaluatedPower(-575, -345), parser.lastFrameMeasurements.phasePower[1]);
+
+    feedDatasets(parser, {
+        standardTicDataset("SINSTS", "3000000000"),
+    });
+    parser.onFrameComplete();
+    EXPECT_EQ(0U, recorder.powers.size());
+}
+
+TEST(TicFrameParser_tests, energyIndicesNarrowInjectionRange) {
+    PowerDataRecorder recorder;
+    TicFrameParser parser(PowerDataRecorder::onNewFrameMeasurements, &recorder);
+    double injectedWh = 500000.0;
+
+    for (unsigned int seconds = 0; seconds < 300; seconds += 2) {   /* Injecting 700W for 5 minutes, one frame every 2s */
+        char horodate[14];
+        snprintf(horodate, sizeof(horodate), "E240502%02u%02u%02u", 12U, seconds / 60, seconds % 60);
+        char eait[10];
+        snprintf(eait, sizeof(eait), "%09u", static_cast<unsigned int>(injectedWh));
+        feedDatasets(parser, {
+            standardTicDataset("DATE", "", horodate),
+            standardTicDataset("EAST", "001000000"),
+            standardTicDataset("EAIT", eait),
+            standardTicDataset("IRMS1", "003"),
+            standardTicDataset("URMS1", "230"),
+            standardTicDataset("SINSTS", "00000"),
+        });
+        parser.onFrameComplete();
+        injectedWh += 700 * 2.0 / 3600.0;
+    }
+
+    ASSERT_EQ(150U, recorder.powers.size());
+    EXPECT_EQ(TicEvaluatedPower(-805, -575), recorder.powers.front());  /* No history yet */
+    const TicEvaluatedPower& last = recorder.powers.back();
+    EXPECT_LE(last.minValue, -700);
+    EXPECT_GE(last.maxValue, -700);
+    EXPECT_LE(last.maxValue - last.minValue, 40);
+    EXPECT_EQ(last, parser.lastFrameMeasurements.instPower);
+    EXPECT_EQ(TicEvaluatedPower(-805, -575), parser.lastFrameMeasurements.phasePower[0]);   /* Per-phase ranges are not narrowed */
+}
+
+TEST(TicFrameParser_tests, measurementsArePublishedOncePerFrame) {
+    PowerDataRecorder recorder;
+    TicFrameParser parser(PowerDataRecorder::onNewFrameMeasurements, &recorder);
+
+    feedDatasets(parser, {
+        standardTicDataset("DATE", "", "E240502120000"),
+        standardTicDataset("SINSTS", "01400"),   /* Enough to compute the power */
+    });
+    EXPECT_EQ(0U, recorder.nbFrames);   /* Nothing is published before the end of the frame */
+    feedDatasets(parser, {
+        standardTicDataset("IRMS1", "006"),
+        standardTicDataset("URMS1", "231"),
+    });
+    parser.onFrameComplete();
+
+    EXPECT_EQ(1U, recorder.nbFrames);
+    ASSERT_EQ(1U, recorder.powers.size());
+    EXPECT_EQ(TicEvaluatedPower(1400, 1400), recorder.powers[0]);
+    EXPECT_EQ(0U, parser.lastFrameMeasurements.fromFrameNb);
+    EXPECT_EQ(TimeOfDay(12, 0, 0), parser.lastFrameMeasurements.timestamp);
+    EXPECT_EQ(231U, parser.lastFrameMeasurements.instVoltage);  /* Received after the power, still part of the snapshot */
+    EXPECT_EQ(6U, parser.lastFrameMeasurements.instAbsCurrent);
+
+    /* The snapshot is not altered while the next frame is being received */
+    feedDatasets(parser, {
+        standardTicDataset("DATE", "", "E240502120002"),
+        standardTicDataset("SINSTS", "01500"),
+    });
+    EXPECT_EQ(0U, parser.lastFrameMeasurements.fromFrameNb);
+    EXPECT_EQ(TicEvaluatedPower(1400, 1400), parser.lastFrameMeasurements.instPower);
+    EXPECT_EQ(1400U, parser.lastFrameMeasurements.datasets.getValue(TicLabelTable::SINSTS));
+    parser.onFrameComplete();
+    EXPECT_EQ(2U, recorder.nbFrames);
+    EXPECT_EQ(1U, parser.lastFrameMeasurements.fromFrameNb);
+    EXPECT_EQ(TicEvaluatedPower(1500, 1500), parser.lastFrameMeasurements.instPower);
+
+    parser.onFrameComplete();   /* An empty frame is not published */
+    EXPECT_EQ(2U, recorder.nbFrames);
+}
+
+TEST(TicFrameParser_tests, datasetErrorsAreAttributedToLabelAndPosition) {
+    for (bool streamingDecoding : { false, true }) {
+        TicFrameParser parser;
+        parser.setStreamingDecoding(streamingDecoding);
+        unsigned int nbDatasetErrors = 0;
+        parser.invokeOnDatasetError([](void* context) { (*static_cast<unsigned int*>(context))++; }, &nbDatasetErrors);
+
+        std::vector<uint8_t> wrongChecksum = standardTicDataset("URMS1", "230");
+        wrongChecksum.back()++;
+        std::vector<uint8_t> damagedLabel = standardTicDataset("IRMS1", "003");
+        damagedLabel[1] = 'X';
+        for (unsigned int frame = 0; frame < 2; frame++) {
+            for (const std::vector<uint8_t>& dataset : { standardTicDataset("SINSTS", "01400"), wrongChecksum, damagedLabel }) {
+                if (streamingDecoding) {
+                    std::vector<uint8_t> bytes(1, 0x0a);
+                    bytes.insert(bytes.end(), dataset.begin(), dataset.end());
+                    bytes.push_back(0x0d);
+                    parser.onNewFrameBytes(bytes.data(), static_cast<unsigned int>(bytes.size()));
+                }
+                else {
+                    parser.onDatasetExtracted(dataset.data(), static_cast<unsigned int>(dataset.size()));
+                }
+            }
+            parser.onFrameComplete();
+        }
+
+        DatasetErrorStats::Snapshot stats = parser.getDatasetErrorStats();
+        EXPECT_EQ(4U, nbDatasetErrors);
+        EXPECT_EQ(4U, stats.errorCount);
+        EXPECT_EQ(2U, stats.perLabel[TicLabelTable::URMS1]);
+        EXPECT_EQ(2U, stats.perLabel[TicLabelTable::Unknown]);
+        EXPECT_EQ(0U, stats.perLabel[TicLabelTable::SINSTS]);
+        EXPECT_EQ(0U, stats.perPosition[0]);
+        EXPECT_EQ(2U, stats.perPosition[1]);
+        EXPECT_EQ(2U, stats.perPosition[2]);
+        EXPECT_EQ(2U, stats.frameCount);
+        EXPECT_EQ(2U, stats.framesWithErrors);
+        EXPECT_EQ(1U, stats.burstCount);    /* 3 errors within the default window */
+    }
+}
+
+TEST(TicFrameParser_tests, historicalDatasetErrorsAreAttributedToLabel) {
+    TicFrameParser parser;
+    std::vector<uint8_t> wrongChecksum = historicalTicDataset("IINST", "002");
+    wrongChecksum.back()++;
+    for (const std::vector<uint8_t>& dataset : { historicalTicDataset("ADCO", "031428097115"), historicalTicDataset("OPTARIF", "BASE"), wrongChecksum, historicalTicDataset("PAPP", "00450") }) {
+        parser.onDatasetExtracted(dataset.data(), static_cast<unsigned int>(dataset.size()));
+    }
+    parser.onFrameComplete();
+
+    DatasetErrorStats::Snapshot stats = parser.getDatasetErrorStats();
+    EXPECT_EQ(1U, stats.errorCount);
+    EXPECT_EQ(1U, stats.perLabel[TicLabelTable::IINST]);
+    EXPECT_EQ(0U, stats.perLabel[TicLabelTable::Unknown]);
+    EXPECT_EQ(1U, stats.perPosition[2]);
+    EXPECT_EQ(TicLabelTable::IINST, stats.getWorstLabel());
+    EXPECT_EQ(TicEvaluatedPower(450, 450), parser.lastFrameMeasurements.instPower);
+}
@@ -0,0 +1,170 @@
+#include "gmock/gmock.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "../tools/Tools.h"
+#include "TicFrameRecord.h"
+#include "TicFrameParser.h"
+
+static bool storeDataset(TicFrameRecord& record, TicLabelTable::Label label, const std::vector<uint8_t>& dataset) {
+    TIC::DatasetView dv(dataset.data(), dataset.size());
+    EXPECT_TRUE(dv.isValid());
+    return record.store(label, dv);
+}
+
+TEST(TicFrameRecord_tests, DefaultInstanciation) {
+    TicFrameRecord record;
+
+    EXPECT_EQ(0U, record.getCount());
+    for (unsigned int label = TicLabelTable::Unknown; label < TicLabelTable::LabelCount; label++) {
+        EXPECT_FALSE(record.has(static_cast<TicLabelTable::Label>(label)));
+    }
+    EXPECT_EQ(static_cast<uint32_t>(-1), record.getValue(TicLabelTable::EAST));
+    EXPECT_EQ(nullptr, record.getText(TicLabelTable::ADSC));
+}
+
+TEST(TicFrameRecord_tests, numericValues) {
+    TicFrameRecord record;
+
+    EXPECT_TRUE(record.setValue(TicLabelTable::EAST, 123456789));
+    EXPECT_TRUE(record.setValue(TicLabelTable::PMAX, 0));
+    EXPECT_TRUE(record.setValue(TicLabelTable::STGE, 0xFFFFFFFF));
+    EXPECT_TRUE(record.has(TicLabelTable::EAST));
+    EXPECT_TRUE(record.has(TicLabelTable::PMAX));
+    EXPECT_FALSE(record.has(TicLabelTable::EAIT));
+    EXPECT_EQ(123456789U, record.getValue(TicLabelTable::EAST));
+    EXPECT_EQ(0U, record.getValue(TicLabelTable::PMAX));
+    EXPECT_EQ(0xFFFFFFFFU, record.getValue(TicLabelTable::STGE));
+    EXPECT_EQ(3U, record.getCount());
+
+    EXPECT_FALSE(record.setValue(TicLabelTable::ADSC, 1)); /* Stored as text */
+    EXPECT_FALSE(record.setValue(TicLabelTable::MSG1, 1)); /* Not stored */
+    EXPECT_FALSE(record.setValue(TicLabelTable::Unknown, 1));
+    EXPECT_FALSE(record.has(TicLabelTable::ADSC));
+    EXPECT_EQ(3U, record.getCount());
+}
+
+TEST(TicFrameRecord_tests, textValues) {
+    TicFrameRecord record;
+    const std::string ngtf("      BASE      ");
+    const std::string tooLong("THIS TEXT IS TOO LONG");
+
+    EXPECT_TRUE(record.setText(TicLabelTable::NGTF, reinterpret_cast<const uint8_t*>(ngtf.data()), ngtf.size()));
+    EXPECT_STREQ(ngtf.c_str(), record.getText(TicLabelTable::NGTF));
+    EXPECT_EQ(static_cast<uint32_t>(-1), record.getValue(TicLabelTable::NGTF));
+    EXPECT_FALSE(record.setText(TicLabelTable::LTARF, reinterpret_cast<const uint8_t*>(tooLong.data()), tooLong.size()));
+    EXPECT_FALSE(record.has(TicLabelTable::LTARF));
+    EXPECT_FALSE(record.setText(TicLabelTable::EAST, reinterpret_cast<const uint8_t*>(ngtf.data()), ngtf.size()));
+    EXPECT_EQ(nullptr, record.getText(TicLabelTable::EAST));
+}
+
+TEST(TicFrameRecord_tests, resetForgetsAllValues) {
+    TicFrameRecord record;
+    const std::string adsc("012345678901");
+
+    record.setValue(TicLabelTable::EAST, 1000);
+    record.setValue(TicLabelTable::PAPP, 2000);     /* In the last presence word */
+    record.setText(TicLabelTable::ADSC, reinterpret_cast<const uint8_t*>(adsc.data()), adsc.size());
+    EXPECT_EQ(3U, record.getCount());
+
+    record.reset();
+    EXPECT_EQ(0U, record.getCount());
+    EXPECT_FALSE(record.has(TicLabelTable::EAST));
+    EXPECT_FALSE(record.has(TicLabelTable::PAPP));
+    EXPECT_EQ(static_cast<uint32_t>(-1), record.getValue(TicLabelTable::EAST));
+    EXPECT_EQ(nullptr, record.getText(TicLabelTable::ADSC));
+}
+
+TEST(TicFrameRecord_tests, swapWith) {
+    TicFrameRecord full;
+    TicFrameRecord empty;
+    full.setValue(TicLabelTable::SINSTS, 850);
+    full.setValue(TicLabelTable::URMS1, 231);
+
+    full.swapWith(empty);
+    EXPECT_EQ(0U, full.getCount());
+    EXPECT_EQ(2U, empty.getCount());
+    EXPECT_EQ(850U, empty.getValue(TicLabelTable::SINSTS));
+
+    /* Swap back but using std::swap() */
+    std::swap(full, empty);
+    EXPECT_EQ(2U, full.getCount());
+    EXPECT_EQ(231U, full.getValue(TicLabelTable::URMS1));
+    EXPECT_EQ(0U, empty.getCount());
+}
+
+TEST(TicFrameRecord_tests, storeDatasets) {
+    TicFrameRecord record;
+
+    EXPECT_TRUE(storeDataset(record, TicLabelTable::EAST, standardTicDataset("EAST", "001234567")));
+    EXPECT_TRUE(storeDataset(record, TicLabelTable::STGE, standardTicDataset("STGE", "003A0001")));
+    EXPECT_TRUE(storeDataset(record, TicLabelTable::LTARF, standardTicDataset("LTARF", "  HEURE  PLEINE ")));
+    EXPECT_TRUE(storeDataset(record, TicLabelTable::SMAXSN, standardTicDataset("SMAXSN", "04000", "E240502230005")));
+    EXPECT_FALSE(storeDataset(record, TicLabelTable::DATE, standardTicDataset("DATE", "", "E240502235800")));
+    EXPECT_FALSE(storeDataset(record, TicLabelTable::MSG1, standardTicDataset("MSG1", "PAS DE          MESSAGE         ")));
+    EXPECT_FALSE(storeDataset(record, TicLabelTable::SINSTS, standardTicDataset("SINSTS", "08X0")));  /* Malformed value */
+    EXPECT_FALSE(storeDataset(record, TicLabelTable::STGE, standardTicDataset("STGE", "003G0001")));  /* Malformed hexadecimal value */
+
+    EXPECT_EQ(1234567U, record.getValue(TicLabelTable::EAST));
+    EXPECT_EQ(0x003A0001U, record.getValue(TicLabelTable::STGE));
+    EXPECT_STREQ("  HEURE  PLEINE ", record.getText(TicLabelTable::LTARF));
+    EXPECT_EQ(4000U, record.getValue(TicLabelTable::SMAXSN));
+    EXPECT_FALSE(record.has(TicLabelTable::DATE));
+    EXPECT_FALSE(record.has(TicLabelTable::MSG1));
+    EXPECT_FALSE(record.has(TicLabelTable::SINSTS));
+    EXPECT_EQ(4U, record.getCount());
+}
+
+TEST(TicFrameRecord_tests, parserRecordsAllLabelsOfFrame) {
+    TicFrameParser parser;
+    std::vector<std::vector<uint8_t>> frame = {
+        standardTicDataset("ADSC", "012345678901"),
+        standardTicDataset("DATE", "", "E240502120000"),
+        standardTicDataset("EAST", "001000000"),
+        standardTicDataset("EAIT", "000500000"),
+        standardTicDataset("IRMS1", "004"),
+        standardTicDataset("IRMS2", "002"),
+        standardTicDataset("IRMS3", "000"),
+        standardTicDataset("URMS1", "231"),
+        standardTicDataset("URMS2", "229"),
+        standardTicDataset("URMS3", "232"),
+        standardTicDataset("SINSTS", "01400"),
+        standardTicDataset("SINSTS1", "00920"),
+        standardTicDataset("SINSTS2", "00480"),
+        standardTicDataset("SINSTS3", "00000"),
+        standardTicDataset("SMAXSN-1", "05120", "E240501183012"),
+        standardTicDataset("NJOURF+1", "00"),
+        standardTicDataset("ADCO", "012345678901"),    /* Not a standard label */
+    };
+
+    for (const std::vector<uint8_t>& dataset : frame) {
+        parser.onDatasetExtracted(dataset.data(), static_cast<unsigned int>(dataset.size()));
+    }
+    parser.onFrameComplete();
+
+    const TicFrameRecord& record = parser.lastFrameMeasurements.datasets;
+    EXPECT_EQ(0U, parser.lastFrameMeasurements.fromFrameNb);
+    EXPECT_EQ(15U, record.getCount());   /* All labels but DATE and ADCO */
+    EXPECT_STREQ("012345678901", record.getText(TicLabelTable::ADSC));
+    EXPECT_EQ(1000000U, record.getValue(TicLabelTable::EAST));
+    EXPECT_EQ(500000U, record.getValue(TicLabelTable::EAIT));
+    EXPECT_EQ(2U, record.getValue(TicLabelTable::IRMS2));
+    EXPECT_EQ(232U, record.getValue(TicLabelTable::URMS3));
+    EXPECT_EQ(480U, record.getValue(TicLabelTable::SINSTS2));
+    EXPECT_EQ(5120U, record.getValue(TicLabelTable::SMAXSN_M1));
+    EXPECT_EQ(0U, record.getValue(TicLabelTable::NJOURF_P1));
+    EXPECT_EQ(1400, parser.lastFrameMeasurements.instPower.minValue);
+
+    /* The first dataset of the next frame starts a new record, committed at the end of that frame */
+    std::vector<uint8_t> nextDataset = standardTicDataset("EAST", "001000001");
+    parser.onDatasetExtracted(nextDataset.data(), static_cast<unsigned int>(nextDataset.size()));
+    EXPECT_EQ(1U, parser.currentFrameMeasurements.fromFrameNb);
+    EXPECT_EQ(1U, parser.currentFrameMeasurements.datasets.getCount());
+    EXPECT_EQ(15U, record.getCount());
+    parser.onFrameComplete();
+    EXPECT_EQ(1U, parser.lastFrameMeasurements.fromFrameNb);
+    EXPECT_EQ(1U, record.getCount());
+    EXPECT_EQ(1000001U, record.getValue(TicLabelTable::EAST));
+    EXPECT_FALSE(record.has(TicLabelTable::SINSTS));
+}
@@ -0,0 +1,90 @@
+#include "gmock/gmock.h"
+#include <cstring>
+#include <set>
+#include <string>
+
+#include "TicLabelTable.h"
+
+static TicLabelTable::Label lookup(const std::string& label) {
+    return TicLabelTable::lookup(reinterpret_cast<const uint8_t*>(label.data()), label.size());
+}
+
+TEST(TicLabelTable_tests, knownLabels) {
+    EXPECT_EQ(TicLabelTable::DATE, lookup("DATE"));
+    EXPECT_EQ(TicLabelTable::SINSTS, lookup("SINSTS"));
+    EXPECT_EQ(TicLabelTable::PAPP, lookup("PAPP"));
+    EXPECT_EQ(TicLabelTable::URMS1, lookup("URMS1"));
+    EXPECT_EQ(TicLabelTable::IRMS1, lookup("IRMS1"));
+    EXPECT_EQ(TicLabelTable::PREF, lookup("PREF"));
+    EXPECT_EQ(TicLabelTable::PMAX, lookup("PMAX"));
+    EXPECT_EQ(TicLabelTable::SMAXSN, lookup("SMAXSN"));
+    EXPECT_EQ(TicLabelTable::BASE, lookup("BASE"));
+    EXPECT_EQ(TicLabelTable::HCHC, lookup("HCHC"));
+    EXPECT_EQ(TicLabelTable::HCHP, lookup("HCHP"));
+}
+
+TEST(TicLabelTable_tests, standardLabels) {
+    EXPECT_EQ(TicLabelTable::ADSC, lookup("ADSC"));
+    EXPECT_EQ(TicLabelTable::VTIC, lookup("VTIC"));
+    EXPECT_EQ(TicLabelTable::NGTF, lookup("NGTF"));
+    EXPECT_EQ(TicLabelTable::EAST, lookup("EAST"));
+    EXPECT_EQ(TicLabelTable::EASF01, lookup("EASF01"));
+    EXPECT_EQ(TicLabelTable::EASF10, lookup("EASF10"));
+    EXPECT_EQ(TicLabelTable::EAIT, lookup("EAIT"));
+    EXPECT_EQ(TicLabelTable::IRMS2, lookup("IRMS2"));
+    EXPECT_EQ(TicLabelTable::URMS3, lookup("URMS3"));
+    EXPECT_EQ(TicLabelTable::SINSTS1, lookup("SINSTS1"));
+    EXPECT_EQ(TicLabelTable::SMAXSN_M1, lookup("SMAXSN-1"));
+    EXPECT_EQ(TicLabelTable::SMAXSN3_M1, lookup("SMAXSN3-1"));
+    EXPECT_EQ(TicLabelTable::STGE, lookup("STGE"));
+    EXPECT_EQ(TicLabelTable::NJOURF_P1, lookup("NJOURF+1"));
+    EXPECT_EQ(TicLabelTable::PPOINTE, lookup("PPOINTE"));
+}
+
+TEST(TicLabelTable_tests, historicalLabels) {
+    EXPECT_EQ(TicLabelTable::ADCO, lookup("ADCO"));
+    EXPECT_EQ(TicLabelTable::OPTARIF, lookup("OPTARIF"));
+    EXPECT_EQ(TicLabelTable::ISOUSC, lookup("ISOUSC"));
+    EXPECT_EQ(TicLabelTable::BBRHPJR, lookup("BBRHPJR"));
+    EXPECT_EQ(TicLabelTable::PTEC, lookup("PTEC"));
+    EXPECT_EQ(TicLabelTable::IINST, lookup("IINST"));
+    EXPECT_EQ(TicLabelTable::IINST3, lookup("IINST3"));
+    EXPECT_EQ(TicLabelTable::IMAX, lookup("IMAX"));
+    EXPECT_EQ(TicLabelTable::HHPHC, lookup("HHPHC"));
+    EXPECT_EQ(TicLabelTable::MOTDETAT, lookup("MOTDETAT"));
+    EXPECT_EQ(TicLabelTable::PPOT, lookup("PPOT"));
+    EXPECT_EQ(TicLabelTable::ADPS, lookup("ADPS"));
+    EXPECT_EQ(TicLabelTable::ADIR2, lookup("ADIR2"));
+}
+
+TEST(TicLabelTable_tests, namesRoundTrip) {
+    std::set<std::size_t> buckets;
+    for (unsigned int label = TicLabelTable::Unknown + 1; label < TicLabelTable::LabelCount; label++) {
+        const char* name = TicLabelTable::getName(static_cast<TicLabelTable::Label>(label));
+        EXPECT_EQ(static_cast<TicLabelTable::Label>(label), lookup(name));
+        buckets.insert(TicLabelTable::getBucket(name, strlen(name)));
+    }
+    EXPECT_EQ(static_cast<std::size_t>(TicLabelTable::LabelCount - 1), buckets.size()); /* Perfect hash: one bucket per label */
+    EXPECT_STREQ("", TicLabelTable::getName(TicLabelTable::Unknown));
+}
+
+TEST(TicLabelTable_tests, unknownLabels) {
+    const char* unknownLabels[] = {
+        "IINST4", "IMAX0", "ADIR4", "BBRHCJ", "HCH", "ADC0", /* Near misses on historical labels */
+        "date", "PAP", "PAPPX", "SINST", "URMS", "DAT", /* Near misses */
+        "EASF11", "EASD05", "IRMS4", "SINSTS4", "SMAXSN-2", "SMAXSN4-1", "NJOURF-1", "MSG3"  /* Near misses on standard labels */
+    };
+    for (const char* label : unknownLabels) {
+        EXPECT_EQ(TicLabelTable::Unknown, lookup(label)) << label;
+    }
+}
+
+TEST(TicLabelTable_tests, invalidInput) {
+    EXPECT_EQ(TicLabelTable::Unknown, TicLabelTable::lookup(nullptr, 4));
+    EXPECT_EQ(TicLabelTable::Unknown, lookup(""));
+    EXPECT_EQ(TicLabelTable::Unknown, lookup("SINSTS_AND_MUCH_MORE"));
+    /* A known label followed by more bytes that are not part of the label */
+    const uint8_t buffer[] = { 'P', 'A', 'P', 'P', ' ', '0' };
+    EXPECT_EQ(TicLabelTable::PAPP, TicLabelTable::lookup(buffer, 4));
+    EXPECT_EQ(TicLabelTable::Unknown, TicLabelTable::lookup(buffer, 5));
+}
@@ -0,0 +1,135 @@
+#include "gmock/gmock.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "TraceLog.h"
+#include "TraceDecoder.h"
+#include "TicLabelTable.h"
+
+static void appendToVector(const uint8_t* buf, std::size_t len, void* context) {
+    std::vector<uint8_t>* output = static_cast<std::vector<uint8_t>*>(context);
+    output->insert(output->end(), buf, buf + len);
+}
+
+static std::string decode(const std::vector<uint8_t>& dump) {
+    TraceDecoder decoder;
+    decoder.pushBytes(dump.data(), dump.size());
+    return decoder.takeText();
+}
+
+TEST(TraceLog_tests, recordIsBinary) {
+    TraceLog trace;
+    EXPECT_TRUE(trace.isEmpty());
+    EXPECT_TRUE(trace.log<Trace::NewFrameId>(0x12345678U));
+    EXPECT_FALSE(trace.isEmpty());
+
+    std::vector<uint8_t> dump;
+    EXPECT_EQ(6U, trace.drain(appendToVector, &dump));
+    std::vector<uint8_t> expected { TraceLog::RecordMarker, Trace::NewFrameId, 0x78, 0x56, 0x34, 0x12 };
+    EXPECT_EQ(expected, dump);
+    EXPECT_TRUE(trace.isEmpty());
+}
+
+TEST(TraceLog_tests, decodeAllArgumentTypes) {
+    TraceLog trace;
+    trace.log<Trace::MissingTimeGetter>();
+    trace.log<Trace::SystemTimeAsHorodate>(23U, 5U, 59U);
+    trace.log<Trace::NewComputedPower>(-1200, 350, true);
+    trace.log<Trace::NewDataset>(TicLabelTable::SINSTS);
+
+    std::vector<uint8_t> dump;
+    trace.drain(appendToVector, &dump);
+    EXPECT_EQ("Missing time getter\n"
+              "Using systemtime (23:5:59) as horodate\n"
+              "onNewComputedPower([-1200;350]W) with valid horodate: 1\n"
+              "New dataset: SINSTS\n", decode(dump));
+}
+
+TEST(TraceLog_tests, formatEvent) {
+    uint32_t args[] = { 0xbeef };
+    EXPECT_EQ("onDatasetExtracted() called with 48879 bytes", TraceDecoder::formatEvent(Trace::DatasetExtracted, args));
+    EXPECT_EQ("<unknown trace event 250>", TraceDecoder::formatEvent(static_cast<Trace::Event>(250), nullptr));
+}
+
+TEST(TraceLog_tests, decodeRecordsMixedWithText) {
+    TraceLog trace;
+    trace.log<Trace::NewDayDetected>();
+    std::vector<uint8_t> dump;
+    std::string before("Init\n");
+    std::string after("Waiting for TIC data...\n");
+    dump.insert(dump.end(), before.begin(), before.end());
+    trace.drain(appendToVector, &dump);
+    dump.insert(dump.end(), after.begin(), after.end());
+    EXPECT_EQ("Init\nSwitch to new day detected\nWaiting for TIC data...\n", decode(dump));
+}
+
+TEST(TraceLog_tests, decodeOneByteAtATime) {
+    TraceLog trace;
+    trace.log<Trace::SystemTimeAsHorodate>(1U, 2U, 3U);
+    trace.log<Trace::NewFrameId>(42U);
+    std::vector<uint8_t> dump;
+    EXPECT_EQ(TraceLog::RecordHeaderSize + 3 * sizeof(uint32_t), trace.drain(appendToVector, &dump, 1)); /* Rounded up to a whole record */
+    EXPECT_EQ(TraceLog::RecordHeaderSize + sizeof(uint32_t), trace.drain(appendToVector, &dump, 1));
+    EXPECT_TRUE(trace.isEmpty());
+    TraceDecoder decoder;
+    std::string text;
+    for (uint8_t byte : dump) {
+        decoder.pushBytes(&byte, 1);
+        text += decoder.takeText();
+    }
+    EXPECT_EQ("Using systemtime (1:2:3) as horodate\nIt seems we are in a new frame ID 42\n", text);
+}
+
+TEST(TraceLog_tests, drainInSmallChunksMixedWithText) {
+    TraceLog trace;
+    trace.log<Trace::SystemTimeAsHorodate>(1U, 2U, 3U);
+    trace.log<Trace::NewDayDetected>();
+    trace.log<Trace::NewFrameId>(42U);
+    std::vector<uint8_t> dump;
+    std::string text("Dataset error\n");
+    std::size_t nbChunks = 0;
+    while (!trace.isEmpty()) {
+        trace.drain(appendToVector, &dump, TraceLog::RecordHeaderSize); /* Smaller than any record with arguments */
+        dump.insert(dump.end(), text.begin(), text.end()); /* Plain text printed between two drains must not end up inside a record */
+        nbChunks++;
+    }
+    EXPECT_EQ(3U, nbChunks);
+    EXPECT_EQ("Using systemtime (1:2:3) as horodate\nDataset error\n"
+              "Switch to new day detected\nDataset error\n"
+              "It seems we are in a new frame ID 42\nDataset error\n", decode(dump));
+}
+
+TEST(TraceLog_tests, unknownEventFallsBackToText) {
+    std::vector<uint8_t> dump { TraceLog::RecordMarker, 0xfe, 'o', 'k', '\n' };
+    EXPECT_EQ("<unknown trace event 254>\nok\n", decode(dump));
+}
+
+TEST(TraceLog_tests, droppedRecordsAreReported) {
+    TraceLog trace;
+    const std::size_t recordSize = TraceLog::RecordHeaderSize + sizeof(uint32_t);
+    unsigned int nbStored = 0;
+    for (unsigned int frame = 0; frame < TraceLog::Capacity; frame++) {
+        if (trace.log<Trace::NewFrameId>(frame)) {
+            nbStored++;
+        }
+    }
+    EXPECT_EQ(TraceLog::Capacity / recordSize, nbStored); /* Records are never truncated */
+    EXPECT_EQ(TraceLog::Capacity - nbStored, trace.getDroppedCount());
+
+    std::vector<uint8_t> dump;
+    while (!trace.isEmpty()) {
+        trace.drain(appendToVector, &dump, 100);
+    }
+    std::string text = decode(dump);
+    std::string expectedEnd = "It seems we are in a new frame ID " + std::to_string(nbStored - 1) + "\n"
+                              + std::to_string(TraceLog::Capacity - nbStored) + " trace record(s) dropped (trace buffer full)\n";
+    ASSERT_GE(text.size(), expectedEnd.size());
+    EXPECT_EQ(expectedEnd, text.substr(text.size() - expectedEnd.size()));
+
+    /* Logging resumes once there is room again, and drops are only reported once */
+    dump.clear();
+    EXPECT_TRUE(trace.log<Trace::NewFrameId>(7U));
+    trace.drain(appendToVector, &dump);
+    EXPECT_EQ("It seems we are in a new frame ID 7\n", decode(dump));
+}
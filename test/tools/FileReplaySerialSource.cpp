@@ -0,0 +1,108 @@
+#include "FileReplaySerialSource.h"
+
+#include <cstring>
+
+FileReplaySerialSource::FileReplaySerialSource(const std::vector<uint8_t>& capture, unsigned int baudrate, double speedFactor, FClockFunc clock, void* clockContext) :
+    capture(capture),
+    baudrate(baudrate),
+    speedFactor(speedFactor),
+    clock(clock),
+    clockContext(clockContext),
+    startTime(0),
+    consumed(0)
+{
+    this->start();
+}
+
+std::chrono::nanoseconds FileReplaySerialSource::now() const {
+    if (this->clock != nullptr) {
+        return this->clock(this->clockContext);
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+}
+
+void FileReplaySerialSource::start() {
+    this->startTime = this->now();
+    this->consumed = 0;
+}
+
+std::chrono::nanoseconds FileReplaySerialSource::getArrivalOffset(std::size_t pos) const {
+    if (this->speedFactor <= Unlimited || this->baudrate == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+    /* Byte pos is fully received once (pos+1) bytes have been shifted on the line */
+    double seconds = static_cast<double>(pos + 1) * BitsPerByte / this->baudrate / this->speedFactor;
+    return std::chrono::nanoseconds(static_cast<int64_t>(seconds * 1e9));
+}
+
+std::chrono::nanoseconds FileReplaySerialSource::getArrivalTime(std::size_t pos) const {
+    return this->startTime + this->getArrivalOffset(pos);
+}
+
+std::size_t FileReplaySerialSource::getArrivedCount() const {
+    if (this->speedFactor <= Unlimited || this->baudrate == 0) {
+        return this->capture.size();
+    }
+    std::chrono::nanoseconds elapsed = this->now() - this->startTime;
+    double arrived = std::chrono::duration<double>(elapsed).count() * this->speedFactor * this->baudrate / BitsPerByte;
+    if (arrived <= 0) {
+        return 0;
+    }
+    if (arrived >= static_cast<double>(this->capture.size())) {
+        return this->capture.size();
+    }
+    std::size_t count = static_cast<std::size_t>(arrived);
+    /* Fix floating point rounding, so that we are always consistent with getArrivalOffset() */
+    while (count > 0 && this->getArrivalOffset(count - 1) > elapsed) {
+        count--;
+    }
+    while (count < this->capture.size() && this->getArrivalOffset(count) <= elapsed) {
+        count++;
+    }
+    return count;
+}
+
+bool FileReplaySerialSource::isFinished() const {
+    return (this->consumed >= this->capture.size());
+}
+
+std::size_t FileReplaySerialSource::read(uint8_t* buffer, std::size_t maxLen) {
+    RxRegion regions[2];
+    if (this->peek(regions) == 0) {
+        return 0;
+    }
+    std::size_t len = regions[0].len;
+    if (len > maxLen) {
+        len = maxLen;
+    }
+    memcpy(buffer, regions[0].buf, len);
+    this->commit(len);
+    return len;
+}
+
+unsigned int FileReplaySerialSource::peek(RxRegion (&regions)[2]) {
+    std::size_t arrived = this->getArrivedCount();
+    regions[1] = RxRegion{nullptr, 0};  /* A capture is linear, there is never a second region */
+    if (arrived <= this->consumed) {
+        regions[0] = RxRegion{nullptr, 0};
+        return 0;
+    }
+    regions[0] = RxRegion{this->capture.data() + this->consumed, arrived - this->consumed};
+    return 1;
+}
+
+void FileReplaySerialSource::commit(std::size_t len) {
+    std::size_t available = this->capture.size() - this->consumed;
+    if (len > available) {
+        len = available;
+    }
+    this->consumed += len;
+}
+
+unsigned int FileReplaySerialSource::getRxOverflowCount(bool reset) {
+    return 0;   /* Bytes are never dropped, they are just delivered late if the consumer is too slow */
+}
+
+unsigned long FileReplaySerialSource::getRxBytesTotal() const {
+    return static_cast<unsigned long>(this->getArrivedCount());
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "SerialSource.h"
+
+/**
+ * @brief Host serial source replaying a TIC capture with the timing of a real serial link
+ *
+ * Byte n of the capture becomes available once the time needed to transmit bytes 0 to n on a serial line at the configured baudrate
+ * has elapsed since start(). TIC uses 7E1 framing, so each byte takes 10 bit times (start, 7 data bits, parity and stop).
+ * The replay can be accelerated by a speed factor, or run without any timing constraint (all bytes immediately available).
+ *
+ * Received bytes are returned in place, directly inside the capture (peek() never copies).
+ */
+class FileReplaySerialSource : public SerialSource {
+public:
+/* Types */
+    typedef std::chrono::nanoseconds(*FClockFunc)(void* context); /*!< A monotonic clock, returning the current time */
+
+    static constexpr unsigned int BitsPerByte = 10; /*!< 1 start bit, 7 data bits, 1 parity bit, 1 stop bit */
+    static constexpr double Unlimited = 0;  /*!< Speed factor value to make all bytes available immediately */
+
+/* Methods */
+    /**
+     * @brief Construct a new replay source
+     *
+     * @param capture The raw bytes to replay (the vector must outlive this object)
+     * @param baudrate The baudrate of the simulated serial line (1200 for historical TIC, 9600 for standard TIC)
+     * @param speedFactor How many times faster than real time bytes are delivered (Unlimited to deliver all bytes immediately)
+     * @param clock A clock function to use instead of std::chrono::steady_clock (allows tests to control time)
+     * @param clockContext A context pointer passed to @p clock
+     */
+    FileReplaySerialSource(const std::vector<uint8_t>& capture, unsigned int baudrate, double speedFactor = 1.0, FClockFunc clock = nullptr, void* clockContext = nullptr);
+
+    /**
+     * @brief Start the replay: the first byte starts being transmitted now
+     */
+    void start();
+
+    /**
+     * @brief Get the time at which a given byte of the capture becomes available, relative to start()
+     *
+     * @param pos The offset of the byte in the capture
+     */
+    std::chrono::nanoseconds getArrivalOffset(std::size_t pos) const;
+
+    /**
+     * @brief Get the absolute time (on our clock) at which a given byte of the capture becomes available
+     *
+     * @param pos The offset of the byte in the capture
+     */
+    std::chrono::nanoseconds getArrivalTime(std::size_t pos) const;
+
+    /**
+     * @brief Get the current time on our clock
+     */
+    std::chrono::nanoseconds now() const;
+
+    /**
+     * @brief Get the number of capture bytes that have arrived so far (whether consumed or not)
+     */
+    std::size_t getArrivedCount() const;
+
+    /**
+     * @brief Have all capture bytes been delivered and consumed?
+     */
+    bool isFinished() const;
+
+    std::size_t read(uint8_t* buffer, std::size_t maxLen) override;
+    unsigned int peek(RxRegion (&regions)[2]) override;
+    void commit(std::size_t len) override;
+    unsigned int getRxOverflowCount(bool reset = false) override;
+    unsigned long getRxBytesTotal() const override;
+
+private:
+/* Attributes */
+    const std::vector<uint8_t>& capture; /*!< The bytes to replay */
+    unsigned int baudrate;  /*!< The simulated line baudrate */
+    double speedFactor; /*!< The acceleration factor compared to real time */
+    FClockFunc clock;   /*!< An optional clock function (steady_clock if nullptr) */
+    void* clockContext; /*!< The context passed to the above clock function */
+    std::chrono::nanoseconds startTime; /*!< The time at which start() was invoked */
+    std::size_t consumed;   /*!< The number of bytes already committed by the consumer */
+};
@@ -0,0 +1,112 @@
+#include "PtySerialSource.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+PtySerialSource::PtySerialSource() :
+    masterFd(-1),
+    slaveFd(-1),
+    slavePath(),
+    rxRing(),
+    rxBytesTotal(0)
+{
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        return;
+    }
+    if (grantpt(fd) != 0 || unlockpt(fd) != 0 || ptsname(fd) == nullptr) {
+        close(fd);
+        return;
+    }
+    this->slavePath = ptsname(fd);
+    this->slaveFd = open(this->slavePath.c_str(), O_RDWR | O_NOCTTY);
+    if (this->slaveFd < 0) {
+        close(fd);
+        this->slavePath.clear();
+        return;
+    }
+    /* TIC is a binary-transparent byte stream for us: no echo, no line discipline, no CR/LF translation */
+    struct termios tio;
+    if (tcgetattr(this->slaveFd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(this->slaveFd, TCSANOW, &tio);
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    this->masterFd = fd;
+}
+
+PtySerialSource::~PtySerialSource() {
+    if (this->slaveFd >= 0) {
+        close(this->slaveFd);
+    }
+    if (this->masterFd >= 0) {
+        close(this->masterFd);
+    }
+}
+
+bool PtySerialSource::isOpen() const {
+    return (this->masterFd >= 0);
+}
+
+const std::string& PtySerialSource::getSlavePath() const {
+    return this->slavePath;
+}
+
+void PtySerialSource::pollPty() {
+    if (this->masterFd < 0) {
+        return;
+    }
+    uint8_t chunk[256];
+    while (this->rxRing.getCount() < this->rxRing.getCapacity()) {
+        std::size_t room = this->rxRing.getCapacity() - this->rxRing.getCount();
+        ssize_t got = ::read(this->masterFd, chunk, (room < sizeof(chunk)) ? room : sizeof(chunk));
+        if (got <= 0) {
+            break;  /* Nothing more pending (EAGAIN) or error */
+        }
+        this->rxRing.push(chunk, static_cast<std::size_t>(got));
+        this->rxBytesTotal += static_cast<unsigned long>(got);
+    }
+}
+
+bool PtySerialSource::waitForData(int timeoutMs) {
+    if (!this->rxRing.isEmpty()) {
+        return true;
+    }
+    if (this->masterFd < 0) {
+        return false;
+    }
+    struct pollfd pfd;
+    pfd.fd = this->masterFd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (poll(&pfd, 1, timeoutMs) <= 0) {
+        return false;
+    }
+    this->pollPty();
+    return !this->rxRing.isEmpty();
+}
+
+std::size_t PtySerialSource::read(uint8_t* buffer, std::size_t maxLen) {
+    this->pollPty();
+    return this->rxRing.pop(buffer, maxLen);
+}
+
+unsigned int PtySerialSource::peek(RxRegion (&regions)[2]) {
+    this->pollPty();
+    return this->rxRing.peek(regions);
+}
+
+void PtySerialSource::commit(std::size_t len) {
+    this->rxRing.commit(len);
+}
+
+unsigned int PtySerialSource::getRxOverflowCount(bool reset) {
+    return 0;   /* When our ring is full, bytes stay queued in the pty, they are never lost */
+}
+
+unsigned long PtySerialSource::getRxBytesTotal() const {
+    return this->rxBytesTotal;
+}
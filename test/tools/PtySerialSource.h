@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "SerialSource.h"
+#include "SpscByteRing.h"
+
+/**
+ * @brief Host serial source reading from a Linux pseudo-terminal
+ *
+ * A new pty pair is allocated at construction, in raw mode. Any program can then write TIC bytes to the slave side
+ * (for example `cat capture.bin > /dev/pts/N`, or a serial forwarder such as socat), and we read them on the master side.
+ * Bytes read from the master are buffered in a ring, from which peek() returns them in place.
+ */
+class PtySerialSource : public SerialSource {
+public:
+    static constexpr std::size_t RxRingSize = 4096; /*!< The size of the reception ring between the pty and the consumer */
+
+    PtySerialSource();
+    ~PtySerialSource();
+
+    /**
+     * @brief Did the pty pair allocation succeed?
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Get the path of the slave side of the pty, where TIC bytes should be written
+     *
+     * @return The path to the slave device (eg: /dev/pts/3), or an empty string if no pty could be allocated
+     */
+    const std::string& getSlavePath() const;
+
+    /**
+     * @brief Wait until bytes are available on the pty (or already buffered)
+     *
+     * @param timeoutMs The maximum time to wait (in ms)
+     * @return true if bytes are available
+     */
+    bool waitForData(int timeoutMs);
+
+    std::size_t read(uint8_t* buffer, std::size_t maxLen) override;
+    unsigned int peek(RxRegion (&regions)[2]) override;
+    void commit(std::size_t len) override;
+    unsigned int getRxOverflowCount(bool reset = false) override;
+    unsigned long getRxBytesTotal() const override;
+
+private:
+    PtySerialSource(const PtySerialSource&) = delete;
+    PtySerialSource& operator= (const PtySerialSource&) = delete;
+
+    /**
+     * @brief Move all bytes pending on the pty master (without blocking) to our reception ring, as long as there is room for them
+     */
+    void pollPty();
+
+/* Attributes */
+    int masterFd;   /*!< The file descriptor for the master side of the pty (-1 if not open) */
+    int slaveFd;    /*!< A file descriptor we keep open on the slave side, so that the pty survives writers closing it */
+    std::string slavePath;  /*!< The path to the slave side of the pty */
+    SpscByteRing<RxRingSize> rxRing;  /*!< Bytes read from the pty, not yet committed by the consumer */
+    unsigned long rxBytesTotal; /*!< The total number of bytes read from the pty */
+};
@@ -66,3 +66,28 @@ std::string vectorToHexString(const std::vector<uint8_t>& vec) {
 	}
 	return out.str();
 }
+
+std::vector<uint8_t> standardTicDataset(const std::string& label, const std::string& value, const std::string& horodate) {
+    std::string dataset = label + '\t';
+    if (!horodate.empty()) {
+        dataset += horodate + '\t';
+    }
+    dataset += value + '\t';
+    unsigned int sum = 0;
+    for (char c : dataset) {
+        sum += static_cast<uint8_t>(c);
+    }
+    dataset += static_cast<char>((sum & 0x3f) + 0x20);   /* The checksum covers the label up to the last separator */
+    return std::vector<uint8_t>(dataset.begin(), dataset.end());
+}
+
+std::vector<uint8_t> historicalTicDataset(const std::string& label, const std::string& value) {
+    std::string dataset = label + ' ' + value;
+    unsigned int sum = 0;
+    for (char c : dataset) {
+        sum += static_cast<uint8_t>(c);
+    }
+    dataset += ' ';
+    dataset += static_cast<char>((sum & 0x3f) + 0x20);   /* The checksum does not cover the last separator */
+    return std::vector<uint8_t>(dataset.begin(), dataset.end());
+}
@@ -6,6 +6,25 @@
 
 std::string vectorToHexString(const std::vector<uint8_t> &vec);
 
+/**
+ * @brief Build a standard TIC dataset with a valid checksum, as provided by TIC::DatasetExtractor (without the surrounding LF and CR)
+ *
+ * @param label The dataset label
+ * @param value The dataset value
+ * @param horodate An optional horodate (inserted between the label and the value if not empty)
+ * @return The dataset bytes
+ */
+std::vector<uint8_t> standardTicDataset(const std::string& label, const std::string& value, const std::string& horodate = "");
+
+/**
+ * @brief Build a historical TIC dataset with a valid checksum, as provided by TIC::DatasetExtractor (without the surrounding LF and CR)
+ *
+ * @param label The dataset label
+ * @param value The dataset value
+ * @return The dataset bytes
+ */
+std::vector<uint8_t> historicalTicDataset(const std::string& label, const std::string& value);
+
 inline std::vector<uint8_t> readVectorFromDisk(const std::string& inputFilename) {
     std::ifstream instream(inputFilename, std::ios::in | std::ios::binary);
     if (instream.rdstate() & std::ios_base::failbit) {
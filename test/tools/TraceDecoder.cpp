@@ -0,0 +1,119 @@
+#include "TraceDecoder.h"
+
+#include <cstdio>
+
+#include "TicLabelTable.h"
+
+namespace {
+const char* const formats[] = {
+#define TRACE_EVENT_FORMAT(name, argCount, format) format,
+    TRACE_EVENTS(TRACE_EVENT_FORMAT)
+#undef TRACE_EVENT_FORMAT
+};
+
+constexpr bool argCountsFit() {
+    for (uint8_t argCount : Trace::ArgCounts) {
+        if (argCount > TraceDecoder::MaxArgs) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(argCountsFit(), "A trace event has more arguments than TraceDecoder can handle");
+}
+
+TraceDecoder::TraceDecoder() :
+    text(),
+    inRecord(false),
+    eventKnown(false),
+    event(Trace::EventCount),
+    argBytes(),
+    argBytesCount(0)
+{
+}
+
+std::string TraceDecoder::formatEvent(Trace::Event event, const uint32_t* args) {
+    if (event >= Trace::EventCount) {
+        return "<unknown trace event " + std::to_string(static_cast<unsigned int>(event)) + ">";
+    }
+    std::string result;
+    unsigned int argIndex = 0;
+    for (const char* format = formats[event]; *format != '\0'; format++) {
+        if (*format != '%' || format[1] == '\0' || argIndex >= Trace::ArgCounts[event]) {
+            result += *format;
+            continue;
+        }
+        format++;
+        uint32_t arg = args[argIndex++];
+        switch (*format) {
+            case 'u':
+                result += std::to_string(arg);
+                break;
+            case 'd':
+                result += std::to_string(static_cast<int32_t>(arg));
+                break;
+            case 'x': {
+                char hex[8 + 1];
+                snprintf(hex, sizeof(hex), "%x", arg);
+                result += hex;
+                break;
+            }
+            case 'L':
+                result += (arg < TicLabelTable::LabelCount) ? TicLabelTable::getName(static_cast<TicLabelTable::Label>(arg)) : "?";
+                if (arg == TicLabelTable::Unknown) {
+                    result += "<unknown label>";
+                }
+                break;
+            default:    /* Not a conversion, print it as is */
+                result += '%';
+                result += *format;
+                argIndex--;
+                break;
+        }
+    }
+    return result;
+}
+
+void TraceDecoder::pushBytes(const uint8_t* buf, std::size_t len) {
+    for (std::size_t pos = 0; pos < len; pos++) {
+        uint8_t byte = buf[pos];
+        if (!this->inRecord) {
+            if (byte == TraceLog::RecordMarker) {
+                this->inRecord = true;
+                this->eventKnown = false;
+                this->argBytesCount = 0;
+            }
+            else {
+                this->text += static_cast<char>(byte);
+            }
+            continue;
+        }
+        if (!this->eventKnown) {
+            this->event = static_cast<Trace::Event>(byte);
+            this->eventKnown = true;
+            if (this->event >= Trace::EventCount) {
+                this->text += formatEvent(this->event, nullptr) + "\n";
+                this->inRecord = false;   /* We cannot know the length of this record, go on as if it was text */
+                continue;
+            }
+        }
+        else {
+            this->argBytes[this->argBytesCount++] = byte;
+        }
+        if (this->argBytesCount == Trace::ArgCounts[this->event] * sizeof(uint32_t)) {
+            uint32_t args[MaxArgs];
+            for (unsigned int arg = 0; arg < Trace::ArgCounts[this->event]; arg++) {
+                const uint8_t* argLE = this->argBytes + arg * sizeof(uint32_t);
+                args[arg] = static_cast<uint32_t>(argLE[0]) | (static_cast<uint32_t>(argLE[1]) << 8) | (static_cast<uint32_t>(argLE[2]) << 16) | (static_cast<uint32_t>(argLE[3]) << 24);
+            }
+            this->text += formatEvent(this->event, args) + "\n";
+            this->inRecord = false;
+        }
+    }
+}
+
+std::string TraceDecoder::takeText() {
+    std::string result;
+    result.swap(this->text);
+    return result;
+}
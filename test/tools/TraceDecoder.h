@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "TraceLog.h"
+
+/**
+ * @brief Host-side decoder turning a debug console dump (plain text mixed with TraceLog binary records) back into text
+ *
+ * Plain text is kept as is, each binary record is replaced by its format string from TraceEvents.h (with its arguments), followed by a new line.
+ * Bytes can be pushed in chunks of any size, records split across chunks are decoded once complete.
+ */
+class TraceDecoder {
+public:
+/* Types */
+    static constexpr std::size_t MaxArgs = 8; /*!< The maximum number of arguments of an event */
+
+/* Methods */
+    TraceDecoder();
+
+    /**
+     * @brief Decode more bytes of the dump
+     *
+     * @param buf The dump bytes
+     * @param len The number of bytes in @p buf
+     */
+    void pushBytes(const uint8_t* buf, std::size_t len);
+
+    /**
+     * @brief Get the text decoded so far, and forget it
+     */
+    std::string takeText();
+
+    /**
+     * @brief Format a trace event the way printf() would, using its format string from TraceEvents.h
+     *
+     * @param event The event
+     * @param args The arguments of the event (Trace::ArgCounts[event] values)
+     * @return The formatted text (without a trailing new line)
+     */
+    static std::string formatEvent(Trace::Event event, const uint32_t* args);
+
+private:
+/* Attributes */
+    std::string text; /*!< The text decoded so far */
+    bool inRecord; /*!< Are we inside a binary record? */
+    bool eventKnown; /*!< Inside a record, have we received the event ID yet? */
+    Trace::Event event; /*!< The event of the current record */
+    uint8_t argBytes[MaxArgs * sizeof(uint32_t)]; /*!< The argument bytes of the current record received so far */
+    std::size_t argBytesCount; /*!< The number of bytes in argBytes */
+};
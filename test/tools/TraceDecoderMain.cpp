@@ -0,0 +1,33 @@
+#include <cstdio>
+#include <vector>
+
+#include "Tools.h"
+#include "TraceDecoder.h"
+
+/**
+ * @brief Decode debug console dumps containing TraceLog records
+ *
+ * Usage: trace_decoder [dump file...]
+ * Dumps are read from the standard input if no file is provided (for example: cat /dev/ttyACM0 | trace_decoder), the decoded text goes to the standard output
+ */
+int main(int argc, char* argv[]) {
+    TraceDecoder decoder;
+    if (argc <= 1) {
+        uint8_t buf[256];
+        std::size_t len;
+        while ((len = fread(buf, 1, sizeof(buf), stdin)) > 0) {
+            decoder.pushBytes(buf, len);
+            std::string text = decoder.takeText();
+            fwrite(text.data(), 1, text.size(), stdout);
+            fflush(stdout);
+        }
+        return 0;
+    }
+    for (int arg = 1; arg < argc; arg++) {
+        std::vector<uint8_t> dump = readVectorFromDisk(argv[arg]);
+        decoder.pushBytes(dump.data(), dump.size());
+        std::string text = decoder.takeText();
+        fwrite(text.data(), 1, text.size(), stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include "UartLineSimulator.h"
+
+#include <cmath>
+
+static const unsigned int BitsPerFrame = 10; /* 1 start bit, 7 data bits, 1 parity bit, 1 stop bit */
+
+static bool evenParityBit(uint8_t data) {
+    unsigned int ones = 0;
+    for (unsigned int bit = 0; bit < 7; bit++) {
+        ones += (data >> bit) & 1;
+    }
+    return (ones % 2) != 0;  /* Set the parity bit so that the total number of 1s is even */
+}
+
+UartLineSimulator::UartLineSimulator(const std::vector<uint8_t>& txBytes, unsigned int txBaudRate) :
+    txBytes(txBytes),
+    txBaudRate(txBaudRate),
+    cursorSeconds(0)
+{
+}
+
+double UartLineSimulator::getTransmissionEnd() const {
+    return static_cast<double>(this->txBytes.size() * BitsPerFrame) / this->txBaudRate;
+}
+
+bool UartLineSimulator::lineLevel(double timeSeconds) const {
+    if (timeSeconds < 0) {
+        return true;
+    }
+    return this->bitLevel(static_cast<uint64_t>(std::floor(timeSeconds * this->txBaudRate)));
+}
+
+bool UartLineSimulator::bitLevel(uint64_t bitIndex) const {
+    uint64_t byteIndex = bitIndex / BitsPerFrame;
+    if (byteIndex >= this->txBytes.size()) {
+        return true;    /* Idle line */
+    }
+    uint8_t data = this->txBytes[byteIndex] & 0x7f;
+    unsigned int bitInFrame = static_cast<unsigned int>(bitIndex % BitsPerFrame);
+    if (bitInFrame == 0) {
+        return false;   /* Start bit */
+    }
+    if (bitInFrame <= 7) {
+        return ((data >> (bitInFrame - 1)) & 1) != 0;
+    }
+    if (bitInFrame == 8) {
+        return evenParityBit(data);
+    }
+    return true;    /* Stop bit */
+}
+
+double UartLineSimulator::findNextStartBit(double fromSeconds) const {
+    /* The line level only changes on transmitter bit boundaries, so we can walk on them */
+    uint64_t endBit = static_cast<uint64_t>(this->txBytes.size()) * BitsPerFrame;
+    uint64_t bit = static_cast<uint64_t>(std::floor(fromSeconds * this->txBaudRate));
+    if (bit == 0 && !this->bitLevel(0)) {
+        return 0;   /* The line was idle before transmission started, so the very first start bit is a falling edge */
+    }
+    while (bit < endBit && !this->bitLevel(bit)) {  /* Wait for the line to go high */
+        bit++;
+    }
+    while (bit < endBit && this->bitLevel(bit)) {   /* Wait for the falling edge */
+        bit++;
+    }
+    if (bit >= endBit) {
+        return -1;
+    }
+    double edge = static_cast<double>(bit) / this->txBaudRate;
+    return (edge < fromSeconds) ? fromSeconds : edge;
+}
+
+std::vector<UartReceivedByte> UartLineSimulator::receiveUntil(double untilSeconds, unsigned int rxBaudRate) {
+    std::vector<UartReceivedByte> result;
+    double rxBitTime = 1.0 / rxBaudRate;
+    while (this->cursorSeconds < untilSeconds) {
+        double start = this->findNextStartBit(this->cursorSeconds);
+        if (start < 0) {
+            this->cursorSeconds = untilSeconds;  /* Nothing more on the line */
+            break;
+        }
+        if (start >= untilSeconds) {
+            break;  /* Next byte is after this slot, we will find it again on next call (the cursor has to stay before its falling edge) */
+        }
+        if (this->lineLevel(start + rxBitTime / 2)) {
+            this->cursorSeconds = start + rxBitTime / 2; /* Glitch, not a real start bit (line is high again at mid start bit) */
+            continue;
+        }
+        uint8_t data = 0;
+        unsigned int ones = 0;
+        for (unsigned int bit = 0; bit < 7; bit++) {
+            if (this->lineLevel(start + (bit + 1.5) * rxBitTime)) {
+                data |= (1 << bit);
+                ones++;
+            }
+        }
+        bool parity = this->lineLevel(start + 8.5 * rxBitTime);
+        bool stop = this->lineLevel(start + 9.5 * rxBitTime);
+        UartReceivedByte received;
+        received.byte = data;
+        received.parityError = (((ones + (parity ? 1 : 0)) % 2) != 0);
+        received.framingError = !stop;
+        received.timeSeconds = start + 9.5 * rxBitTime;
+        result.push_back(received);
+        this->cursorSeconds = start + 9.5 * rxBitTime;  /* Resume looking for a start bit from the middle of the stop bit */
+    }
+    return result;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief A byte as decoded by a simulated UART receiver
+ */
+struct UartReceivedByte {
+    uint8_t byte;   /*!< The 7 data bits */
+    bool parityError;   /*!< Did the even parity check fail? */
+    bool framingError;  /*!< Was the stop bit sampled low? */
+    double timeSeconds; /*!< When the byte was available (end of the stop bit) */
+};
+
+/**
+ * @brief Bit-level simulation of a 7E1 serial line, as used by TIC
+ *
+ * A byte stream is transmitted back-to-back at a given baudrate (1 start bit, 7 data bits LSB first, 1 even parity bit, 1 stop bit).
+ * It is then sampled by a receiver that may run at another baudrate, the way a UART does: it waits for the line to be idle (high),
+ * then for a falling edge (start bit), and then samples each bit at its middle.
+ * When the receiver baudrate is wrong, this produces the same kind of garbage and line errors a real UART would produce.
+ */
+class UartLineSimulator {
+public:
+    /**
+     * @brief Construct a new line simulator
+     *
+     * @param txBytes The bytes transmitted on the line (the vector must outlive this object)
+     * @param txBaudRate The baudrate of the transmitter
+     */
+    UartLineSimulator(const std::vector<uint8_t>& txBytes, unsigned int txBaudRate);
+
+    /**
+     * @brief Receive all bytes whose start bit begins before a given time
+     *
+     * Successive calls continue where the previous one stopped, each call can use a different receiver baudrate (to simulate a UART reconfiguration)
+     *
+     * @param untilSeconds The end of the reception slot (time 0 is the start of transmission)
+     * @param rxBaudRate The baudrate of the receiver
+     * @return The bytes received
+     */
+    std::vector<UartReceivedByte> receiveUntil(double untilSeconds, unsigned int rxBaudRate);
+
+    /**
+     * @brief Get the time at which the transmitter is done
+     */
+    double getTransmissionEnd() const;
+
+    /**
+     * @brief Get the level of the line at a given time
+     *
+     * @return true for high (idle or 1 bit), false for low
+     */
+    bool lineLevel(double timeSeconds) const;
+
+private:
+    /**
+     * @brief Get the level of the line during a given transmitter bit period
+     *
+     * @param bitIndex The index of the bit period since the start of transmission
+     */
+    bool bitLevel(uint64_t bitIndex) const;
+
+    /**
+     * @brief Find the first time, at or after @p fromSeconds, where the line is high then falls
+     *
+     * @return The time of the falling edge, or a negative value if there is none before the end of transmission
+     */
+    double findNextStartBit(double fromSeconds) const;
+
+/* Attributes */
+    const std::vector<uint8_t>& txBytes;    /*!< The transmitted bytes */
+    unsigned int txBaudRate;    /*!< The transmitter baudrate */
+    double cursorSeconds;   /*!< Where the receiver resumes looking for a start bit */
+};
@@ -0,0 +1,61 @@
+#include "VirtualClock.h"
+
+VirtualClock::VirtualClock(uint32_t idleStep) :
+    time(0),
+    idleStep(idleStep),
+    idleCount(0),
+    interrupts()
+{
+}
+
+uint32_t VirtualClock::now() const {
+    return static_cast<uint32_t>(this->time);
+}
+
+void VirtualClock::runUntil(uint64_t until) {
+    while (!this->interrupts.empty() && this->interrupts.begin()->first <= until) {
+        std::multimap<uint64_t, Interrupt>::iterator next = this->interrupts.begin();
+        uint64_t at = next->first;
+        Interrupt interrupt = next->second;
+        this->interrupts.erase(next);
+        if (at > this->time) {
+            this->time = at;
+        }
+        if (interrupt.period != 0) {
+            this->interrupts.insert(std::make_pair(at + interrupt.period, interrupt));
+        }
+        interrupt.handler(interrupt.context);   /* Interrupts preempt the main context, they take no time here */
+    }
+    if (until > this->time) {
+        this->time = until;
+    }
+}
+
+void VirtualClock::advance(uint32_t duration) {
+    this->runUntil(this->time + duration);
+}
+
+void VirtualClock::idle() {
+    this->idleCount++;
+    uint64_t wakeUp = this->time + this->idleStep;
+    if (!this->interrupts.empty() && this->interrupts.begin()->first < wakeUp) {
+        wakeUp = this->interrupts.begin()->first;
+    }
+    this->runUntil(wakeUp);
+}
+
+void VirtualClock::scheduleInterrupt(uint64_t at, FInterruptFunc handler, void* context, uint32_t period) {
+    this->interrupts.insert(std::make_pair(at, Interrupt{handler, context, period}));
+}
+
+unsigned int VirtualClock::getIdleCount() const {
+    return this->idleCount;
+}
+
+uint32_t VirtualClock::getTime(void* context) {
+    return static_cast<VirtualClock*>(context)->now();
+}
+
+void VirtualClock::sleep(void* context) {
+    static_cast<VirtualClock*>(context)->idle();
+}
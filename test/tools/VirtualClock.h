@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+/**
+ * @brief Simulated time source, with simulated interrupts, to run an EventScheduler on host
+ *
+ * Time (in µs) only moves forward when advance() or idle() is invoked. Interrupts are scheduled at given times (possibly periodically),
+ * and are fired, in time order, as soon as time reaches them (including while a handler is consuming time using advance()).
+ * idle() models a WFI: it jumps to the next interrupt, but never further than idleStep (like the SysTick would wake up the core).
+ */
+class VirtualClock {
+public:
+/* Types */
+    typedef void(*FInterruptFunc)(void* context);   /*!< The prototype of simulated interrupt handlers */
+
+/* Methods */
+    /**
+     * @brief Construct a new virtual clock, starting at time 0
+     *
+     * @param idleStep The maximum time slept in idle() (in µs)
+     */
+    VirtualClock(uint32_t idleStep = 1000);
+
+    /**
+     * @brief Get the current time (in µs)
+     */
+    uint32_t now() const;
+
+    /**
+     * @brief Consume time, firing all interrupts scheduled in that time span
+     *
+     * @param duration The time to consume (in µs)
+     */
+    void advance(uint32_t duration);
+
+    /**
+     * @brief Sleep until the next interrupt (or for idleStep at most)
+     */
+    void idle();
+
+    /**
+     * @brief Schedule a simulated interrupt
+     *
+     * @param at When the interrupt fires (in µs)
+     * @param handler The function to run when the interrupt fires
+     * @param context A user-defined pointer that will be passed as argument when invoking handler()
+     * @param period If not 0, the interrupt fires again every @p period µs
+     */
+    void scheduleInterrupt(uint64_t at, FInterruptFunc handler, void* context = nullptr, uint32_t period = 0);
+
+    /**
+     * @brief Get the number of times idle() has been invoked
+     */
+    unsigned int getIdleCount() const;
+
+    /**
+     * @brief Adapter to use a VirtualClock as an EventScheduler time source
+     *
+     * @param context A pointer to the VirtualClock
+     */
+    static uint32_t getTime(void* context);
+
+    /**
+     * @brief Adapter to use a VirtualClock as an EventScheduler idle function
+     *
+     * @param context A pointer to the VirtualClock
+     */
+    static void sleep(void* context);
+
+private:
+    struct Interrupt {
+        FInterruptFunc handler; /*!< The function to run */
+        void* context;  /*!< The argument passed to handler() */
+        uint32_t period;    /*!< The period of the interrupt (0 for a one-shot interrupt) */
+    };
+
+    /**
+     * @brief Move time forward up to a given time, firing all interrupts scheduled up to that time
+     */
+    void runUntil(uint64_t until);
+
+/* Attributes */
+    uint64_t time;  /*!< The current time (in µs) */
+    uint32_t idleStep;  /*!< The maximum time slept in idle() */
+    unsigned int idleCount; /*!< How many times idle() has been invoked */
+    std::multimap<uint64_t, Interrupt> interrupts;  /*!< Scheduled interrupts, by firing time */
+};